@@ -141,7 +141,9 @@ bool MiracastGstPlayer::launch(std::string& localip , std::string& streaming_por
     {
         m_rtsp_reference_instance = rtsp_instance;
     }
+    MiracastSessionTracer::getInstance()->span_begin(MIRACAST_SPAN_PIPELINE_SETUP);
     ret = createPipeline();
+    MiracastSessionTracer::getInstance()->span_end(MIRACAST_SPAN_PIPELINE_SETUP);
     if ( !ret ){
         m_rtsp_reference_instance = nullptr;
         MIRACASTLOG_ERROR("Failed to create the pipeline");
@@ -204,24 +206,22 @@ void *MiracastGstPlayer::playbackThread(void *ctx)
 void* MiracastGstPlayer::monitor_player_statistics_thread(void *ctx)
 {
     MiracastGstPlayer *self = (MiracastGstPlayer *)ctx;
-    int elapsed_seconds = 0,
-        stats_timeout = 0;
+    int elapsed_seconds = 0;
+    uint64_t stats_timeout = 0;
     MIRACASTLOG_TRACE("Entering..!!!");
     self->m_statistics_thread_loop = true;
     struct timespec start_time, current_time;
-    std::string opt_flag_buffer = "";
+    MiracastOptFlags *opt_flags = MiracastOptFlags::getInstance();
 
     clock_gettime(CLOCK_REALTIME, &start_time);
     while (true == self->m_statistics_thread_loop)
     {
         clock_gettime(CLOCK_REALTIME, &current_time);
-        opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_player_stats",true,false);
 
-        if (!opt_flag_buffer.empty())
+        if (opt_flags->get_integer(MIRACAST_OPT_PLAYER_STATS, stats_timeout))
         {
-            stats_timeout = std::atoi(opt_flag_buffer.c_str());
             elapsed_seconds = current_time.tv_sec - start_time.tv_sec;
-            if (elapsed_seconds >= stats_timeout)
+            if ((uint64_t)elapsed_seconds >= stats_timeout)
             {
                 self->get_player_statistics();
                 // Refresh the Statistics time
@@ -390,6 +390,7 @@ void MiracastGstPlayer::onFirstVideoFrameCallback(GstElement* object, guint arg0
     MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
 
     self->m_firstVideoFrameReceived = true;
+    MiracastSessionTracer::getInstance()->span_end(MIRACAST_SPAN_FIRST_VIDEO_FRAME);
     MIRACASTLOG_INFO("!!! First Video Frame has received !!!");
     self->notifyPlaybackState(MIRACAST_GSTPLAYER_STATE_FIRST_VIDEO_FRAME_RECEIVED);
     MIRACASTLOG_TRACE("Exiting..!!!");
@@ -793,11 +794,11 @@ bool MiracastGstPlayer::createPipeline()
     MIRACASTLOG_TRACE(">>>>>>>rtpjitterbuffer configuration start");
     MIRACASTLOG_TRACE("Set the 'post-drop-messages' and 'do-lost' to rtpjitterbuffer.");
     g_object_set(G_OBJECT(m_rtpjitterbuffer), "post-drop-messages", true, "do-lost" , true , nullptr );
-    std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_faststart-min-packets",true,false);
+    MiracastOptFlags *opt_flags = MiracastOptFlags::getInstance();
+    uint64_t packetsPerBuffer = 0;
 
-    if (!opt_flag_buffer.empty())
+    if (opt_flags->get_integer(MIRACAST_OPT_FASTSTART_MIN_PACKETS, packetsPerBuffer))
     {
-        uint64_t packetsPerBuffer = std::stoull(opt_flag_buffer);
         MIRACASTLOG_INFO("Set 'faststart-min-packets' to rtpjitterbuffer");
         g_object_set(G_OBJECT(m_rtpjitterbuffer), "faststart-min-packets", packetsPerBuffer, nullptr );
     }
@@ -809,11 +810,8 @@ bool MiracastGstPlayer::createPipeline()
     MIRACASTLOG_TRACE(">>>>>>>tsparse configuration start");
     MIRACASTLOG_TRACE("Set 'set-timestamps' to tsparse");
     g_object_set(G_OBJECT(m_tsparse), "set-timestamps", true, nullptr );
-    opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_tsparse_alignment",true,false);
-
-    if (!opt_flag_buffer.empty())
+    if (opt_flags->get_integer(MIRACAST_OPT_TSPARSE_ALIGNMENT, packetsPerBuffer))
     {
-        uint64_t packetsPerBuffer = std::stoull(opt_flag_buffer);
         MIRACASTLOG_INFO("Set 'alignment' to tsparse");
         g_object_set(G_OBJECT(m_tsparse), "alignment", packetsPerBuffer, nullptr );
     }
@@ -0,0 +1,53 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2026 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include <interfaces/IMiracastPlayer.h>
+
+namespace WPEFramework
+{
+    namespace Exchange
+    {
+        /*
+         * Session setup timeline of the player. Kept next to the plugin until it moves
+         * into IMiracastPlayer; without proxy stubs it is only reachable in-process.
+         */
+        struct EXTERNAL IMiracastPlayerSessionTrace : virtual public Core::IUnknown
+        {
+            enum { ID = IMiracastPlayer::ID + 0x40 };
+
+            struct EXTERNAL INotification : virtual public Core::IUnknown
+            {
+                enum { ID = IMiracastPlayerSessionTrace::ID + 1 };
+
+                /* breakdown is the per-phase JSON the session end logs as MCAST-TIMELINE */
+                virtual void OnSessionBreakdown(const string &clientMac, const bool success, const string &breakdown) = 0;
+            };
+
+            virtual Core::hresult Register(INotification *notification) = 0;
+            virtual Core::hresult Unregister(INotification *notification) = 0;
+
+            /* Active session, else the last completed one; "{}" before the first session */
+            virtual Core::hresult GetSessionBreakdown(string &breakdown) = 0;
+            virtual Core::hresult ExportSessionTrace(const string &filePath) = 0;
+        };
+    } // namespace Exchange
+} // namespace WPEFramework
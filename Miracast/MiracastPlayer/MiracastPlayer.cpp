@@ -98,6 +98,14 @@ namespace WPEFramework
                             mMiracastPlayerImpl->Register(&mMiracastPlayerNotification);
                             /* Invoking Plugin API register to wpeframework */
                             Exchange::JMiracastPlayer::Register(*this, mMiracastPlayerImpl);
+
+                            mSessionTrace = mMiracastPlayerImpl->QueryInterface<Exchange::IMiracastPlayerSessionTrace>();
+                            if (nullptr != mSessionTrace)
+                            {
+                                mSessionTrace->Register(&mMiracastPlayerNotification);
+                                PluginHost::JSONRPC::Register<JsonObject, JsonObject>(_T("getSessionBreakdown"), &MiracastPlayer::getSessionBreakdown, this);
+                                PluginHost::JSONRPC::Register<JsonObject, JsonObject>(_T("exportSessionTrace"), &MiracastPlayer::exportSessionTrace, this);
+                            }
                         }
                        
                     }
@@ -135,6 +143,14 @@ namespace WPEFramework
             ASSERT(0 == mConnectionId);
             if (nullptr != mMiracastPlayerImpl)
             {
+                if (nullptr != mSessionTrace)
+                {
+                    PluginHost::JSONRPC::Unregister(_T("getSessionBreakdown"));
+                    PluginHost::JSONRPC::Unregister(_T("exportSessionTrace"));
+                    mSessionTrace->Unregister(&mMiracastPlayerNotification);
+                    mSessionTrace->Release();
+                    mSessionTrace = nullptr;
+                }
                 mMiracastPlayerImpl->Unregister(&mMiracastPlayerNotification);
                 Exchange::JMiracastPlayer::Unregister(*this);
                 if (mConfigure)
@@ -193,6 +209,29 @@ namespace WPEFramework
             return("This MiracastPlayer Plugin Facilitates Miracast session like RTSP communication and GStreamer Playback");
         }
 
+        uint32_t MiracastPlayer::getSessionBreakdown(const JsonObject &parameters, JsonObject &response)
+        {
+            string breakdown;
+            JsonObject timeline;
+            uint32_t result = mSessionTrace->GetSessionBreakdown(breakdown);
+
+            if (Core::ERROR_NONE == result)
+            {
+                timeline.FromString(breakdown);
+                response["breakdown"] = timeline;
+            }
+            response["success"] = (Core::ERROR_NONE == result);
+            return result;
+        }
+
+        uint32_t MiracastPlayer::exportSessionTrace(const JsonObject &parameters, JsonObject &response)
+        {
+            uint32_t result = mSessionTrace->ExportSessionTrace(parameters["file"].String());
+
+            response["success"] = (Core::ERROR_NONE == result);
+            return result;
+        }
+
         void MiracastPlayer::Deactivated(RPC::IRemoteConnection* connection)
         {
             if (connection->Id() == mConnectionId) {
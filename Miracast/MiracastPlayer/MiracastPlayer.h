@@ -24,6 +24,7 @@
 #include <interfaces/json/JMiracastPlayer.h>
 #include <interfaces/IMiracastPlayer.h>
 #include <interfaces/IConfiguration.h>
+#include "IMiracastPlayerSessionTrace.h"
 #include "UtilsLogging.h"
 #include "tracing/Logging.h"
 #include <mutex>
@@ -36,7 +37,8 @@ namespace WPEFramework
         {
             private:
                 class Notification : public RPC::IRemoteConnection::INotification,
-                                    public Exchange::IMiracastPlayer::INotification
+                                    public Exchange::IMiracastPlayer::INotification,
+                                    public Exchange::IMiracastPlayerSessionTrace::INotification
                 {
                     private:
                         Notification() = delete;
@@ -56,6 +58,7 @@ namespace WPEFramework
 
                         BEGIN_INTERFACE_MAP(Notification)
                         INTERFACE_ENTRY(Exchange::IMiracastPlayer::INotification)
+                        INTERFACE_ENTRY(Exchange::IMiracastPlayerSessionTrace::INotification)
                         INTERFACE_ENTRY(RPC::IRemoteConnection::INotification)
                         END_INTERFACE_MAP
 
@@ -74,6 +77,18 @@ namespace WPEFramework
                             Exchange::JMiracastPlayer::Event::OnStateChange(_parent, clientName, clientMac, playerState, reasonCode, reasonDescription);
                         }
 
+                        void OnSessionBreakdown(const string &clientMac, const bool success, const string &breakdown) override
+                        {
+                            JsonObject params;
+                            JsonObject timeline;
+
+                            timeline.FromString(breakdown);
+                            params["mac"] = clientMac;
+                            params["success"] = success;
+                            params["breakdown"] = timeline;
+                            _parent.Notify(_T("onSessionBreakdown"), params);
+                        }
+
                     private:
                         MiracastPlayer& _parent;
                 }; // class Notification
@@ -98,12 +113,15 @@ namespace WPEFramework
 
             private:
                 void Deactivated(RPC::IRemoteConnection* connection);
+                uint32_t getSessionBreakdown(const JsonObject &parameters, JsonObject &response);
+                uint32_t exportSessionTrace(const JsonObject &parameters, JsonObject &response);
 
             private: /* members */
                 PluginHost::IShell* mCurrentService{};
                 uint32_t mConnectionId{};
                 Exchange::IMiracastPlayer* mMiracastPlayerImpl{};
                 Exchange::IConfiguration* mConfigure;
+                Exchange::IMiracastPlayerSessionTrace* mSessionTrace{};
                 Core::Sink<Notification> mMiracastPlayerNotification;
 
             public /* constants */:
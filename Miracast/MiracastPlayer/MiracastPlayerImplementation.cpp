@@ -65,12 +65,7 @@ namespace WPEFramework
             _adminLock.Lock();
 
             // Make sure we can't register the same notification callback multiple times
-            if (std::find(_miracastPlayerNotification.begin(), _miracastPlayerNotification.end(), notification) == _miracastPlayerNotification.end())
-            {
-                _miracastPlayerNotification.push_back(notification);
-                notification->AddRef();
-            }
-            else
+            if (!_miracastPlayerNotification.add(notification))
             {
                 MIRACASTLOG_ERROR("same notification is registered already");
             }
@@ -93,12 +88,9 @@ namespace WPEFramework
             _adminLock.Lock();
 
             // we just unregister one notification once
-            auto itr = std::find(_miracastPlayerNotification.begin(), _miracastPlayerNotification.end(), notification);
-            if (itr != _miracastPlayerNotification.end())
+            if (_miracastPlayerNotification.remove(notification))
             {
-                (*itr)->Release();
                 MIRACASTLOG_INFO("Unregister notification");
-                _miracastPlayerNotification.erase(itr);
                 status = Core::ERROR_NONE;
             }
             else
@@ -111,6 +103,38 @@ namespace WPEFramework
             return status;
         }
 
+        Core::hresult MiracastPlayerImplementation::Register(Exchange::IMiracastPlayerSessionTrace::INotification *notification)
+        {
+            ASSERT(nullptr != notification);
+
+            _adminLock.Lock();
+            if (!_sessionTraceNotification.add(notification))
+            {
+                MIRACASTLOG_ERROR("same session trace notification is registered already");
+            }
+            _adminLock.Unlock();
+            return Core::ERROR_NONE;
+        }
+
+        Core::hresult MiracastPlayerImplementation::Unregister(Exchange::IMiracastPlayerSessionTrace::INotification *notification)
+        {
+            Core::hresult status = Core::ERROR_GENERAL;
+
+            ASSERT(nullptr != notification);
+
+            _adminLock.Lock();
+            if (_sessionTraceNotification.remove(notification))
+            {
+                status = Core::ERROR_NONE;
+            }
+            else
+            {
+                MIRACASTLOG_ERROR("session trace notification not found");
+            }
+            _adminLock.Unlock();
+            return status;
+        }
+
         /*  Helper methods Start */
         /* ------------------------------------------------------------------------------------------------------- */
         void MiracastPlayerImplementation::unsetEnvArgumentsInternal(void)
@@ -153,16 +177,19 @@ namespace WPEFramework
         /*  Helper and Internal methods End */
         /* ------------------------------------------------------------------------------------------------------- */
 
-        void MiracastPlayerImplementation::dispatchEvent(Event event, const ParamsType &params)
+        void MiracastPlayerImplementation::dispatchEvent(Event event, ParamsType &&params)
         {
-            Core::IWorkerPool::Instance().Submit(Job::Create(this, event, params));
+            Core::IWorkerPool::Instance().Submit(Job::Create(this, event, std::move(params)));
         }
 
         void MiracastPlayerImplementation::Dispatch(Event event,const ParamsType& params)
         {
-            _adminLock.Lock();
+            MiracastNotificationList<Exchange::IMiracastPlayer::INotification>::NOTIFICATION_SNAPSHOT listeners;
 
-            std::list<Exchange::IMiracastPlayer::INotification *>::const_iterator index(_miracastPlayerNotification.begin());
+            /* Listeners are called on the snapshot, a slow one cannot hold up Register/Unregister */
+            _adminLock.Lock();
+            listeners = _miracastPlayerNotification.snapshot();
+            _adminLock.Unlock();
 
             switch (event)
             {
@@ -182,10 +209,9 @@ namespace WPEFramework
                         reason = std::get<3>(*tupleValue);
                         reasonCodeStr = std::to_string(reason);
                         MIRACASTLOG_INFO("Notifying PLAYER_STATE_CHANGE Event ClientMac[%s] ClientName[%s] PlayerState[%d] ReasonCode[%u]",clientMac.c_str(), clientName.c_str(), (int)playerState, (int)reason);
-                        while (index != _miracastPlayerNotification.end())
+                        for (Exchange::IMiracastPlayer::INotification *notification : *listeners)
                         {
-                            (*index)->OnStateChange(clientName , clientMac , playerState , reasonCodeStr, reason );
-                            ++index;
+                            notification->OnStateChange(clientName , clientMac , playerState , reasonCodeStr, reason );
                         }
                     }
                     else
@@ -194,11 +220,32 @@ namespace WPEFramework
                     }
                 }
                 break;
+                case MIRACASTPLAYER_EVENT_ON_SESSION_BREAKDOWN:
+                {
+                    MiracastNotificationList<Exchange::IMiracastPlayerSessionTrace::INotification>::NOTIFICATION_SNAPSHOT traceListeners;
+
+                    _adminLock.Lock();
+                    traceListeners = _sessionTraceNotification.snapshot();
+                    _adminLock.Unlock();
+
+                    if (const auto* tupleValue = boost::get<std::tuple<std::string, bool, std::string>>(&params))
+                    {
+                        MIRACASTLOG_INFO("Notifying SESSION_BREAKDOWN Event ClientMac[%s] Success[%d]", std::get<0>(*tupleValue).c_str(), std::get<1>(*tupleValue));
+                        for (Exchange::IMiracastPlayerSessionTrace::INotification *notification : *traceListeners)
+                        {
+                            notification->OnSessionBreakdown(std::get<0>(*tupleValue), std::get<1>(*tupleValue), std::get<2>(*tupleValue));
+                        }
+                    }
+                    else
+                    {
+                        MIRACASTLOG_ERROR("MIRACASTPLAYER_EVENT_ON_SESSION_BREAKDOWN: Invalid parameters");
+                    }
+                }
+                break;
                 default:
                     MIRACASTLOG_WARNING("Event[%u] not handled", event);
                 break;
             }
-            _adminLock.Unlock();
         }
 
         /*  COMRPC Methods Start */
@@ -216,6 +263,9 @@ namespace WPEFramework
                     MiracastRTSPMsg::destroyInstance();
                     m_miracast_rtsp_obj = nullptr;
                     m_GstPlayer = nullptr;
+                    MiracastSessionTracer::getInstance()->set_session_end_handler(nullptr, nullptr);
+                    MiracastSessionTracer::destroyInstance();
+                    MiracastOptFlags::destroyInstance();
                     m_isPluginInitialized = false;
                     MIRACASTLOG_INFO("Done..!!!");
                 }
@@ -240,6 +290,7 @@ namespace WPEFramework
                     if (nullptr != m_miracast_rtsp_obj)
                     {
                         m_GstPlayer = MiracastGstPlayer::getInstance();
+                        MiracastSessionTracer::getInstance()->set_session_end_handler(&MiracastPlayerImplementation::sessionEndCallback, this);
                         m_isPluginInitialized = true;
                         result = Core::ERROR_NONE;
                     }
@@ -423,7 +474,7 @@ namespace WPEFramework
                     MIRACASTLOG_INFO("Wayland Display Name from App: [%s]", waylandDisplayName.c_str());
                 }
 
-                std::string waylandDisplayOverrideName = MiracastCommon::parse_opt_flag("/opt/miracast_custom_westeros_name");
+                std::string waylandDisplayOverrideName = MiracastOptFlags::getInstance()->get_string(MIRACAST_OPT_CUSTOM_WESTEROS_NAME);
                 if (!waylandDisplayOverrideName.empty())
                 {
                     MIRACASTLOG_INFO("Wayland Display Name from Overrides: [%s]", waylandDisplayOverrideName.c_str());
@@ -509,7 +560,7 @@ namespace WPEFramework
                     MIRACASTLOG_INFO("Wayland Display Name from App: [%s]", waylandDisplayName.c_str());
                 }
 
-                std::string waylandDisplayOverrideName = MiracastCommon::parse_opt_flag("/opt/miracast_custom_westeros_name");
+                std::string waylandDisplayOverrideName = MiracastOptFlags::getInstance()->get_string(MIRACAST_OPT_CUSTOM_WESTEROS_NAME);
                 if (!waylandDisplayOverrideName.empty())
                 {
                     MIRACASTLOG_INFO("Wayland Display Name from Overrides: [%s]", waylandDisplayOverrideName.c_str());
@@ -548,6 +599,27 @@ namespace WPEFramework
             MIRACASTLOG_TRACE("Exiting ...");
             return Core::ERROR_NONE;
         }
+
+        Core::hresult MiracastPlayerImplementation::GetSessionBreakdown(string &breakdown)
+        {
+            breakdown = MiracastSessionTracer::getInstance()->get_session_breakdown();
+            return Core::ERROR_NONE;
+        }
+
+        Core::hresult MiracastPlayerImplementation::ExportSessionTrace(const string &filePath)
+        {
+            if (filePath.empty())
+            {
+                MIRACASTLOG_ERROR("Missing trace file path");
+                return Core::ERROR_BAD_REQUEST;
+            }
+            if (!MiracastSessionTracer::getInstance()->export_chrome_trace(filePath))
+            {
+                MIRACASTLOG_ERROR("No session timeline exported to [%s]", filePath.c_str());
+                return Core::ERROR_GENERAL;
+            }
+            return Core::ERROR_NONE;
+        }
         /*  COMRPC Methods End */
         /* ------------------------------------------------------------------------------------------------------- */
 
@@ -559,7 +631,7 @@ namespace WPEFramework
 
             auto tupleParam = std::make_tuple(client_mac,client_name,player_state,reason_code);
 
-            if (0 == access("/opt/miracast_autoconnect", F_OK))
+            if (MiracastOptFlags::getInstance()->is_present(MIRACAST_OPT_AUTOCONNECT))
             {
                 char commandBuffer[768] = {0};
                 snprintf( commandBuffer,
@@ -573,7 +645,7 @@ namespace WPEFramework
             }
             else
             {
-                dispatchEvent(MIRACASTPLAYER_EVENT_ON_STATE_CHANGE, tupleParam);
+                dispatchEvent(MIRACASTPLAYER_EVENT_ON_STATE_CHANGE, std::move(tupleParam));
             }
 
             if ( WPEFramework::Exchange::IMiracastPlayer::STATE_STOPPED == player_state )
@@ -582,6 +654,13 @@ namespace WPEFramework
             }
             MIRACASTLOG_TRACE("Exiting ...");
         }
+
+        void MiracastPlayerImplementation::sessionEndCallback(void *ctx, const std::string &source_mac, bool success, const std::string &breakdown)
+        {
+            MiracastPlayerImplementation *playerImpl = static_cast<MiracastPlayerImplementation *>(ctx);
+
+            playerImpl->dispatchEvent(MIRACASTPLAYER_EVENT_ON_SESSION_BREAKDOWN, std::make_tuple(source_mac, success, breakdown));
+        }
         /*  Events End */
         /* ------------------------------------------------------------------------------------------------------- */
     } // namespace Plugin
@@ -32,6 +32,8 @@
 
 #include "MiracastRTSPMsg.h"
 #include "MiracastGstPlayer.h"
+#include "IMiracastPlayerSessionTrace.h"
+#include <MiracastNotificationList.h>
 
 #include "libIBus.h"
 
@@ -39,13 +41,14 @@ using namespace WPEFramework;
 
 using MiracastPlayerState = WPEFramework::Exchange::IMiracastPlayer::State;
 using MiracastPlayerReasonCode = WPEFramework::Exchange::IMiracastPlayer::ReasonCode;
-using ParamsType = boost::variant<std::tuple<std::string, std::string, MiracastPlayerState, MiracastPlayerReasonCode>>;
+using ParamsType = boost::variant<std::tuple<std::string, std::string, MiracastPlayerState, MiracastPlayerReasonCode>,
+                                  std::tuple<std::string, bool, std::string>>;
 
 namespace WPEFramework
 {
     namespace Plugin
     {
-        class MiracastPlayerImplementation : public Exchange::IMiracastPlayer, public Exchange::IConfiguration, public MiracastPlayerNotifier
+        class MiracastPlayerImplementation : public Exchange::IMiracastPlayer, public Exchange::IConfiguration, public Exchange::IMiracastPlayerSessionTrace, public MiracastPlayerNotifier
         {
         public:
             // We do not allow this plugin to be copied !!
@@ -63,18 +66,20 @@ namespace WPEFramework
             BEGIN_INTERFACE_MAP(MiracastPlayerImplementation)
             INTERFACE_ENTRY(Exchange::IMiracastPlayer)
             INTERFACE_ENTRY(Exchange::IConfiguration)
+            INTERFACE_ENTRY(Exchange::IMiracastPlayerSessionTrace)
             END_INTERFACE_MAP
 
         public:
             enum Event
             {
-                MIRACASTPLAYER_EVENT_ON_STATE_CHANGE
+                MIRACASTPLAYER_EVENT_ON_STATE_CHANGE,
+                MIRACASTPLAYER_EVENT_ON_SESSION_BREAKDOWN
             };
             class EXTERNAL Job : public Core::IDispatch
             {
             protected:
-                Job(MiracastPlayerImplementation *MiracastPlayerImplementation, Event event, ParamsType &params)
-                    : _miracastPlayerImplementation(MiracastPlayerImplementation), _event(event), _params(params)
+                Job(MiracastPlayerImplementation *MiracastPlayerImplementation, Event event, ParamsType &&params)
+                    : _miracastPlayerImplementation(MiracastPlayerImplementation), _event(event), _params(std::move(params))
                 {
                     if (_miracastPlayerImplementation != nullptr)
                     {
@@ -95,12 +100,12 @@ namespace WPEFramework
                 }
 
             public:
-                static Core::ProxyType<Core::IDispatch> Create(MiracastPlayerImplementation *miracastPlayerImplementation, Event event, ParamsType params)
+                static Core::ProxyType<Core::IDispatch> Create(MiracastPlayerImplementation *miracastPlayerImplementation, Event event, ParamsType &&params)
                 {
         #ifndef USE_THUNDER_R4
-                    return (Core::proxy_cast<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastPlayerImplementation, event, params)));
+                    return (Core::proxy_cast<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastPlayerImplementation, event, std::move(params))));
         #else
-                    return (Core::ProxyType<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastPlayerImplementation, event, params)));
+                    return (Core::ProxyType<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastPlayerImplementation, event, std::move(params))));
         #endif
                 }
                 virtual void Dispatch()
@@ -129,19 +134,26 @@ namespace WPEFramework
             Core::hresult SetEnvArguments( IEnvArgumentsIterator * const envArgs , Result &result ) override;
             Core::hresult UnsetEnvArguments(Result &result ) override;
 
+            Core::hresult Register(Exchange::IMiracastPlayerSessionTrace::INotification *notification) override;
+            Core::hresult Unregister(Exchange::IMiracastPlayerSessionTrace::INotification *notification) override;
+            Core::hresult GetSessionBreakdown(string &breakdown) override;
+            Core::hresult ExportSessionTrace(const string &filePath) override;
+
         private:
             mutable Core::CriticalSection _adminLock;
             PluginHost::IShell *mService;
-            std::list<Exchange::IMiracastPlayer::INotification *> _miracastPlayerNotification; // List of registered notifications
+            MiracastNotificationList<Exchange::IMiracastPlayer::INotification> _miracastPlayerNotification; // List of registered notifications
+            MiracastNotificationList<Exchange::IMiracastPlayerSessionTrace::INotification> _sessionTraceNotification;
             PluginHost::IShell* _service;
             MiracastGstPlayer *m_GstPlayer;
             VIDEO_RECT_STRUCT m_video_sink_rect;
             bool m_isPluginInitialized;
 
-            void dispatchEvent(Event, const ParamsType &params);
+            void dispatchEvent(Event, ParamsType &&params);
             void Dispatch(Event event, const ParamsType &params);
             void unsetEnvArgumentsInternal(void);
             std::string stateDescription(MiracastPlayerState e);
+            static void sessionEndCallback(void *ctx, const std::string &source_mac, bool success, const std::string &breakdown);
 
         public:
             static MiracastPlayerImplementation *_instance;
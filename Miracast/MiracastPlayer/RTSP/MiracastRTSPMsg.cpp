@@ -17,6 +17,8 @@
  * limitations under the License.
  */
 
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <MiracastRTSPMsg.h>
 #include <MiracastGstPlayer.h>
 
@@ -173,10 +175,9 @@ void MiracastRTSPMsg::destroyInstance()
     MIRACASTLOG_TRACE("Entering...");
 
     rtsp_hldr_msgq_data.state = RTSP_SELF_ABORT;
-    m_rtsp_msg_obj->send_msgto_rtsp_msg_hdler_thread(rtsp_hldr_msgq_data);
-
     if (nullptr != m_rtsp_msg_obj)
     {
+        m_rtsp_msg_obj->send_msgto_rtsp_msg_hdler_thread(rtsp_hldr_msgq_data);
         delete m_rtsp_msg_obj;
         m_rtsp_msg_obj = nullptr;
     }
@@ -194,6 +195,11 @@ MiracastRTSPMsg::MiracastRTSPMsg()
     m_controller_thread = nullptr;
     m_tcpSockfd = -1;
     m_epollfd = -1;
+    m_tcp_connect_thread_id = 0;
+    m_tcp_connect_sockfd = -1;
+    m_tcp_connect_epollfd = -1;
+    m_tcp_connect_cancel_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    m_tcp_connect_result = MIRACAST_FAIL;
     m_streaming_started = false;
 
     m_wfd_src_req_timeout = RTSP_REQUEST_RECV_TIMEOUT;
@@ -276,22 +282,33 @@ MiracastRTSPMsg::~MiracastRTSPMsg()
         m_rtsp_msg_handler_thread = nullptr;
     }
 
+    finish_TCPConnect();
     Release_SocketAndEpollDescriptor();
+    if (-1 != m_tcp_connect_cancel_fd)
+    {
+        close(m_tcp_connect_cancel_fd);
+        m_tcp_connect_cancel_fd = -1;
+    }
 }
 
 void MiracastRTSPMsg::Release_SocketAndEpollDescriptor(void)
+{
+    Release_SocketAndEpollDescriptor(m_tcpSockfd, m_epollfd);
+}
+
+void MiracastRTSPMsg::Release_SocketAndEpollDescriptor(int &sockfd, int &epollfd)
 {
     MIRACASTLOG_TRACE("Entering...");
-    if (-1 != m_tcpSockfd)
+    if (-1 != sockfd)
     {
-        shutdown(m_tcpSockfd , SHUT_RDWR);
-        close(m_tcpSockfd);
-        m_tcpSockfd = -1;
+        shutdown(sockfd , SHUT_RDWR);
+        close(sockfd);
+        sockfd = -1;
     }
-    if ( -1 != m_epollfd )
+    if ( -1 != epollfd )
     {
-        close(m_epollfd);
-        m_epollfd = -1;
+        close(epollfd);
+        epollfd = -1;
     }
     MIRACASTLOG_TRACE("Exiting...");
 }
@@ -874,6 +891,38 @@ bool MiracastRTSPMsg::wait_data_timeout(int m_Sockfd, unsigned int ms)
     return returnValue;
 }
 
+bool MiracastRTSPMsg::wait_connect_timeout(int sockfd, unsigned int ms)
+{
+    struct pollfd poll_fds[2] = {};
+    bool returnValue = false;
+    int result = 0;
+
+    MIRACASTLOG_TRACE("Entering WaitTime[%u]...",ms);
+
+    /* A non-blocking connect completes with the socket writable */
+    poll_fds[0].fd = sockfd;
+    poll_fds[0].events = POLLOUT;
+    poll_fds[1].fd = m_tcp_connect_cancel_fd;
+    poll_fds[1].events = POLLIN;
+
+    result = poll(poll_fds, 2, static_cast<int>(ms));
+    if ( -1 == result )
+    {
+        MIRACASTLOG_ERROR("poll() failed: [%s]",strerror(errno));
+    }
+    else if ( 0 == result )
+    {
+        MIRACASTLOG_VERBOSE("poll() timedout");
+    }
+    else if ( 0 == (poll_fds[1].revents & POLLIN))
+    {
+        returnValue = (0 != (poll_fds[0].revents & (POLLOUT | POLLERR | POLLHUP)));
+    }
+
+    MIRACASTLOG_TRACE("Exiting ret[%d]...",returnValue);
+    return returnValue;
+}
+
 RTSP_STATUS MiracastRTSPMsg::receive_buffer_timedOut(int socket_fd, void *buffer, size_t buffer_len , unsigned int wait_time_ms )
 {
     int recv_return = -1;
@@ -909,7 +958,7 @@ RTSP_STATUS MiracastRTSPMsg::receive_buffer_timedOut(int socket_fd, void *buffer
     return status;
 }
 
-MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
+MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP, int &sockfd, int &epollfd)
 {
     MIRACASTLOG_TRACE("Entering...");
     MiracastError ret = MIRACAST_FAIL;
@@ -943,26 +992,26 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
     unsigned int current_waittime = SOCKET_DFLT_WAIT_TIMEOUT / retry_count;
     bool is_connected = false;
 
-    while ( retry_count-- && ( false == is_connected ))
+    while ( retry_count-- && ( false == is_connected ) && ( false == is_TCPConnectCancelled()))
     {
-        Release_SocketAndEpollDescriptor();
+        Release_SocketAndEpollDescriptor(sockfd, epollfd);
 
-        m_tcpSockfd = socket(in_addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
-        if (m_tcpSockfd < 0)
+        sockfd = socket(in_addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (sockfd < 0)
         {
             MIRACASTLOG_ERROR("TCP Socket creation error %s", strerror(errno));
             continue;
         }
         // Set SO_REUSEADDR option
         int optval = 1;
-        if (setsockopt(m_tcpSockfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) == -1)
+        if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) == -1)
         {
             MIRACASTLOG_ERROR("Failed to set SO_REUSEADDR: %s", strerror(errno));
             continue;
         }
     #if 0
         /* Bind socket */
-        if (bind(m_tcpSockfd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        if (bind(sockfd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
         {
             MIRACASTLOG_ERROR("TCP Socket bind error %s", strerror(errno));
             continue;
@@ -970,20 +1019,20 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
     #endif
 
         /*---Add socket to epoll---*/
-        m_epollfd = epoll_create(1);
+        epollfd = epoll_create(1);
         struct epoll_event event;
         event.events = EPOLLIN | EPOLLOUT;
-        event.data.fd = m_tcpSockfd;
-        epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_tcpSockfd, &event);
+        event.data.fd = sockfd;
+        epoll_ctl(epollfd, EPOLL_CTL_ADD, sockfd, &event);
 
-        int fcntl_result = fcntl(m_tcpSockfd, F_SETFL, O_NONBLOCK);
+        int fcntl_result = fcntl(sockfd, F_SETFL, O_NONBLOCK);
         if (fcntl_result < 0) {
             MIRACASTLOG_ERROR("Failed to set non-blocking mode: %s", strerror(errno));
 			return MIRACAST_FAIL;
         }
         MIRACASTLOG_INFO("NON_BLOCKING Socket Enabled...");
 
-        r = connect(m_tcpSockfd, (struct sockaddr *)&in_addr, addr_size);
+        r = connect(sockfd, (struct sockaddr *)&in_addr, addr_size);
         if (r < 0)
         {
             if (errno != EINPROGRESS)
@@ -994,17 +1043,17 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
             {
                 MIRACASTLOG_INFO("WaitingTime[%u] for Socket Connection",current_waittime);
                 // connection in progress
-                if (!wait_data_timeout(m_tcpSockfd, current_waittime ))
+                if (!wait_connect_timeout(sockfd, current_waittime ))
                 {
-                    // connection timed out or failed
+                    // connection timed out, failed or cancelled
                     MIRACASTLOG_ERROR("Socket Connection Timedout %s received(%d)...", strerror(errno), errno);
-                    usleep(500000);
+                    is_TCPConnectCancelled(SOCKET_CONNECT_RETRY_DELAY);
                 }
                 else
                 {
                     int error = 0;
                     socklen_t len = sizeof(error);
-                    if (getsockopt(m_tcpSockfd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0)
+                    if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0)
                     {
                         // connection successful
                         // do something with the connected socket
@@ -1015,7 +1064,7 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
                     else
                     {
                         MIRACASTLOG_ERROR("Socket failed to connect %s received(%d)", strerror(errno), errno);
-                        usleep(500000);
+                        is_TCPConnectCancelled(SOCKET_CONNECT_RETRY_DELAY);
                     }
                 }
             }
@@ -1031,7 +1080,7 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
     if (is_connected)
     {
         /*---Wait for socket connect to complete---*/
-        num_ready = epoll_wait(m_epollfd, events, MAX_EPOLL_EVENTS, 1000 /*timeout*/);
+        num_ready = epoll_wait(epollfd, events, MAX_EPOLL_EVENTS, 1000 /*timeout*/);
         for (i = 0; i < num_ready; i++)
         {
             if (events[i].events & EPOLLOUT)
@@ -1040,7 +1089,7 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
             }
         }
 
-        num_ready = epoll_wait(m_epollfd, events, MAX_EPOLL_EVENTS, 1000 /*timeout*/);
+        num_ready = epoll_wait(epollfd, events, MAX_EPOLL_EVENTS, 1000 /*timeout*/);
         for (i = 0; i < num_ready; i++)
         {
             if (events[i].events & EPOLLOUT)
@@ -1053,13 +1102,117 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
 
     if ( MIRACAST_FAIL == ret )
     {
-        Release_SocketAndEpollDescriptor();
+        Release_SocketAndEpollDescriptor(sockfd, epollfd);
     }
 
     MIRACASTLOG_TRACE("Exiting...");
     return ret;
 }
 
+void *MiracastRTSPMsg::tcp_connect_thread(void *ctx)
+{
+    MiracastRTSPMsg *rtsp_msg_obj = static_cast<MiracastRTSPMsg *>(ctx);
+
+    rtsp_msg_obj->m_tcp_connect_result = rtsp_msg_obj->initiate_TCP(rtsp_msg_obj->m_tcp_connect_ip,
+                                                                    rtsp_msg_obj->m_tcp_connect_sockfd,
+                                                                    rtsp_msg_obj->m_tcp_connect_epollfd);
+    return nullptr;
+}
+
+void MiracastRTSPMsg::start_TCPConnect(std::string goIP)
+{
+    uint64_t pending_cancel = 0;
+    MIRACASTLOG_TRACE("Entering...");
+
+    finish_TCPConnect();
+    Release_SocketAndEpollDescriptor();
+    if (sizeof(pending_cancel) == read(m_tcp_connect_cancel_fd, &pending_cancel, sizeof(pending_cancel)))
+    {
+        MIRACASTLOG_VERBOSE("Dropped cancel of the previous TCP connect");
+    }
+    m_tcp_connect_ip = std::move(goIP);
+    m_tcp_connect_result = MIRACAST_FAIL;
+
+    if (0 != pthread_create(&m_tcp_connect_thread_id, nullptr, tcp_connect_thread, this))
+    {
+        MIRACASTLOG_ERROR("TCP connect thread creation failed, connecting in place");
+        m_tcp_connect_thread_id = 0;
+        m_tcp_connect_result = initiate_TCP(m_tcp_connect_ip, m_tcp_connect_sockfd, m_tcp_connect_epollfd);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastError MiracastRTSPMsg::finish_TCPConnect(void)
+{
+    if (0 != m_tcp_connect_thread_id)
+    {
+        pthread_join(m_tcp_connect_thread_id, nullptr);
+        m_tcp_connect_thread_id = 0;
+    }
+    /* The worker only touches its own descriptors, they are handed over
+     * to the RTSP thread here once the join has ordered its writes */
+    if (-1 != m_tcp_connect_sockfd)
+    {
+        Release_SocketAndEpollDescriptor();
+        m_tcpSockfd = m_tcp_connect_sockfd;
+        m_epollfd = m_tcp_connect_epollfd;
+        m_tcp_connect_sockfd = -1;
+        m_tcp_connect_epollfd = -1;
+    }
+    return m_tcp_connect_result;
+}
+
+void MiracastRTSPMsg::cancel_TCPConnect(void)
+{
+    uint64_t cancel = 1;
+
+    if ((-1 != m_tcp_connect_cancel_fd) &&
+        (sizeof(cancel) != write(m_tcp_connect_cancel_fd, &cancel, sizeof(cancel))))
+    {
+        MIRACASTLOG_ERROR("Failed to cancel TCP connect [%s]", strerror(errno));
+    }
+}
+
+bool MiracastRTSPMsg::is_TCPConnectCancelled(unsigned int wait_ms)
+{
+    struct pollfd poll_fd = {};
+
+    /* Also serves as the retry delay, returning early once cancelled */
+    poll_fd.fd = m_tcp_connect_cancel_fd;
+    poll_fd.events = POLLIN;
+    return ((1 == poll(&poll_fd, 1, static_cast<int>(wait_ms))) && (0 != (poll_fd.revents & POLLIN)));
+}
+
+/* The stop request that cancelled the setup is consumed here, the idle loop would otherwise report a second stop */
+MiracastPlayerReasonCode MiracastRTSPMsg::take_SetupStopRequest(void)
+{
+    RTSP_HLDR_MSGQ_STRUCT rtsp_message_data = {};
+    MiracastPlayerReasonCode reason = WPEFramework::Exchange::IMiracastPlayer::REASON_CODE_RTSP_ERROR;
+
+    while (true == m_rtsp_msg_handler_thread->receive_message(&rtsp_message_data, sizeof(rtsp_message_data), THREAD_RECV_MSG_WAIT_IMMEDIATE))
+    {
+        if ( RTSP_SELF_ABORT == rtsp_message_data.state )
+        {
+            m_rtsp_msg_hldr_running_state = false;
+            break;
+        }
+        else if ( RTSP_TEARDOWN_FROM_SINK2SRC == rtsp_message_data.state )
+        {
+            if ( STOP_REASON_APP_REQ_FOR_EXIT == rtsp_message_data.stop_reason_code )
+            {
+                reason = WPEFramework::Exchange::IMiracastPlayer::REASON_CODE_APP_REQ_TO_STOP;
+            }
+            else if ( STOP_REASON_APP_REQ_FOR_NEW_CONNECTION == rtsp_message_data.stop_reason_code )
+            {
+                reason = WPEFramework::Exchange::IMiracastPlayer::REASON_CODE_NEW_SRC_DEV_CONNECT_REQ;
+            }
+            break;
+        }
+        MIRACASTLOG_WARNING("Dropping RTSP Msg Action[%#04X] of the stopped session", rtsp_message_data.state);
+    }
+    return reason;
+}
+
 RTSP_STATUS MiracastRTSPMsg::send_rstp_msg(int socket_fd, std::string rtsp_response_buffer)
 {
     int read_ret = 0;
@@ -1907,20 +2060,12 @@ MiracastError MiracastRTSPMsg::start_streaming( VIDEO_RECT_STRUCT video_rect )
     MIRACASTLOG_TRACE("Entering...");
     std::string gstreamerPipeline = "";
     const char *mcastfile = "/opt/miracast_gstpipline.txt";
-    std::ifstream mcgstfile(mcastfile);
-    std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_skip_firstframe_callback");
+    MiracastOptFlags *opt_flags = MiracastOptFlags::getInstance();
 
-    if (!opt_flag_buffer.empty())
+    if (opt_flags->is_present(MIRACAST_OPT_GST_PIPELINE))
     {
-        MIRACASTLOG_INFO("#### updating state as PLAYING ####");
-        set_state(WPEFramework::Exchange::IMiracastPlayer::STATE_PLAYING , true );
-    }
-
-    if (mcgstfile.is_open())
-    {
-        std::getline(mcgstfile, gstreamerPipeline);
+        gstreamerPipeline = opt_flags->get_string(MIRACAST_OPT_GST_PIPELINE);
         MIRACASTLOG_VERBOSE("gstpipeline reading from file [%s], gstreamerPipeline as [ %s] ", mcastfile, gstreamerPipeline.c_str());
-        mcgstfile.close();
         if (0 == MiracastCommon::execute_SystemCommand(gstreamerPipeline.c_str()))
             MIRACASTLOG_VERBOSE("Pipeline created successfully ");
         else
@@ -1931,7 +2076,7 @@ MiracastError MiracastRTSPMsg::start_streaming( VIDEO_RECT_STRUCT video_rect )
     }
     else
     {
-        if (access("/opt/miracast_gst", F_OK) == 0)
+        if (opt_flags->is_present(MIRACAST_OPT_GST))
         {
             gstreamerPipeline = "GST_DEBUG=3 gst-launch-1.0 -vvv playbin uri=udp://0.0.0.0:1990 video-sink=\"westerossink\"";
             MIRACASTLOG_VERBOSE("pipeline constructed is --> %s", gstreamerPipeline.c_str());
@@ -1947,7 +2092,11 @@ MiracastError MiracastRTSPMsg::start_streaming( VIDEO_RECT_STRUCT video_rect )
         {
             MiracastGstPlayer *MiracastGstPlayerObj = MiracastGstPlayer::getInstance();
             MiracastGstPlayerObj->setVideoRectangle( video_rect );
-            MiracastGstPlayerObj->launch(m_sink_ip, m_wfd_streaming_port ,this);
+            if (!MiracastGstPlayerObj->launch(m_sink_ip, m_wfd_streaming_port ,this))
+            {
+                MIRACASTLOG_ERROR("Pipeline creation failure");
+                return MIRACAST_FAIL;
+            }
         }
     }
     m_streaming_started = true;
@@ -2004,6 +2153,7 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
                 client_name = "",
                 go_ip_addr = "";
     bool    start_monitor_keep_alive_msg = false;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
 
 	m_rtsp_msg_hldr_running_state = true;
 
@@ -2049,11 +2199,42 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
 
             set_state( WPEFramework::Exchange::IMiracastPlayer::STATE_INITIATED , true );
 
-            if (MIRACAST_OK != initiate_TCP(rtsp_message_data.source_dev_ip))
+            session_tracer->begin_session(rtsp_message_data.source_dev_mac);
+            session_tracer->span_begin(MIRACAST_SPAN_TCP_CONNECT);
+            /* Build the pipeline while the source accepts the RTSP connection, the first failure stops both */
+            start_TCPConnect(rtsp_message_data.source_dev_ip);
+            /* A stop request cancels the connect, the pipeline is not built for a session already going away */
+            if ((false == is_TCPConnectCancelled()) &&
+                (MIRACAST_OK != start_streaming(video_rect_st)))
+            {
+                MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK PIPELINE SETUP FAILED, CANCELLING TCP CONNECT ####");
+                cancel_TCPConnect();
+                finish_TCPConnect();
+                Release_SocketAndEpollDescriptor();
+                session_tracer->end_session(false);
+                set_state( WPEFramework::Exchange::IMiracastPlayer::STATE_STOPPED , true , WPEFramework::Exchange::IMiracastPlayer::REASON_CODE_GST_ERROR );
+                continue;
+            }
+            if (is_TCPConnectCancelled())
             {
+                MIRACASTLOG_WARNING("#### MCAST-TRIAGE-OK STOP REQUESTED DURING SESSION SETUP ####");
+                finish_TCPConnect();
+                Release_SocketAndEpollDescriptor();
+                reason = take_SetupStopRequest();
+                stop_streaming( WPEFramework::Exchange::IMiracastPlayer::STATE_STOPPED );
+                session_tracer->end_session(false);
+                set_state( WPEFramework::Exchange::IMiracastPlayer::STATE_STOPPED , true , reason );
+                continue;
+            }
+            if (MIRACAST_OK != finish_TCPConnect())
+            {
+                stop_streaming( WPEFramework::Exchange::IMiracastPlayer::STATE_STOPPED );
+                session_tracer->end_session(false);
                 set_state( WPEFramework::Exchange::IMiracastPlayer::STATE_STOPPED , true , WPEFramework::Exchange::IMiracastPlayer::REASON_CODE_RTSP_ERROR );
                 continue;
             }
+            session_tracer->span_end(MIRACAST_SPAN_TCP_CONNECT);
+            session_tracer->span_begin(MIRACAST_SPAN_RTSP_M1_M7);
         }
         else
         {
@@ -2069,7 +2250,11 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
 
         m_getparameter_response_sent = false;
 
-        start_streaming(video_rect_st);
+        if (!MiracastOptFlags::getInstance()->get_string(MIRACAST_OPT_SKIP_FIRSTFRAME_CALLBACK).empty())
+        {
+            MIRACASTLOG_INFO("#### updating state as PLAYING ####");
+            set_state(WPEFramework::Exchange::IMiracastPlayer::STATE_PLAYING , true );
+        }
 
         while (( status_code = receive_buffer_timedOut( m_tcpSockfd, rtsp_message_socket, sizeof(rtsp_message_socket),get_wait_timeout())) &&
                 ( status_code == RTSP_MSG_SUCCESS ))
@@ -2114,6 +2299,8 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
         if ((RTSP_MSG_SUCCESS == status_code) || (RTSP_M1_M7_MSG_EXCHANGE_RECEIVED == status_code ))
         {
             MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-RTSP-DONE RTSP_M1_M7_MSG_EXCHANGE_RECEIVED[%#04X] ####", status_code);
+            session_tracer->span_end(MIRACAST_SPAN_RTSP_M1_M7);
+            session_tracer->span_begin(MIRACAST_SPAN_FIRST_VIDEO_FRAME);
             start_monitor_keep_alive_msg = true;
             //start_streaming(video_rect_st);
             MIRACASTLOG_INFO("!!!! GstPlayer instance created, Waiting for first-frame !!!!");
@@ -2155,6 +2342,7 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
                 reason = WPEFramework::Exchange::IMiracastPlayer::REASON_CODE_RTSP_TIMEOUT;
                 MIRACASTLOG_INFO("#### MCAST-TRIAGE-NOK RTSP RECV TIMEOUT ####");
             }
+            session_tracer->end_session(false);
             set_state(WPEFramework::Exchange::IMiracastPlayer::STATE_STOPPED , true , reason );
         }
 
@@ -2326,8 +2514,8 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
                             {
                                 state = WPEFramework::Exchange::IMiracastPlayer::STATE_PLAYING;
                                 MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-GST-PLAYING updating state as PLAYING ####");
-                                std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_skip_firstframe_callback");
-                                if (!opt_flag_buffer.empty())
+                                session_tracer->end_session(true);
+                                if (!MiracastOptFlags::getInstance()->get_string(MIRACAST_OPT_SKIP_FIRSTFRAME_CALLBACK).empty())
                                 {
                                     notifyGstPlayer = false;
                                 }
@@ -2360,6 +2548,8 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
             }
         }
 
+        /* Session torn down before the first frame */
+        session_tracer->end_session(false);
         Release_SocketAndEpollDescriptor();
     }
     MIRACASTLOG_TRACE("Exiting...");
@@ -2372,6 +2562,12 @@ void MiracastRTSPMsg::send_msgto_rtsp_msg_hdler_thread(RTSP_HLDR_MSGQ_STRUCT rts
     {
         m_rtsp_msg_handler_thread->send_message(&rtsp_hldr_msgq_data, RTSP_HANDLER_MSGQ_SIZE);
     }
+    /* Queued first, so a setup that sees the cancel also finds the stop request */
+    if (( RTSP_SELF_ABORT == rtsp_hldr_msgq_data.state ) ||
+        ( RTSP_TEARDOWN_FROM_SINK2SRC == rtsp_hldr_msgq_data.state ))
+    {
+        cancel_TCPConnect();
+    }
     MIRACASTLOG_TRACE("Exiting...");
 }
 
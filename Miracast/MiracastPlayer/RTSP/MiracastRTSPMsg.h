@@ -25,6 +25,7 @@
 #include <arpa/inet.h>
 #include <sys/epoll.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <interfaces/IMiracastPlayer.h>
 
 using namespace WPEFramework;
@@ -35,6 +36,7 @@ using MiracastPlayerReasonCode = WPEFramework::Exchange::IMiracastPlayer::Reason
 #define RTSP_REQUEST_RECV_TIMEOUT   ( 6 * ONE_SECOND_IN_MILLISEC )
 #define RTSP_RESPONSE_RECV_TIMEOUT  ( 5 * ONE_SECOND_IN_MILLISEC )
 #define SOCKET_DFLT_WAIT_TIMEOUT    ( 10 * ONE_SECOND_IN_MILLISEC )
+#define SOCKET_CONNECT_RETRY_DELAY  ( 500 )
 #define RTSP_DFLT_KEEP_ALIVE_WAIT_TIMEOUT_SEC   ( 60 )
 #define RTSP_KEEP_ALIVE_POLL_WAIT_TIMEOUT   ( ONE_SECOND_IN_MILLISEC )
 #define RTSP_KEEP_ALIVE_WAIT_TIMEOUT_OFFSET_SEC   ( 20 )
@@ -53,13 +55,6 @@ typedef enum rtsp_status_e
 }
 RTSP_STATUS;
 
-typedef enum miracast_player_stop_reason_code_e
-{
-    STOP_REASON_APP_REQ_FOR_EXIT = 300,
-    STOP_REASON_APP_REQ_FOR_NEW_CONNECTION = 301
-}
-MiracastPlayerStopReasonCode;
-
 typedef struct rtsp_hldr_msgq_st
 {
     char source_dev_ip[24];
@@ -474,6 +469,14 @@ class MiracastRTSPMsg
         int m_epollfd;
         int m_wfd_src_session_timeout;
 
+        /* TCP connect worker, runs while the pipeline is set up */
+        pthread_t m_tcp_connect_thread_id;
+        int m_tcp_connect_sockfd;
+        int m_tcp_connect_epollfd;
+        int m_tcp_connect_cancel_fd;
+        std::string m_tcp_connect_ip;
+        MiracastError m_tcp_connect_result;
+
         bool m_streaming_started;
         bool m_rtsp_msg_hldr_running_state;
         bool m_is_unicast;
@@ -506,13 +509,20 @@ class MiracastRTSPMsg
 
         MiracastPlayerState get_state(void);
 
-        MiracastError initiate_TCP(std::string goIP);
+        MiracastError initiate_TCP(std::string goIP, int &sockfd, int &epollfd);
+        void start_TCPConnect(std::string goIP);
+        MiracastError finish_TCPConnect(void);
+        void cancel_TCPConnect(void);
+        bool is_TCPConnectCancelled(unsigned int wait_ms = 0);
+        MiracastPlayerReasonCode take_SetupStopRequest(void);
+        static void *tcp_connect_thread(void *ctx);
         MiracastError start_streaming( VIDEO_RECT_STRUCT video_rect );
         MiracastError stop_streaming( MiracastPlayerState state );
         void set_state( MiracastPlayerState state , bool send_notification = false , MiracastPlayerReasonCode reason_code = WPEFramework::Exchange::IMiracastPlayer::REASON_CODE_SUCCESS );
         void store_srcsink_info( std::string client_name, std::string client_mac, std::string src_dev_ip, std::string sink_ip);
         MiracastError create_RTSPThread(void);
         void Release_SocketAndEpollDescriptor(void);
+        static void Release_SocketAndEpollDescriptor(int &sockfd, int &epollfd);
         RTSP_STATUS validate_rtsp_m1_msg_m2_send_request(std::string rtsp_m1_msg_buffer);
         RTSP_STATUS validate_rtsp_m2_request_ack(std::string rtsp_m1_response_ack_buffer);
         RTSP_STATUS validate_rtsp_m3_response_back(std::string rtsp_m3_msg_buffer);
@@ -543,6 +553,7 @@ class MiracastRTSPMsg
         unsigned int get_wait_timeout(void);
         RTSP_STATUS receive_buffer_timedOut(int sockfd, void *buffer, size_t buffer_len , unsigned int wait_time_ms = RTSP_REQUEST_RECV_TIMEOUT );
         bool wait_data_timeout(int m_Sockfd, unsigned int ms);
+        bool wait_connect_timeout(int sockfd, unsigned int ms);
         RTSP_STATUS send_rstp_msg(int sockfd, std::string rtsp_response_buffer);
         MiracastError updateVideoRectangle( const VIDEO_RECT_STRUCT& videorect );
         int validateGetParameterContentLength(std::string& input);
@@ -0,0 +1,462 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <chrono>
+#include <random>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/eventfd.h>
+#include "MiracastDHCPClient.h"
+
+typedef std::chrono::steady_clock dhcp_clock;
+
+static const DHCP_CLIENT_IO_OPS dhcp_raw_io_ops =
+{
+    &MiracastDHCPCommon::open_raw_socket,
+    &MiracastDHCPCommon::send_raw,
+    &MiracastDHCPCommon::recv_raw,
+    &MiracastDHCPCommon::set_interface_address,
+    &MiracastDHCPCommon::remove_interface_address
+};
+
+const DHCP_CLIENT_IO_OPS *MiracastDHCPClient::m_installed_io_ops{nullptr};
+
+static const uint8_t dhcp_broadcast_hw_addr[DHCP_HW_ADDR_LEN] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+static const uint8_t dhcp_requested_params[] =
+{
+    DHCP_OPTION_SUBNET_MASK,
+    DHCP_OPTION_ROUTER,
+    DHCP_OPTION_DNS_SERVER,
+    DHCP_OPTION_LEASE_TIME,
+    DHCP_OPTION_RENEWAL_TIME
+};
+
+MiracastDHCPClient::MiracastDHCPClient()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    m_ifindex = 0;
+    memset(m_hw_addr, 0, sizeof(m_hw_addr));
+    m_xid = 0;
+    m_leased_ip = 0;
+    m_prefix_len = 0;
+    m_server_id = 0;
+    m_lease_time_s = 0;
+    m_stop_fd = -1;
+    m_renew_thread_id = 0;
+    m_lease_lost_handler = nullptr;
+    m_lease_lost_ctx = nullptr;
+    m_io_ops = (nullptr != m_installed_io_ops) ? m_installed_io_ops : &dhcp_raw_io_ops;
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastDHCPClient::~MiracastDHCPClient()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    stop();
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastDHCPClient::build_request(DHCP_PACKET &packet, DHCP_MESSAGE_TYPE type, uint32_t requested_ip, uint32_t server_id, uint32_t client_ip)
+{
+    uint8_t client_id[DHCP_HW_ADDR_LEN + 1] = { 1 };
+
+    MiracastDHCPCommon::init_packet(packet, DHCP_BOOTREQUEST, type, m_xid, m_hw_addr);
+    /* No address to receive unicast on yet, ask for broadcast replies */
+    packet.flags = (0 == client_ip) ? htons(DHCP_BROADCAST_FLAG) : 0;
+    packet.ciaddr = client_ip;
+
+    memcpy(&client_id[1], m_hw_addr, DHCP_HW_ADDR_LEN);
+    MiracastDHCPCommon::add_option(packet, DHCP_OPTION_CLIENT_ID, client_id, sizeof(client_id));
+    if (0 != requested_ip)
+    {
+        MiracastDHCPCommon::add_option_u32(packet, DHCP_OPTION_REQUESTED_IP, requested_ip);
+    }
+    if (0 != server_id)
+    {
+        MiracastDHCPCommon::add_option_u32(packet, DHCP_OPTION_SERVER_ID, server_id);
+    }
+    MiracastDHCPCommon::add_option(packet, DHCP_OPTION_PARAM_REQUEST, dhcp_requested_params, sizeof(dhcp_requested_params));
+}
+
+uint8_t MiracastDHCPClient::exchange(int sock_fd,
+                                     DHCP_PACKET &request,
+                                     uint32_t src_ip,
+                                     unsigned int max_attempts,
+                                     unsigned int deadline_ms,
+                                     DHCP_PACKET &reply,
+                                     size_t &reply_len)
+{
+    uint8_t request_type = MiracastDHCPCommon::get_message_type(request, sizeof(request));
+    unsigned int retransmit_ms = DHCP_CLIENT_INITIAL_RETRANSMIT_MS;
+    dhcp_clock::time_point exchange_start = dhcp_clock::now();
+    dhcp_clock::time_point deadline = exchange_start + std::chrono::milliseconds(deadline_ms);
+
+    for (unsigned int attempt = 0; (attempt < max_attempts) && (dhcp_clock::now() < deadline); ++attempt)
+    {
+        dhcp_clock::time_point retransmit_at = std::min(deadline, dhcp_clock::now() + std::chrono::milliseconds(retransmit_ms));
+
+        /* Seconds elapsed since the exchange began, some servers look at it */
+        request.secs = htons(static_cast<uint16_t>(std::chrono::duration_cast<std::chrono::seconds>(dhcp_clock::now() - exchange_start).count()));
+        m_io_ops->send(sock_fd, m_ifindex,
+                       src_ip, DHCP_CLIENT_PORT,
+                       INADDR_BROADCAST, DHCP_SERVER_PORT,
+                       dhcp_broadcast_hw_addr, request);
+        while (true)
+        {
+            long long remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(retransmit_at - dhcp_clock::now()).count();
+            if (0 >= remaining_ms)
+            {
+                break;
+            }
+
+            struct pollfd poll_fds[2] = { { sock_fd, POLLIN, 0 }, { m_stop_fd, POLLIN, 0 } };
+            int ready = poll(poll_fds, (0 <= m_stop_fd) ? 2 : 1, static_cast<int>(remaining_ms));
+            if ((0 < ready) && (poll_fds[1].revents & POLLIN))
+            {
+                return 0;
+            }
+            if ((0 >= ready) || (0 == (poll_fds[0].revents & POLLIN)))
+            {
+                continue;
+            }
+
+            reply_len = m_io_ops->recv(sock_fd, DHCP_CLIENT_PORT, reply);
+            if ((0 == reply_len) ||
+                (DHCP_BOOTREPLY != reply.op) ||
+                (m_xid != reply.xid) ||
+                (0 != memcmp(reply.chaddr, m_hw_addr, DHCP_HW_ADDR_LEN)))
+            {
+                continue;
+            }
+
+            uint8_t reply_type = MiracastDHCPCommon::get_message_type(reply, reply_len);
+            if (((DHCP_DISCOVER == request_type) && (DHCP_OFFER == reply_type)) ||
+                ((DHCP_REQUEST == request_type) && ((DHCP_ACK == reply_type) || (DHCP_NAK == reply_type))))
+            {
+                return reply_type;
+            }
+        }
+        retransmit_ms = std::min(retransmit_ms * 2, static_cast<unsigned int>(DHCP_CLIENT_MAX_RETRANSMIT_MS));
+    }
+    return 0;
+}
+
+bool MiracastDHCPClient::apply_lease(const DHCP_PACKET &reply, size_t reply_len, DHCP_LEASE &lease)
+{
+    std::vector<uint8_t> value;
+    uint32_t subnet_mask = htonl(0xFFFFFF00),
+             router = 0,
+             server_id = 0,
+             lease_time = htonl(DHCP_INFINITE_LEASE);
+
+    MiracastDHCPCommon::get_option_u32(reply, reply_len, DHCP_OPTION_SUBNET_MASK, subnet_mask);
+    MiracastDHCPCommon::get_option_u32(reply, reply_len, DHCP_OPTION_ROUTER, router);
+    MiracastDHCPCommon::get_option_u32(reply, reply_len, DHCP_OPTION_SERVER_ID, server_id);
+    MiracastDHCPCommon::get_option_u32(reply, reply_len, DHCP_OPTION_LEASE_TIME, lease_time);
+
+    lease.dns_servers.clear();
+    if (MiracastDHCPCommon::get_option(reply, reply_len, DHCP_OPTION_DNS_SERVER, value))
+    {
+        for (size_t offset = 0; offset + sizeof(uint32_t) <= value.size(); offset += sizeof(uint32_t))
+        {
+            uint32_t dns_server = 0;
+            memcpy(&dns_server, &value[offset], sizeof(dns_server));
+            lease.dns_servers.push_back(MiracastDHCPCommon::ip_to_string(dns_server));
+        }
+    }
+
+    uint8_t prefix_len = MiracastDHCPCommon::mask_to_prefix(ntohl(subnet_mask));
+    if (!m_io_ops->set_address(m_ifindex, reply.yiaddr, prefix_len))
+    {
+        return false;
+    }
+
+    m_leased_ip = reply.yiaddr;
+    m_prefix_len = prefix_len;
+    m_server_id = server_id;
+    m_lease_time_s = ntohl(lease_time);
+
+    lease.ip_address = MiracastDHCPCommon::ip_to_string(reply.yiaddr);
+    lease.subnet_mask = MiracastDHCPCommon::ip_to_string(subnet_mask);
+    lease.router = router ? MiracastDHCPCommon::ip_to_string(router) : "";
+    lease.server_id = server_id ? MiracastDHCPCommon::ip_to_string(server_id) : "";
+    lease.lease_time_s = m_lease_time_s;
+    return true;
+}
+
+MiracastError MiracastDHCPClient::start(const std::string &interface,
+                                       const std::string &requested_ip,
+                                       DHCP_LEASE &lease,
+                                       unsigned int timeout_ms)
+{
+    DHCP_PACKET request,
+                reply;
+    size_t reply_len = 0;
+    uint32_t requested_addr = 0;
+    uint8_t reply_type = 0;
+    int sock_fd = -1;
+    dhcp_clock::time_point start_time = dhcp_clock::now();
+
+    MIRACASTLOG_TRACE("Entering...");
+    stop();
+
+    std::lock_guard<std::mutex> lock(m_client_mutex);
+    m_interface = interface;
+    m_ifindex = static_cast<int>(if_nametoindex(interface.c_str()));
+    if ((0 == m_ifindex) || !MiracastDHCPCommon::get_hw_address(interface, m_hw_addr))
+    {
+        MIRACASTLOG_ERROR("Could not find [%s]", interface.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_INVALID_CONFIGURATION;
+    }
+    sock_fd = m_io_ops->open_socket(m_ifindex);
+    m_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((0 > sock_fd) || (0 > m_stop_fd))
+    {
+        if (0 <= sock_fd)
+        {
+            close(sock_fd);
+        }
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_INVALID_CONFIGURATION;
+    }
+
+    m_xid = std::random_device()();
+    if (!requested_ip.empty())
+    {
+        inet_pton(AF_INET, requested_ip.c_str(), &requested_addr);
+    }
+
+    while (dhcp_clock::now() < start_time + std::chrono::milliseconds(timeout_ms))
+    {
+        unsigned int remaining_ms = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        start_time + std::chrono::milliseconds(timeout_ms) - dhcp_clock::now()).count());
+
+        if (0 != requested_addr)
+        {
+            /* INIT-REBOOT, confirm the address of the previous session in a single round trip */
+            build_request(request, DHCP_REQUEST, requested_addr, 0, 0);
+            reply_type = exchange(sock_fd, request, 0, DHCP_CLIENT_INIT_REBOOT_ATTEMPTS, remaining_ms, reply, reply_len);
+            if (DHCP_ACK == reply_type)
+            {
+                break;
+            }
+            MIRACASTLOG_INFO("Requested address [%s] not confirmed, discovering", requested_ip.c_str());
+            requested_addr = 0;
+            continue;
+        }
+
+        build_request(request, DHCP_DISCOVER, 0, 0, 0);
+        reply_type = exchange(sock_fd, request, 0, UINT32_MAX, remaining_ms, reply, reply_len);
+        if (DHCP_OFFER != reply_type)
+        {
+            break;
+        }
+
+        uint32_t server_id = reply.siaddr;
+        MiracastDHCPCommon::get_option_u32(reply, reply_len, DHCP_OPTION_SERVER_ID, server_id);
+        MIRACASTLOG_INFO("DHCP offer of [%s] from [%s]",
+                         MiracastDHCPCommon::ip_to_string(reply.yiaddr).c_str(),
+                         MiracastDHCPCommon::ip_to_string(server_id).c_str());
+
+        remaining_ms = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                           start_time + std::chrono::milliseconds(timeout_ms) - dhcp_clock::now()).count());
+        build_request(request, DHCP_REQUEST, reply.yiaddr, server_id, 0);
+        reply_type = exchange(sock_fd, request, 0, UINT32_MAX, remaining_ms, reply, reply_len);
+        if (DHCP_ACK == reply_type)
+        {
+            break;
+        }
+        MIRACASTLOG_WARNING("DHCP request not acknowledged [%u], restarting", reply_type);
+        m_xid++;
+    }
+    close(sock_fd);
+
+    if ((DHCP_ACK != reply_type) || !apply_lease(reply, reply_len, lease))
+    {
+        MIRACASTLOG_ERROR("No DHCP lease on [%s] within %u ms", interface.c_str(), timeout_ms);
+        close(m_stop_fd);
+        m_stop_fd = -1;
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_FAIL;
+    }
+
+    MIRACASTLOG_INFO("lease of %s obtained from %s in %lld ms, lease time %u, router [%s]",
+                     lease.ip_address.c_str(),
+                     lease.server_id.c_str(),
+                     static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(dhcp_clock::now() - start_time).count()),
+                     lease.lease_time_s,
+                     lease.router.c_str());
+
+    if ((DHCP_INFINITE_LEASE != m_lease_time_s) &&
+        (0 != pthread_create(&m_renew_thread_id, nullptr, MiracastDHCPClient::renew_thread, this)))
+    {
+        MIRACASTLOG_ERROR("DHCP renew thread creation failed, lease expires in %u s", m_lease_time_s);
+        m_renew_thread_id = 0;
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return MIRACAST_OK;
+}
+
+void MiracastDHCPClient::stop(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    std::lock_guard<std::mutex> lock(m_client_mutex);
+
+    if (0 != m_renew_thread_id)
+    {
+        uint64_t value = 1;
+        if (sizeof(value) != write(m_stop_fd, &value, sizeof(value)))
+        {
+            MIRACASTLOG_ERROR("Unable to signal the DHCP renew thread");
+        }
+        pthread_join(m_renew_thread_id, nullptr);
+        m_renew_thread_id = 0;
+    }
+    if (0 <= m_stop_fd)
+    {
+        close(m_stop_fd);
+        m_stop_fd = -1;
+    }
+    m_leased_ip = 0;
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastDHCPClient::set_lease_lost_handler(DHCP_LEASE_LOST_HANDLER handler, void *ctx)
+{
+    std::lock_guard<std::mutex> lock(m_client_mutex);
+    m_lease_lost_handler = handler;
+    m_lease_lost_ctx = ctx;
+}
+
+const DHCP_CLIENT_IO_OPS *MiracastDHCPClient::set_IOOps(const DHCP_CLIENT_IO_OPS *io_ops)
+{
+    const DHCP_CLIENT_IO_OPS *previous = m_installed_io_ops;
+
+    m_installed_io_ops = io_ops;
+    return previous;
+}
+
+bool MiracastDHCPClient::wait_for_stop(unsigned int timeout_ms)
+{
+    struct pollfd poll_fd = { m_stop_fd, POLLIN, 0 };
+    return (0 < poll(&poll_fd, 1, static_cast<int>(timeout_ms)));
+}
+
+void *MiracastDHCPClient::renew_thread(void *ctx)
+{
+    MiracastDHCPClient *dhcp_client = static_cast<MiracastDHCPClient *>(ctx);
+    dhcp_client->renew_loop();
+    return nullptr;
+}
+
+void MiracastDHCPClient::renew_loop(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    dhcp_clock::time_point lease_start = dhcp_clock::now();
+
+    while (true)
+    {
+        /* T1 at half the lease, then retry until the lease runs out */
+        dhcp_clock::time_point expiry = lease_start + std::chrono::seconds(m_lease_time_s);
+        dhcp_clock::time_point renew_at = lease_start + std::chrono::seconds(m_lease_time_s / 2);
+        long long wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(renew_at - dhcp_clock::now()).count();
+
+        if (wait_for_stop(static_cast<unsigned int>(std::max(wait_ms, 0LL))))
+        {
+            break;
+        }
+
+        bool renewed = false;
+        while ((!renewed) && (dhcp_clock::now() < expiry))
+        {
+            DHCP_PACKET request,
+                        reply;
+            size_t reply_len = 0;
+            int sock_fd = m_io_ops->open_socket(m_ifindex);
+
+            if (0 <= sock_fd)
+            {
+                m_xid++;
+                build_request(request, DHCP_REQUEST, 0, 0, m_leased_ip);
+                dhcp_clock::time_point sent_at = dhcp_clock::now();
+                uint8_t reply_type = exchange(sock_fd, request, m_leased_ip, UINT32_MAX, DHCP_CLIENT_TIMEOUT_MS, reply, reply_len);
+                close(sock_fd);
+
+                if ((DHCP_ACK == reply_type) && (reply.yiaddr == m_leased_ip))
+                {
+                    uint32_t lease_time = htonl(DHCP_INFINITE_LEASE);
+                    MiracastDHCPCommon::get_option_u32(reply, reply_len, DHCP_OPTION_LEASE_TIME, lease_time);
+                    m_lease_time_s = ntohl(lease_time);
+                    lease_start = sent_at;
+                    renewed = true;
+                    MIRACASTLOG_INFO("DHCP lease of %s renewed for %u s",
+                                     MiracastDHCPCommon::ip_to_string(m_leased_ip).c_str(),
+                                     m_lease_time_s);
+                }
+                else if (DHCP_NAK == reply_type)
+                {
+                    MIRACASTLOG_ERROR("DHCP lease of %s revoked by the GO", MiracastDHCPCommon::ip_to_string(m_leased_ip).c_str());
+                    drop_lease();
+                    MIRACASTLOG_TRACE("Exiting...");
+                    return;
+                }
+            }
+            if ((!renewed) && wait_for_stop(DHCP_CLIENT_RENEW_RETRY_MS))
+            {
+                MIRACASTLOG_TRACE("Exiting...");
+                return;
+            }
+        }
+        if ((!renewed) || (DHCP_INFINITE_LEASE == m_lease_time_s))
+        {
+            if (!renewed)
+            {
+                MIRACASTLOG_ERROR("DHCP lease of %s expired on [%s]",
+                                  MiracastDHCPCommon::ip_to_string(m_leased_ip).c_str(),
+                                  m_interface.c_str());
+                drop_lease();
+            }
+            break;
+        }
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastDHCPClient::drop_lease(void)
+{
+    std::string ip_address = MiracastDHCPCommon::ip_to_string(m_leased_ip);
+
+    /* Keeping the address would leave the sink reachable on a subnet the GO reassigns */
+    if (!m_io_ops->remove_address(m_ifindex, m_leased_ip, m_prefix_len))
+    {
+        MIRACASTLOG_ERROR("Failed to flush %s from [%s]", ip_address.c_str(), m_interface.c_str());
+    }
+    m_leased_ip = 0;
+
+    if (nullptr != m_lease_lost_handler)
+    {
+        m_lease_lost_handler(m_lease_lost_ctx, m_interface, ip_address);
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_DHCP_CLIENT_H_
+#define _MIRACAST_DHCP_CLIENT_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <pthread.h>
+#include <MiracastCommon.h>
+#include "MiracastDHCPCommon.h"
+
+#define DHCP_CLIENT_TIMEOUT_MS              (15000)
+#define DHCP_CLIENT_INITIAL_RETRANSMIT_MS   (250)
+#define DHCP_CLIENT_MAX_RETRANSMIT_MS       (2000)
+/* Attempts to confirm the previous address before falling back to DISCOVER */
+#define DHCP_CLIENT_INIT_REBOOT_ATTEMPTS    (2)
+#define DHCP_CLIENT_RENEW_RETRY_MS          (10000)
+
+typedef struct dhcp_lease_st
+{
+    std::string ip_address;
+    std::string subnet_mask;
+    std::string router;
+    std::string server_id;
+    std::vector<std::string> dns_servers;
+    uint32_t lease_time_s;
+}
+DHCP_LEASE;
+
+/* Raw socket and rtnetlink access of the client, L1 tests install their own */
+typedef struct dhcp_client_io_ops_st
+{
+    int (*open_socket)(int ifindex);
+    bool (*send)(int sock_fd, int ifindex,
+                 uint32_t src_ip, uint16_t src_port,
+                 uint32_t dst_ip, uint16_t dst_port,
+                 const uint8_t *dst_hw_addr,
+                 const DHCP_PACKET &packet);
+    size_t (*recv)(int sock_fd, uint16_t dst_port, DHCP_PACKET &packet);
+    bool (*set_address)(int ifindex, uint32_t ip_address, uint8_t prefix_len);
+    bool (*remove_address)(int ifindex, uint32_t ip_address, uint8_t prefix_len);
+}
+DHCP_CLIENT_IO_OPS;
+
+/* Called from the renew worker once the leased address is gone from the interface */
+typedef void (*DHCP_LEASE_LOST_HANDLER)(void *ctx, const std::string &interface, const std::string &ip_address);
+
+/* DHCP client of the controller, L1 tests install their own through MiracastController */
+class MiracastDHCPClientInterface
+{
+public:
+    virtual ~MiracastDHCPClientInterface() {}
+
+    /* MIRACAST_INVALID_CONFIGURATION means the interface cannot be used, the caller falls back to udhcpc */
+    virtual MiracastError start(const std::string &interface,
+                                const std::string &requested_ip,
+                                DHCP_LEASE &lease,
+                                unsigned int timeout_ms = DHCP_CLIENT_TIMEOUT_MS) = 0;
+    virtual void stop(void) = 0;
+    /* Invoked when the lease expires or is NAKed by the GO */
+    virtual void set_lease_lost_handler(DHCP_LEASE_LOST_HANDLER handler, void *ctx) = 0;
+};
+
+/**
+ * DHCP client for the P2P group interface in client role. The exchange runs
+ * on an AF_PACKET socket with short initial retransmits, the leased address
+ * is configured over rtnetlink and a worker renews the lease until stop().
+ * A requested address from an earlier session is first confirmed with an
+ * INIT-REBOOT REQUEST, which saves the DISCOVER/OFFER round trip.
+ */
+class MiracastDHCPClient : public MiracastDHCPClientInterface
+{
+public:
+    MiracastDHCPClient();
+    ~MiracastDHCPClient() override;
+
+    MiracastError start(const std::string &interface,
+                        const std::string &requested_ip,
+                        DHCP_LEASE &lease,
+                        unsigned int timeout_ms = DHCP_CLIENT_TIMEOUT_MS) override;
+    void stop(void) override;
+    void set_lease_lost_handler(DHCP_LEASE_LOST_HANDLER handler, void *ctx) override;
+
+    /* Used by clients created afterwards, nullptr restores the AF_PACKET backend. Returns the previous ops */
+    static const DHCP_CLIENT_IO_OPS *set_IOOps(const DHCP_CLIENT_IO_OPS *io_ops);
+
+private:
+    static const DHCP_CLIENT_IO_OPS *m_installed_io_ops;
+    const DHCP_CLIENT_IO_OPS *m_io_ops;
+    std::mutex m_client_mutex;
+    std::string m_interface;
+    int m_ifindex;
+    uint8_t m_hw_addr[DHCP_HW_ADDR_LEN];
+    uint32_t m_xid;
+    uint32_t m_leased_ip;
+    uint8_t m_prefix_len;
+    uint32_t m_server_id;
+    uint32_t m_lease_time_s;
+    int m_stop_fd;
+    pthread_t m_renew_thread_id;
+    DHCP_LEASE_LOST_HANDLER m_lease_lost_handler;
+    void *m_lease_lost_ctx;
+
+    /* Sends request until a reply of one of the expected types arrives or the deadline passes */
+    uint8_t exchange(int sock_fd,
+                     DHCP_PACKET &request,
+                     uint32_t src_ip,
+                     unsigned int max_attempts,
+                     unsigned int deadline_ms,
+                     DHCP_PACKET &reply,
+                     size_t &reply_len);
+    void build_request(DHCP_PACKET &packet, DHCP_MESSAGE_TYPE type, uint32_t requested_ip, uint32_t server_id, uint32_t client_ip);
+    bool apply_lease(const DHCP_PACKET &reply, size_t reply_len, DHCP_LEASE &lease);
+    bool wait_for_stop(unsigned int timeout_ms);
+    /* Flushes the leased address and reports the loss */
+    void drop_lease(void);
+
+    static void *renew_thread(void *ctx);
+    void renew_loop(void);
+};
+
+#endif /* _MIRACAST_DHCP_CLIENT_H_ */
@@ -0,0 +1,446 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include "MiracastDHCPCommon.h"
+
+#define DHCP_NETLINK_ACK_TIMEOUT_MS (1000)
+#define DHCP_IP_TTL                 (64)
+
+typedef struct dhcp_netlink_request_st
+{
+    struct nlmsghdr header;
+    union
+    {
+        struct ifaddrmsg address;
+        struct ifinfomsg link;
+    };
+    char attributes[64];
+}
+DHCP_NETLINK_REQUEST;
+
+static uint16_t checksum(const void *data, size_t len, uint32_t sum = 0)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+    while (1 < len)
+    {
+        sum += (static_cast<uint32_t>(bytes[0]) << 8) | bytes[1];
+        bytes += 2;
+        len -= 2;
+    }
+    if (len)
+    {
+        sum += static_cast<uint32_t>(bytes[0]) << 8;
+    }
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return htons(static_cast<uint16_t>(~sum));
+}
+
+static void add_netlink_attr(struct nlmsghdr *header, uint16_t type, const void *data, size_t len)
+{
+    struct rtattr *attr = reinterpret_cast<struct rtattr *>(reinterpret_cast<char *>(header) + NLMSG_ALIGN(header->nlmsg_len));
+
+    attr->rta_type = type;
+    attr->rta_len = RTA_LENGTH(len);
+    memcpy(RTA_DATA(attr), data, len);
+    header->nlmsg_len = NLMSG_ALIGN(header->nlmsg_len) + RTA_ALIGN(attr->rta_len);
+}
+
+static bool send_netlink_request(struct nlmsghdr *header)
+{
+    struct sockaddr_nl local_addr;
+    char buffer[1024];
+    bool success = false;
+    int sock_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+
+    if (0 > sock_fd)
+    {
+        MIRACASTLOG_ERROR("rtnetlink socket failed [%s]", strerror(errno));
+        return false;
+    }
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.nl_family = AF_NETLINK;
+    if ((0 != bind(sock_fd, reinterpret_cast<struct sockaddr *>(&local_addr), sizeof(local_addr))) ||
+        (0 > send(sock_fd, header, header->nlmsg_len, 0)))
+    {
+        MIRACASTLOG_ERROR("rtnetlink request failed [%s]", strerror(errno));
+        close(sock_fd);
+        return false;
+    }
+
+    struct pollfd poll_fd = { sock_fd, POLLIN, 0 };
+    if (0 < poll(&poll_fd, 1, DHCP_NETLINK_ACK_TIMEOUT_MS))
+    {
+        ssize_t len = recv(sock_fd, buffer, sizeof(buffer), 0);
+        struct nlmsghdr *reply = reinterpret_cast<struct nlmsghdr *>(buffer);
+
+        if ((0 < len) && NLMSG_OK(reply, static_cast<unsigned int>(len)) && (NLMSG_ERROR == reply->nlmsg_type))
+        {
+            const struct nlmsgerr *error = static_cast<const struct nlmsgerr *>(NLMSG_DATA(reply));
+            success = ((0 == error->error) || (-EEXIST == error->error));
+            if (!success)
+            {
+                MIRACASTLOG_ERROR("rtnetlink request type[%u] rejected [%s]", header->nlmsg_type, strerror(-error->error));
+            }
+        }
+    }
+    close(sock_fd);
+    return success;
+}
+
+void MiracastDHCPCommon::init_packet(DHCP_PACKET &packet, uint8_t op, DHCP_MESSAGE_TYPE type, uint32_t xid, const uint8_t *hw_addr)
+{
+    uint8_t message_type = static_cast<uint8_t>(type);
+
+    memset(&packet, 0, sizeof(packet));
+    packet.op = op;
+    packet.htype = 1;
+    packet.hlen = DHCP_HW_ADDR_LEN;
+    packet.xid = xid;
+    packet.cookie = htonl(DHCP_MAGIC_COOKIE);
+    memcpy(packet.chaddr, hw_addr, DHCP_HW_ADDR_LEN);
+    packet.options[0] = DHCP_OPTION_END;
+    add_option(packet, DHCP_OPTION_MESSAGE_TYPE, &message_type, sizeof(message_type));
+}
+
+bool MiracastDHCPCommon::add_option(DHCP_PACKET &packet, uint8_t code, const void *data, uint8_t len)
+{
+    size_t end = 0;
+
+    while ((end < DHCP_OPTIONS_LEN) && (DHCP_OPTION_END != packet.options[end]))
+    {
+        end += (DHCP_OPTION_PAD == packet.options[end]) ? 1 : (2 + packet.options[end + 1]);
+    }
+    if (DHCP_OPTIONS_LEN < (end + 2 + len + 1))
+    {
+        MIRACASTLOG_ERROR("No room for DHCP option[%u]", code);
+        return false;
+    }
+    packet.options[end] = code;
+    packet.options[end + 1] = len;
+    memcpy(&packet.options[end + 2], data, len);
+    packet.options[end + 2 + len] = DHCP_OPTION_END;
+    return true;
+}
+
+bool MiracastDHCPCommon::add_option_u32(DHCP_PACKET &packet, uint8_t code, uint32_t value)
+{
+    return add_option(packet, code, &value, sizeof(value));
+}
+
+bool MiracastDHCPCommon::get_option(const DHCP_PACKET &packet, size_t packet_len, uint8_t code, std::vector<uint8_t> &value)
+{
+    size_t options_len = 0,
+           index = 0;
+
+    if (packet_len <= offsetof(DHCP_PACKET, options))
+    {
+        return false;
+    }
+    options_len = std::min(packet_len - offsetof(DHCP_PACKET, options), static_cast<size_t>(DHCP_OPTIONS_LEN));
+
+    while (index < options_len)
+    {
+        uint8_t current = packet.options[index];
+
+        if (DHCP_OPTION_END == current)
+        {
+            break;
+        }
+        if (DHCP_OPTION_PAD == current)
+        {
+            index++;
+            continue;
+        }
+        if ((index + 1 >= options_len) || (index + 2 + packet.options[index + 1] > options_len))
+        {
+            break;
+        }
+        if (code == current)
+        {
+            value.assign(&packet.options[index + 2], &packet.options[index + 2] + packet.options[index + 1]);
+            return true;
+        }
+        index += 2 + packet.options[index + 1];
+    }
+    return false;
+}
+
+bool MiracastDHCPCommon::get_option_u32(const DHCP_PACKET &packet, size_t packet_len, uint8_t code, uint32_t &value)
+{
+    std::vector<uint8_t> data;
+
+    if (!get_option(packet, packet_len, code, data) || (sizeof(value) > data.size()))
+    {
+        return false;
+    }
+    memcpy(&value, data.data(), sizeof(value));
+    return true;
+}
+
+uint8_t MiracastDHCPCommon::get_message_type(const DHCP_PACKET &packet, size_t packet_len)
+{
+    std::vector<uint8_t> data;
+
+    if ((htonl(DHCP_MAGIC_COOKIE) != packet.cookie) ||
+        !get_option(packet, packet_len, DHCP_OPTION_MESSAGE_TYPE, data) ||
+        data.empty())
+    {
+        return 0;
+    }
+    return data[0];
+}
+
+size_t MiracastDHCPCommon::get_packet_length(const DHCP_PACKET &packet)
+{
+    size_t end = 0;
+
+    while ((end < DHCP_OPTIONS_LEN) && (DHCP_OPTION_END != packet.options[end]))
+    {
+        end += (DHCP_OPTION_PAD == packet.options[end]) ? 1 : (2 + packet.options[end + 1]);
+    }
+    /* Some servers still expect the 300 byte BOOTP minimum */
+    return std::max(offsetof(DHCP_PACKET, options) + end + 1, static_cast<size_t>(300));
+}
+
+int MiracastDHCPCommon::open_raw_socket(int ifindex)
+{
+    struct sockaddr_ll local_addr;
+    int sock_fd = socket(AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC, htons(ETH_P_IP));
+
+    if (0 > sock_fd)
+    {
+        MIRACASTLOG_ERROR("AF_PACKET socket failed [%s]", strerror(errno));
+        return -1;
+    }
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.sll_family = AF_PACKET;
+    local_addr.sll_protocol = htons(ETH_P_IP);
+    local_addr.sll_ifindex = ifindex;
+    if (0 != bind(sock_fd, reinterpret_cast<struct sockaddr *>(&local_addr), sizeof(local_addr)))
+    {
+        MIRACASTLOG_ERROR("AF_PACKET bind to ifindex[%d] failed [%s]", ifindex, strerror(errno));
+        close(sock_fd);
+        return -1;
+    }
+    return sock_fd;
+}
+
+bool MiracastDHCPCommon::send_raw(int sock_fd, int ifindex,
+                                  uint32_t src_ip, uint16_t src_port,
+                                  uint32_t dst_ip, uint16_t dst_port,
+                                  const uint8_t *dst_hw_addr,
+                                  const DHCP_PACKET &packet)
+{
+    DHCP_IP_PACKET ip_packet;
+    struct sockaddr_ll destination;
+    size_t dhcp_len = get_packet_length(packet);
+    size_t udp_len = sizeof(ip_packet.udp) + dhcp_len;
+    uint32_t pseudo_sum = 0;
+
+    memset(&ip_packet, 0, sizeof(ip_packet));
+    memcpy(&ip_packet.dhcp, &packet, dhcp_len);
+
+    ip_packet.udp.source = htons(src_port);
+    ip_packet.udp.dest = htons(dst_port);
+    ip_packet.udp.len = htons(static_cast<uint16_t>(udp_len));
+
+    /* UDP checksum covers the IPv4 pseudo header */
+    pseudo_sum += (ntohl(src_ip) >> 16) + (ntohl(src_ip) & 0xFFFF);
+    pseudo_sum += (ntohl(dst_ip) >> 16) + (ntohl(dst_ip) & 0xFFFF);
+    pseudo_sum += IPPROTO_UDP + static_cast<uint32_t>(udp_len);
+    ip_packet.udp.check = checksum(&ip_packet.udp, udp_len, pseudo_sum);
+    if (0 == ip_packet.udp.check)
+    {
+        ip_packet.udp.check = 0xFFFF;
+    }
+
+    ip_packet.ip.version = 4;
+    ip_packet.ip.ihl = sizeof(ip_packet.ip) >> 2;
+    ip_packet.ip.tot_len = htons(static_cast<uint16_t>(sizeof(ip_packet.ip) + udp_len));
+    ip_packet.ip.ttl = DHCP_IP_TTL;
+    ip_packet.ip.protocol = IPPROTO_UDP;
+    ip_packet.ip.saddr = src_ip;
+    ip_packet.ip.daddr = dst_ip;
+    ip_packet.ip.check = checksum(&ip_packet.ip, sizeof(ip_packet.ip));
+
+    memset(&destination, 0, sizeof(destination));
+    destination.sll_family = AF_PACKET;
+    destination.sll_protocol = htons(ETH_P_IP);
+    destination.sll_ifindex = ifindex;
+    destination.sll_halen = DHCP_HW_ADDR_LEN;
+    memcpy(destination.sll_addr, dst_hw_addr, DHCP_HW_ADDR_LEN);
+
+    if (0 > sendto(sock_fd, &ip_packet, sizeof(ip_packet.ip) + udp_len, 0,
+                   reinterpret_cast<struct sockaddr *>(&destination), sizeof(destination)))
+    {
+        MIRACASTLOG_ERROR("DHCP send on ifindex[%d] failed [%s]", ifindex, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+size_t MiracastDHCPCommon::recv_raw(int sock_fd, uint16_t dst_port, DHCP_PACKET &packet)
+{
+    DHCP_IP_PACKET ip_packet;
+    ssize_t len = recv(sock_fd, &ip_packet, sizeof(ip_packet), MSG_DONTWAIT);
+    size_t ip_header_len = 0,
+           udp_len = 0;
+
+    if (static_cast<ssize_t>(sizeof(ip_packet.ip) + sizeof(ip_packet.udp)) > len)
+    {
+        return 0;
+    }
+    ip_header_len = ip_packet.ip.ihl << 2;
+    if ((4 != ip_packet.ip.version) ||
+        (sizeof(ip_packet.ip) != ip_header_len) ||
+        (IPPROTO_UDP != ip_packet.ip.protocol) ||
+        (htons(dst_port) != ip_packet.udp.dest))
+    {
+        return 0;
+    }
+    udp_len = ntohs(ip_packet.udp.len);
+    if ((udp_len < sizeof(ip_packet.udp) + offsetof(DHCP_PACKET, options)) ||
+        (static_cast<size_t>(len) < ip_header_len + udp_len))
+    {
+        return 0;
+    }
+
+    size_t dhcp_len = std::min(udp_len - sizeof(ip_packet.udp), sizeof(packet));
+    memset(&packet, 0, sizeof(packet));
+    memcpy(&packet, &ip_packet.dhcp, dhcp_len);
+    return dhcp_len;
+}
+
+bool MiracastDHCPCommon::get_hw_address(const std::string &interface, uint8_t *hw_addr)
+{
+    struct ifreq request;
+    bool success = false;
+    int sock_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+    if (0 > sock_fd)
+    {
+        return false;
+    }
+    memset(&request, 0, sizeof(request));
+    strncpy(request.ifr_name, interface.c_str(), sizeof(request.ifr_name) - 1);
+    if (0 == ioctl(sock_fd, SIOCGIFHWADDR, &request))
+    {
+        memcpy(hw_addr, request.ifr_hwaddr.sa_data, DHCP_HW_ADDR_LEN);
+        success = true;
+    }
+    else
+    {
+        MIRACASTLOG_ERROR("SIOCGIFHWADDR on [%s] failed [%s]", interface.c_str(), strerror(errno));
+    }
+    close(sock_fd);
+    return success;
+}
+
+bool MiracastDHCPCommon::set_interface_address(int ifindex, uint32_t ip_address, uint8_t prefix_len)
+{
+    DHCP_NETLINK_REQUEST request;
+    uint32_t broadcast = ip_address | htonl((prefix_len < 32) ? (0xFFFFFFFF >> prefix_len) : 0);
+
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.address));
+    request.header.nlmsg_type = RTM_NEWADDR;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | NLM_F_CREATE | NLM_F_REPLACE;
+    request.address.ifa_family = AF_INET;
+    request.address.ifa_prefixlen = prefix_len;
+    request.address.ifa_scope = RT_SCOPE_UNIVERSE;
+    request.address.ifa_index = ifindex;
+    add_netlink_attr(&request.header, IFA_LOCAL, &ip_address, sizeof(ip_address));
+    add_netlink_attr(&request.header, IFA_ADDRESS, &ip_address, sizeof(ip_address));
+    add_netlink_attr(&request.header, IFA_BROADCAST, &broadcast, sizeof(broadcast));
+
+    MIRACASTLOG_INFO("Configuring %s/%u on ifindex[%d]", ip_to_string(ip_address).c_str(), prefix_len, ifindex);
+    return send_netlink_request(&request.header);
+}
+
+bool MiracastDHCPCommon::remove_interface_address(int ifindex, uint32_t ip_address, uint8_t prefix_len)
+{
+    DHCP_NETLINK_REQUEST request;
+
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.address));
+    request.header.nlmsg_type = RTM_DELADDR;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    request.address.ifa_family = AF_INET;
+    request.address.ifa_prefixlen = prefix_len;
+    request.address.ifa_index = ifindex;
+    add_netlink_attr(&request.header, IFA_LOCAL, &ip_address, sizeof(ip_address));
+
+    MIRACASTLOG_INFO("Removing %s/%u from ifindex[%d]", ip_to_string(ip_address).c_str(), prefix_len, ifindex);
+    return send_netlink_request(&request.header);
+}
+
+bool MiracastDHCPCommon::set_interface_up(int ifindex)
+{
+    DHCP_NETLINK_REQUEST request;
+
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.link));
+    request.header.nlmsg_type = RTM_NEWLINK;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    request.link.ifi_family = AF_UNSPEC;
+    request.link.ifi_index = ifindex;
+    request.link.ifi_flags = IFF_UP;
+    request.link.ifi_change = IFF_UP;
+    return send_netlink_request(&request.header);
+}
+
+uint8_t MiracastDHCPCommon::mask_to_prefix(uint32_t subnet_mask)
+{
+    return static_cast<uint8_t>(__builtin_popcount(subnet_mask));
+}
+
+std::string MiracastDHCPCommon::ip_to_string(uint32_t ip_address)
+{
+    char buffer[INET_ADDRSTRLEN] = {0};
+    struct in_addr addr;
+
+    addr.s_addr = ip_address;
+    inet_ntop(AF_INET, &addr, buffer, sizeof(buffer));
+    return buffer;
+}
+
+std::string MiracastDHCPCommon::hw_to_string(const uint8_t *hw_addr)
+{
+    char buffer[18] = {0};
+
+    snprintf(buffer, sizeof(buffer), "%02x:%02x:%02x:%02x:%02x:%02x",
+             hw_addr[0], hw_addr[1], hw_addr[2], hw_addr[3], hw_addr[4], hw_addr[5]);
+    return buffer;
+}
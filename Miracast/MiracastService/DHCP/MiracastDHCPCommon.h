@@ -0,0 +1,139 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_DHCP_COMMON_H_
+#define _MIRACAST_DHCP_COMMON_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <MiracastLogger.h>
+
+#define DHCP_SERVER_PORT            (67)
+#define DHCP_CLIENT_PORT            (68)
+#define DHCP_MAGIC_COOKIE           (0x63825363)
+#define DHCP_OPTIONS_LEN            (312)
+#define DHCP_HW_ADDR_LEN            (6)
+#define DHCP_BROADCAST_FLAG         (0x8000)
+#define DHCP_INFINITE_LEASE         (0xFFFFFFFF)
+
+#define DHCP_BOOTREQUEST            (1)
+#define DHCP_BOOTREPLY              (2)
+
+typedef enum dhcp_message_type_e
+{
+    DHCP_DISCOVER = 1,
+    DHCP_OFFER,
+    DHCP_REQUEST,
+    DHCP_DECLINE,
+    DHCP_ACK,
+    DHCP_NAK,
+    DHCP_RELEASE,
+    DHCP_INFORM
+}
+DHCP_MESSAGE_TYPE;
+
+typedef enum dhcp_option_code_e
+{
+    DHCP_OPTION_PAD = 0,
+    DHCP_OPTION_SUBNET_MASK = 1,
+    DHCP_OPTION_ROUTER = 3,
+    DHCP_OPTION_DNS_SERVER = 6,
+    DHCP_OPTION_HOST_NAME = 12,
+    DHCP_OPTION_REQUESTED_IP = 50,
+    DHCP_OPTION_LEASE_TIME = 51,
+    DHCP_OPTION_MESSAGE_TYPE = 53,
+    DHCP_OPTION_SERVER_ID = 54,
+    DHCP_OPTION_PARAM_REQUEST = 55,
+    DHCP_OPTION_RENEWAL_TIME = 58,
+    DHCP_OPTION_REBINDING_TIME = 59,
+    DHCP_OPTION_CLIENT_ID = 61,
+    DHCP_OPTION_END = 255
+}
+DHCP_OPTION_CODE;
+
+typedef struct __attribute__((packed)) dhcp_packet_st
+{
+    uint8_t op;
+    uint8_t htype;
+    uint8_t hlen;
+    uint8_t hops;
+    uint32_t xid;
+    uint16_t secs;
+    uint16_t flags;
+    uint32_t ciaddr;
+    uint32_t yiaddr;
+    uint32_t siaddr;
+    uint32_t giaddr;
+    uint8_t chaddr[16];
+    uint8_t sname[64];
+    uint8_t file[128];
+    uint32_t cookie;
+    uint8_t options[DHCP_OPTIONS_LEN];
+}
+DHCP_PACKET;
+
+typedef struct __attribute__((packed)) dhcp_ip_packet_st
+{
+    struct iphdr ip;
+    struct udphdr udp;
+    DHCP_PACKET dhcp;
+}
+DHCP_IP_PACKET;
+
+/**
+ * BOOTP/DHCP message helpers shared by the P2P DHCP client and server. The
+ * messages travel over an AF_PACKET socket so they can be exchanged before the
+ * group interface has an address, and the address itself is configured over
+ * rtnetlink.
+ */
+class MiracastDHCPCommon
+{
+public:
+    static void init_packet(DHCP_PACKET &packet, uint8_t op, DHCP_MESSAGE_TYPE type, uint32_t xid, const uint8_t *hw_addr);
+    static bool add_option(DHCP_PACKET &packet, uint8_t code, const void *data, uint8_t len);
+    static bool add_option_u32(DHCP_PACKET &packet, uint8_t code, uint32_t value);
+    /* Returns false when the option is absent */
+    static bool get_option(const DHCP_PACKET &packet, size_t packet_len, uint8_t code, std::vector<uint8_t> &value);
+    static bool get_option_u32(const DHCP_PACKET &packet, size_t packet_len, uint8_t code, uint32_t &value);
+    static uint8_t get_message_type(const DHCP_PACKET &packet, size_t packet_len);
+    static size_t get_packet_length(const DHCP_PACKET &packet);
+
+    static int open_raw_socket(int ifindex);
+    static bool send_raw(int sock_fd, int ifindex,
+                         uint32_t src_ip, uint16_t src_port,
+                         uint32_t dst_ip, uint16_t dst_port,
+                         const uint8_t *dst_hw_addr,
+                         const DHCP_PACKET &packet);
+    /* Reads one datagram, returns the DHCP payload length or 0 when it was not for dst_port */
+    static size_t recv_raw(int sock_fd, uint16_t dst_port, DHCP_PACKET &packet);
+
+    static bool get_hw_address(const std::string &interface, uint8_t *hw_addr);
+    static bool set_interface_address(int ifindex, uint32_t ip_address, uint8_t prefix_len);
+    static bool remove_interface_address(int ifindex, uint32_t ip_address, uint8_t prefix_len);
+    static bool set_interface_up(int ifindex);
+    static uint8_t mask_to_prefix(uint32_t subnet_mask);
+    static std::string ip_to_string(uint32_t ip_address);
+    static std::string hw_to_string(const uint8_t *hw_addr);
+};
+
+#endif /* _MIRACAST_DHCP_COMMON_H_ */
@@ -0,0 +1,468 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <chrono>
+#include <algorithm>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "MiracastDHCPServer.h"
+
+static const uint8_t dhcp_broadcast_hw_addr[DHCP_HW_ADDR_LEN] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+static std::string to_lower_mac(std::string mac_address)
+{
+    std::transform(mac_address.begin(), mac_address.end(), mac_address.begin(), ::tolower);
+    return mac_address;
+}
+
+MiracastDHCPServer::MiracastDHCPServer()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    m_ifindex = 0;
+    m_server_ip = 0;
+    m_subnet_mask = 0;
+    m_pool_start = 0;
+    m_pool_end = 0;
+    m_reserved_ip = 0;
+    m_running = false;
+    m_recv_fd = -1;
+    m_send_fd = -1;
+    m_stop_fd = -1;
+    m_server_thread_id = 0;
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastDHCPServer::~MiracastDHCPServer()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    stop();
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastError MiracastDHCPServer::start(const std::string &interface,
+                                        const std::string &reserved_mac,
+                                        const std::string &reserved_ip)
+{
+    int enable = 1;
+    struct sockaddr_in local_addr;
+
+    MIRACASTLOG_TRACE("Entering...");
+    stop();
+
+    std::lock_guard<std::mutex> lock(m_server_mutex);
+    m_interface = interface;
+    m_ifindex = static_cast<int>(if_nametoindex(interface.c_str()));
+    if (0 == m_ifindex)
+    {
+        MIRACASTLOG_ERROR("Could not find [%s]", interface.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_INVALID_CONFIGURATION;
+    }
+
+    inet_pton(AF_INET, DHCP_SERVER_ADDRESS, &m_server_ip);
+    inet_pton(AF_INET, DHCP_SERVER_POOL_START, &m_pool_start);
+    inet_pton(AF_INET, DHCP_SERVER_POOL_END, &m_pool_end);
+    m_subnet_mask = htonl(0xFFFFFFFF << (32 - DHCP_SERVER_PREFIX_LEN));
+
+    m_reserved_mac.clear();
+    m_reserved_ip = 0;
+    if (!reserved_mac.empty() && !reserved_ip.empty() &&
+        (1 == inet_pton(AF_INET, reserved_ip.c_str(), &m_reserved_ip)) &&
+        ((m_reserved_ip & m_subnet_mask) == (m_server_ip & m_subnet_mask)) &&
+        (m_reserved_ip != m_server_ip))
+    {
+        /* Hand a returning source the address it had in the previous session */
+        m_reserved_mac = to_lower_mac(reserved_mac);
+    }
+    else
+    {
+        m_reserved_ip = 0;
+    }
+
+    if (!MiracastDHCPCommon::set_interface_address(m_ifindex, m_server_ip, DHCP_SERVER_PREFIX_LEN) ||
+        !MiracastDHCPCommon::set_interface_up(m_ifindex))
+    {
+        MIRACASTLOG_ERROR("Unable to configure [%s] for the DHCP server", interface.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_INVALID_CONFIGURATION;
+    }
+
+    /* Requests arrive on a plain UDP socket so the kernel does not answer them with ICMP */
+    m_recv_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    /* Replies go out on a send-only AF_PACKET socket, the client has no address yet */
+    m_send_fd = socket(AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    m_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.sin_family = AF_INET;
+    local_addr.sin_port = htons(DHCP_SERVER_PORT);
+    local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if ((0 > m_recv_fd) || (0 > m_send_fd) || (0 > m_stop_fd) ||
+        (0 != setsockopt(m_recv_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable))) ||
+        (0 != setsockopt(m_recv_fd, SOL_SOCKET, SO_BINDTODEVICE, interface.c_str(), interface.size() + 1)) ||
+        (0 != bind(m_recv_fd, reinterpret_cast<struct sockaddr *>(&local_addr), sizeof(local_addr))))
+    {
+        MIRACASTLOG_ERROR("Unable to open DHCP server sockets on [%s] [%s]", interface.c_str(), strerror(errno));
+        close_sockets();
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_INVALID_CONFIGURATION;
+    }
+
+    {
+        std::lock_guard<std::mutex> lease_lock(m_lease_mutex);
+        m_bindings.clear();
+        m_declined.clear();
+        m_running = true;
+    }
+
+    if (0 != pthread_create(&m_server_thread_id, nullptr, MiracastDHCPServer::server_thread, this))
+    {
+        MIRACASTLOG_ERROR("DHCP server thread creation failed");
+        m_server_thread_id = 0;
+        {
+            std::lock_guard<std::mutex> lease_lock(m_lease_mutex);
+            m_running = false;
+        }
+        close_sockets();
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_INVALID_CONFIGURATION;
+    }
+
+    MIRACASTLOG_INFO("DHCP server on [%s] %s, pool %s-%s, reserved [%s - %s]",
+                     interface.c_str(),
+                     DHCP_SERVER_ADDRESS,
+                     DHCP_SERVER_POOL_START,
+                     DHCP_SERVER_POOL_END,
+                     m_reserved_mac.c_str(),
+                     (0 != m_reserved_ip) ? reserved_ip.c_str() : "");
+    MIRACASTLOG_TRACE("Exiting...");
+    return MIRACAST_OK;
+}
+
+void MiracastDHCPServer::stop(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    std::lock_guard<std::mutex> lock(m_server_mutex);
+
+    if (0 != m_server_thread_id)
+    {
+        uint64_t value = 1;
+        if (sizeof(value) != write(m_stop_fd, &value, sizeof(value)))
+        {
+            MIRACASTLOG_ERROR("Unable to signal the DHCP server thread");
+        }
+        pthread_join(m_server_thread_id, nullptr);
+        m_server_thread_id = 0;
+    }
+    close_sockets();
+
+    std::lock_guard<std::mutex> lease_lock(m_lease_mutex);
+    m_running = false;
+    m_bindings.clear();
+    m_lease_cond.notify_all();
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastDHCPServer::close_sockets(void)
+{
+    if (0 <= m_recv_fd)
+    {
+        close(m_recv_fd);
+        m_recv_fd = -1;
+    }
+    if (0 <= m_send_fd)
+    {
+        close(m_send_fd);
+        m_send_fd = -1;
+    }
+    if (0 <= m_stop_fd)
+    {
+        close(m_stop_fd);
+        m_stop_fd = -1;
+    }
+}
+
+bool MiracastDHCPServer::is_running(void)
+{
+    std::lock_guard<std::mutex> lease_lock(m_lease_mutex);
+    return m_running;
+}
+
+bool MiracastDHCPServer::wait_for_lease(const std::string &mac_address, DHCP_SERVER_LEASE &lease, unsigned int timeout_ms)
+{
+    std::string client_mac = to_lower_mac(mac_address);
+    bool granted = false;
+
+    MIRACASTLOG_TRACE("Entering...");
+    std::unique_lock<std::mutex> lease_lock(m_lease_mutex);
+    m_lease_cond.wait_for(lease_lock, std::chrono::milliseconds(timeout_ms), [&]()
+    {
+        for (const auto &binding : m_bindings)
+        {
+            if (binding.second.acknowledged && (client_mac.empty() || (client_mac == binding.first)))
+            {
+                lease.mac_address = binding.first;
+                lease.ip_address = MiracastDHCPCommon::ip_to_string(binding.second.ip_address);
+                granted = true;
+                break;
+            }
+        }
+        return (granted || !m_running);
+    });
+
+    if (granted)
+    {
+        MIRACASTLOG_INFO("Peer [%s] leased [%s]", lease.mac_address.c_str(), lease.ip_address.c_str());
+    }
+    else
+    {
+        MIRACASTLOG_ERROR("No DHCP lease for [%s] within %u ms", mac_address.c_str(), timeout_ms);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return granted;
+}
+
+bool MiracastDHCPServer::is_address_free(uint32_t ip_address, const std::string &mac_address)
+{
+    time_t now = time(nullptr);
+
+    if ((ip_address == m_server_ip) ||
+        (m_declined.end() != m_declined.find(ip_address)) ||
+        ((ip_address == m_reserved_ip) && (mac_address != m_reserved_mac)))
+    {
+        return false;
+    }
+    for (const auto &binding : m_bindings)
+    {
+        if ((binding.first != mac_address) && (binding.second.ip_address == ip_address) && (binding.second.expiry > now))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t MiracastDHCPServer::allocate_address(const std::string &mac_address, uint32_t requested_ip)
+{
+    auto existing = m_bindings.find(mac_address);
+
+    if ((0 != m_reserved_ip) && (mac_address == m_reserved_mac) && is_address_free(m_reserved_ip, mac_address))
+    {
+        return m_reserved_ip;
+    }
+    if ((m_bindings.end() != existing) && is_address_free(existing->second.ip_address, mac_address))
+    {
+        return existing->second.ip_address;
+    }
+    if ((0 != requested_ip) &&
+        (ntohl(requested_ip) >= ntohl(m_pool_start)) &&
+        (ntohl(requested_ip) <= ntohl(m_pool_end)) &&
+        is_address_free(requested_ip, mac_address))
+    {
+        return requested_ip;
+    }
+    for (uint32_t candidate = ntohl(m_pool_start); candidate <= ntohl(m_pool_end); ++candidate)
+    {
+        if (is_address_free(htonl(candidate), mac_address))
+        {
+            return htonl(candidate);
+        }
+    }
+    return 0;
+}
+
+void MiracastDHCPServer::send_reply(const DHCP_PACKET &request, DHCP_MESSAGE_TYPE type, uint32_t client_ip)
+{
+    DHCP_PACKET reply;
+    uint32_t dst_ip = INADDR_BROADCAST;
+    const uint8_t *dst_hw_addr = dhcp_broadcast_hw_addr;
+
+    MiracastDHCPCommon::init_packet(reply, DHCP_BOOTREPLY, type, request.xid, request.chaddr);
+    reply.flags = request.flags;
+    reply.giaddr = request.giaddr;
+    MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_SERVER_ID, m_server_ip);
+    if (DHCP_NAK != type)
+    {
+        reply.ciaddr = request.ciaddr;
+        reply.yiaddr = client_ip;
+        MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_LEASE_TIME, htonl(DHCP_SERVER_LEASE_TIME_S));
+        MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_SUBNET_MASK, m_subnet_mask);
+        MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_ROUTER, m_server_ip);
+
+        /* RFC 2131 4.1, unicast unless the client asked for broadcast or cannot take it yet */
+        if (0 != request.ciaddr)
+        {
+            dst_ip = request.ciaddr;
+            dst_hw_addr = request.chaddr;
+        }
+        else if (0 == (ntohs(request.flags) & DHCP_BROADCAST_FLAG))
+        {
+            dst_ip = client_ip;
+            dst_hw_addr = request.chaddr;
+        }
+    }
+    MiracastDHCPCommon::send_raw(m_send_fd, m_ifindex,
+                                 m_server_ip, DHCP_SERVER_PORT,
+                                 dst_ip, DHCP_CLIENT_PORT,
+                                 dst_hw_addr, reply);
+}
+
+void MiracastDHCPServer::handle_packet(const DHCP_PACKET &request, size_t request_len)
+{
+    std::string mac_address = MiracastDHCPCommon::hw_to_string(request.chaddr);
+    uint8_t type = MiracastDHCPCommon::get_message_type(request, request_len);
+    uint32_t requested_ip = 0,
+             server_id = 0,
+             client_ip = 0;
+    time_t now = time(nullptr);
+
+    MiracastDHCPCommon::get_option_u32(request, request_len, DHCP_OPTION_REQUESTED_IP, requested_ip);
+
+    std::lock_guard<std::mutex> lease_lock(m_lease_mutex);
+    switch (type)
+    {
+        case DHCP_DISCOVER:
+        {
+            client_ip = allocate_address(mac_address, requested_ip);
+            if (0 == client_ip)
+            {
+                MIRACASTLOG_ERROR("DHCP pool exhausted, ignoring DISCOVER from [%s]", mac_address.c_str());
+                break;
+            }
+            /* The address is bound here, the REQUEST only confirms it */
+            DHCP_BINDING &binding = m_bindings[mac_address];
+            binding.ip_address = client_ip;
+            binding.expiry = now + DHCP_SERVER_OFFER_HOLD_S;
+            binding.acknowledged = false;
+            MIRACASTLOG_INFO("DHCP OFFER of [%s] to [%s]", MiracastDHCPCommon::ip_to_string(client_ip).c_str(), mac_address.c_str());
+            send_reply(request, DHCP_OFFER, client_ip);
+        }
+        break;
+        case DHCP_REQUEST:
+        {
+            if (MiracastDHCPCommon::get_option_u32(request, request_len, DHCP_OPTION_SERVER_ID, server_id) && (server_id != m_server_ip))
+            {
+                /* The client took an offer from another server */
+                auto binding = m_bindings.find(mac_address);
+                if ((m_bindings.end() != binding) && !binding->second.acknowledged)
+                {
+                    m_bindings.erase(binding);
+                }
+                break;
+            }
+            if (0 == requested_ip)
+            {
+                requested_ip = request.ciaddr;
+            }
+            client_ip = allocate_address(mac_address, requested_ip);
+            if ((0 == requested_ip) || (client_ip != requested_ip))
+            {
+                MIRACASTLOG_WARNING("DHCP NAK for [%s] requested by [%s]",
+                                    MiracastDHCPCommon::ip_to_string(requested_ip).c_str(),
+                                    mac_address.c_str());
+                send_reply(request, DHCP_NAK, 0);
+                break;
+            }
+            DHCP_BINDING &binding = m_bindings[mac_address];
+            binding.ip_address = client_ip;
+            binding.expiry = now + DHCP_SERVER_LEASE_TIME_S;
+            binding.acknowledged = true;
+            MIRACASTLOG_INFO("DHCP ACK of [%s] to [%s]", MiracastDHCPCommon::ip_to_string(client_ip).c_str(), mac_address.c_str());
+            send_reply(request, DHCP_ACK, client_ip);
+            m_lease_cond.notify_all();
+        }
+        break;
+        case DHCP_DECLINE:
+        {
+            MIRACASTLOG_WARNING("DHCP DECLINE of [%s] from [%s]",
+                                MiracastDHCPCommon::ip_to_string(requested_ip).c_str(),
+                                mac_address.c_str());
+            m_declined.insert(requested_ip);
+            m_bindings.erase(mac_address);
+        }
+        break;
+        case DHCP_RELEASE:
+        {
+            MIRACASTLOG_INFO("DHCP RELEASE from [%s]", mac_address.c_str());
+            m_bindings.erase(mac_address);
+        }
+        break;
+        default:
+        {
+            MIRACASTLOG_VERBOSE("Ignoring DHCP message type[%u] from [%s]", type, mac_address.c_str());
+        }
+        break;
+    }
+}
+
+void *MiracastDHCPServer::server_thread(void *ctx)
+{
+    MiracastDHCPServer *dhcp_server = static_cast<MiracastDHCPServer *>(ctx);
+    dhcp_server->server_loop();
+    return nullptr;
+}
+
+void MiracastDHCPServer::server_loop(void)
+{
+    DHCP_PACKET request;
+
+    MIRACASTLOG_TRACE("Entering...");
+    while (true)
+    {
+        struct pollfd poll_fds[2] = { { m_recv_fd, POLLIN, 0 }, { m_stop_fd, POLLIN, 0 } };
+        int ready = poll(poll_fds, 2, -1);
+
+        if (0 > ready)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            MIRACASTLOG_ERROR("DHCP server poll failed [%s]", strerror(errno));
+            break;
+        }
+        if (poll_fds[1].revents & POLLIN)
+        {
+            break;
+        }
+        if (0 == (poll_fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        memset(&request, 0, sizeof(request));
+        ssize_t len = recv(m_recv_fd, &request, sizeof(request), MSG_DONTWAIT);
+        if ((static_cast<ssize_t>(offsetof(DHCP_PACKET, options)) >= len) ||
+            (DHCP_BOOTREQUEST != request.op) ||
+            (DHCP_HW_ADDR_LEN != request.hlen))
+        {
+            continue;
+        }
+        handle_packet(request, static_cast<size_t>(len));
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
@@ -0,0 +1,123 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_DHCP_SERVER_H_
+#define _MIRACAST_DHCP_SERVER_H_
+
+#include <string>
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <pthread.h>
+#include <MiracastCommon.h>
+#include "MiracastDHCPCommon.h"
+
+#define DHCP_SERVER_ADDRESS         "192.168.59.1"
+#define DHCP_SERVER_PREFIX_LEN      (24)
+#define DHCP_SERVER_POOL_START      "192.168.59.50"
+#define DHCP_SERVER_POOL_END        "192.168.59.230"
+#define DHCP_SERVER_LEASE_TIME_S    (24 * 60 * 60)
+/* An offered address is held for the REQUEST that normally follows right away */
+#define DHCP_SERVER_OFFER_HOLD_S    (30)
+
+typedef struct dhcp_server_lease_st
+{
+    std::string ip_address;
+    std::string mac_address;
+}
+DHCP_SERVER_LEASE;
+
+/* DHCP server of the controller, L1 tests install their own through MiracastController */
+class MiracastDHCPServerInterface
+{
+public:
+    virtual ~MiracastDHCPServerInterface() {}
+
+    /* Anything but MIRACAST_OK makes the caller fall back to dnsmasq */
+    virtual MiracastError start(const std::string &interface,
+                                const std::string &reserved_mac = "",
+                                const std::string &reserved_ip = "") = 0;
+    virtual void stop(void) = 0;
+    virtual bool is_running(void) = 0;
+    virtual bool wait_for_lease(const std::string &mac_address, DHCP_SERVER_LEASE &lease, unsigned int timeout_ms) = 0;
+};
+
+/**
+ * DHCP server for the P2P group interface in GO role. The group address is
+ * configured over rtnetlink and a worker answers the single source from a
+ * small pool, binding its address on DISCOVER. Each acknowledged lease is
+ * handed to wait_for_lease() so the controller learns the source address
+ * without looking at the neighbour table.
+ */
+class MiracastDHCPServer : public MiracastDHCPServerInterface
+{
+public:
+    MiracastDHCPServer();
+    ~MiracastDHCPServer() override;
+
+    /* reserved_ip is handed to reserved_mac, typically the address of the previous session */
+    MiracastError start(const std::string &interface,
+                        const std::string &reserved_mac = "",
+                        const std::string &reserved_ip = "") override;
+    void stop(void) override;
+    bool is_running(void) override;
+    /* An empty mac_address accepts the first client */
+    bool wait_for_lease(const std::string &mac_address, DHCP_SERVER_LEASE &lease, unsigned int timeout_ms) override;
+
+private:
+    typedef struct dhcp_binding_st
+    {
+        uint32_t ip_address;
+        time_t expiry;
+        bool acknowledged;
+    }
+    DHCP_BINDING;
+
+    std::mutex m_server_mutex;
+    std::mutex m_lease_mutex;
+    std::condition_variable m_lease_cond;
+    std::string m_interface;
+    int m_ifindex;
+    uint32_t m_server_ip;
+    uint32_t m_subnet_mask;
+    uint32_t m_pool_start;
+    uint32_t m_pool_end;
+    std::string m_reserved_mac;
+    uint32_t m_reserved_ip;
+    /* Keyed by the client MAC address */
+    std::map<std::string, DHCP_BINDING> m_bindings;
+    std::set<uint32_t> m_declined;
+    bool m_running;
+    int m_recv_fd;
+    int m_send_fd;
+    int m_stop_fd;
+    pthread_t m_server_thread_id;
+
+    uint32_t allocate_address(const std::string &mac_address, uint32_t requested_ip);
+    bool is_address_free(uint32_t ip_address, const std::string &mac_address);
+    void handle_packet(const DHCP_PACKET &request, size_t request_len);
+    void send_reply(const DHCP_PACKET &request, DHCP_MESSAGE_TYPE type, uint32_t client_ip);
+    void close_sockets(void);
+
+    static void *server_thread(void *ctx);
+    void server_loop(void);
+};
+
+#endif /* _MIRACAST_DHCP_SERVER_H_ */
@@ -0,0 +1,238 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include "MiracastArpProber.h"
+
+typedef struct __attribute__((packed)) arp_ipv4_packet_st
+{
+    uint16_t hw_type;
+    uint16_t proto_type;
+    uint8_t hw_len;
+    uint8_t proto_len;
+    uint16_t opcode;
+    uint8_t sender_mac[ETH_ALEN];
+    uint8_t sender_ip[4];
+    uint8_t target_mac[ETH_ALEN];
+    uint8_t target_ip[4];
+}
+ARP_IPV4_PACKET;
+
+typedef std::chrono::steady_clock probe_clock;
+
+static bool get_interface_addresses(int sock_fd, const std::string &interface, uint8_t *mac, struct in_addr &ip_address)
+{
+    struct ifreq request;
+
+    memset(&request, 0, sizeof(request));
+    strncpy(request.ifr_name, interface.c_str(), sizeof(request.ifr_name) - 1);
+    if (0 != ioctl(sock_fd, SIOCGIFHWADDR, &request))
+    {
+        MIRACASTLOG_ERROR("SIOCGIFHWADDR on [%s] failed [%s]", interface.c_str(), strerror(errno));
+        return false;
+    }
+    memcpy(mac, request.ifr_hwaddr.sa_data, ETH_ALEN);
+
+    /* Without an address yet the request goes out as an ARP probe from 0.0.0.0 */
+    memset(&ip_address, 0, sizeof(ip_address));
+    memset(&request, 0, sizeof(request));
+    strncpy(request.ifr_name, interface.c_str(), sizeof(request.ifr_name) - 1);
+    request.ifr_addr.sa_family = AF_INET;
+    if (0 == ioctl(sock_fd, SIOCGIFADDR, &request))
+    {
+        ip_address = reinterpret_cast<struct sockaddr_in *>(&request.ifr_addr)->sin_addr;
+    }
+    return true;
+}
+
+static bool send_request(int sock_fd, int ifindex, const uint8_t *local_mac, const struct in_addr &local_ip, const struct in_addr &target_ip)
+{
+    ARP_IPV4_PACKET request;
+    struct sockaddr_ll destination;
+
+    memset(&request, 0, sizeof(request));
+    request.hw_type = htons(ARPHRD_ETHER);
+    request.proto_type = htons(ETH_P_IP);
+    request.hw_len = ETH_ALEN;
+    request.proto_len = sizeof(request.sender_ip);
+    request.opcode = htons(ARPOP_REQUEST);
+    memcpy(request.sender_mac, local_mac, ETH_ALEN);
+    memcpy(request.sender_ip, &local_ip, sizeof(request.sender_ip));
+    memcpy(request.target_ip, &target_ip, sizeof(request.target_ip));
+
+    memset(&destination, 0, sizeof(destination));
+    destination.sll_family = AF_PACKET;
+    destination.sll_protocol = htons(ETH_P_ARP);
+    destination.sll_ifindex = ifindex;
+    destination.sll_halen = ETH_ALEN;
+    memset(destination.sll_addr, 0xFF, ETH_ALEN);
+
+    if (0 > sendto(sock_fd, &request, sizeof(request), 0,
+                   reinterpret_cast<struct sockaddr *>(&destination), sizeof(destination)))
+    {
+        MIRACASTLOG_ERROR("ARP request send failed [%s]", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/* Returns true once the reply of target_ip has been read, false when the socket ran dry */
+static bool read_reply(int sock_fd, const struct in_addr &target_ip, std::string &mac_address)
+{
+    ARP_IPV4_PACKET reply;
+
+    while (true)
+    {
+        ssize_t len = recv(sock_fd, &reply, sizeof(reply), MSG_DONTWAIT);
+        if (0 > len)
+        {
+            return false;
+        }
+        if ((static_cast<ssize_t>(sizeof(reply)) > len) ||
+            (htons(ARPOP_REPLY) != reply.opcode) ||
+            (htons(ETH_P_IP) != reply.proto_type) ||
+            (0 != memcmp(reply.sender_ip, &target_ip, sizeof(reply.sender_ip))))
+        {
+            continue;
+        }
+
+        char mac[18] = {0};
+        snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
+                 reply.sender_mac[0], reply.sender_mac[1], reply.sender_mac[2],
+                 reply.sender_mac[3], reply.sender_mac[4], reply.sender_mac[5]);
+        mac_address = mac;
+        return true;
+    }
+}
+
+bool MiracastArpProber::probe(const std::string &interface,
+                              const std::string &target_ip,
+                              ARP_PROBE_RESULT &result,
+                              unsigned int attempts,
+                              unsigned int attempt_timeout_ms)
+{
+    struct sockaddr_ll local_addr;
+    struct in_addr local_ip,
+                   target_addr;
+    uint8_t local_mac[ETH_ALEN] = {0};
+    int ifindex = static_cast<int>(if_nametoindex(interface.c_str()));
+    int sock_fd = -1;
+
+    MIRACASTLOG_TRACE("Entering...");
+    result.reachable = false;
+    result.mac_address.clear();
+    result.rtt_us = 0;
+    result.attempts = 0;
+
+    if ((0 == ifindex) || (1 != inet_pton(AF_INET, target_ip.c_str(), &target_addr)))
+    {
+        MIRACASTLOG_ERROR("Invalid ARP probe target [%s] on [%s]", target_ip.c_str(), interface.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    sock_fd = socket(AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC, htons(ETH_P_ARP));
+    if (0 > sock_fd)
+    {
+        MIRACASTLOG_ERROR("AF_PACKET socket failed [%s]", strerror(errno));
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.sll_family = AF_PACKET;
+    local_addr.sll_protocol = htons(ETH_P_ARP);
+    local_addr.sll_ifindex = ifindex;
+    if ((0 != bind(sock_fd, reinterpret_cast<struct sockaddr *>(&local_addr), sizeof(local_addr))) ||
+        (!get_interface_addresses(sock_fd, interface, local_mac, local_ip)))
+    {
+        MIRACASTLOG_ERROR("Unable to prepare ARP probe on [%s] [%s]", interface.c_str(), strerror(errno));
+        close(sock_fd);
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    while ((!result.reachable) && (result.attempts < attempts))
+    {
+        probe_clock::time_point sent_at = probe_clock::now();
+        probe_clock::time_point deadline = sent_at + std::chrono::milliseconds(attempt_timeout_ms);
+
+        result.attempts++;
+        if (!send_request(sock_fd, ifindex, local_mac, local_ip, target_addr))
+        {
+            usleep(attempt_timeout_ms * 1000);
+            continue;
+        }
+
+        while (!result.reachable)
+        {
+            long long remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - probe_clock::now()).count();
+            if (0 >= remaining_ms)
+            {
+                break;
+            }
+
+            struct pollfd poll_fd = { sock_fd, POLLIN, 0 };
+            int ready = poll(&poll_fd, 1, static_cast<int>(remaining_ms));
+            if ((0 > ready) && (EINTR != errno))
+            {
+                MIRACASTLOG_ERROR("ARP probe poll failed [%s]", strerror(errno));
+                break;
+            }
+            if ((0 < ready) && read_reply(sock_fd, target_addr, result.mac_address))
+            {
+                result.reachable = true;
+                result.rtt_us = static_cast<unsigned int>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(probe_clock::now() - sent_at).count());
+            }
+        }
+    }
+    close(sock_fd);
+
+    if (result.reachable)
+    {
+        MIRACASTLOG_INFO("ARP reply from [%s - %s] on [%s] attempt[%u] rtt[%u us]",
+                         target_ip.c_str(),
+                         result.mac_address.c_str(),
+                         interface.c_str(),
+                         result.attempts,
+                         result.rtt_us);
+    }
+    else
+    {
+        MIRACASTLOG_ERROR("No ARP reply from [%s] on [%s] after %u attempts",
+                          target_ip.c_str(),
+                          interface.c_str(),
+                          result.attempts);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return result.reachable;
+}
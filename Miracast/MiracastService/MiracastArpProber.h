@@ -0,0 +1,69 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_ARP_PROBER_H_
+#define _MIRACAST_ARP_PROBER_H_
+
+#include <string>
+#include <stdint.h>
+#include <MiracastLogger.h>
+
+#define ARP_PROBE_DFLT_ATTEMPTS         (5)
+#define ARP_PROBE_DFLT_TIMEOUT_MS       (300)
+
+typedef struct arp_probe_result_st
+{
+    bool reachable;
+    std::string mac_address;
+    /* Request to reply time of the answered attempt */
+    unsigned int rtt_us;
+    unsigned int attempts;
+}
+ARP_PROBE_RESULT;
+
+/* Peer reachability check of the controller, L1 tests install their own through MiracastController */
+class MiracastArpProberInterface
+{
+public:
+    virtual ~MiracastArpProberInterface() {}
+
+    virtual bool probe(const std::string &interface,
+                       const std::string &target_ip,
+                       ARP_PROBE_RESULT &result,
+                       unsigned int attempts = ARP_PROBE_DFLT_ATTEMPTS,
+                       unsigned int attempt_timeout_ms = ARP_PROBE_DFLT_TIMEOUT_MS) = 0;
+};
+
+/**
+ * Sends ARP requests on an AF_PACKET socket bound to the interface and waits
+ * for the reply of the target, the same check arping performs but without a
+ * shell and a process per attempt. Each attempt waits attempt_timeout_ms,
+ * replies to an earlier attempt still count.
+ */
+class MiracastArpProber : public MiracastArpProberInterface
+{
+public:
+    bool probe(const std::string &interface,
+               const std::string &target_ip,
+               ARP_PROBE_RESULT &result,
+               unsigned int attempts = ARP_PROBE_DFLT_ATTEMPTS,
+               unsigned int attempt_timeout_ms = ARP_PROBE_DFLT_TIMEOUT_MS) override;
+};
+
+#endif /* _MIRACAST_ARP_PROBER_H_ */
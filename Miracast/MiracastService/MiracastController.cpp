@@ -17,11 +17,89 @@
  * limitations under the License.
  */
 
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <arpa/inet.h>
 #include "MiracastController.h"
 
 void ControllerThreadCallback(void *args);
+void P2PInitThreadCallback(void *args);
+void PeerProbeThreadCallback(void *args);
+void InterfaceEventCallback(void *ctx, const INTERFACE_EVENT &event);
+void DHCPLeaseLostCallback(void *ctx, const std::string &interface, const std::string &ip_address);
 
 MiracastController *MiracastController::m_miracast_ctrl_obj{nullptr};
+MiracastNeighborTableInterface *MiracastController::m_installed_neighbor_table{nullptr};
+MiracastArpProberInterface *MiracastController::m_installed_arp_prober{nullptr};
+MiracastDHCPClientInterface *MiracastController::m_installed_dhcp_client{nullptr};
+MiracastDHCPServerInterface *MiracastController::m_installed_dhcp_server{nullptr};
+
+#define SESSION_STATE(state)    CONTROLLER_SESSION_MASK(CONTROLLER_SESSION_##state)
+#define SESSION_ANY             CONTROLLER_SESSION_ANY_MASK
+
+const CONTROLLER_FSM_STATE MiracastController::m_session_states[CONTROLLER_SESSION_STATE_MAX] =
+{
+    /* name, restart_on_failure, group_alive */
+    { "IDLE",               false,  false },
+    { "LISTENING",          true,   false },
+    { "CONNECT_REQUESTED",  true,   false },
+    { "CONNECTING",         true,   false },
+    { "GROUP_FORMING",      true,   false },
+    { "CONNECTED",          false,  true  }
+};
+
+const CONTROLLER_FSM_TRANSITION MiracastController::m_session_transitions[] =
+{
+    /* event, from states, guard, handler, next state, fail state */
+    { CONTROLLER_GO_DEVICE_FOUND, SESSION_ANY, nullptr, &MiracastController::handle_DeviceEvent, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_DEVICE_PROVISION, SESSION_ANY, nullptr, &MiracastController::handle_DeviceEvent, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_DEVICE_LOST, SESSION_ANY, nullptr, &MiracastController::handle_DeviceEvent, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_NEG_REQUEST, SESSION_STATE(CONNECT_REQUESTED), &MiracastController::is_SourceUnassigned,
+        &MiracastController::handle_ConnectRequestInProgress, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_NEG_REQUEST, SESSION_STATE(IDLE) | SESSION_STATE(LISTENING) | SESSION_STATE(CONNECTING) | SESSION_STATE(GROUP_FORMING),
+        &MiracastController::is_SourceUnassigned, &MiracastController::handle_NewConnectRequest, CONTROLLER_SESSION_CONNECT_REQUESTED, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_NEG_REQUEST, SESSION_STATE(CONNECTED), &MiracastController::is_SourceUnassigned,
+        &MiracastController::handle_NewConnectRequest, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    /* A source is already assigned, report one more request at most */
+    { CONTROLLER_GO_NEG_REQUEST, SESSION_ANY, nullptr, &MiracastController::handle_AdditionalConnectRequest, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_GROUP_STARTED, SESSION_STATE(CONNECT_REQUESTED), nullptr, &MiracastController::handle_GroupStarted, CONTROLLER_SESSION_CONNECTED, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_GROUP_STARTED, SESSION_ANY, nullptr, &MiracastController::handle_GroupStarted, CONTROLLER_SESSION_CONNECTED, CONTROLLER_SESSION_IDLE },
+    /* The connect request stays reported until it is accepted, rejected or timed out */
+    { CONTROLLER_GO_NEG_FAILURE, SESSION_STATE(CONNECT_REQUESTED), nullptr, &MiracastController::handle_GroupFailure, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_NEG_FAILURE, SESSION_ANY, nullptr, &MiracastController::handle_GroupFailure, CONTROLLER_SESSION_IDLE, CONTROLLER_SESSION_IDLE },
+    { CONTROLLER_GO_GROUP_FORMATION_FAILURE, SESSION_STATE(CONNECT_REQUESTED), nullptr, &MiracastController::handle_GroupFailure, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_GROUP_FORMATION_FAILURE, SESSION_ANY, nullptr, &MiracastController::handle_GroupFailure, CONTROLLER_SESSION_IDLE, CONTROLLER_SESSION_IDLE },
+    { CONTROLLER_GO_GROUP_REMOVED, SESSION_ANY, nullptr, &MiracastController::handle_GroupRemoved, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+    /* The P2P group interface went down or lost its address without a P2P-GROUP-REMOVED */
+    { CONTROLLER_GROUP_INTERFACE_LOST, SESSION_ANY, &MiracastController::is_GroupInterfaceEvent,
+        &MiracastController::handle_GroupInterfaceLost, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+    { CONTROLLER_GROUP_INTERFACE_LOST, SESSION_ANY, nullptr, nullptr, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_STOP_FIND, SESSION_ANY, nullptr, &MiracastController::handle_StopFind, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_NEG_SUCCESS, SESSION_STATE(IDLE) | SESSION_STATE(LISTENING) | SESSION_STATE(CONNECTING),
+        nullptr, &MiracastController::handle_NegSuccess, CONTROLLER_SESSION_GROUP_FORMING, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_NEG_SUCCESS, SESSION_ANY, nullptr, &MiracastController::handle_NegSuccess, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_GROUP_FORMATION_SUCCESS, SESSION_ANY, nullptr, &MiracastController::handle_FormationSuccess, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_EVENT_ERROR, SESSION_ANY, nullptr, &MiracastController::handle_EventError, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_GO_UNKNOWN_EVENT, SESSION_ANY, nullptr, &MiracastController::handle_EventError, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_START_DISCOVERING, SESSION_ANY, nullptr, &MiracastController::handle_DiscoveryAction, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+    { CONTROLLER_STOP_DISCOVERING, SESSION_ANY, nullptr, &MiracastController::handle_DiscoveryAction, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+    { CONTROLLER_RESTART_DISCOVERING, SESSION_ANY, nullptr, &MiracastController::handle_DiscoveryAction, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+    { CONTROLLER_P2P_READY, SESSION_ANY, nullptr, &MiracastController::handle_P2PReadyAction, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    /* Requests made while a group is up are cached until it is removed */
+    { CONTROLLER_CONNECT_REQ_FROM_THUNDER, SESSION_STATE(CONNECTED), nullptr, &MiracastController::handle_CacheConnectRequest, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_CONNECT_REQ_FROM_THUNDER, SESSION_ANY, nullptr, &MiracastController::handle_ConnectRequest, CONTROLLER_SESSION_CONNECTING, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_CONNECT_CACHED_SOURCE, SESSION_STATE(CONNECTED), nullptr, &MiracastController::handle_KeepCachedSource, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_CONNECT_CACHED_SOURCE, SESSION_ANY, nullptr, &MiracastController::handle_ConnectCachedSource, CONTROLLER_SESSION_CONNECTING, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_FLUSH_CURRENT_SESSION, SESSION_ANY, nullptr, &MiracastController::handle_FlushSession, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_CONNECT_REQ_REJECT, SESSION_STATE(CONNECT_REQUESTED), nullptr, &MiracastController::handle_ConnectRequestClosed, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+    { CONTROLLER_CONNECT_REQ_REJECT, SESSION_ANY, nullptr, &MiracastController::handle_ConnectRequestClosed, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_CONNECT_REQ_TIMEOUT, SESSION_STATE(CONNECT_REQUESTED), nullptr, &MiracastController::handle_ConnectRequestClosed, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+    { CONTROLLER_CONNECT_REQ_TIMEOUT, SESSION_ANY, nullptr, &MiracastController::handle_ConnectRequestClosed, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+    { CONTROLLER_SWITCH_LAUNCH_REQ_CTX, SESSION_ANY, nullptr, &MiracastController::handle_SwitchLaunchRequest, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME }
+};
+
+#undef SESSION_STATE
+#undef SESSION_ANY
 
 MiracastController *MiracastController::getInstance(MiracastError &error_code, MiracastServiceNotifier *notifier, std::string p2p_ctrl_iface)
 {
@@ -57,29 +135,58 @@ void MiracastController::destroyInstance()
 }
 
 MiracastController::MiracastController(void)
+    : m_session_fsm(m_session_states,
+                    m_session_transitions,
+                    sizeof(m_session_transitions) / sizeof(m_session_transitions[0]))
 {
     MIRACASTLOG_TRACE("Entering...");
 
     m_notify_handler = nullptr;
     m_groupInfo = nullptr;
     m_p2p_ctrl_obj = nullptr;
+    m_p2p_ready_obj = nullptr;
+    m_p2p_init_thread_id = 0;
+    m_p2p_init_cancel_fd = -1;
+    m_peer_probe_thread_id = 0;
+    m_peer_probe_alive = false;
     m_controller_thread = nullptr;
     m_tcpserverSockfd = -1;
     m_connectionStatus = false;
+    m_neighbor_table = (nullptr != m_installed_neighbor_table) ? m_installed_neighbor_table : &m_builtin_neighbor_table;
+    m_arp_prober = (nullptr != m_installed_arp_prober) ? m_installed_arp_prober : &m_builtin_arp_prober;
+    m_dhcp_client = (nullptr != m_installed_dhcp_client) ? m_installed_dhcp_client : &m_builtin_dhcp_client;
+    m_dhcp_client->set_lease_lost_handler(&DHCPLeaseLostCallback, this);
+    m_dhcp_server = (nullptr != m_installed_dhcp_server) ? m_installed_dhcp_server : &m_builtin_dhcp_server;
     setP2PBackendDiscovery(false);
 
     MIRACASTLOG_TRACE("Exiting...");
 }
 
+void MiracastController::set_NeighborTable(MiracastNeighborTableInterface *neighbor_table)
+{
+    m_installed_neighbor_table = neighbor_table;
+}
+
+void MiracastController::set_ArpProber(MiracastArpProberInterface *arp_prober)
+{
+    m_installed_arp_prober = arp_prober;
+}
+
+void MiracastController::set_DHCPClient(MiracastDHCPClientInterface *dhcp_client)
+{
+    m_installed_dhcp_client = dhcp_client;
+}
+
+void MiracastController::set_DHCPServer(MiracastDHCPServerInterface *dhcp_server)
+{
+    m_installed_dhcp_server = dhcp_server;
+}
+
 MiracastController::~MiracastController()
 {
     MIRACASTLOG_TRACE("Entering...");
 
-    while (!m_deviceInfoList.empty())
-    {
-        delete m_deviceInfoList.back();
-        m_deviceInfoList.pop_back();
-    }
+    m_peer_cache.clear();
 
     if (nullptr != m_groupInfo)
     {
@@ -95,6 +202,12 @@ MiracastError MiracastController::create_ControllerFramework(std::string p2p_ctr
     MiracastError ret_code = MIRACAST_OK;
     MIRACASTLOG_TRACE("Entering...");
 
+    /* Lookups fall back to the kernel when this fails, so it is not fatal */
+    if (!m_interface_table.start(&InterfaceEventCallback, this))
+    {
+        MIRACASTLOG_WARNING("Interface table unavailable, interface lookups go to the kernel");
+    }
+
     m_controller_thread = new MiracastThread(CONTROLLER_THREAD_NAME,
                                              CONTROLLER_THREAD_STACK,
                                              CONTROLLER_MSGQ_COUNT,
@@ -106,8 +219,34 @@ MiracastError MiracastController::create_ControllerFramework(std::string p2p_ctr
     {
         ret_code = MIRACAST_CONTROLLER_INIT_FAILED;
     }
-    else{
-        m_p2p_ctrl_obj = MiracastP2P::getInstance(ret_code,std::move(p2p_ctrl_iface));
+    else if ((0 == access(WPA_SUP_DFLT_CTRL_PATH, F_OK)) &&
+             (0 != access((std::string(WPA_SUP_DFLT_CTRL_PATH) + p2p_ctrl_iface).c_str(), F_OK)))
+    {
+        /* wpa_supplicant is running without this interface, the configured interface is wrong */
+        MIRACASTLOG_ERROR("Unable to find P2P ctrl iface path[%s%s]", WPA_SUP_DFLT_CTRL_PATH, p2p_ctrl_iface.c_str());
+        ret_code = MIRACAST_INVALID_P2P_CTRL_IFACE;
+    }
+    else
+    {
+        /*
+         * Waiting for wpa_supplicant, opening the control interface with its
+         * retries and starting the monitor all run on the init thread, so
+         * activation never waits on them. Readiness or failure is reported
+         * through the controller thread, see on_P2PReady().
+         */
+        m_p2p_ctrl_iface = std::move(p2p_ctrl_iface);
+        m_p2p_init_cancel_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if ((0 > m_p2p_init_cancel_fd) ||
+            (0 != pthread_create(&m_p2p_init_thread_id, nullptr, reinterpret_cast<void *(*)(void *)>(&P2PInitThreadCallback), this)))
+        {
+            MIRACASTLOG_ERROR("Unable to start P2P init thread");
+            m_p2p_init_thread_id = 0;
+            ret_code = MIRACAST_CONTROLLER_INIT_FAILED;
+        }
+        else
+        {
+            MIRACASTLOG_INFO("Bringing P2P up in the background");
+        }
     }
     if ( MIRACAST_OK != ret_code ){
         destroy_ControllerFramework();
@@ -125,159 +264,187 @@ MiracastError MiracastController::destroy_ControllerFramework(void)
     controller_msgq_data.state = CONTROLLER_SELF_ABORT;
     send_thundermsg_to_controller_thread(controller_msgq_data);
 
-    if (nullptr != m_p2p_ctrl_obj)
+    if (0 != m_p2p_init_thread_id)
+    {
+        uint64_t cancel = 1;
+        if (sizeof(cancel) != write(m_p2p_init_cancel_fd, &cancel, sizeof(cancel)))
+        {
+            MIRACASTLOG_ERROR("Failed to cancel P2P init thread [%s]", strerror(errno));
+        }
+        pthread_join(m_p2p_init_thread_id, nullptr);
+        m_p2p_init_thread_id = 0;
+    }
+    if (0 <= m_p2p_init_cancel_fd)
+    {
+        close(m_p2p_init_cancel_fd);
+        m_p2p_init_cancel_fd = -1;
+    }
+
     {
+        /* The background init may have created the instance without the controller thread picking it up */
+        std::lock_guard<std::mutex> lock(m_p2p_ctrl_mutex);
         MiracastP2P::destroyInstance();
         m_p2p_ctrl_obj = nullptr;
+        m_p2p_ready_obj = nullptr;
     }
     if (nullptr != m_controller_thread){
         delete m_controller_thread;
         m_controller_thread = nullptr;
     }
+    m_interface_table.stop();
     MIRACASTLOG_TRACE("Exiting...");
     return MIRACAST_OK;
 }
 
-std::string MiracastController::parse_p2p_event_data(const char *tmpBuff, const char *lookup_data)
+std::string MiracastController::getifNameByIPv4(std::string ip_address)
 {
-    char return_buf[1024] = {0};
-    const char  *ret = nullptr, 
-                *ret_equal = nullptr,
-                *ret_space = nullptr,
-                *quote_start = nullptr,
-                *quote_end = nullptr;
-    ret = strstr(tmpBuff, lookup_data);
-
-    if (nullptr != ret)
-    {
-        if (0 == strncmp(ret, lookup_data, strlen(lookup_data)))
-        {
-            ret_equal = strstr(ret, "=");
-            if (!ret_equal)
-            {
-                MIRACASTLOG_ERROR("Failed to find '=' in parsed data");
-                return "";
-            }
-            
-            ret_space = strstr(ret_equal, " ");
-
-            if (0 == strncmp("name", lookup_data, strlen(lookup_data)))
-            {
-                quote_start = strstr(ret_equal, "'");
-                if (quote_start) {
-                    quote_end = strstr(quote_start + 1, "'");
-                }
-            }
+    return m_interface_table.find_interface_by_ipv4(ip_address);
+}
 
-            if (0 == strncmp("ssid", lookup_data, strlen(lookup_data)))
-            {
-                quote_start = strstr(ret_equal, "\"");
-                if (quote_start) {
-                    quote_end = strstr(quote_start + 1, "\"");
-                }
-            }
+std::string MiracastController::get_STAInterface(uint32_t &change_count)
+{
+    return m_interface_table.find_wireless_station(change_count);
+}
 
-            if (quote_start && quote_end) {
-                unsigned int length = quote_end - quote_start;
-                if (length < sizeof(return_buf)) {
-                   snprintf(return_buf, length, "%s", quote_start + 1);
-                }
-            }
-            else if (ret_space)
-            {
-                snprintf(return_buf, (int)(ret_space - ret_equal), "%s", ret + strlen(lookup_data) + 1);
-                MIRACASTLOG_VERBOSE("Parsed Data is - %s", return_buf);
-            }
-            else
-            {
-                snprintf(return_buf, strlen(ret_equal - 1), "%s", ret + strlen(lookup_data) + 1);
-                MIRACASTLOG_VERBOSE("Parsed Data is - %s", return_buf);
-            }
-        }
-    }
-    return std::string(return_buf);
+void InterfaceEventCallback(void *ctx, const INTERFACE_EVENT &event)
+{
+    MiracastController *miracast_ctrler_obj = (MiracastController *)ctx;
+    miracast_ctrler_obj->on_InterfaceEvent(event);
 }
 
-std::string MiracastController::getifNameByIPv4(std::string ip_address)
+void MiracastController::on_InterfaceEvent(const INTERFACE_EVENT &event)
 {
-    struct ifaddrs *ifaddrList = nullptr, *currentifa = nullptr;
-    int family, s;
-    char host[MAX_IFACE_NAME_LEN];
-    std::string ifaceName = "";
+    CONTROLLER_MSGQ_STRUCT controller_msgq_data = {0};
 
-    // Get list of all network interfaces
-    if ( -1 == getifaddrs(&ifaddrList))
+    switch (event.type)
     {
-        MIRACASTLOG_ERROR("getifaddrs failed[%s]",strerror(errno));
+    case INTERFACE_EVENT_LINK_UP:
+    {
+        MIRACASTLOG_INFO("Link [%s] index [%d] is up", event.interface.c_str(), event.ifindex);
     }
-    else
+    break;
+    case INTERFACE_EVENT_LINK_DOWN:
     {
-        // Iterate through the list of network interfaces
-        for ( currentifa = ifaddrList; nullptr != currentifa; currentifa = currentifa->ifa_next)
-        {
-            if ( nullptr == currentifa->ifa_addr )
-            {
-                continue;
-            }
-            family = currentifa->ifa_addr->sa_family;
-            // Check for IPv4 address
-            if ( AF_INET == family )
-            {
-                s = getnameinfo(currentifa->ifa_addr, sizeof(struct sockaddr_in), host, MAX_IFACE_NAME_LEN, NULL, 0, NI_NUMERICHOST);
-                if (s != 0)
-                {
-                    MIRACASTLOG_ERROR("getnameinfo failed[%s]",strerror(errno));
-                    break;
-                }
-                // Compare IP address with the given IP
-                if ( 0 == strcmp(host, ip_address.c_str()))
-                {
-                    ifaceName = currentifa->ifa_name;
-                }
-            }
-        }
-        if ( nullptr != ifaddrList )
-        {
-            freeifaddrs(ifaddrList);
-            ifaddrList = nullptr;
-        }
+        MIRACASTLOG_INFO("Link [%s] index [%d] is down", event.interface.c_str(), event.ifindex);
+        controller_msgq_data.state = CONTROLLER_GROUP_INTERFACE_LOST;
+    }
+    break;
+    case INTERFACE_EVENT_ADDRESS_ASSIGNED:
+    {
+        MIRACASTLOG_INFO("Address [%s] assigned on [%s]", event.ip_address.c_str(), event.interface.c_str());
+    }
+    break;
+    case INTERFACE_EVENT_ADDRESS_REMOVED:
+    {
+        MIRACASTLOG_INFO("Address [%s] removed from [%s]", event.ip_address.c_str(), event.interface.c_str());
+        controller_msgq_data.state = CONTROLLER_GROUP_INTERFACE_LOST;
+        strncpy(controller_msgq_data.sink_dev_ip, event.ip_address.c_str(), sizeof(controller_msgq_data.sink_dev_ip) - 1);
+    }
+    break;
+    default:
+    break;
+    }
+
+    /* Runs on the interface table thread, m_groupInfo is only compared on the controller thread */
+    if ((CONTROLLER_GROUP_INTERFACE_LOST == controller_msgq_data.state) && !event.interface.empty())
+    {
+        strncpy(controller_msgq_data.source_dev_name, event.interface.c_str(), sizeof(controller_msgq_data.source_dev_name) - 1);
+        send_thundermsg_to_controller_thread(controller_msgq_data);
     }
-    return ifaceName;
 }
 
-std::string MiracastController::start_DHCPClient(std::string interface, std::string &default_gw_ip_addr)
+void DHCPLeaseLostCallback(void *ctx, const std::string &interface, const std::string &ip_address)
+{
+    MiracastController *miracast_ctrler_obj = (MiracastController *)ctx;
+    miracast_ctrler_obj->on_DHCPLeaseLost(interface, ip_address);
+}
+
+void MiracastController::on_DHCPLeaseLost(const std::string &interface, const std::string &ip_address)
+{
+    CONTROLLER_MSGQ_STRUCT controller_msgq_data = {0};
+
+    /* Runs on the DHCP renew thread, the address is already flushed from the interface */
+    MIRACASTLOG_ERROR("DHCP lease of [%s] lost on [%s]", ip_address.c_str(), interface.c_str());
+    controller_msgq_data.state = CONTROLLER_GROUP_INTERFACE_LOST;
+    strncpy(controller_msgq_data.source_dev_name, interface.c_str(), sizeof(controller_msgq_data.source_dev_name) - 1);
+    strncpy(controller_msgq_data.sink_dev_ip, ip_address.c_str(), sizeof(controller_msgq_data.sink_dev_ip) - 1);
+    send_thundermsg_to_controller_thread(controller_msgq_data);
+}
+
+std::string MiracastController::start_DHCPClient(std::string interface, std::string &default_gw_ip_addr, std::string requested_ip)
 {
     MIRACASTLOG_TRACE("Entering...");
     char data[1024] = {0};
     char command[128] = {0};
-    char sys_cls_file_ifidx[128] = {0};
     std::string local_addr = "",
                 gw_ip_addr = "",
                 popen_buffer = "",
                 system_cmd_buffer = "";
-    std::smatch match;
-    std::regex localipRegex(R"(lease\s+of\s+(\d+\.\d+\.\d+\.\d+)\s+obtained)");
-    std::regex goipRegex1(R"(default\s+gw\s+(\d+\.\d+\.\d+\.\d+)\s+dev)");
-    std::regex goipRegex2(R"(Adding\s+DNS\s+(\d+\.\d+\.\d+\.\d+))", std::regex_constants::icase);
     FILE *popen_file_ptr = nullptr;
     char *current_line_buffer = nullptr;
     std::size_t len = 0;
     unsigned char retry_count = 5;
 
-    sprintf( sys_cls_file_ifidx , "/sys/class/net/%s/ifindex" , interface.c_str());
+    /* The group interface can still be coming up when the group start is reported */
+    if (!m_interface_table.wait_for_link_up(interface, GROUP_LINK_WAIT_TIMEOUT_MS))
+    {
+        MIRACASTLOG_ERROR("Group interface [%s] is not up", interface.c_str());
+        return std::string("");
+    }
 
-    std::ifstream ifIndexFile(sys_cls_file_ifidx);
+    DHCP_LEASE lease;
+    MiracastError dhcp_status = m_dhcp_client->start(interface, requested_ip, lease);
 
-    if (!ifIndexFile.good()) {
-        MIRACASTLOG_ERROR("Could not find [%s]\n",sys_cls_file_ifidx);
+    if (MIRACAST_OK == dhcp_status)
+    {
+        /* Router first, then DNS and the server itself, the GO is usually all three */
+        if (!lease.router.empty())
+        {
+            default_gw_ip_addr = lease.router;
+        }
+        else if (!lease.dns_servers.empty())
+        {
+            default_gw_ip_addr = lease.dns_servers.front();
+        }
+        else
+        {
+            default_gw_ip_addr = lease.server_id;
+        }
+        MIRACASTLOG_INFO("local IP addr obtained is %s, GO IP addr obtained is %s\n", lease.ip_address.c_str(), default_gw_ip_addr.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return lease.ip_address;
+    }
+    if (MIRACAST_INVALID_CONFIGURATION != dhcp_status)
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return std::string("");
+    }
+    MIRACASTLOG_WARNING("Built-in DHCP client unavailable on [%s], falling back to udhcpc", interface.c_str());
+
+    struct in_addr requested_addr;
+    bool request_previous_ip = (!requested_ip.empty() &&
+                                (1 == inet_pton(AF_INET, requested_ip.c_str(), &requested_addr)));
+    int command_len = 0;
+
+    /* Ask for the address used in the previous session with this source */
+    command_len = snprintf(command, sizeof(command), "/sbin/udhcpc -v -i %s -s /etc/wifi_p2p/udhcpc.script%s%s 2>&1",
+                            interface.c_str(),
+                            request_previous_ip ? " -r " : "",
+                            request_previous_ip ? requested_ip.c_str() : "");
+    if ((0 > command_len) || (sizeof(command) <= (size_t)command_len))
+    {
+        MIRACASTLOG_ERROR("udhcpc command for [%s] does not fit", interface.c_str());
         return std::string("");
     }
-
-    sprintf(command, "/sbin/udhcpc -v -i ");
-    sprintf(command + strlen(command), "%s" , interface.c_str());
-    sprintf(command + strlen(command), " -s /etc/wifi_p2p/udhcpc.script 2>&1");
     MIRACASTLOG_VERBOSE("command : [%s]", command);
 
+    /* Only the udhcpc fallback parses text, the built-in client never pays for the regex compile */
+    std::smatch match;
+    std::regex localipRegex(R"(lease\s+of\s+(\d+\.\d+\.\d+\.\d+)\s+obtained)");
+    std::regex goipRegex1(R"(default\s+gw\s+(\d+\.\d+\.\d+\.\d+)\s+dev)");
+    std::regex goipRegex2(R"(Adding\s+DNS\s+(\d+\.\d+\.\d+\.\d+))", std::regex_constants::icase);
+
+    m_udhcpc_started = true;
     while ( retry_count-- )
     {
         popen_file_ptr = popen(command, "r");
@@ -331,11 +498,18 @@ std::string MiracastController::start_DHCPClient(std::string interface, std::str
     return local_addr;
 }
 
-std::string MiracastController::start_DHCPServer(std::string interface)
+std::string MiracastController::start_DHCPServer(std::string interface, std::string peer_iface_mac, std::string reserved_ip)
 {
     MIRACASTLOG_TRACE("Entering...");
     std::string command = "";
 
+    if (MIRACAST_OK == m_dhcp_server->start(interface, peer_iface_mac, reserved_ip))
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return DHCP_SERVER_ADDRESS;
+    }
+    MIRACASTLOG_WARNING("Built-in DHCP server unavailable on [%s], falling back to dnsmasq", interface.c_str());
+
     command = "ifconfig ";
     command.append(interface.c_str());
     command.append(" 192.168.59.1 netmask 255.255.255.0 up");
@@ -345,6 +519,17 @@ std::string MiracastController::start_DHCPServer(std::string interface)
     command = "/usr/bin/dnsmasq -p0 -i ";
     command.append(interface.c_str());
     command.append(" -F 192.168.59.50,192.168.59.230,255.255.255.0,24h --log-queries=extra");
+    struct in_addr reserved_addr;
+    if (!peer_iface_mac.empty() && !reserved_ip.empty() &&
+        (1 == inet_pton(AF_INET, reserved_ip.c_str(), &reserved_addr)) &&
+        (std::string::npos == peer_iface_mac.find_first_not_of("0123456789abcdefABCDEF:")))
+    {
+        /* Hand a returning source the address it had in the previous session */
+        command.append(" --dhcp-host=");
+        command.append(peer_iface_mac);
+        command.append(",");
+        command.append(reserved_ip);
+    }
     MIRACASTLOG_INFO("command : [%s]", command.c_str());
     MiracastCommon::execute_SystemCommand(command.c_str());
 
@@ -473,11 +658,18 @@ void MiracastController::remove_P2PGroupInstance(void)
         }
         if ( true == m_groupInfo->isGO )
         {
-            strncpy( commandBuffer , "ps -ax | awk '/dnsmasq -p0 -i/ && !/grep/ {print $1}' | xargs kill -9" , sizeof(commandBuffer));
-            commandBuffer[sizeof(commandBuffer) - 1] = '\0';
-            MIRACASTLOG_INFO("Terminate old dnsmasq instance: [%s]",commandBuffer);
-            MiracastCommon::execute_SystemCommand(commandBuffer);
-            memset( commandBuffer , 0x00 , sizeof(commandBuffer));
+            if (m_dhcp_server->is_running())
+            {
+                m_dhcp_server->stop();
+            }
+            else
+            {
+                strncpy( commandBuffer , "ps -ax | awk '/dnsmasq -p0 -i/ && !/grep/ {print $1}' | xargs kill -9" , sizeof(commandBuffer));
+                commandBuffer[sizeof(commandBuffer) - 1] = '\0';
+                MIRACASTLOG_INFO("Terminate old dnsmasq instance: [%s]",commandBuffer);
+                MiracastCommon::execute_SystemCommand(commandBuffer);
+                memset( commandBuffer , 0x00 , sizeof(commandBuffer));
+            }
             if (!m_groupInfo->srcDevIPAddr.empty())
             {
                 remove_ARPEntry(m_groupInfo->srcDevIPAddr);
@@ -485,10 +677,15 @@ void MiracastController::remove_P2PGroupInstance(void)
         }
         else
         {
-            strncpy( commandBuffer , "ps -ax | awk '/p2p_udhcpc/ && !/grep/ {print $1}' | xargs kill -9" , sizeof(commandBuffer));
-            commandBuffer[sizeof(commandBuffer) - 1] = '\0';
-            MIRACASTLOG_INFO("Terminate old udhcpc p2p instance : [%s]", commandBuffer);
-            MiracastCommon::execute_SystemCommand(commandBuffer);
+            m_dhcp_client->stop();
+            if (m_udhcpc_started)
+            {
+                strncpy( commandBuffer , "ps -ax | awk '/p2p_udhcpc/ && !/grep/ {print $1}' | xargs kill -9" , sizeof(commandBuffer));
+                commandBuffer[sizeof(commandBuffer) - 1] = '\0';
+                MIRACASTLOG_INFO("Terminate old udhcpc p2p instance : [%s]", commandBuffer);
+                MiracastCommon::execute_SystemCommand(commandBuffer);
+                m_udhcpc_started = false;
+            }
         }
         delete m_groupInfo;
         m_groupInfo = nullptr;
@@ -511,18 +708,16 @@ void MiracastController::checkAndInitiateP2PBackendDiscovery(void)
     }
 }
 
-void MiracastController::event_handler(P2P_EVENTS eventId, void *data, size_t len )
+/* Takes over the caller's reference of event_buffer */
+void MiracastController::event_handler(P2P_EVENTS eventId, MIRACAST_EVENT_BUFFER *event_buffer)
 {
     CONTROLLER_MSGQ_STRUCT controller_msgq_data = {0};
-    std::string event_buffer;
     MIRACASTLOG_TRACE("Entering...");
 
-    event_buffer = (char *)data;
-    free(data);
-
     if ( false == m_start_discovering_enabled )
     {
         MIRACASTLOG_INFO("Miracast discovery not enabled. So no need to notify to MiracastController");
+        MiracastEventBufferPool::getInstance()->release(event_buffer);
         MIRACASTLOG_TRACE("Exiting...");
         return;
     }
@@ -530,12 +725,15 @@ void MiracastController::event_handler(P2P_EVENTS eventId, void *data, size_t le
     if (nullptr != m_controller_thread){
         controller_msgq_data.msg_type = P2P_MSG;
         controller_msgq_data.state = convertP2PtoSessionActions(eventId);
-        strncpy(controller_msgq_data.msg_buffer, event_buffer.c_str(), sizeof(controller_msgq_data.msg_buffer));
-        controller_msgq_data.msg_buffer[sizeof(controller_msgq_data.msg_buffer) - 1] = '\0';
+        controller_msgq_data.event_buffer = event_buffer;
 
-        MIRACASTLOG_INFO("event_handler to Controller Action[%#08X] buffer:%s  ", controller_msgq_data.state, event_buffer.c_str());
+        MIRACASTLOG_INFO("event_handler to Controller Action[%#08X] buffer:%s  ", controller_msgq_data.state, event_buffer->data);
         m_controller_thread->send_message(&controller_msgq_data, sizeof(controller_msgq_data));
-        MIRACASTLOG_VERBOSE("event received : %d buffer:%s  ", eventId, event_buffer.c_str());
+        MIRACASTLOG_VERBOSE("event received : %d buffer:%s  ", eventId, event_buffer->data);
+    }
+    else
+    {
+        MiracastEventBufferPool::getInstance()->release(event_buffer);
     }
     MIRACASTLOG_TRACE("Exiting...");
 }
@@ -547,8 +745,11 @@ MiracastError MiracastController::set_WFDParameters(void)
     if (nullptr != m_p2p_ctrl_obj)
     {
         std::string ifName = getifNameByIPv4("192.168.59.1");
+        uint32_t sta_change_count = 0;
+        std::string sta_iface_name = get_STAInterface(sta_change_count);
+
         m_p2p_ctrl_obj->remove_GroupInterface(ifName);
-        ret = m_p2p_ctrl_obj->set_WFDParameters();
+        ret = m_p2p_ctrl_obj->set_WFDParameters(sta_iface_name, sta_change_count);
     }
     MIRACASTLOG_TRACE("Exiting...");
     return ret;
@@ -559,6 +760,7 @@ MiracastError MiracastController::discover_devices(bool isNotificationRequired)
     MIRACASTLOG_TRACE("Entering...");
     MiracastError ret = MIRACAST_FAIL;
     if (nullptr != m_p2p_ctrl_obj){
+        MiracastSessionTracer::getInstance()->span_begin(MIRACAST_SPAN_P2P_FIND);
         ret = m_p2p_ctrl_obj->discover_devices();
         if ((nullptr != m_notify_handler) && (isNotificationRequired))
         {
@@ -589,11 +791,34 @@ MiracastError MiracastController::connect_device(std::string device_mac , std::s
     MIRACASTLOG_TRACE("Entering...");
     MIRACASTLOG_INFO("Connecting to the MAC - %s", device_mac.c_str());
     MiracastError ret = MIRACAST_FAIL;
-    DeviceInfo *device_info_ptr = MiracastController::get_device_details(device_mac);
+    DeviceInfo device_info;
+    KNOWN_SOURCE known_source;
+    int persistent_network_id = P2P_PERSISTENT_NETWORK_NONE;
 
-    if ((nullptr != m_p2p_ctrl_obj) && ( nullptr != device_info_ptr ))
+    if ((nullptr != m_p2p_ctrl_obj) && ( get_device_details(device_mac, device_info) ))
     {
-        ret = m_p2p_ctrl_obj->connect_device(device_mac,device_info_ptr->authType);
+        m_reinvoked_source_mac.clear();
+        if (m_source_store.find(device_mac, known_source) && (P2P_PERSISTENT_NETWORK_NONE != known_source.persistent_network_id))
+        {
+            persistent_network_id = known_source.persistent_network_id;
+            m_reinvoked_source_mac = device_mac;
+            MIRACASTLOG_INFO("#### Known source[%s] reinvoking persistent group[%d] ####",
+                                device_mac.c_str(),
+                                persistent_network_id);
+        }
+        else if (MiracastOptFlags::getInstance()->is_present(MIRACAST_OPT_PERSISTENT_GROUP))
+        {
+            /* Keeps the credentials for the next connection, at the cost of a saved network per source */
+            persistent_network_id = P2P_PERSISTENT_NETWORK_NEW;
+        }
+        MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+        session_tracer->begin_session(device_mac);
+        session_tracer->span_end(MIRACAST_SPAN_USER_ACCEPT);
+        session_tracer->span_begin(MIRACAST_SPAN_GO_NEGOTIATION);
+        uint32_t sta_change_count = 0;
+        std::string sta_iface_name = get_STAInterface(sta_change_count);
+        ret = m_p2p_ctrl_obj->connect_device(device_mac,device_info.authType,persistent_network_id,sta_iface_name,sta_change_count);
+        session_tracer->set_sta_frequency(m_p2p_ctrl_obj->get_STAFrequency());
         if (MIRACAST_OK == ret )
         {
             set_WFDSourceMACAddress(device_mac);
@@ -643,9 +868,9 @@ std::string MiracastController::get_connected_device_mac()
     return mac_address;
 }
 
-std::vector<DeviceInfo *> MiracastController::get_allPeers()
+std::vector<DeviceInfo> MiracastController::get_allPeers()
 {
-    return m_deviceInfoList;
+    return m_peer_cache.snapshot();
 }
 
 bool MiracastController::get_connection_status()
@@ -655,74 +880,24 @@ bool MiracastController::get_connection_status()
 
 void MiracastController::create_DeviceCacheData(std::string deviceMAC,std::string authType,std::string modelName,std::string deviceType, bool force_overwrite)
 {
-    bool new_device_entry = false;
     MIRACASTLOG_TRACE("Entering...");
-    DeviceInfo *cur_device_info_ptr = MiracastController::get_device_details(deviceMAC);
-
-    // Allocate memory and update the device cache info
-    if ( nullptr == cur_device_info_ptr )
-    {
-        cur_device_info_ptr = new DeviceInfo;
-        new_device_entry = true;
-        force_overwrite = true;
-        MIRACASTLOG_VERBOSE("#### Creating Device Cache ####");
-    }
-
-    if (( nullptr != cur_device_info_ptr ) && (force_overwrite))
-    {
-        cur_device_info_ptr->deviceMAC = std::move(deviceMAC);
-        cur_device_info_ptr->authType = std::move(authType);
-        cur_device_info_ptr->modelName = std::move(modelName);
-        cur_device_info_ptr->deviceType = std::move(deviceType);
-        MIRACASTLOG_INFO("#### Device Cache Name[%s]Mac[%s]Authtype[%s]Type[%s] New[%u] Force[%u] ####",
-                            cur_device_info_ptr->modelName.c_str(),
-                            cur_device_info_ptr->deviceMAC.c_str(),
-                            cur_device_info_ptr->authType.c_str(),
-                            cur_device_info_ptr->deviceType.c_str(),
-                            new_device_entry,
-                            force_overwrite);
-    }
-
-    if ( new_device_entry && cur_device_info_ptr )
-    {
-        m_deviceInfoList.push_back(cur_device_info_ptr);
-    }
+    m_peer_cache.update(deviceMAC, authType, modelName, deviceType, force_overwrite);
     MIRACASTLOG_TRACE("Exiting...");
 }
 
-DeviceInfo *MiracastController::get_device_details(std::string MAC)
+bool MiracastController::get_device_details(std::string MAC, DeviceInfo &device_info)
 {
-    DeviceInfo *deviceInfo = nullptr;
-    std::size_t found;
-    MIRACASTLOG_TRACE("Entering...");
-    for (auto device : m_deviceInfoList)
-    {
-        found = device->deviceMAC.find(MAC);
-        if (found != std::string::npos)
-        {
-            deviceInfo = device;
-            break;
-        }
-    }
-    MIRACASTLOG_TRACE("Exiting...");
-    return deviceInfo;
+    return m_peer_cache.lookup(MAC, device_info);
 }
 
 std::string MiracastController::get_device_name(std::string mac_address)
 {
-    MIRACASTLOG_TRACE("Entering...");
-    size_t found;
+    DeviceInfo device_info;
     std::string device_name = "";
-    int i = 0;
-    for (auto devices : m_deviceInfoList)
+    MIRACASTLOG_TRACE("Entering...");
+    if (m_peer_cache.lookup(mac_address, device_info))
     {
-        found = devices->deviceMAC.find(mac_address);
-        if (found != std::string::npos)
-        {
-            device_name = devices->modelName;
-            break;
-        }
-        i++;
+        device_name = device_info.modelName;
     }
     MIRACASTLOG_TRACE("Exiting...");
     return device_name;
@@ -732,9 +907,15 @@ MiracastError MiracastController::set_FriendlyName(std::string friendly_name , b
 {
     MiracastError ret = MIRACAST_OK;
     MIRACASTLOG_TRACE("Entering..");
+    std::lock_guard<std::mutex> lock(m_p2p_ctrl_mutex);
     if (nullptr != m_p2p_ctrl_obj){
         ret = m_p2p_ctrl_obj->set_FriendlyName(std::move(friendly_name), apply );
     }
+    else
+    {
+        /* Applied once P2P is ready */
+        m_pending_friendly_name = std::move(friendly_name);
+    }
     MIRACASTLOG_TRACE("Exiting..");
     return ret;
 }
@@ -744,20 +925,32 @@ std::string MiracastController::get_FriendlyName(void)
     std::string friendly_name = "";
     MIRACASTLOG_TRACE("Entering and Exiting...");
 
+    std::lock_guard<std::mutex> lock(m_p2p_ctrl_mutex);
     if (nullptr != m_p2p_ctrl_obj){
         friendly_name = m_p2p_ctrl_obj->get_FriendlyName();
     }
+    else
+    {
+        friendly_name = m_pending_friendly_name;
+    }
     return friendly_name;
 }
 
 void MiracastController::remove_ARPEntry(std::string& ipAddress)
 {
+    MIRACASTLOG_TRACE("Entering..");
+    if (m_neighbor_table->remove_entry(ipAddress) && !m_neighbor_table->has_entry(ipAddress))
+    {
+        MIRACASTLOG_INFO("ARP entry [%s] removed sucessfully", ipAddress.c_str());
+        MIRACASTLOG_TRACE("Exiting..");
+        return;
+    }
+    MIRACASTLOG_WARNING("rtnetlink removal of [%s] failed, falling back to arp", ipAddress.c_str());
     char arpEntryRemoval[128] = {0},
          arpEntryCheck[128] = {0};
     unsigned int retry_count = 5;
     std::string popen_buffer = "";
 
-    MIRACASTLOG_TRACE("Entering..");
     snprintf(arpEntryRemoval,sizeof(arpEntryRemoval),"arp -d %s",ipAddress.c_str());
     snprintf(arpEntryCheck,sizeof(arpEntryCheck),"awk '$1 == \"%s\" {print $1}' /proc/net/arp",ipAddress.c_str());
     while(retry_count--)
@@ -778,596 +971,957 @@ void MiracastController::remove_ARPEntry(std::string& ipAddress)
     MIRACASTLOG_TRACE("Exiting..");
 }
 
+std::string MiracastController::get_PeerIPAddress(std::string interface, std::string peer_iface_mac)
+{
+    std::string peer_ip_address = "";
+
+    MIRACASTLOG_TRACE("Entering...");
+    if (m_dhcp_server->is_running())
+    {
+        /* Our own server reports the address the moment it is acknowledged */
+        DHCP_SERVER_LEASE lease;
+        if (m_dhcp_server->wait_for_lease(peer_iface_mac, lease, PEER_NEIGHBOR_WAIT_TIMEOUT_MS))
+        {
+            peer_ip_address = lease.ip_address;
+        }
+    }
+    else
+    {
+        /* Returns as soon as the kernel learns the peer, not at the next poll */
+        m_neighbor_table->wait_for_ip_by_mac(interface, peer_iface_mac, peer_ip_address, PEER_NEIGHBOR_WAIT_TIMEOUT_MS);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return peer_ip_address;
+}
+
 bool MiracastController::getConnectionStatusByARPING( const char* remote_address, const char* interface )
 {
-    char commandBuffer[128] = {0};
-    std::string popen_buffer = "";
     bool returnValue = false;
     MIRACASTLOG_TRACE("Entering...");
-    snprintf( commandBuffer , sizeof(commandBuffer),"arping -c 1 %s -I %s" , remote_address, interface);
-    returnValue = MiracastCommon::execute_PopenCommand( commandBuffer , "Unicast reply from" , 15 , popen_buffer, 50 );
+    ARP_PROBE_RESULT probe_result;
+    returnValue = m_arp_prober->probe(interface, remote_address, probe_result);
     MIRACASTLOG_TRACE("Exiting...");
     return returnValue;
 }
 
+void PeerProbeThreadCallback(void *args)
+{
+    MiracastController *miracast_ctrler_obj = (MiracastController *)args;
+    miracast_ctrler_obj->peer_probe_thread();
+}
+
+void MiracastController::peer_probe_thread(void)
+{
+    m_peer_probe_alive = getConnectionStatusByARPING(m_peer_probe_ip.c_str(), m_peer_probe_iface.c_str());
+}
+
+void MiracastController::start_PeerProbe(const std::string &interface, const std::string &ip_address)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    finish_PeerProbe();
+    m_peer_probe_iface = interface;
+    m_peer_probe_ip = ip_address;
+    m_peer_probe_alive = false;
+
+    if (0 != pthread_create(&m_peer_probe_thread_id, nullptr, reinterpret_cast<void *(*)(void *)>(&PeerProbeThreadCallback), this))
+    {
+        MIRACASTLOG_ERROR("Unable to start peer probe thread, probing in place");
+        m_peer_probe_thread_id = 0;
+        peer_probe_thread();
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+bool MiracastController::finish_PeerProbe(void)
+{
+    if (0 != m_peer_probe_thread_id)
+    {
+        pthread_join(m_peer_probe_thread_id, nullptr);
+        m_peer_probe_thread_id = 0;
+    }
+    return m_peer_probe_alive;
+}
+
 void MiracastController::Controller_Thread(void *args)
 {
     CONTROLLER_MSGQ_STRUCT controller_msgq_data = {0};
-    bool    new_thunder_req_client_connection_sent = false,
-            another_thunder_req_client_connection_sent = false,
-            session_restart_required = false,
-            p2p_group_instance_alive = false;
+    MiracastEventBufferPool *event_pool = MiracastEventBufferPool::getInstance();
 
     MIRACASTLOG_TRACE("Entering...");
 
     while (nullptr != m_controller_thread)
     {
-        std::string event_buffer;
-        event_buffer.clear();
+        const char *event_buffer = "";
 
         MIRACASTLOG_TRACE("!!! Waiting for Event !!!\n");
-        m_controller_thread->receive_message(&controller_msgq_data, CONTROLLER_MSGQ_SIZE, THREAD_RECV_MSG_INDEFINITE_WAIT);
+        controller_msgq_data.event_buffer = nullptr;
+        if (!get_DueDeferredAction(controller_msgq_data))
+        {
+            int deferred_wait_ms = get_DeferredActionWaitMs();
+
+            if (THREAD_RECV_MSG_INDEFINITE_WAIT == deferred_wait_ms)
+            {
+                m_controller_thread->receive_message(&controller_msgq_data, CONTROLLER_MSGQ_SIZE, THREAD_RECV_MSG_INDEFINITE_WAIT);
+            }
+            else if (!m_controller_thread->receive_message_timed(&controller_msgq_data, CONTROLLER_MSGQ_SIZE, static_cast<unsigned int>(deferred_wait_ms)))
+            {
+                /* Nothing queued before the next deferred action became due */
+                continue;
+            }
+        }
 
-        event_buffer = controller_msgq_data.msg_buffer;
+        if (nullptr != controller_msgq_data.event_buffer)
+        {
+            event_buffer = controller_msgq_data.event_buffer->data;
+        }
 
-        MIRACASTLOG_TRACE("!!! Received Action[%#08X]Data[%s] !!!\n", controller_msgq_data.state, event_buffer.c_str());
+        MIRACASTLOG_TRACE("!!! Received Action[%#08X]Data[%s] !!!\n", controller_msgq_data.state, event_buffer);
 
         if (CONTROLLER_SELF_ABORT == controller_msgq_data.state)
         {
             MIRACASTLOG_INFO("CONTROLLER_SELF_ABORT Received.\n");
+            m_session_fsm.dump_Metrics();
+            event_pool->release(controller_msgq_data.event_buffer);
             break;
         }
 
         switch (controller_msgq_data.msg_type)
         {
             case P2P_MSG:
-            {
-                MIRACASTLOG_TRACE("P2P_MSG type received");
-
-                switch (controller_msgq_data.state)
-                {
-                    case CONTROLLER_GO_DEVICE_FOUND:
-                    case CONTROLLER_GO_DEVICE_PROVISION:
-                    case CONTROLLER_GO_DEVICE_LOST:
-                    {
-                        string deviceMAC;
-                        string deviceType;
-                        string modelName;
-                        std::string wfdSubElements;
-
-                        deviceMAC = parse_p2p_event_data(event_buffer.c_str(), "p2p_dev_addr");
-
-                        if ( CONTROLLER_GO_DEVICE_LOST == controller_msgq_data.state )
-                        {
-                            size_t found;
-                            int i = 0;
-
-                            MIRACASTLOG_INFO("CONTROLLER_GO_DEVICE_LOST Received");
-                            for (auto devices : m_deviceInfoList)
-                            {
-                                found = devices->deviceMAC.find(deviceMAC);
-                                if (found != std::string::npos)
-                                {
-                                    delete devices;
-                                    m_deviceInfoList.erase(m_deviceInfoList.begin() + i);
-                                    break;
-                                }
-                                i++;
-                            }
-                        }
-                        else
-                        {
-                            std::string authType = "pbc";
-                            deviceType = parse_p2p_event_data(event_buffer.c_str(), "pri_dev_type");
-                            modelName = parse_p2p_event_data(event_buffer.c_str(), "name");
-
-                            if ( CONTROLLER_GO_DEVICE_FOUND == controller_msgq_data.state )
-                            {
-                                MIRACASTLOG_INFO("CONTROLLER_GO_DEVICE_FOUND Received");
-                            }
-                            else
-                            {
-                                MIRACASTLOG_INFO("CONTROLLER_GO_DEVICE_PROVISION Received");
-                                if (std::string::npos != event_buffer.find("P2P-PROV-DISC-SHOW-PIN"))
-                                {
-                                    std::istringstream iss(event_buffer);
-                                    std::string token;
-
-                                    // Ignore the first two tokens (P2P-PROV-DISC-SHOW-PIN and the MAC address)
-                                    iss >> token;
-
-                                    iss >> token;
-
-                                    // Get the third token which is PIN
-                                    iss >> token;
-                                    MIRACASTLOG_INFO("!!!! P2P-PROV-DISC-SHOW-PIN is [%s] !!!!",token.c_str());
-                                    authType = token;
-                                }
-                            }
-
-                            create_DeviceCacheData(std::move(deviceMAC),std::move(authType),std::move(modelName),std::move(deviceType),true);
-                            wfdSubElements = parse_p2p_event_data(event_buffer.c_str(), "wfd_dev_info");
-                            #if 0
-                                device->isCPSupported = ((strtol(wfdSubElements.c_str(), nullptr, 16) >> 32) && 256);
-                                device->deviceRole = (DEVICEROLE)((strtol(wfdSubElements.c_str(), nullptr, 16) >> 32) && 3);
-                            #endif
-                            MIRACASTLOG_TRACE("Device data parsed & stored successfully");
-                        }
-                    }
-                    break;
-                    case CONTROLLER_GO_NEG_REQUEST:
-                    {
-                        MIRACASTLOG_INFO("CONTROLLER_GO_NEG_REQUEST Received\n");
-                        std::string received_mac_address;
-                        size_t space_find = event_buffer.find(" ");
-                        size_t dev_str = event_buffer.find("dev_passwd_id");
-                        if ((space_find != std::string::npos) && (dev_str != std::string::npos))
-                        {
-                            received_mac_address = event_buffer.substr(space_find, dev_str - space_find);
-                            REMOVE_SPACES(received_mac_address);
-                        }
-
-                        create_DeviceCacheData(received_mac_address,"pbc","Miracast-Source","unknown",false);
-                        std::string device_name = get_device_name(received_mac_address);
-
-                        if ( get_WFDSourceMACAddress().empty())
-                        {
-                            if ( false == new_thunder_req_client_connection_sent )
-                            {
-                                new_thunder_req_client_connection_sent = true;
-                                notify_ConnectionRequest(std::move(device_name),std::move(received_mac_address));
-                                MIRACASTLOG_INFO("!!! Connection Request reported waiting for user action !!!\n");
-                            }
-                            else
-                            {
-                                MIRACASTLOG_WARNING("!!! Another connect request has Received while new connection inprogress !!!\n");
-                            }
-                        }
-                        else
-                        {
-                            if (0 == (received_mac_address.compare(get_WFDSourceMACAddress())))
-                            {
-                                MIRACASTLOG_WARNING("Duplicate Connect Request has Received\n");
-                            }
-                            else
-                            {
-                                if ( false == another_thunder_req_client_connection_sent )
-                                {
-                                    notify_ConnectionRequest(device_name,received_mac_address);
-                                    another_thunder_req_client_connection_sent = true;
-                                    MIRACASTLOG_INFO("!!! New Connection Request reported waiting for user action !!!\n");
-                                }
-                                else
-                                {
-                                    //  Need to handle connect request received evenafter connection already established with other client
-                                    MIRACASTLOG_ERROR("!!! 3rd connect request has Received while existing is inprogress MAC[%s][%s] !!!\n",
-                                                        received_mac_address.c_str(),
-                                                        device_name.c_str());
-                                }
-                            }
-                        }
-                    }
-                    break;
-                    case CONTROLLER_GO_GROUP_STARTED:
-                    case CONTROLLER_GO_NEG_FAILURE:
-                    case CONTROLLER_GO_GROUP_FORMATION_FAILURE:
-                    {
-                        MiracastServiceReasonCode error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE;
-
-                        if ( CONTROLLER_GO_GROUP_STARTED == controller_msgq_data.state )
-                        {
-                            std::string remote_address = "",
-                                        local_address  = "";
-                            std::string src_dev_ip = "",
-                                        src_dev_mac = "",
-                                        src_dev_name = "",
-                                        sink_dev_ip = "";
-                            std::string modelName = "Miracast-Source",
-                                        authType = "pbc",
-                                        deviceType = "unknown",
-                                        result = "";
-                            m_groupInfo = new GroupInfo();
-                            // Initialize all GroupInfo members to safe defaults
-                            m_groupInfo->interface.clear();
-                            m_groupInfo->isGO = false;
-                            m_groupInfo->SSID.clear();
-                            m_groupInfo->goDevAddr.clear();
-                            m_groupInfo->ipAddr.clear();
-                            m_groupInfo->ipMask.clear();
-                            m_groupInfo->srcDevIPAddr.clear();
-                            m_groupInfo->localIPAddr.clear();
-                            size_t found = event_buffer.find("client");
-                            size_t found_space = event_buffer.find(" ");
-
-                            MIRACASTLOG_TRACE("CONTROLLER_GO_GROUP_STARTED Received");
-
-                            m_groupInfo->goDevAddr = parse_p2p_event_data(event_buffer.c_str(), "go_dev_addr");
-
-                            if (found != std::string::npos)
-                            {
-                                MIRACASTLOG_INFO("!!!! P2P GROUP STARTED IN CLIENT MODE !!!!");
-                                m_groupInfo->ipAddr = parse_p2p_event_data(event_buffer.c_str(), "ip_addr");
-                                m_groupInfo->ipMask = parse_p2p_event_data(event_buffer.c_str(), "ip_mask");
-                                m_groupInfo->srcDevIPAddr = parse_p2p_event_data(event_buffer.c_str(), "go_ip_addr");
-                                m_groupInfo->SSID = parse_p2p_event_data(event_buffer.c_str(), "ssid");
-
-                                std::size_t firstDash = m_groupInfo->SSID.find("-");
-                                if (firstDash != std::string::npos)
-                                {
-                                    std::size_t secondDash = m_groupInfo->SSID.find("-", firstDash + 1);
-                                    if (secondDash != std::string::npos)
-                                    {
-                                        result = m_groupInfo->SSID.substr(secondDash + 1);
-                                        if (!result.empty())
-                                        {
-                                            modelName.clear();
-                                            modelName = result.c_str();
-                                        }
-                                    }
-                                    MIRACASTLOG_INFO("#### Parsed Device Name[%s] from ssid[%s] field of P2P GO STARTED[%s]####",
-                                                        modelName.c_str(),
-                                                        m_groupInfo->SSID.c_str(),
-                                                        event_buffer.c_str());
-                                }
-
-                                size_t found_client = event_buffer.find("client");
-                                m_groupInfo->interface = event_buffer.substr(found_space, found_client - found_space);
-                                REMOVE_SPACES(m_groupInfo->interface);
-
-                                if (getenv("GET_PACKET_DUMP") != nullptr)
-                                {
-                                    std::string tcpdump;
-                                    tcpdump.append("tcpdump -i ");
-                                    tcpdump.append(m_groupInfo->interface);
-                                    tcpdump.append(" -s 65535 -w /opt/p2p_cli_dump.pcap &");
-                                    MIRACASTLOG_VERBOSE("Dump command to execute - %s", tcpdump.c_str());
-                                    MiracastCommon::execute_SystemCommand(tcpdump.c_str());
-                                }
-
-                                std::string default_gw_ip = "";
-
-                                // STB is a client in the p2p group
-                                m_groupInfo->isGO = false;
-                                m_groupInfo->localIPAddr = start_DHCPClient(m_groupInfo->interface, default_gw_ip);
-                                if (m_groupInfo->localIPAddr.empty())
-                                {
-                                    MIRACASTLOG_ERROR("Local IP address is not obtained");
-                                }
-                                else
-                                {
-                                    if (m_groupInfo->srcDevIPAddr.empty())
-                                    {
-                                        MIRACASTLOG_INFO("Could be Persistent Group checking default_gw_ip [%s]\n", default_gw_ip.c_str());
-                                        m_groupInfo->srcDevIPAddr.append(default_gw_ip);
-                                    }
-                                    remote_address = m_groupInfo->srcDevIPAddr;
-                                    local_address = m_groupInfo->localIPAddr;
-                                }
-                            }
-                            else
-                            {
-                                MIRACASTLOG_INFO("!!!! P2P GROUP STARTED IN GO MODE !!!!");
-                                size_t found_go = event_buffer.find("GO");
-                                m_groupInfo->interface = event_buffer.substr(found_space, found_go - found_space);
-                                REMOVE_SPACES(m_groupInfo->interface);
-
-                                if (getenv("GET_PACKET_DUMP") != nullptr)
-                                {
-                                    std::string tcpdump;
-                                    tcpdump.append("tcpdump -i ");
-                                    tcpdump.append(m_groupInfo->interface);
-                                    tcpdump.append(" -s 65535 -w /opt/p2p_go_dump.pcap &");
-                                    MIRACASTLOG_VERBOSE("Dump command to execute - %s", tcpdump.c_str());
-                                    MiracastCommon::execute_SystemCommand(tcpdump.c_str());
-                                }
-
-                                local_address = start_DHCPServer( m_groupInfo->interface );
-                                m_groupInfo->isGO = true;
-
-                                std::string mac_address = get_WFDSourceMACAddress();
-                                std::string peer_iface_mac = get_SourcePeerIface(mac_address);
-                                char command[128] = {0};
-                                std::string popen_buffer = "";
-                                sprintf( command, "awk '$4 == \"%s\" && $4 !~ /incomplete/ {print $1}' /proc/net/arp", peer_iface_mac.c_str());
-
-                                MiracastCommon::execute_PopenCommand( command , nullptr , 15 , popen_buffer , 1000000 );
-                                if (!popen_buffer.empty())
-                                {
-                                    remote_address = std::move(popen_buffer);
-                                    if ( false == getConnectionStatusByARPING(remote_address.c_str(),m_groupInfo->interface.c_str()))
-                                    {
-                                        remove_ARPEntry(remote_address);
-                                        remote_address.clear();
-                                        MIRACASTLOG_ERROR("#### ARPING failed so clearing remote_address to report [WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE] ####");
-                                    }
-                                }
-                            }
-
-                            create_DeviceCacheData(m_groupInfo->goDevAddr,std::move(authType),std::move(modelName),std::move(deviceType),false);
-
-                            if (!remote_address.empty())
-                            {
-                                m_groupInfo->srcDevIPAddr = remote_address;
-                                src_dev_ip = std::move(remote_address);
-                                sink_dev_ip = std::move(local_address);
-                                src_dev_mac = get_WFDSourceMACAddress();;
-                                src_dev_name = get_WFDSourceName();
-
-                                if (!m_connect_req_notified && src_dev_mac.empty() && src_dev_name.empty())
-                                {
-                                    src_dev_mac = m_groupInfo->goDevAddr;
-                                    src_dev_name = get_device_name(src_dev_mac);
-                                    set_WFDSourceMACAddress(src_dev_mac);
-                                    set_WFDSourceName(src_dev_name);
-                                }
-                                MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-LAUNCH LAUNCH REQ FOR SRC_NAME[%s] SRC_MAC[%s] SRC_IP[%s] SINK_IP[%s] ConnectReq[%u]####",
-                                                    src_dev_name.c_str(),
-                                                    src_dev_mac.c_str(),
-                                                    src_dev_ip.c_str(),
-                                                    sink_dev_ip.c_str(),
-                                                    m_connect_req_notified);
-                                if (nullptr != m_notify_handler)
-                                {
-                                    m_notify_handler->onMiracastServiceLaunchRequest(std::move(src_dev_ip),
-                                                                                     std::move(src_dev_mac),
-                                                                                     std::move(src_dev_name),
-                                                                                     std::move(sink_dev_ip),
-                                                                                     m_connect_req_notified );
-                                }
-                                checkAndInitiateP2PBackendDiscovery();
-                                session_restart_required = false;
-                                p2p_group_instance_alive = true;
-                                m_connect_req_notified = false;
-                            }
-                            else
-                            {
-                                error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE;
-                                session_restart_required = true;
-                                MIRACASTLOG_ERROR("!!!! Unable to get the Source Device IP and Terminating Group Here !!!!");
-                                remove_P2PGroupInstance();
-                            }
-                        }
-                        else
-                        {
-                            if ( CONTROLLER_GO_GROUP_FORMATION_FAILURE == controller_msgq_data.state )
-                            {
-                                error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_P2P_GROUP_FORMATION_FAILURE;
-                                MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK CONTROLLER_GO_GROUP_FORMATION_FAILURE ####");
-                            }
-                            else if ( CONTROLLER_GO_NEG_FAILURE == controller_msgq_data.state )
-                            {
-                                error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_P2P_GROUP_NEGOTIATION_FAILURE;
-                                MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK CONTROLLER_GO_NEG_FAILURE ####");
-                            }
-
-                            if ( p2p_group_instance_alive )
-                            {
-                                MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK [GROUP_FORMATION/NEG_FAILURE - %#08X] AFTER P2P GROUP STARTED ####",
-                                                    controller_msgq_data.state );
-                                p2p_group_instance_alive = false;
-                            }
-                            m_connect_req_notified = false;
-                        }
-
-                        if ( true == session_restart_required )
-                        {
-                            if (nullptr != m_notify_handler)
-                            {
-                                std::string mac_address = get_WFDSourceMACAddress();
-                                std::string device_name = get_WFDSourceName();
-                                m_notify_handler->onMiracastServiceClientConnectionError( mac_address , device_name , error_code );
-                            }
-                            MIRACASTLOG_INFO("!!! Restarting Session !!!");
-                            restart_session(false);
-                            if (m_start_discovering_enabled){
-                                discover_devices();
-                            }
-                            session_restart_required = false;
-                        }
-                    }
-                    break;
-                    case CONTROLLER_GO_GROUP_REMOVED:
-                    {
-                        MIRACASTLOG_INFO("CONTROLLER_GO_GROUP_REMOVED Received\n");
-                        if ( p2p_group_instance_alive )
-                        {
-                            std::string device_name = get_NewSourceName(),
-                                        mac_address = get_NewSourceMACAddress();
-
-                            if ( ! mac_address.empty())
-                            {
-                                MIRACASTLOG_INFO("!!!! Cached Connect Request found[%s][%s] and trying to connect it after 5sec !!!!",
-                                                    device_name.c_str(),
-                                                    mac_address.c_str());
-                                sleep(5);
-                                connect_device(std::move(mac_address),std::move(device_name));
-                                reset_NewSourceName();
-                                reset_NewSourceMACAddress();
-                            }
-                            else
-                            {
-                                MIRACASTLOG_INFO("!!!! Cached Connect Request not found !!!!");
-                            }
-                        }
-                        new_thunder_req_client_connection_sent = false;
-                        another_thunder_req_client_connection_sent = false;
-                        session_restart_required = true;
-                        p2p_group_instance_alive = false;
-                    }
-                    break;
-                    case CONTROLLER_GO_STOP_FIND:
-                    {
-                        MIRACASTLOG_TRACE("[CONTROLLER_GO_STOP_FIND] Received");
-                    }
-                    break;
-                    case CONTROLLER_GO_NEG_SUCCESS:
-                    {
-                        std::string current_device_mac = get_WFDSourceMACAddress();
-                        std::string peer_iface_mac = parse_p2p_event_data(event_buffer.c_str(), "peer_iface");
-                        MIRACASTLOG_INFO("[CONTROLLER_GO_NEG_SUCCESS] Received");
-                        set_SourcePeerIface(current_device_mac,std::move(peer_iface_mac));
-                    }
-                    break;
-                    case CONTROLLER_GO_GROUP_FORMATION_SUCCESS:
-                    {
-                        MIRACASTLOG_INFO("[CONTROLLER_GO_GROUP_FORMATION_SUCCESS] Received");
-                    }
-                    break;
-                    case CONTROLLER_GO_EVENT_ERROR:
-                    case CONTROLLER_GO_UNKNOWN_EVENT:
-                    {
-                        MIRACASTLOG_ERROR("[GO_EVENT_ERROR/GO_UNKNOWN_EVENT] Received");
-                    }
-                    break;
-                    default:
-                    {
-                        MIRACASTLOG_ERROR("!!! Invalid state Received[%#08X]Data[%s] with P2P_MSG !!!\n", controller_msgq_data.state, event_buffer.c_str());
-                    }
-                    break;
-                }
-            }
-            break;
             case CONTRLR_FW_MSG:
             {
-                MIRACASTLOG_TRACE("CONTRLR_FW_MSG type received");
-                switch (controller_msgq_data.state)
+                P2P_EVENT_FIELDS event_fields;
+                CONTROLLER_FSM_EVENT fsm_event = { &controller_msgq_data, event_buffer, &event_fields };
+
+                MIRACASTLOG_TRACE("%s type received", (P2P_MSG == controller_msgq_data.msg_type) ? "P2P_MSG" : "CONTRLR_FW_MSG");
+                if ((CONTRLR_FW_MSG == controller_msgq_data.msg_type) &&
+                    ((CONTROLLER_START_DISCOVERING == controller_msgq_data.state) ||
+                     (CONTROLLER_CONNECT_REQ_FROM_THUNDER == controller_msgq_data.state)) &&
+                    (std::chrono::steady_clock::now() < m_discovery_settle_until))
                 {
-                    case CONTROLLER_START_DISCOVERING:
-                    case CONTROLLER_STOP_DISCOVERING:
-                    case CONTROLLER_RESTART_DISCOVERING:
-                    {
-                        if (CONTROLLER_START_DISCOVERING == controller_msgq_data.state)
-                        {
-                            MIRACASTLOG_INFO("CONTROLLER_START_DISCOVERING Received\n");
-                            set_WFDParameters();
-                            discover_devices();
-                            m_start_discovering_enabled = true;
-                        }
-                        else if (CONTROLLER_STOP_DISCOVERING == controller_msgq_data.state)
-                        {
-                            MIRACASTLOG_INFO("CONTROLLER_STOP_DISCOVERING Received\n");
-                            stop_session(false);
-                            m_start_discovering_enabled = false;
-                            sleep(2);
-                        }
-                        else
-                        {
-                            std::string cached_mac_address = get_NewSourceMACAddress(),
-                            mac_address = controller_msgq_data.source_dev_mac;
-                            MIRACASTLOG_INFO("CONTROLLER_RESTART_DISCOVERING Received\n");
-                            m_connectionStatus = false;
-
-                            if ((!cached_mac_address.empty()) && ( 0 == mac_address.compare(cached_mac_address)))
-                            {
-                                reset_NewSourceMACAddress();
-                                reset_NewSourceName();
-                                MIRACASTLOG_INFO("[%s] Cached Device info removed...",cached_mac_address.c_str());
-                            }
-                            restart_session(false);
-                            if (m_start_discovering_enabled){
-                                discover_devices();
-                            }
-                        }
-                        new_thunder_req_client_connection_sent = false;
-                        another_thunder_req_client_connection_sent = false;
-                        session_restart_required = true;
-                        p2p_group_instance_alive = false;
-                        m_connect_req_notified = false;
-                    }
-                    break;
-                    case CONTROLLER_CONNECT_REQ_FROM_THUNDER:
-                    {
-                        MIRACASTLOG_INFO("CONTROLLER_CONNECT_REQ_FROM_THUNDER Received");
-                        std::string mac_address = controller_msgq_data.source_dev_mac;
-                        std::string device_name = get_device_name(mac_address);
-
-                        if ( false == p2p_group_instance_alive )
-                        {
-                            connect_device(mac_address,device_name);
-                            new_thunder_req_client_connection_sent = false;
-                            another_thunder_req_client_connection_sent = false;
-                            session_restart_required = true;
-                        }
-                        else
-                        {
-                            if ( get_NewSourceMACAddress().empty())
-                            {
-                                MIRACASTLOG_INFO("!!! Caching New Connection until P2P Group remove properly !!!");
-                                set_NewSourceMACAddress(std::move(mac_address));
-                                set_NewSourceName(std::move(device_name));
-                            }
-                            else
-                            {
-                                MIRACASTLOG_ERROR("!!! Unable to Cache Connection[%s - %s] as [%s - %s] was already cached !!!",
-                                                    device_name.c_str(),
-                                                    mac_address.c_str(),
-                                                    get_NewSourceName().c_str(),
-                                                    get_NewSourceMACAddress().c_str());
-                            }
-                        }
-                    }
-                    break;
-                    case CONTROLLER_FLUSH_CURRENT_SESSION:
-                    {
-                        MIRACASTLOG_INFO("CONTROLLER_FLUSH_CURRENT_SESSION Received\n");
-                        remove_P2PGroupInstance();
-                    }
-                    break;
-                    case CONTROLLER_CONNECT_REQ_REJECT:
-                    case CONTROLLER_CONNECT_REQ_TIMEOUT:
-                    {
-                        if ( CONTROLLER_CONNECT_REQ_REJECT == controller_msgq_data.state )
-                        {
-                            MIRACASTLOG_INFO("CONTROLLER_CONNECT_REQ_REJECT Received\n");
-                        }
-                        else
-                        {
-                            MIRACASTLOG_INFO("CONTROLLER_CONNECT_REQ_TIMEOUT Received\n");
-                        }
-                        new_thunder_req_client_connection_sent = false;
-                        another_thunder_req_client_connection_sent = false;
-                    }
-                    break;
-                    case CONTROLLER_SWITCH_LAUNCH_REQ_CTX:
-                    {
-                        MIRACASTLOG_INFO("Launch Request to be notified from here");
-                        if (nullptr != m_notify_handler)
-                        {
-                            MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-LAUNCH LAUNCH REQ FOR SRC_NAME[%s] SRC_MAC[%s] SRC_IP[%s] SINK_IP[%s] ####",
-                                                    controller_msgq_data.source_dev_name,
-                                                    controller_msgq_data.source_dev_mac,
-                                                    controller_msgq_data.source_dev_ip,
-                                                    controller_msgq_data.sink_dev_ip);
-                            m_notify_handler->onMiracastServiceLaunchRequest( controller_msgq_data.source_dev_ip,
-                                                                              controller_msgq_data.source_dev_mac,
-                                                                              controller_msgq_data.source_dev_name,
-                                                                              controller_msgq_data.sink_dev_ip,
-                                                                              true );
-                        }
-                    }
-                    break;
-                    default:
-                    {
-                        MIRACASTLOG_ERROR("!!! Invalid state Received[%#08X]Data[%s] with CONTRLR_FW_MSG !!!", controller_msgq_data.state, event_buffer.c_str());
-                    }
+                    /* Let the previous stop settle without blocking P2P events meanwhile */
+                    unsigned int settle_ms = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                m_discovery_settle_until - std::chrono::steady_clock::now()).count()) + 1;
+                    MIRACASTLOG_INFO("Deferring Action[%#08X] by %u ms after stop", controller_msgq_data.state, settle_ms);
+                    schedule_DeferredAction(controller_msgq_data, settle_ms);
                     break;
                 }
+                parse_p2p_event_fields(event_buffer, event_fields);
+                m_session_fsm.dispatch(this, fsm_event);
             }
             break;
             default:
             {
-                MIRACASTLOG_ERROR("!!! Invalid MsgType Received[%#08X]Data[%s]  !!!", controller_msgq_data.msg_type, event_buffer.c_str());
+                MIRACASTLOG_ERROR("!!! Invalid MsgType Received[%#08X]Data[%s]  !!!", controller_msgq_data.msg_type, event_buffer);
             }
             break;
-        }        
+        }
+        event_pool->release(controller_msgq_data.event_buffer);
+        controller_msgq_data.event_buffer = nullptr;
     }
     MIRACASTLOG_TRACE("Exiting...");
 }
 
-void MiracastController::send_thundermsg_to_controller_thread(CONTROLLER_MSGQ_STRUCT controller_msgq_data)
+bool MiracastController::handle_DeviceEvent(CONTROLLER_FSM_EVENT &event)
 {
-    MIRACASTLOG_TRACE("Entering...");
-    if (nullptr != m_controller_thread)
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+    P2P_EVENT_FIELDS &event_fields = *event.event_fields;
+    const char *event_buffer = event.event_buffer;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+
+    string deviceMAC;
+    string deviceType;
+    string modelName;
+    std::string wfdSubElements;
+
+    deviceMAC = get_p2p_event_field(event_fields, P2P_EVENT_KEY_P2P_DEV_ADDR);
+
+    if ( CONTROLLER_GO_DEVICE_LOST == controller_msgq_data.state )
+    {
+        MIRACASTLOG_INFO("CONTROLLER_GO_DEVICE_LOST Received");
+        m_peer_cache.remove(deviceMAC);
+    }
+    else
+    {
+        std::string authType = "pbc";
+        deviceType = get_p2p_event_field(event_fields, P2P_EVENT_KEY_PRI_DEV_TYPE);
+        modelName = get_p2p_event_field(event_fields, P2P_EVENT_KEY_NAME);
+
+        if ( CONTROLLER_GO_DEVICE_FOUND == controller_msgq_data.state )
+        {
+            MIRACASTLOG_INFO("CONTROLLER_GO_DEVICE_FOUND Received");
+        }
+        else
+        {
+            MIRACASTLOG_INFO("CONTROLLER_GO_DEVICE_PROVISION Received");
+            session_tracer->begin_session(deviceMAC);
+            session_tracer->span_end(MIRACAST_SPAN_P2P_FIND);
+            session_tracer->span_mark(MIRACAST_SPAN_PROVISION_DISCOVERY);
+            if (nullptr != strstr(event_buffer, "P2P-PROV-DISC-SHOW-PIN"))
+            {
+                // P2P-PROV-DISC-SHOW-PIN <MAC address> <PIN>
+                std::string token = get_p2p_event_arg(event_fields, 1);
+                MIRACASTLOG_INFO("!!!! P2P-PROV-DISC-SHOW-PIN is [%s] !!!!",token.c_str());
+                authType = token;
+            }
+        }
+
+        create_DeviceCacheData(std::move(deviceMAC),std::move(authType),std::move(modelName),std::move(deviceType),true);
+        wfdSubElements = get_p2p_event_field(event_fields, P2P_EVENT_KEY_WFD_DEV_INFO);
+        #if 0
+            device->isCPSupported = ((strtol(wfdSubElements.c_str(), nullptr, 16) >> 32) && 256);
+            device->deviceRole = (DEVICEROLE)((strtol(wfdSubElements.c_str(), nullptr, 16) >> 32) && 3);
+        #endif
+        MIRACASTLOG_TRACE("Device data parsed & stored successfully");
+    }
+    return true;
+}
+
+void MiracastController::begin_ConnectRequest(CONTROLLER_FSM_EVENT &event, std::string &mac_address, std::string &device_name)
+{
+    P2P_EVENT_FIELDS &event_fields = *event.event_fields;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+
+    MIRACASTLOG_INFO("CONTROLLER_GO_NEG_REQUEST Received\n");
+    mac_address.clear();
+    if (nullptr != event_fields.fields[P2P_EVENT_KEY_DEV_PASSWD_ID].value)
+    {
+        mac_address = get_p2p_event_arg(event_fields, 0);
+    }
+
+    create_DeviceCacheData(mac_address,"pbc","Miracast-Source","unknown",false);
+    device_name = get_device_name(mac_address);
+
+    session_tracer->begin_session(mac_address);
+    session_tracer->span_end(MIRACAST_SPAN_P2P_FIND);
+    session_tracer->span_begin(MIRACAST_SPAN_USER_ACCEPT);
+}
+
+bool MiracastController::is_SourceUnassigned(const CONTROLLER_FSM_EVENT &event)
+{
+    return get_WFDSourceMACAddress().empty();
+}
+
+/* source_dev_name carries the interface, sink_dev_ip the address for an address removal */
+bool MiracastController::is_GroupInterfaceEvent(const CONTROLLER_FSM_EVENT &event)
+{
+    const CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+
+    if ((nullptr == m_groupInfo) || (m_groupInfo->interface != controller_msgq_data.source_dev_name))
+    {
+        return false;
+    }
+    return (('\0' == controller_msgq_data.sink_dev_ip[0]) ||
+            (m_groupInfo->localIPAddr == controller_msgq_data.sink_dev_ip));
+}
+
+bool MiracastController::handle_NewConnectRequest(CONTROLLER_FSM_EVENT &event)
+{
+    std::string received_mac_address,
+                device_name;
+
+    begin_ConnectRequest(event, received_mac_address, device_name);
+    if (!accept_PreApprovedSource(received_mac_address, device_name))
+    {
+        notify_ConnectionRequest(std::move(device_name),std::move(received_mac_address));
+        MIRACASTLOG_INFO("!!! Connection Request reported waiting for user action !!!\n");
+    }
+    return true;
+}
+
+bool MiracastController::accept_PreApprovedSource(const std::string &mac_address, const std::string &device_name)
+{
+    CONTROLLER_MSGQ_STRUCT controller_msgq_data = {0};
+    DeviceInfo device_info;
+    std::string policy_reason;
+
+    get_device_details(mac_address, device_info);
+    if (SOURCE_POLICY_ACCEPT != m_source_policy.evaluate(mac_address, device_name, device_info.deviceType, policy_reason))
+    {
+        MIRACASTLOG_VERBOSE("Source [%s - %s] needs user action, %s", device_name.c_str(), mac_address.c_str(), policy_reason.c_str());
+        return false;
+    }
+
+    MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-CONNECT-REQ DEVICE[%s - %s] PRE-APPROVED BY [%s] ####",
+                        device_name.c_str(),
+                        mac_address.c_str(),
+                        policy_reason.c_str());
+    /* The service moves straight to accepted, so the launch is reported as for an accepted request */
+    m_connect_req_notified = true;
+    if (nullptr != m_notify_handler)
+    {
+        m_notify_handler->onMiracastServiceClientConnectionAccepted(mac_address, device_name);
+    }
+
+    /* Same path as acceptClientConnection, the session moves on once this is dequeued */
+    strncpy(controller_msgq_data.source_dev_mac, mac_address.c_str(), sizeof(controller_msgq_data.source_dev_mac));
+    controller_msgq_data.source_dev_mac[sizeof(controller_msgq_data.source_dev_mac) - 1] = '\0';
+    controller_msgq_data.state = CONTROLLER_CONNECT_REQ_FROM_THUNDER;
+    send_thundermsg_to_controller_thread(controller_msgq_data);
+    return true;
+}
+
+bool MiracastController::handle_ConnectRequestInProgress(CONTROLLER_FSM_EVENT &event)
+{
+    std::string received_mac_address,
+                device_name;
+
+    begin_ConnectRequest(event, received_mac_address, device_name);
+    MIRACASTLOG_WARNING("!!! Another connect request has Received while new connection inprogress !!!\n");
+    return true;
+}
+
+bool MiracastController::handle_AdditionalConnectRequest(CONTROLLER_FSM_EVENT &event)
+{
+    std::string received_mac_address,
+                device_name;
+
+    begin_ConnectRequest(event, received_mac_address, device_name);
+    if (0 == (received_mac_address.compare(get_WFDSourceMACAddress())))
+    {
+        MIRACASTLOG_WARNING("Duplicate Connect Request has Received\n");
+    }
+    else if (m_additional_request_mac.empty())
+    {
+        m_additional_request_mac = received_mac_address;
+        notify_ConnectionRequest(device_name,received_mac_address);
+        MIRACASTLOG_INFO("!!! New Connection Request reported waiting for user action !!!\n");
+    }
+    else
+    {
+        //  Need to handle connect request received evenafter connection already established with other client
+        MIRACASTLOG_ERROR("!!! 3rd connect request has Received while existing is inprogress MAC[%s][%s] !!!\n",
+                            received_mac_address.c_str(),
+                            device_name.c_str());
+    }
+    return true;
+}
+
+bool MiracastController::handle_GroupStarted(CONTROLLER_FSM_EVENT &event)
+{
+    P2P_EVENT_FIELDS &event_fields = *event.event_fields;
+    const char *event_buffer = event.event_buffer;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+
+    MiracastServiceReasonCode error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE;
+    std::string remote_address = "",
+                local_address  = "";
+    std::string src_dev_ip = "",
+                src_dev_mac = "",
+                src_dev_name = "",
+                sink_dev_ip = "";
+    std::string modelName = "Miracast-Source",
+                authType = "pbc",
+                deviceType = "unknown",
+                result = "";
+    m_groupInfo = new GroupInfo();
+    // Initialize all GroupInfo members to safe defaults
+    m_groupInfo->interface.clear();
+    m_groupInfo->isGO = false;
+    m_groupInfo->SSID.clear();
+    m_groupInfo->goDevAddr.clear();
+    m_groupInfo->ipAddr.clear();
+    m_groupInfo->ipMask.clear();
+    m_groupInfo->srcDevIPAddr.clear();
+    m_groupInfo->localIPAddr.clear();
+    m_groupInfo->isPersistent = false;
+    // P2P-GROUP-STARTED <interface> <GO|client> ssid=".." ...
+    std::string group_role = get_p2p_event_arg(event_fields, 1);
+    bool peer_probe_started = false;
+
+    MIRACASTLOG_TRACE("CONTROLLER_GO_GROUP_STARTED Received");
+
+    m_groupInfo->goDevAddr = get_p2p_event_field(event_fields, P2P_EVENT_KEY_GO_DEV_ADDR);
+    m_groupInfo->isPersistent = has_p2p_event_arg(event_fields, P2P_PERSISTENT_GROUP_FLAG);
+
+    KNOWN_SOURCE known_source;
+    std::string known_source_mac = get_WFDSourceMACAddress();
+    if (known_source_mac.empty())
+    {
+        known_source_mac = m_groupInfo->goDevAddr;
+    }
+    bool is_known_source = m_source_store.find(known_source_mac, known_source);
+
+    /* Persistent group re-invocation starts the session here */
+    session_tracer->begin_session(m_groupInfo->goDevAddr);
+    session_tracer->span_end(MIRACAST_SPAN_GROUP_START);
+
+    unsigned int group_freq = static_cast<unsigned int>(atoi(get_p2p_event_field(event_fields, P2P_EVENT_KEY_FREQ).c_str()));
+    unsigned int sta_freq = (nullptr != m_p2p_ctrl_obj) ? m_p2p_ctrl_obj->get_STAFrequency() : 0;
+    session_tracer->set_group_frequency(group_freq);
+    if ((0 != sta_freq) && (0 != group_freq) && (sta_freq != group_freq))
+    {
+        MIRACASTLOG_WARNING("#### P2P group on %u MHz while STA is on %u MHz, multi-channel concurrency ####", group_freq, sta_freq);
+    }
+    else
+    {
+        MIRACASTLOG_INFO("#### P2P group on %u MHz, STA on %u MHz ####", group_freq, sta_freq);
+    }
+
+    if ("client" == group_role)
+    {
+        MIRACASTLOG_INFO("!!!! P2P GROUP STARTED IN CLIENT MODE !!!!");
+        m_groupInfo->ipAddr = get_p2p_event_field(event_fields, P2P_EVENT_KEY_IP_ADDR);
+        m_groupInfo->ipMask = get_p2p_event_field(event_fields, P2P_EVENT_KEY_IP_MASK);
+        m_groupInfo->srcDevIPAddr = get_p2p_event_field(event_fields, P2P_EVENT_KEY_GO_IP_ADDR);
+        m_groupInfo->SSID = get_p2p_event_field(event_fields, P2P_EVENT_KEY_SSID);
+
+        std::size_t firstDash = m_groupInfo->SSID.find("-");
+        if (firstDash != std::string::npos)
+        {
+            std::size_t secondDash = m_groupInfo->SSID.find("-", firstDash + 1);
+            if (secondDash != std::string::npos)
+            {
+                result = m_groupInfo->SSID.substr(secondDash + 1);
+                if (!result.empty())
+                {
+                    modelName.clear();
+                    modelName = result.c_str();
+                }
+            }
+            MIRACASTLOG_INFO("#### Parsed Device Name[%s] from ssid[%s] field of P2P GO STARTED[%s]####",
+                                modelName.c_str(),
+                                m_groupInfo->SSID.c_str(),
+                                event_buffer);
+        }
+
+        m_groupInfo->interface = get_p2p_event_arg(event_fields, 0);
+
+        if (getenv("GET_PACKET_DUMP") != nullptr)
+        {
+            std::string tcpdump;
+            tcpdump.append("tcpdump -i ");
+            tcpdump.append(m_groupInfo->interface);
+            tcpdump.append(" -s 65535 -w /opt/p2p_cli_dump.pcap &");
+            MIRACASTLOG_VERBOSE("Dump command to execute - %s", tcpdump.c_str());
+            MiracastCommon::execute_SystemCommand(tcpdump.c_str());
+        }
+
+        std::string default_gw_ip = "";
+
+        // STB is a client in the p2p group
+        m_groupInfo->isGO = false;
+        session_tracer->span_begin(MIRACAST_SPAN_DHCP);
+        m_groupInfo->localIPAddr = start_DHCPClient(m_groupInfo->interface,
+                                                    default_gw_ip,
+                                                    (is_known_source && !known_source.sink_was_go) ? known_source.local_ip : "");
+        session_tracer->span_end(MIRACAST_SPAN_DHCP);
+        if (m_groupInfo->localIPAddr.empty())
+        {
+            MIRACASTLOG_ERROR("Local IP address is not obtained");
+        }
+        else
+        {
+            if (m_groupInfo->srcDevIPAddr.empty())
+            {
+                MIRACASTLOG_INFO("Could be Persistent Group checking default_gw_ip [%s]\n", default_gw_ip.c_str());
+                m_groupInfo->srcDevIPAddr.append(default_gw_ip);
+            }
+            remote_address = m_groupInfo->srcDevIPAddr;
+            local_address = m_groupInfo->localIPAddr;
+        }
+    }
+    else
+    {
+        MIRACASTLOG_INFO("!!!! P2P GROUP STARTED IN GO MODE !!!!");
+        m_groupInfo->interface = get_p2p_event_arg(event_fields, 0);
+
+        if (getenv("GET_PACKET_DUMP") != nullptr)
+        {
+            std::string tcpdump;
+            tcpdump.append("tcpdump -i ");
+            tcpdump.append(m_groupInfo->interface);
+            tcpdump.append(" -s 65535 -w /opt/p2p_go_dump.pcap &");
+            MIRACASTLOG_VERBOSE("Dump command to execute - %s", tcpdump.c_str());
+            MiracastCommon::execute_SystemCommand(tcpdump.c_str());
+        }
+
+        m_groupInfo->SSID = get_p2p_event_field(event_fields, P2P_EVENT_KEY_SSID);
+        std::string mac_address = get_WFDSourceMACAddress();
+        std::string peer_iface_mac = get_SourcePeerIface(mac_address);
+
+        session_tracer->span_begin(MIRACAST_SPAN_DHCP);
+        local_address = start_DHCPServer( m_groupInfo->interface,
+                                          peer_iface_mac,
+                                          (is_known_source && known_source.sink_was_go) ? known_source.remote_ip : "");
+        session_tracer->span_end(MIRACAST_SPAN_DHCP);
+        m_groupInfo->isGO = true;
+        std::string peer_ip_address = get_PeerIPAddress(m_groupInfo->interface, peer_iface_mac);
+        if (!peer_ip_address.empty())
+        {
+            /* Verify the source while the launch request below goes out */
+            session_tracer->span_begin(MIRACAST_SPAN_ARP_VERIFY);
+            start_PeerProbe(m_groupInfo->interface, peer_ip_address);
+            peer_probe_started = true;
+            remote_address = std::move(peer_ip_address);
+        }
+    }
+
+    create_DeviceCacheData(m_groupInfo->goDevAddr,std::move(authType),std::move(modelName),std::move(deviceType),false);
+
+    KNOWN_SOURCE connected_source;
+    connected_source.persistent_network_id = P2P_PERSISTENT_NETWORK_NONE;
+    if (!remote_address.empty() && m_groupInfo->isPersistent && (nullptr != m_p2p_ctrl_obj))
+    {
+        connected_source.persistent_network_id = m_p2p_ctrl_obj->get_PersistentNetworkId(m_groupInfo->SSID);
+    }
+
+    if (!remote_address.empty())
+    {
+        bool launched = true;
+
+        m_groupInfo->srcDevIPAddr = remote_address;
+        src_dev_ip = std::move(remote_address);
+        sink_dev_ip = std::move(local_address);
+        src_dev_mac = get_WFDSourceMACAddress();;
+        src_dev_name = get_WFDSourceName();
+
+        if (!m_connect_req_notified && src_dev_mac.empty() && src_dev_name.empty())
+        {
+            src_dev_mac = m_groupInfo->goDevAddr;
+            src_dev_name = get_device_name(src_dev_mac);
+            set_WFDSourceMACAddress(src_dev_mac);
+            set_WFDSourceName(src_dev_name);
+        }
+
+        MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-LAUNCH LAUNCH REQ FOR SRC_NAME[%s] SRC_MAC[%s] SRC_IP[%s] SINK_IP[%s] ConnectReq[%u]####",
+                            src_dev_name.c_str(),
+                            src_dev_mac.c_str(),
+                            src_dev_ip.c_str(),
+                            sink_dev_ip.c_str(),
+                            m_connect_req_notified);
+        if (nullptr != m_notify_handler)
+        {
+            m_notify_handler->onMiracastServiceLaunchRequest(src_dev_ip,
+                                                             src_dev_mac,
+                                                             src_dev_name,
+                                                             sink_dev_ip,
+                                                             m_connect_req_notified );
+        }
+
+        if (peer_probe_started)
+        {
+            /* The player connects while the probe runs, take the launch back if the source is gone */
+            bool peer_alive = finish_PeerProbe();
+
+            session_tracer->span_end(MIRACAST_SPAN_ARP_VERIFY);
+            if (!peer_alive)
+            {
+                MIRACASTLOG_ERROR("#### ARPING failed so cancelling the Launch Request to report [WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE] ####");
+                remove_ARPEntry(src_dev_ip);
+                if (nullptr != m_notify_handler)
+                {
+                    m_notify_handler->onMiracastServiceLaunchCancel(src_dev_mac,
+                                                                    src_dev_name,
+                                                                    WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE);
+                }
+                launched = false;
+            }
+        }
+
+        if (launched)
+        {
+            connected_source.device_mac = src_dev_mac;
+            connected_source.peer_iface = get_SourcePeerIface(src_dev_mac);
+            connected_source.device_name = src_dev_name;
+            connected_source.sink_was_go = m_groupInfo->isGO;
+            connected_source.local_ip = sink_dev_ip;
+            connected_source.remote_ip = src_dev_ip;
+            connected_source.last_connected = static_cast<uint64_t>(time(nullptr));
+            m_source_store.record(connected_source);
+            m_reinvoked_source_mac.clear();
+
+            session_tracer->end_session(true);
+            checkAndInitiateP2PBackendDiscovery();
+            m_connect_req_notified = false;
+            return true;
+        }
+    }
+
+    error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE;
+    MIRACASTLOG_ERROR("!!!! Unable to get the Source Device IP and Terminating Group Here !!!!");
+    session_tracer->end_session(false);
+    remove_P2PGroupInstance();
+    restart_FailedSession(error_code);
+    return false;
+}
+
+bool MiracastController::handle_GroupFailure(CONTROLLER_FSM_EVENT &event)
+{
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+
+    MiracastServiceReasonCode error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE;
+
+    if ( CONTROLLER_GO_GROUP_FORMATION_FAILURE == controller_msgq_data.state )
+    {
+        error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_P2P_GROUP_FORMATION_FAILURE;
+        MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK CONTROLLER_GO_GROUP_FORMATION_FAILURE ####");
+    }
+    else if ( CONTROLLER_GO_NEG_FAILURE == controller_msgq_data.state )
+    {
+        error_code = WPEFramework::Exchange::IMiracastService::REASON_CODE_P2P_GROUP_NEGOTIATION_FAILURE;
+        MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK CONTROLLER_GO_NEG_FAILURE ####");
+    }
+
+    if (!m_reinvoked_source_mac.empty())
+    {
+        /* Stale persistent credentials, fall back to a full negotiation next time */
+        m_source_store.forget_persistent_group(m_reinvoked_source_mac);
+        m_reinvoked_source_mac.clear();
+    }
+
+    if ( m_session_fsm.get_StateInfo().group_alive )
+    {
+        MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK [GROUP_FORMATION/NEG_FAILURE - %#08X] AFTER P2P GROUP STARTED ####",
+                            controller_msgq_data.state );
+    }
+    m_connect_req_notified = false;
+    session_tracer->end_session(false);
+
+    if (m_session_fsm.get_StateInfo().restart_on_failure)
+    {
+        restart_FailedSession(error_code);
+    }
+    return true;
+}
+
+void MiracastController::restart_FailedSession(MiracastServiceReasonCode error_code)
+{
+    if (nullptr != m_notify_handler)
+    {
+        std::string mac_address = get_WFDSourceMACAddress();
+        std::string device_name = get_WFDSourceName();
+        m_notify_handler->onMiracastServiceClientConnectionError( mac_address , device_name , error_code );
+    }
+    MIRACASTLOG_INFO("!!! Restarting Session !!!");
+    restart_session(false);
+    if (m_start_discovering_enabled){
+        discover_devices();
+    }
+}
+
+bool MiracastController::handle_GroupRemoved(CONTROLLER_FSM_EVENT &event)
+{
+    MIRACASTLOG_INFO("CONTROLLER_GO_GROUP_REMOVED Received\n");
+    if ( m_session_fsm.get_StateInfo().group_alive )
+    {
+        std::string device_name = get_NewSourceName(),
+                    mac_address = get_NewSourceMACAddress();
+
+        if ( ! mac_address.empty())
+        {
+            CONTROLLER_MSGQ_STRUCT cached_connect = {0};
+
+            MIRACASTLOG_INFO("!!!! Cached Connect Request found[%s][%s] and trying to connect it after %u ms !!!!",
+                                device_name.c_str(),
+                                mac_address.c_str(),
+                                CACHED_CONNECT_DEFERRAL_MS);
+            cached_connect.state = CONTROLLER_CONNECT_CACHED_SOURCE;
+            schedule_DeferredAction(cached_connect, CACHED_CONNECT_DEFERRAL_MS);
+        }
+        else
+        {
+            MIRACASTLOG_INFO("!!!! Cached Connect Request not found !!!!");
+        }
+    }
+    m_additional_request_mac.clear();
+    m_session_fsm.dump_Metrics();
+    return true;
+}
+
+bool MiracastController::handle_GroupInterfaceLost(CONTROLLER_FSM_EVENT &event)
+{
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+
+    MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK P2P GROUP INTERFACE [%s] LOST [%s], TEARING DOWN THE SESSION ####",
+                        controller_msgq_data.source_dev_name,
+                        ('\0' == controller_msgq_data.sink_dev_ip[0]) ? "LINK DOWN" : controller_msgq_data.sink_dev_ip);
+    MiracastSessionTracer::getInstance()->end_session(false);
+    m_connect_req_notified = false;
+    m_additional_request_mac.clear();
+    restart_FailedSession(WPEFramework::Exchange::IMiracastService::REASON_CODE_GENERIC_FAILURE);
+    return true;
+}
+
+bool MiracastController::handle_StopFind(CONTROLLER_FSM_EVENT &event)
+{
+    MIRACASTLOG_TRACE("[CONTROLLER_GO_STOP_FIND] Received");
+    return true;
+}
+
+bool MiracastController::handle_NegSuccess(CONTROLLER_FSM_EVENT &event)
+{
+    P2P_EVENT_FIELDS &event_fields = *event.event_fields;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+
+    std::string current_device_mac = get_WFDSourceMACAddress();
+    std::string peer_iface_mac = get_p2p_event_field(event_fields, P2P_EVENT_KEY_PEER_IFACE);
+    MIRACASTLOG_INFO("[CONTROLLER_GO_NEG_SUCCESS] Received");
+    session_tracer->span_end(MIRACAST_SPAN_GO_NEGOTIATION);
+    session_tracer->span_begin(MIRACAST_SPAN_GROUP_START);
+    set_SourcePeerIface(current_device_mac,std::move(peer_iface_mac));
+    return true;
+}
+
+bool MiracastController::handle_FormationSuccess(CONTROLLER_FSM_EVENT &event)
+{
+    MIRACASTLOG_INFO("[CONTROLLER_GO_GROUP_FORMATION_SUCCESS] Received");
+    return true;
+}
+
+bool MiracastController::handle_EventError(CONTROLLER_FSM_EVENT &event)
+{
+    MIRACASTLOG_ERROR("[GO_EVENT_ERROR/GO_UNKNOWN_EVENT] Received");
+    return true;
+}
+
+bool MiracastController::handle_DiscoveryAction(CONTROLLER_FSM_EVENT &event)
+{
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+
+    if (CONTROLLER_START_DISCOVERING == controller_msgq_data.state)
+    {
+        MIRACASTLOG_INFO("CONTROLLER_START_DISCOVERING Received\n");
+        set_WFDParameters();
+        discover_devices();
+        m_start_discovering_enabled = true;
+    }
+    else if (CONTROLLER_STOP_DISCOVERING == controller_msgq_data.state)
+    {
+        MIRACASTLOG_INFO("CONTROLLER_STOP_DISCOVERING Received\n");
+        stop_session(false);
+        m_start_discovering_enabled = false;
+        cancel_DeferredAction(CONTROLLER_START_DISCOVERING);
+        cancel_DeferredAction(CONTROLLER_CONNECT_REQ_FROM_THUNDER);
+        cancel_DeferredAction(CONTROLLER_CONNECT_CACHED_SOURCE);
+        m_discovery_settle_until = std::chrono::steady_clock::now() + std::chrono::milliseconds(STOP_DISCOVERY_SETTLE_MS);
+    }
+    else
+    {
+        std::string cached_mac_address = get_NewSourceMACAddress(),
+        mac_address = controller_msgq_data.source_dev_mac;
+        MIRACASTLOG_INFO("CONTROLLER_RESTART_DISCOVERING Received\n");
+        m_connectionStatus = false;
+
+        if ((!cached_mac_address.empty()) && ( 0 == mac_address.compare(cached_mac_address)))
+        {
+            reset_NewSourceMACAddress();
+            reset_NewSourceName();
+            MIRACASTLOG_INFO("[%s] Cached Device info removed...",cached_mac_address.c_str());
+        }
+        restart_session(false);
+        if (m_start_discovering_enabled){
+            discover_devices();
+        }
+    }
+    session_tracer->end_session(false);
+    m_additional_request_mac.clear();
+    m_connect_req_notified = false;
+    return true;
+}
+
+bool MiracastController::handle_P2PReadyAction(CONTROLLER_FSM_EVENT &event)
+{
+    MIRACASTLOG_INFO("CONTROLLER_P2P_READY Received");
+    on_P2PReady();
+    return true;
+}
+
+bool MiracastController::handle_ConnectRequest(CONTROLLER_FSM_EVENT &event)
+{
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+
+    MIRACASTLOG_INFO("CONTROLLER_CONNECT_REQ_FROM_THUNDER Received");
+    std::string mac_address = controller_msgq_data.source_dev_mac;
+    std::string device_name = get_device_name(mac_address);
+
+    if (cancel_DeferredAction(CONTROLLER_CONNECT_CACHED_SOURCE))
+    {
+        MIRACASTLOG_INFO("!!! Dropping cached connection[%s], superseded by [%s] !!!",
+                            get_NewSourceMACAddress().c_str(),
+                            mac_address.c_str());
+        reset_NewSourceMACAddress();
+        reset_NewSourceName();
+    }
+    connect_device(mac_address,device_name);
+    m_additional_request_mac.clear();
+    return true;
+}
+
+bool MiracastController::handle_CacheConnectRequest(CONTROLLER_FSM_EVENT &event)
+{
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+
+    MIRACASTLOG_INFO("CONTROLLER_CONNECT_REQ_FROM_THUNDER Received");
+    std::string mac_address = controller_msgq_data.source_dev_mac;
+    std::string device_name = get_device_name(mac_address);
+
+    if ( get_NewSourceMACAddress().empty())
+    {
+        MIRACASTLOG_INFO("!!! Caching New Connection until P2P Group remove properly !!!");
+        set_NewSourceMACAddress(std::move(mac_address));
+        set_NewSourceName(std::move(device_name));
+    }
+    else
+    {
+        MIRACASTLOG_ERROR("!!! Unable to Cache Connection[%s - %s] as [%s - %s] was already cached !!!",
+                            device_name.c_str(),
+                            mac_address.c_str(),
+                            get_NewSourceName().c_str(),
+                            get_NewSourceMACAddress().c_str());
+    }
+    return true;
+}
+
+bool MiracastController::handle_ConnectCachedSource(CONTROLLER_FSM_EVENT &event)
+{
+    std::string device_name = get_NewSourceName(),
+                mac_address = get_NewSourceMACAddress();
+
+    MIRACASTLOG_INFO("CONTROLLER_CONNECT_CACHED_SOURCE Received");
+    if (mac_address.empty())
+    {
+        MIRACASTLOG_INFO("!!!! Cached Connect Request was removed meanwhile !!!!");
+        return false;
+    }
+    connect_device(std::move(mac_address),std::move(device_name));
+    reset_NewSourceName();
+    reset_NewSourceMACAddress();
+    m_additional_request_mac.clear();
+    return true;
+}
+
+bool MiracastController::handle_KeepCachedSource(CONTROLLER_FSM_EVENT &event)
+{
+    MIRACASTLOG_INFO("CONTROLLER_CONNECT_CACHED_SOURCE Received");
+    MIRACASTLOG_INFO("!!!! P2P Group alive again, keeping [%s] cached !!!!", get_NewSourceMACAddress().c_str());
+    return true;
+}
+
+bool MiracastController::handle_FlushSession(CONTROLLER_FSM_EVENT &event)
+{
+    MIRACASTLOG_INFO("CONTROLLER_FLUSH_CURRENT_SESSION Received\n");
+    remove_P2PGroupInstance();
+    return true;
+}
+
+bool MiracastController::handle_ConnectRequestClosed(CONTROLLER_FSM_EVENT &event)
+{
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+    MiracastSessionTracer *session_tracer = MiracastSessionTracer::getInstance();
+
+    if ( CONTROLLER_CONNECT_REQ_REJECT == controller_msgq_data.state )
+    {
+        MIRACASTLOG_INFO("CONTROLLER_CONNECT_REQ_REJECT Received\n");
+    }
+    else
+    {
+        MIRACASTLOG_INFO("CONTROLLER_CONNECT_REQ_TIMEOUT Received\n");
+    }
+    session_tracer->end_session(false);
+    m_additional_request_mac.clear();
+    return true;
+}
+
+bool MiracastController::handle_SwitchLaunchRequest(CONTROLLER_FSM_EVENT &event)
+{
+    CONTROLLER_MSGQ_STRUCT &controller_msgq_data = *event.message;
+
+    MIRACASTLOG_INFO("Launch Request to be notified from here");
+    if (nullptr != m_notify_handler)
+    {
+        MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-LAUNCH LAUNCH REQ FOR SRC_NAME[%s] SRC_MAC[%s] SRC_IP[%s] SINK_IP[%s] ####",
+                                controller_msgq_data.source_dev_name,
+                                controller_msgq_data.source_dev_mac,
+                                controller_msgq_data.source_dev_ip,
+                                controller_msgq_data.sink_dev_ip);
+        m_notify_handler->onMiracastServiceLaunchRequest( controller_msgq_data.source_dev_ip,
+                                                          controller_msgq_data.source_dev_mac,
+                                                          controller_msgq_data.source_dev_name,
+                                                          controller_msgq_data.sink_dev_ip,
+                                                          true );
+    }
+    return true;
+}
+
+void P2PInitThreadCallback(void *args)
+{
+    MiracastController *miracast_ctrler_obj = (MiracastController *)args;
+    miracast_ctrler_obj->p2p_init_thread();
+}
+
+void MiracastController::p2p_init_thread(void)
+{
+    MiracastError ret_code = MIRACAST_FAIL;
+    MIRACASTLOG_TRACE("Entering...");
+
+    if (MiracastP2P::wait_for_CtrlIface(m_p2p_ctrl_iface, P2P_CTRL_IFACE_ASYNC_WAIT_MS, m_p2p_init_cancel_fd))
+    {
+        MiracastP2P *p2p_ctrl_obj = MiracastP2P::getInstance(ret_code, m_p2p_ctrl_iface, m_p2p_init_cancel_fd);
+        std::lock_guard<std::mutex> lock(m_p2p_ctrl_mutex);
+        m_p2p_ready_obj = (MIRACAST_OK == ret_code) ? p2p_ctrl_obj : nullptr;
+    }
+
+    struct pollfd cancel_poll = {m_p2p_init_cancel_fd, POLLIN, 0};
+    if (0 < poll(&cancel_poll, 1, 0))
+    {
+        /* Shutting down, the controller thread is already gone */
+        MIRACASTLOG_INFO("P2P init cancelled");
+        MIRACASTLOG_TRACE("Exiting...");
+        return;
+    }
+    if (MIRACAST_OK != ret_code)
+    {
+        MIRACASTLOG_ERROR("#### MCAST-TRIAGE-NOK P2P INIT FAILED FOR [%s] ####", m_p2p_ctrl_iface.c_str());
+    }
+    /* Sent on failure too, so the service learns that discovery is not available */
+    CONTROLLER_MSGQ_STRUCT controller_msgq_data = {0};
+    controller_msgq_data.state = CONTROLLER_P2P_READY;
+    send_thundermsg_to_controller_thread(controller_msgq_data);
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+/* Runs on the controller thread, replays what was requested while P2P was coming up */
+void MiracastController::on_P2PReady(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    {
+        std::lock_guard<std::mutex> lock(m_p2p_ctrl_mutex);
+        m_p2p_ctrl_obj = m_p2p_ready_obj;
+        if ((nullptr != m_p2p_ctrl_obj) && (!m_pending_friendly_name.empty()))
+        {
+            m_p2p_ctrl_obj->set_FriendlyName(m_pending_friendly_name, false);
+            m_pending_friendly_name.clear();
+        }
+    }
+    if (nullptr == m_p2p_ctrl_obj)
+    {
+        MIRACASTLOG_ERROR("P2P unavailable, discovery %s", m_start_discovering_enabled ? "not possible" : "not requested");
+        if ((nullptr != m_notify_handler) && (m_start_discovering_enabled))
+        {
+            m_notify_handler->onStateChange(MIRACAST_SERVICE_STATE_IDLE);
+        }
+    }
+    else if (m_start_discovering_enabled)
+    {
+        /* discover_devices() reports DISCOVERABLE through the state callback */
+        MIRACASTLOG_INFO("P2P ready, discovery resumed");
+        set_WFDParameters();
+        discover_devices();
+    }
+    else
+    {
+        MIRACASTLOG_INFO("P2P ready, discovery not requested");
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastController::send_thundermsg_to_controller_thread(CONTROLLER_MSGQ_STRUCT controller_msgq_data)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    if (nullptr != m_controller_thread)
     {
         MIRACASTLOG_INFO("Msg to Controller Action[%#08X]", controller_msgq_data.state);
         controller_msgq_data.msg_type = CONTRLR_FW_MSG;
@@ -1376,6 +1930,80 @@ void MiracastController::send_thundermsg_to_controller_thread(CONTROLLER_MSGQ_ST
     MIRACASTLOG_TRACE("Exiting...");
 }
 
+void MiracastController::schedule_DeferredAction(const CONTROLLER_MSGQ_STRUCT &message, unsigned int delay_ms)
+{
+    DEFERRED_ACTION action;
+
+    MIRACASTLOG_TRACE("Entering...");
+    /* A newer request of the same kind replaces the pending one */
+    cancel_DeferredAction(message.state);
+    action.due = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+    action.message = message;
+    action.message.msg_type = CONTRLR_FW_MSG;
+    action.message.event_buffer = nullptr;
+    m_deferred_actions.push_back(action);
+    MIRACASTLOG_INFO("Action[%#08X] deferred by %u ms", message.state, delay_ms);
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+bool MiracastController::cancel_DeferredAction(eCONTROLLER_FW_STATES state)
+{
+    bool cancelled = false;
+
+    for (auto it = m_deferred_actions.begin(); it != m_deferred_actions.end();)
+    {
+        if (state == it->message.state)
+        {
+            MIRACASTLOG_INFO("Deferred Action[%#08X] cancelled", state);
+            it = m_deferred_actions.erase(it);
+            cancelled = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return cancelled;
+}
+
+bool MiracastController::get_DueDeferredAction(CONTROLLER_MSGQ_STRUCT &message)
+{
+    auto earliest = m_deferred_actions.end();
+
+    for (auto it = m_deferred_actions.begin(); it != m_deferred_actions.end(); ++it)
+    {
+        if ((m_deferred_actions.end() == earliest) || (it->due < earliest->due))
+        {
+            earliest = it;
+        }
+    }
+    if ((m_deferred_actions.end() == earliest) || (std::chrono::steady_clock::now() < earliest->due))
+    {
+        return false;
+    }
+    message = earliest->message;
+    m_deferred_actions.erase(earliest);
+    return true;
+}
+
+int MiracastController::get_DeferredActionWaitMs(void)
+{
+    long long wait_ms = -1;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (const auto &action : m_deferred_actions)
+    {
+        long long remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(action.due - now).count();
+        remaining_ms = std::max(remaining_ms, 0LL);
+        if ((0 > wait_ms) || (remaining_ms < wait_ms))
+        {
+            wait_ms = remaining_ms;
+        }
+    }
+    /* Rounded up so the wake-up does not come a millisecond early */
+    return (0 > wait_ms) ? THREAD_RECV_MSG_INDEFINITE_WAIT : static_cast<int>(wait_ms + 1);
+}
+
 void MiracastController::set_enable(bool is_enabled)
 {
     MIRACASTLOG_TRACE("Entering...");
@@ -1449,6 +2077,7 @@ void MiracastController::accept_client_connection(std::string is_accepted)
                         m_current_device_name.c_str(),
                         m_current_device_mac_addr.c_str(),
                         is_accepted.c_str());
+    m_source_policy.record_decision(m_current_device_mac_addr, m_current_device_name, ("Accept" == is_accepted));
     m_current_device_name.clear();
     m_current_device_mac_addr.clear();
     send_thundermsg_to_controller_thread(controller_msgq_data);
@@ -1545,10 +2174,8 @@ void MiracastController::reset_WFDSourceName(void)
 void MiracastController::set_SourcePeerIface(std::string& devMac, std::string peer_iface_mac)
 {
     MIRACASTLOG_TRACE("Entering...");
-    DeviceInfo *device_info_ptr = MiracastController::get_device_details(devMac);
-    if ( nullptr != device_info_ptr )
+    if ( m_peer_cache.set_peer_iface(devMac, peer_iface_mac) )
     {
-        device_info_ptr->peer_iface = peer_iface_mac.c_str();
         MIRACASTLOG_INFO("Updating peer_iface as [%s]",peer_iface_mac.c_str());
     }
     MIRACASTLOG_TRACE("Exiting...");
@@ -1558,10 +2185,10 @@ std::string MiracastController::get_SourcePeerIface(std::string& devMac)
 {
     std::string peer_iface_mac = "";
     MIRACASTLOG_TRACE("Entering...");
-    DeviceInfo *device_info_ptr = MiracastController::get_device_details(devMac);
-    if ( nullptr != device_info_ptr )
+    DeviceInfo device_info;
+    if ( get_device_details(devMac, device_info) )
     {
-        peer_iface_mac = device_info_ptr->peer_iface;
+        peer_iface_mac = device_info.peer_iface;
         if (peer_iface_mac.empty())
         {
             peer_iface_mac = devMac.c_str();
@@ -1612,7 +2239,7 @@ void MiracastController::notify_ConnectionRequest(std::string device_name,std::s
                         m_current_device_name.c_str(), 
                         m_current_device_mac_addr.c_str());
     m_connect_req_notified = true;
-    if (0 == access("/opt/miracast_direct_request", F_OK))
+    if (MiracastOptFlags::getInstance()->is_present(MIRACAST_OPT_DIRECT_REQUEST))
     {
         m_connect_req_notified = false;
     }
@@ -1628,7 +2255,6 @@ void ControllerThreadCallback(void *args)
 {
     MiracastController *miracast_ctrler_obj = (MiracastController *)args;
     MIRACASTLOG_TRACE("Entering...");
-    sleep(1);
     if ( nullptr != miracast_ctrler_obj )
     {
         miracast_ctrler_obj->Controller_Thread(nullptr);
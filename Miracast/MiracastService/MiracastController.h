@@ -34,8 +34,19 @@
 #include <fstream>
 #include <ifaddrs.h>
 #include <netdb.h>
+#include <mutex>
+#include <chrono>
 #include <MiracastCommon.h>
 #include "MiracastP2P.h"
+#include "MiracastPeerCache.h"
+#include "MiracastSourceStore.h"
+#include "MiracastSourcePolicy.h"
+#include "MiracastNeighborTable.h"
+#include "MiracastInterfaceTable.h"
+#include "MiracastArpProber.h"
+#include "MiracastDHCPClient.h"
+#include "MiracastDHCPServer.h"
+#include "MiracastControllerFSM.h"
 #include "MiracastLogger.h"
 #include <interfaces/IMiracastService.h>
 
@@ -46,7 +57,13 @@ using MiracastServiceReasonCode = WPEFramework::Exchange::IMiracastService::Reas
 using MiracastPlayerState = WPEFramework::Exchange::IMiracastService::PlayerState;
 
 #define THUNDER_REQ_THREAD_CLIENT_CONNECTION_WAITTIME (30)
-#define MAX_IFACE_NAME_LEN 16
+#define PEER_NEIGHBOR_WAIT_TIMEOUT_MS (15000)
+/* How long the client group interface may take to come up before DHCP */
+#define GROUP_LINK_WAIT_TIMEOUT_MS (3000)
+/* Delay before a connect request cached during a live group is replayed */
+#define CACHED_CONNECT_DEFERRAL_MS (5000)
+/* Discovery and connect commands are held back this long after a stop */
+#define STOP_DISCOVERY_SETTLE_MS (2000)
 
 /**
  * Abstract class for MiracastService Notification.
@@ -55,8 +72,12 @@ class MiracastServiceNotifier
 {
 public:
     virtual void onMiracastServiceClientConnectionRequest(string client_mac, string client_name) = 0;
+    /* Request accepted by the source policy, the controller connects without waiting for the application */
+    virtual void onMiracastServiceClientConnectionAccepted(string client_mac, string client_name) = 0;
     virtual void onMiracastServiceClientConnectionError(string client_mac, string client_name , MiracastServiceReasonCode reason_code ) = 0;
     virtual void onMiracastServiceLaunchRequest(string src_dev_ip, string src_dev_mac, string src_dev_name, string sink_dev_ip, bool is_connect_req_reported ) = 0;
+    /* Launch request sent while the source was still being verified, and the source turned out to be gone */
+    virtual void onMiracastServiceLaunchCancel(string src_dev_mac, string src_dev_name, MiracastServiceReasonCode reason_code ) = 0;
     virtual void onStateChange(eMIRA_SERVICE_STATES state ) = 0;
 };
 
@@ -66,7 +87,7 @@ public:
     static MiracastController *getInstance( MiracastError &error_code , MiracastServiceNotifier *notifier = nullptr, std::string p2p_ctrl_iface = "");
     static void destroyInstance();
 
-    void event_handler(P2P_EVENTS eventId, void *data, size_t len );
+    void event_handler(P2P_EVENTS eventId, MIRACAST_EVENT_BUFFER *event_buffer);
 
     MiracastError discover_devices(bool isNotificationRequired = true);
     MiracastError connect_device(std::string device_mac , std::string device_name );
@@ -75,10 +96,10 @@ public:
     std::string get_localIp();
     std::string get_wfd_streaming_port_number();
     std::string get_connected_device_mac();
-    std::vector<DeviceInfo *> get_allPeers();
+    std::vector<DeviceInfo> get_allPeers();
 
     bool get_connection_status();
-    DeviceInfo *get_device_details(std::string mac);
+    bool get_device_details(std::string mac, DeviceInfo &device_info);
 
     void send_thundermsg_to_controller_thread(CONTROLLER_MSGQ_STRUCT controller_msgq_data);
 
@@ -115,26 +136,47 @@ public:
     void setP2PBackendDiscovery(bool is_enabled);
     void switch_launch_request_context(const std::string& source_dev_ip,const std::string& source_dev_mac,const std::string& source_dev_name,const std::string& sink_dev_ip);
     void start_discoveryAsync(void);
+    void p2p_init_thread(void);
+    void peer_probe_thread(void);
+    void on_InterfaceEvent(const INTERFACE_EVENT &event);
+    void on_DHCPLeaseLost(const std::string &interface, const std::string &ip_address);
     void stop_discoveryAsync(void);
     void restart_discoveryAsync(void);
+    /* Wireless station interface, change_count moves when its link or address changes */
+    std::string get_STAInterface(uint32_t &change_count);
+    /* Used by controllers created afterwards in place of the rtnetlink table, nullptr restores it */
+    static void set_NeighborTable(MiracastNeighborTableInterface *neighbor_table);
+    /* Used by controllers created afterwards in place of the AF_PACKET prober, nullptr restores it */
+    static void set_ArpProber(MiracastArpProberInterface *arp_prober);
+    /* Used by controllers created afterwards in place of the built-in DHCP client, nullptr restores it */
+    static void set_DHCPClient(MiracastDHCPClientInterface *dhcp_client);
+    /* Used by controllers created afterwards in place of the built-in DHCP server, nullptr restores it */
+    static void set_DHCPServer(MiracastDHCPServerInterface *dhcp_server);
 
 private:
     static MiracastController *m_miracast_ctrl_obj;
+    static MiracastNeighborTableInterface *m_installed_neighbor_table;
+    static MiracastArpProberInterface *m_installed_arp_prober;
+    static MiracastDHCPClientInterface *m_installed_dhcp_client;
+    static MiracastDHCPServerInterface *m_installed_dhcp_server;
     MiracastController();
     virtual ~MiracastController();
     MiracastController &operator=(const MiracastController &) = delete;
     MiracastController(const MiracastController &) = delete;
 
-    std::string parse_p2p_event_data(const char *tmpBuff, const char *lookup_data );
-    std::string start_DHCPClient(std::string interface, std::string &default_gw_ip_addr);
+    std::string start_DHCPClient(std::string interface, std::string &default_gw_ip_addr, std::string requested_ip = "");
     MiracastError initiate_TCP(std::string go_ip);
     MiracastError connect_Sink();
     MiracastError create_ControllerFramework(std::string p2p_ctrl_iface);
     MiracastError destroy_ControllerFramework(void);
+    void on_P2PReady(void);
     void checkAndInitiateP2PBackendDiscovery(void);
     std::string getifNameByIPv4(std::string ip_address);
     bool getConnectionStatusByARPING( const char* remote_address, const char* interface );
     void remove_ARPEntry(std::string& ipAddress);
+    void start_PeerProbe(const std::string &interface, const std::string &ip_address);
+    bool finish_PeerProbe(void);
+    std::string get_PeerIPAddress(std::string interface, std::string peer_iface_mac);
     void create_DeviceCacheData(std::string deviceMAC,std::string authType,std::string modelName,std::string deviceType, bool force_overwrite);
     void set_localIp(std::string ipAddr);
     void set_SourcePeerIface(std::string& devMac, std::string peer_iface_mac);
@@ -146,22 +188,97 @@ private:
     std::string m_new_device_mac_addr;
     std::string m_new_device_name;
     std::string m_localIp;
-    vector<DeviceInfo *> m_deviceInfoList;
+    MiracastPeerCache m_peer_cache;
+    MiracastSourceStore m_source_store;
+    MiracastSourcePolicy m_source_policy;
+    MiracastNeighborTable m_builtin_neighbor_table;
+    MiracastNeighborTableInterface *m_neighbor_table;
+    MiracastArpProber m_builtin_arp_prober;
+    MiracastArpProberInterface *m_arp_prober;
+    MiracastInterfaceTable m_interface_table;
+    MiracastDHCPClient m_builtin_dhcp_client;
+    MiracastDHCPClientInterface *m_dhcp_client;
+    MiracastDHCPServer m_builtin_dhcp_server;
+    MiracastDHCPServerInterface *m_dhcp_server;
+    std::string m_reinvoked_source_mac;
     GroupInfo *m_groupInfo;
     bool m_connectionStatus;
     bool m_p2p_backend_discovery{false};
     bool m_start_discovering_enabled{false};
     bool m_connect_req_notified{false};
+    /* Set when start_DHCPClient() fell back to udhcpc, its teardown is only needed then */
+    bool m_udhcpc_started{false};
     std::string  m_current_device_name;
     std::string  m_current_device_mac_addr;
 
     /*members for interacting with wpa_supplicant*/
     MiracastP2P *m_p2p_ctrl_obj;
+    std::mutex m_p2p_ctrl_mutex;
+    MiracastP2P *m_p2p_ready_obj;
+    std::string m_p2p_ctrl_iface;
+    std::string m_pending_friendly_name;
+    pthread_t m_p2p_init_thread_id;
+    int m_p2p_init_cancel_fd;
+
+    /* Liveness check of the GO client, overlapped with the launch preparation */
+    pthread_t m_peer_probe_thread_id;
+    std::string m_peer_probe_iface;
+    std::string m_peer_probe_ip;
+    bool m_peer_probe_alive;
 
     MiracastThread *m_controller_thread;
     int m_tcpserverSockfd;
+
+    /* Controller messages re-injected into the loop once due, only touched on the controller thread */
+    typedef struct deferred_action_st
+    {
+        std::chrono::steady_clock::time_point due;
+        CONTROLLER_MSGQ_STRUCT message;
+    }
+    DEFERRED_ACTION;
+    std::vector<DEFERRED_ACTION> m_deferred_actions;
+    std::chrono::steady_clock::time_point m_discovery_settle_until;
+
+    void schedule_DeferredAction(const CONTROLLER_MSGQ_STRUCT &message, unsigned int delay_ms);
+    bool cancel_DeferredAction(eCONTROLLER_FW_STATES state);
+    bool get_DueDeferredAction(CONTROLLER_MSGQ_STRUCT &message);
+    int get_DeferredActionWaitMs(void);
+
+    /* Session state of the controller thread, see m_session_transitions */
+    static const CONTROLLER_FSM_STATE m_session_states[CONTROLLER_SESSION_STATE_MAX];
+    static const CONTROLLER_FSM_TRANSITION m_session_transitions[];
+    MiracastControllerFSM m_session_fsm;
+    /* Source of the one extra connect request reported while another source is assigned */
+    std::string m_additional_request_mac;
+
+    bool is_SourceUnassigned(const CONTROLLER_FSM_EVENT &event);
+    bool is_GroupInterfaceEvent(const CONTROLLER_FSM_EVENT &event);
+    void begin_ConnectRequest(CONTROLLER_FSM_EVENT &event, std::string &mac_address, std::string &device_name);
+    bool accept_PreApprovedSource(const std::string &mac_address, const std::string &device_name);
+    void restart_FailedSession(MiracastServiceReasonCode error_code);
+    bool handle_DeviceEvent(CONTROLLER_FSM_EVENT &event);
+    bool handle_NewConnectRequest(CONTROLLER_FSM_EVENT &event);
+    bool handle_ConnectRequestInProgress(CONTROLLER_FSM_EVENT &event);
+    bool handle_AdditionalConnectRequest(CONTROLLER_FSM_EVENT &event);
+    bool handle_GroupStarted(CONTROLLER_FSM_EVENT &event);
+    bool handle_GroupFailure(CONTROLLER_FSM_EVENT &event);
+    bool handle_GroupRemoved(CONTROLLER_FSM_EVENT &event);
+    bool handle_GroupInterfaceLost(CONTROLLER_FSM_EVENT &event);
+    bool handle_StopFind(CONTROLLER_FSM_EVENT &event);
+    bool handle_NegSuccess(CONTROLLER_FSM_EVENT &event);
+    bool handle_FormationSuccess(CONTROLLER_FSM_EVENT &event);
+    bool handle_EventError(CONTROLLER_FSM_EVENT &event);
+    bool handle_DiscoveryAction(CONTROLLER_FSM_EVENT &event);
+    bool handle_P2PReadyAction(CONTROLLER_FSM_EVENT &event);
+    bool handle_ConnectRequest(CONTROLLER_FSM_EVENT &event);
+    bool handle_CacheConnectRequest(CONTROLLER_FSM_EVENT &event);
+    bool handle_ConnectCachedSource(CONTROLLER_FSM_EVENT &event);
+    bool handle_KeepCachedSource(CONTROLLER_FSM_EVENT &event);
+    bool handle_FlushSession(CONTROLLER_FSM_EVENT &event);
+    bool handle_ConnectRequestClosed(CONTROLLER_FSM_EVENT &event);
+    bool handle_SwitchLaunchRequest(CONTROLLER_FSM_EVENT &event);
     eCONTROLLER_FW_STATES convertP2PtoSessionActions(P2P_EVENTS eventId);
-    std::string start_DHCPServer(std::string interface);
+    std::string start_DHCPServer(std::string interface, std::string peer_iface_mac = "", std::string reserved_ip = "");
 };
 
 #endif
@@ -0,0 +1,164 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include "MiracastController.h"
+#include "MiracastControllerFSM.h"
+
+MiracastControllerFSM::MiracastControllerFSM(const CONTROLLER_FSM_STATE *states,
+                                             const CONTROLLER_FSM_TRANSITION *transitions,
+                                             size_t transition_count)
+    : m_states(states),
+      m_transitions(transitions),
+      m_transition_count(transition_count),
+      m_state(CONTROLLER_SESSION_IDLE),
+      m_state_entered(fsm_clock::now()),
+      m_transition_counts(transition_count, 0),
+      m_invalid_count(0)
+{
+    memset(m_state_metrics, 0, sizeof(m_state_metrics));
+    m_state_metrics[CONTROLLER_SESSION_IDLE].entries = 1;
+}
+
+bool MiracastControllerFSM::dispatch(MiracastController *controller, CONTROLLER_FSM_EVENT &event)
+{
+    eCONTROLLER_FW_STATES event_id = event.message->state;
+
+    for (size_t index = 0; index < m_transition_count; ++index)
+    {
+        const CONTROLLER_FSM_TRANSITION &transition = m_transitions[index];
+
+        if ((event_id != transition.event) ||
+            (0 == (transition.from_states & CONTROLLER_SESSION_MASK(m_state))) ||
+            ((nullptr != transition.guard) && !(controller->*transition.guard)(event)))
+        {
+            continue;
+        }
+
+        m_transition_counts[index]++;
+        bool success = (nullptr == transition.handler) || (controller->*transition.handler)(event);
+        eCONTROLLER_SESSION_STATES next_state = success ? transition.next_state : transition.fail_state;
+
+        if ((CONTROLLER_SESSION_SAME != next_state) && (m_state != next_state))
+        {
+            enter_State(next_state, event_id);
+        }
+        return true;
+    }
+
+    m_invalid_count++;
+    MIRACASTLOG_ERROR("!!! Invalid Action[%#08X] in session state [%s] !!!", event_id, m_states[m_state].name);
+    return false;
+}
+
+void MiracastControllerFSM::enter_State(eCONTROLLER_SESSION_STATES state, eCONTROLLER_FW_STATES event)
+{
+    fsm_clock::time_point now = fsm_clock::now();
+    uint64_t dwell_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - m_state_entered).count());
+    CONTROLLER_FSM_STATE_METRICS &metrics = m_state_metrics[m_state];
+
+    metrics.total_dwell_us += dwell_us;
+    if (dwell_us > metrics.max_dwell_us)
+    {
+        metrics.max_dwell_us = dwell_us;
+    }
+
+    MIRACASTLOG_INFO("#### Session [%s] -> [%s] on Action[%#08X] after %llu ms ####",
+                     m_states[m_state].name,
+                     m_states[state].name,
+                     event,
+                     static_cast<unsigned long long>(dwell_us / 1000));
+
+    m_state = state;
+    m_state_entered = now;
+    m_state_metrics[state].entries++;
+}
+
+eCONTROLLER_SESSION_STATES MiracastControllerFSM::get_State(void) const
+{
+    return m_state;
+}
+
+const CONTROLLER_FSM_STATE &MiracastControllerFSM::get_StateInfo(void) const
+{
+    return m_states[m_state];
+}
+
+const char *MiracastControllerFSM::get_StateName(eCONTROLLER_SESSION_STATES state) const
+{
+    return (CONTROLLER_SESSION_STATE_MAX > state) ? m_states[state].name : "SAME";
+}
+
+CONTROLLER_FSM_STATE_METRICS MiracastControllerFSM::get_StateMetrics(eCONTROLLER_SESSION_STATES state) const
+{
+    CONTROLLER_FSM_STATE_METRICS metrics = m_state_metrics[state];
+
+    if (state == m_state)
+    {
+        uint64_t dwell_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(fsm_clock::now() - m_state_entered).count());
+        metrics.total_dwell_us += dwell_us;
+        if (dwell_us > metrics.max_dwell_us)
+        {
+            metrics.max_dwell_us = dwell_us;
+        }
+    }
+    return metrics;
+}
+
+uint32_t MiracastControllerFSM::get_TransitionCount(size_t index) const
+{
+    return (index < m_transition_count) ? m_transition_counts[index] : 0;
+}
+
+uint32_t MiracastControllerFSM::get_InvalidCount(void) const
+{
+    return m_invalid_count;
+}
+
+void MiracastControllerFSM::dump_Metrics(void) const
+{
+    MIRACASTLOG_INFO("#### Session state [%s], invalid actions %u ####", m_states[m_state].name, m_invalid_count);
+    for (int state = CONTROLLER_SESSION_IDLE; state < CONTROLLER_SESSION_STATE_MAX; ++state)
+    {
+        CONTROLLER_FSM_STATE_METRICS metrics = get_StateMetrics(static_cast<eCONTROLLER_SESSION_STATES>(state));
+
+        if (0 == metrics.entries)
+        {
+            continue;
+        }
+        MIRACASTLOG_INFO("  %-18s entries[%u] total[%llu ms] avg[%llu ms] max[%llu ms]",
+                         m_states[state].name,
+                         metrics.entries,
+                         static_cast<unsigned long long>(metrics.total_dwell_us / 1000),
+                         static_cast<unsigned long long>(metrics.total_dwell_us / 1000 / metrics.entries),
+                         static_cast<unsigned long long>(metrics.max_dwell_us / 1000));
+    }
+    for (size_t index = 0; index < m_transition_count; ++index)
+    {
+        if (0 == m_transition_counts[index])
+        {
+            continue;
+        }
+        MIRACASTLOG_VERBOSE("  Action[%#08X] from[%#04X] -> [%s] taken %u times",
+                            m_transitions[index].event,
+                            m_transitions[index].from_states,
+                            get_StateName(m_transitions[index].next_state),
+                            m_transition_counts[index]);
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_CONTROLLER_FSM_H_
+#define _MIRACAST_CONTROLLER_FSM_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdint.h>
+#include <MiracastCommon.h>
+#include "MiracastP2P.h"
+
+class MiracastController;
+
+typedef enum controller_session_states_e
+{
+    /* Nothing in progress, a failure event needs no cleanup */
+    CONTROLLER_SESSION_IDLE = 0,
+    /* Discovery (re)configured or group removed, waiting for a source */
+    CONTROLLER_SESSION_LISTENING,
+    /* Connection request reported, waiting for the user */
+    CONTROLLER_SESSION_CONNECT_REQUESTED,
+    /* P2P connect issued */
+    CONTROLLER_SESSION_CONNECTING,
+    /* GO negotiation done, waiting for the group */
+    CONTROLLER_SESSION_GROUP_FORMING,
+    /* Group up and launch requested */
+    CONTROLLER_SESSION_CONNECTED,
+    CONTROLLER_SESSION_STATE_MAX,
+    /* next_state/fail_state value to stay in the current state */
+    CONTROLLER_SESSION_SAME = CONTROLLER_SESSION_STATE_MAX
+}
+eCONTROLLER_SESSION_STATES;
+
+#define CONTROLLER_SESSION_MASK(state)      (1U << (state))
+#define CONTROLLER_SESSION_ANY_MASK         ((1U << CONTROLLER_SESSION_STATE_MAX) - 1)
+
+typedef struct controller_fsm_event_st
+{
+    CONTROLLER_MSGQ_STRUCT *message;
+    const char *event_buffer;
+    /* Empty for controller framework messages */
+    P2P_EVENT_FIELDS *event_fields;
+}
+CONTROLLER_FSM_EVENT;
+
+typedef bool (MiracastController::*CONTROLLER_FSM_GUARD)(const CONTROLLER_FSM_EVENT &event);
+/* Returns false to take fail_state instead of next_state */
+typedef bool (MiracastController::*CONTROLLER_FSM_HANDLER)(CONTROLLER_FSM_EVENT &event);
+
+typedef struct controller_fsm_transition_st
+{
+    eCONTROLLER_FW_STATES event;
+    uint32_t from_states;
+    CONTROLLER_FSM_GUARD guard;
+    CONTROLLER_FSM_HANDLER handler;
+    eCONTROLLER_SESSION_STATES next_state;
+    eCONTROLLER_SESSION_STATES fail_state;
+}
+CONTROLLER_FSM_TRANSITION;
+
+typedef struct controller_fsm_state_st
+{
+    const char *name;
+    /* A negotiation or group failure seen here restarts the session */
+    bool restart_on_failure;
+    bool group_alive;
+}
+CONTROLLER_FSM_STATE;
+
+typedef struct controller_fsm_state_metrics_st
+{
+    uint32_t entries;
+    uint64_t total_dwell_us;
+    uint64_t max_dwell_us;
+}
+CONTROLLER_FSM_STATE_METRICS;
+
+/**
+ * Table driven dispatcher for the controller thread. The first transition
+ * whose event, source state and guard match runs its handler and moves the
+ * session on; events without a transition are counted and logged. Entries and
+ * dwell time are kept per state so the time spent in each phase of a
+ * connection can be read back with dump_Metrics().
+ */
+class MiracastControllerFSM
+{
+public:
+    MiracastControllerFSM(const CONTROLLER_FSM_STATE *states,
+                          const CONTROLLER_FSM_TRANSITION *transitions,
+                          size_t transition_count);
+
+    /* Returns false when no transition matched */
+    bool dispatch(MiracastController *controller, CONTROLLER_FSM_EVENT &event);
+    eCONTROLLER_SESSION_STATES get_State(void) const;
+    const CONTROLLER_FSM_STATE &get_StateInfo(void) const;
+    const char *get_StateName(eCONTROLLER_SESSION_STATES state) const;
+    /* Dwell of the current state is included up to now */
+    CONTROLLER_FSM_STATE_METRICS get_StateMetrics(eCONTROLLER_SESSION_STATES state) const;
+    uint32_t get_TransitionCount(size_t index) const;
+    uint32_t get_InvalidCount(void) const;
+    void dump_Metrics(void) const;
+
+private:
+    typedef std::chrono::steady_clock fsm_clock;
+
+    const CONTROLLER_FSM_STATE *m_states;
+    const CONTROLLER_FSM_TRANSITION *m_transitions;
+    size_t m_transition_count;
+    eCONTROLLER_SESSION_STATES m_state;
+    fsm_clock::time_point m_state_entered;
+    CONTROLLER_FSM_STATE_METRICS m_state_metrics[CONTROLLER_SESSION_STATE_MAX];
+    std::vector<uint32_t> m_transition_counts;
+    uint32_t m_invalid_count;
+
+    void enter_State(eCONTROLLER_SESSION_STATES state, eCONTROLLER_FW_STATES event);
+};
+
+#endif /* _MIRACAST_CONTROLLER_FSM_H_ */
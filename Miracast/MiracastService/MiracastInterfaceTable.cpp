@@ -0,0 +1,743 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include "MiracastInterfaceTable.h"
+
+typedef struct interface_request_st
+{
+    struct nlmsghdr header;
+    union
+    {
+        struct ifinfomsg link;
+        struct ifaddrmsg address;
+    }
+    message;
+}
+INTERFACE_REQUEST;
+
+static std::string format_ipv4(uint32_t address)
+{
+    char ip_address[INET_ADDRSTRLEN] = {0};
+    struct in_addr in_address;
+
+    in_address.s_addr = htonl(address);
+    inet_ntop(AF_INET, &in_address, ip_address, sizeof(ip_address));
+    return ip_address;
+}
+
+/* Checked once when a link is added or renamed, not on every lookup */
+static bool is_wireless_link(const std::string &name)
+{
+    std::string phy_path = std::string(INTERFACE_TABLE_SYSFS_NET_PATH) + name + "/phy80211";
+    return (!name.empty() && (0 == access(phy_path.c_str(), F_OK)));
+}
+
+MiracastInterfaceTable::MiracastInterfaceTable()
+    : m_event_handler(nullptr),
+      m_event_ctx(nullptr),
+      m_running(false),
+      m_sock_fd(-1),
+      m_stop_fd(-1),
+      m_sequence(0),
+      m_wireless_change_count(0),
+      m_table_thread_id(0)
+{
+}
+
+MiracastInterfaceTable::~MiracastInterfaceTable()
+{
+    stop();
+}
+
+bool MiracastInterfaceTable::open_socket(void)
+{
+    struct sockaddr_nl local_addr;
+
+    m_sock_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    m_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((0 > m_sock_fd) || (0 > m_stop_fd))
+    {
+        MIRACASTLOG_ERROR("Interface table sockets failed [%s]", strerror(errno));
+        close_sockets();
+        return false;
+    }
+
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.nl_family = AF_NETLINK;
+    local_addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+    if (0 != bind(m_sock_fd, reinterpret_cast<struct sockaddr *>(&local_addr), sizeof(local_addr)))
+    {
+        MIRACASTLOG_ERROR("rtnetlink bind failed [%s]", strerror(errno));
+        close_sockets();
+        return false;
+    }
+    return true;
+}
+
+void MiracastInterfaceTable::close_sockets(void)
+{
+    if (0 <= m_sock_fd)
+    {
+        close(m_sock_fd);
+        m_sock_fd = -1;
+    }
+    if (0 <= m_stop_fd)
+    {
+        close(m_stop_fd);
+        m_stop_fd = -1;
+    }
+}
+
+bool MiracastInterfaceTable::start(INTERFACE_EVENT_HANDLER handler, void *ctx)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    if (is_running())
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return true;
+    }
+
+    /* Subscribe before the dumps so a change in between is not missed */
+    if (!open_socket() || !synchronise())
+    {
+        MIRACASTLOG_ERROR("Unable to load the interface table");
+        close_sockets();
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    m_event_handler = handler;
+    m_event_ctx = ctx;
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        m_running = true;
+    }
+
+    if (0 != pthread_create(&m_table_thread_id, nullptr, MiracastInterfaceTable::table_thread, this))
+    {
+        MIRACASTLOG_ERROR("Interface table thread creation failed");
+        m_table_thread_id = 0;
+        stop();
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        MIRACASTLOG_INFO("Interface table loaded with %zu links and %zu IPv4 addresses", m_links.size(), m_addresses.size());
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return true;
+}
+
+void MiracastInterfaceTable::stop(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        m_running = false;
+    }
+    /* Waiters give up once the table is no longer maintained */
+    m_link_cond.notify_all();
+
+    if (0 != m_table_thread_id)
+    {
+        uint64_t value = 1;
+        if (sizeof(value) != write(m_stop_fd, &value, sizeof(value)))
+        {
+            MIRACASTLOG_ERROR("Unable to signal the interface table thread");
+        }
+        pthread_join(m_table_thread_id, nullptr);
+        m_table_thread_id = 0;
+    }
+    close_sockets();
+    m_event_handler = nullptr;
+    m_event_ctx = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        m_links.clear();
+        m_addresses.clear();
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+bool MiracastInterfaceTable::is_running(void)
+{
+    std::lock_guard<std::mutex> lock(m_table_mutex);
+    return m_running;
+}
+
+bool MiracastInterfaceTable::dump(uint16_t msg_type)
+{
+    INTERFACE_REQUEST request;
+    char buffer[INTERFACE_TABLE_RECV_BUFFER_SIZE];
+    uint32_t sequence = ++m_sequence;
+
+    memset(&request, 0, sizeof(request));
+    if (RTM_GETLINK == msg_type)
+    {
+        request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.message.link));
+        request.message.link.ifi_family = AF_UNSPEC;
+    }
+    else
+    {
+        request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.message.address));
+        request.message.address.ifa_family = AF_INET;
+    }
+    request.header.nlmsg_type = msg_type;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = sequence;
+
+    if (0 > send(m_sock_fd, &request, request.header.nlmsg_len, 0))
+    {
+        MIRACASTLOG_ERROR("Interface dump [%u] send failed [%s]", msg_type, strerror(errno));
+        return false;
+    }
+
+    while (true)
+    {
+        struct pollfd poll_fd = { m_sock_fd, POLLIN, 0 };
+        if (0 >= poll(&poll_fd, 1, INTERFACE_TABLE_REQUEST_TIMEOUT_MS))
+        {
+            MIRACASTLOG_ERROR("Interface dump [%u] timed out", msg_type);
+            return false;
+        }
+
+        ssize_t len = recv(m_sock_fd, buffer, sizeof(buffer), 0);
+        if (0 > len)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            MIRACASTLOG_ERROR("Interface dump [%u] recv failed [%s]", msg_type, strerror(errno));
+            return false;
+        }
+
+        for (struct nlmsghdr *msg_header = reinterpret_cast<struct nlmsghdr *>(buffer);
+             NLMSG_OK(msg_header, static_cast<unsigned int>(len));
+             msg_header = NLMSG_NEXT(msg_header, len))
+        {
+            if (sequence == msg_header->nlmsg_seq)
+            {
+                if (NLMSG_DONE == msg_header->nlmsg_type)
+                {
+                    return true;
+                }
+                if (NLMSG_ERROR == msg_header->nlmsg_type)
+                {
+                    MIRACASTLOG_ERROR("Interface dump [%u] failed", msg_type);
+                    return false;
+                }
+            }
+            /* Notifications interleaved with the dump are applied the same way */
+            apply_message(msg_header, nullptr);
+        }
+    }
+}
+
+bool MiracastInterfaceTable::synchronise(std::vector<INTERFACE_EVENT> *events)
+{
+    std::map<int, LINK_ENTRY> old_links;
+    std::vector<ADDRESS_ENTRY> old_addresses;
+    bool synchronised = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        old_links.swap(m_links);
+        old_addresses.swap(m_addresses);
+        ++m_wireless_change_count;
+    }
+    /* Links first so the address entries can be named */
+    synchronised = dump(RTM_GETLINK) && dump(RTM_GETADDR);
+    if (synchronised && (nullptr != events))
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        diff_tables(old_links, old_addresses, events);
+    }
+    m_link_cond.notify_all();
+    return synchronised;
+}
+
+void MiracastInterfaceTable::diff_tables(const std::map<int, LINK_ENTRY> &old_links,
+                                         const std::vector<ADDRESS_ENTRY> &old_addresses,
+                                         std::vector<INTERFACE_EVENT> *events)
+{
+    std::vector<ADDRESS_ENTRY> changed_addresses;
+    INTERFACE_EVENT event;
+
+    /* The changes the dropped notifications would have reported, removals first */
+    std::set_difference(old_addresses.begin(), old_addresses.end(),
+                        m_addresses.begin(), m_addresses.end(),
+                        std::back_inserter(changed_addresses), address_less);
+    for (const ADDRESS_ENTRY &entry : changed_addresses)
+    {
+        std::map<int, LINK_ENTRY>::const_iterator link_entry = old_links.find(entry.ifindex);
+
+        event.type = INTERFACE_EVENT_ADDRESS_REMOVED;
+        event.ifindex = entry.ifindex;
+        event.interface = (old_links.end() != link_entry) ? link_entry->second.name : "";
+        event.ip_address = format_ipv4(entry.address);
+        events->push_back(event);
+    }
+
+    event.ip_address.clear();
+    for (const std::pair<const int, LINK_ENTRY> &old_link : old_links)
+    {
+        std::map<int, LINK_ENTRY>::const_iterator link_entry = m_links.find(old_link.first);
+
+        if (old_link.second.up && ((m_links.end() == link_entry) || !link_entry->second.up))
+        {
+            event.type = INTERFACE_EVENT_LINK_DOWN;
+            event.ifindex = old_link.first;
+            event.interface = old_link.second.name;
+            events->push_back(event);
+        }
+    }
+    for (const std::pair<const int, LINK_ENTRY> &new_link : m_links)
+    {
+        std::map<int, LINK_ENTRY>::const_iterator link_entry = old_links.find(new_link.first);
+
+        if (new_link.second.up && ((old_links.end() == link_entry) || !link_entry->second.up))
+        {
+            event.type = INTERFACE_EVENT_LINK_UP;
+            event.ifindex = new_link.first;
+            event.interface = new_link.second.name;
+            events->push_back(event);
+        }
+    }
+
+    changed_addresses.clear();
+    std::set_difference(m_addresses.begin(), m_addresses.end(),
+                        old_addresses.begin(), old_addresses.end(),
+                        std::back_inserter(changed_addresses), address_less);
+    for (const ADDRESS_ENTRY &entry : changed_addresses)
+    {
+        std::map<int, LINK_ENTRY>::const_iterator link_entry = m_links.find(entry.ifindex);
+
+        event.type = INTERFACE_EVENT_ADDRESS_ASSIGNED;
+        event.ifindex = entry.ifindex;
+        event.interface = (m_links.end() != link_entry) ? link_entry->second.name : "";
+        event.ip_address = format_ipv4(entry.address);
+        events->push_back(event);
+    }
+}
+
+void MiracastInterfaceTable::apply_message(const struct nlmsghdr *msg_header, std::vector<INTERFACE_EVENT> *events)
+{
+    switch (msg_header->nlmsg_type)
+    {
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+        {
+            apply_link(msg_header, events);
+        }
+        break;
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+        {
+            apply_address(msg_header, events);
+        }
+        break;
+        default:
+        break;
+    }
+}
+
+void MiracastInterfaceTable::apply_link(const struct nlmsghdr *msg_header, std::vector<INTERFACE_EVENT> *events)
+{
+    const struct ifinfomsg *link = static_cast<const struct ifinfomsg *>(NLMSG_DATA(msg_header));
+    int attr_len = static_cast<int>(msg_header->nlmsg_len) - static_cast<int>(NLMSG_LENGTH(sizeof(*link)));
+    std::string name;
+    INTERFACE_EVENT event;
+
+    if ((0 > attr_len) || (AF_BRIDGE == link->ifi_family))
+    {
+        return;
+    }
+
+    for (const struct rtattr *attr = IFLA_RTA(link); RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len))
+    {
+        if (IFLA_IFNAME == attr->rta_type)
+        {
+            name.assign(static_cast<const char *>(RTA_DATA(attr)), strnlen(static_cast<const char *>(RTA_DATA(attr)), RTA_PAYLOAD(attr)));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_table_mutex);
+    std::map<int, LINK_ENTRY>::iterator link_entry = m_links.find(link->ifi_index);
+    bool was_up = (m_links.end() != link_entry) && link_entry->second.up;
+
+    event.ifindex = link->ifi_index;
+    if (RTM_DELLINK == msg_header->nlmsg_type)
+    {
+        if (m_links.end() == link_entry)
+        {
+            return;
+        }
+        event.interface = link_entry->second.name;
+        if (link_entry->second.wireless)
+        {
+            ++m_wireless_change_count;
+        }
+        m_links.erase(link_entry);
+        m_addresses.erase(std::remove_if(m_addresses.begin(),
+                                         m_addresses.end(),
+                                         [&event](const ADDRESS_ENTRY &entry) { return entry.ifindex == event.ifindex; }),
+                          m_addresses.end());
+        if (was_up && (nullptr != events))
+        {
+            event.type = INTERFACE_EVENT_LINK_DOWN;
+            events->push_back(std::move(event));
+        }
+        return;
+    }
+
+    LINK_ENTRY &entry = m_links[link->ifi_index];
+    if (!name.empty() && (name != entry.name))
+    {
+        entry.name = std::move(name);
+        entry.wireless = is_wireless_link(entry.name);
+    }
+    entry.up = ((0 != (link->ifi_flags & IFF_UP)) && (0 != (link->ifi_flags & IFF_RUNNING)));
+    if (entry.wireless && (was_up != entry.up))
+    {
+        ++m_wireless_change_count;
+    }
+
+    if ((was_up != entry.up) && (nullptr != events))
+    {
+        event.type = entry.up ? INTERFACE_EVENT_LINK_UP : INTERFACE_EVENT_LINK_DOWN;
+        event.interface = entry.name;
+        events->push_back(std::move(event));
+    }
+}
+
+void MiracastInterfaceTable::apply_address(const struct nlmsghdr *msg_header, std::vector<INTERFACE_EVENT> *events)
+{
+    const struct ifaddrmsg *address = static_cast<const struct ifaddrmsg *>(NLMSG_DATA(msg_header));
+    int attr_len = static_cast<int>(msg_header->nlmsg_len) - static_cast<int>(NLMSG_LENGTH(sizeof(*address)));
+    const struct rtattr *local_attr = nullptr;
+    const struct rtattr *address_attr = nullptr;
+    ADDRESS_ENTRY entry;
+
+    if ((0 > attr_len) || (AF_INET != address->ifa_family))
+    {
+        return;
+    }
+
+    for (const struct rtattr *attr = IFA_RTA(address); RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len))
+    {
+        if (sizeof(struct in_addr) != RTA_PAYLOAD(attr))
+        {
+            continue;
+        }
+        if (IFA_LOCAL == attr->rta_type)
+        {
+            local_attr = attr;
+        }
+        else if (IFA_ADDRESS == attr->rta_type)
+        {
+            address_attr = attr;
+        }
+    }
+    /* IFA_ADDRESS is the peer on point-to-point links, IFA_LOCAL is ours */
+    if (nullptr != local_attr)
+    {
+        address_attr = local_attr;
+    }
+    if (nullptr == address_attr)
+    {
+        return;
+    }
+
+    entry.address = ntohl(static_cast<const struct in_addr *>(RTA_DATA(address_attr))->s_addr);
+    entry.ifindex = static_cast<int>(address->ifa_index);
+
+    std::lock_guard<std::mutex> lock(m_table_mutex);
+    std::vector<ADDRESS_ENTRY>::iterator position = std::lower_bound(m_addresses.begin(), m_addresses.end(), entry, address_less);
+    bool present = (m_addresses.end() != position) &&
+                   (position->address == entry.address) &&
+                   (position->ifindex == entry.ifindex);
+    INTERFACE_EVENT event;
+
+    if (RTM_NEWADDR == msg_header->nlmsg_type)
+    {
+        if (present)
+        {
+            return;
+        }
+        m_addresses.insert(position, entry);
+        event.type = INTERFACE_EVENT_ADDRESS_ASSIGNED;
+    }
+    else
+    {
+        if (!present)
+        {
+            return;
+        }
+        m_addresses.erase(position);
+        event.type = INTERFACE_EVENT_ADDRESS_REMOVED;
+    }
+
+    std::map<int, LINK_ENTRY>::const_iterator address_link = m_links.find(entry.ifindex);
+    if ((m_links.end() != address_link) && address_link->second.wireless)
+    {
+        /* A new address on the station usually follows a (re)association */
+        ++m_wireless_change_count;
+    }
+
+    if (nullptr != events)
+    {
+        std::map<int, LINK_ENTRY>::const_iterator link_entry = m_links.find(entry.ifindex);
+
+        event.ifindex = entry.ifindex;
+        event.interface = (m_links.end() != link_entry) ? link_entry->second.name : "";
+        event.ip_address = format_ipv4(entry.address);
+        events->push_back(std::move(event));
+    }
+}
+
+bool MiracastInterfaceTable::address_less(const ADDRESS_ENTRY &lhs, const ADDRESS_ENTRY &rhs)
+{
+    return (lhs.address < rhs.address) || ((lhs.address == rhs.address) && (lhs.ifindex < rhs.ifindex));
+}
+
+const MiracastInterfaceTable::LINK_ENTRY *MiracastInterfaceTable::find_link(const std::string &interface, int *ifindex)
+{
+    /* Only a handful of links exist, a scan is cheaper than keeping a second index */
+    for (std::map<int, LINK_ENTRY>::const_iterator link_entry = m_links.begin(); m_links.end() != link_entry; ++link_entry)
+    {
+        if (interface == link_entry->second.name)
+        {
+            if (nullptr != ifindex)
+            {
+                *ifindex = link_entry->first;
+            }
+            return &link_entry->second;
+        }
+    }
+    return nullptr;
+}
+
+std::string MiracastInterfaceTable::find_interface_by_ipv4(const std::string &ip_address)
+{
+    struct in_addr in_address;
+    ADDRESS_ENTRY key;
+
+    if (1 != inet_pton(AF_INET, ip_address.c_str(), &in_address))
+    {
+        MIRACASTLOG_ERROR("Invalid IPv4 address [%s]", ip_address.c_str());
+        return "";
+    }
+    key.address = ntohl(in_address.s_addr);
+    key.ifindex = 0;
+
+    std::lock_guard<std::mutex> lock(m_table_mutex);
+    if (!m_running)
+    {
+        MIRACASTLOG_ERROR("Interface table not running, [%s] not looked up", ip_address.c_str());
+        return "";
+    }
+
+    std::vector<ADDRESS_ENTRY>::const_iterator position = std::lower_bound(m_addresses.begin(), m_addresses.end(), key, address_less);
+    for (; (m_addresses.end() != position) && (position->address == key.address); ++position)
+    {
+        std::map<int, LINK_ENTRY>::const_iterator link_entry = m_links.find(position->ifindex);
+        if (m_links.end() != link_entry)
+        {
+            return link_entry->second.name;
+        }
+    }
+    return "";
+}
+
+int MiracastInterfaceTable::get_ifindex(const std::string &interface)
+{
+    int ifindex = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        if (m_running)
+        {
+            find_link(interface, &ifindex);
+            return ifindex;
+        }
+    }
+    return static_cast<int>(if_nametoindex(interface.c_str()));
+}
+
+bool MiracastInterfaceTable::is_link_up(const std::string &interface)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_table_mutex);
+        if (m_running)
+        {
+            const LINK_ENTRY *link_entry = find_link(interface, nullptr);
+            return ((nullptr != link_entry) && link_entry->up);
+        }
+    }
+    /* Without the table only the presence of the link can be told */
+    return (0 != if_nametoindex(interface.c_str()));
+}
+
+std::string MiracastInterfaceTable::find_wireless_station(uint32_t &change_count)
+{
+    std::lock_guard<std::mutex> lock(m_table_mutex);
+
+    change_count = m_wireless_change_count;
+    if (!m_running)
+    {
+        return "";
+    }
+    for (std::map<int, LINK_ENTRY>::const_iterator link_entry = m_links.begin(); m_links.end() != link_entry; ++link_entry)
+    {
+        if (link_entry->second.wireless && link_entry->second.up &&
+            (0 != link_entry->second.name.compare(0, strlen("p2p"), "p2p")))
+        {
+            return link_entry->second.name;
+        }
+    }
+    return "";
+}
+
+bool MiracastInterfaceTable::wait_for_link_up(const std::string &interface, unsigned int timeout_ms)
+{
+    bool link_up = false;
+
+    MIRACASTLOG_TRACE("Entering...");
+    {
+        std::unique_lock<std::mutex> lock(m_table_mutex);
+        if (m_running)
+        {
+            m_link_cond.wait_for(lock,
+                                 std::chrono::milliseconds(timeout_ms),
+                                 [this, &interface, &link_up]()
+                                 {
+                                     const LINK_ENTRY *link_entry = find_link(interface, nullptr);
+                                     link_up = ((nullptr != link_entry) && link_entry->up);
+                                     return (link_up || !m_running);
+                                 });
+            if (!link_up)
+            {
+                MIRACASTLOG_ERROR("Link [%s] not up within %u ms", interface.c_str(), timeout_ms);
+            }
+            MIRACASTLOG_TRACE("Exiting...");
+            return link_up;
+        }
+    }
+    link_up = is_link_up(interface);
+    MIRACASTLOG_TRACE("Exiting...");
+    return link_up;
+}
+
+void MiracastInterfaceTable::notify(const std::vector<INTERFACE_EVENT> &events)
+{
+    if (nullptr == m_event_handler)
+    {
+        return;
+    }
+    for (const INTERFACE_EVENT &event : events)
+    {
+        m_event_handler(m_event_ctx, event);
+    }
+}
+
+void *MiracastInterfaceTable::table_thread(void *ctx)
+{
+    MiracastInterfaceTable *interface_table = static_cast<MiracastInterfaceTable *>(ctx);
+    interface_table->table_loop();
+    return nullptr;
+}
+
+void MiracastInterfaceTable::table_loop(void)
+{
+    char buffer[INTERFACE_TABLE_RECV_BUFFER_SIZE];
+    std::vector<INTERFACE_EVENT> events;
+
+    MIRACASTLOG_TRACE("Entering...");
+    while (true)
+    {
+        struct pollfd poll_fds[2] = { { m_sock_fd, POLLIN, 0 }, { m_stop_fd, POLLIN, 0 } };
+        int ready = poll(poll_fds, 2, -1);
+
+        if (0 > ready)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            MIRACASTLOG_ERROR("Interface table poll failed [%s]", strerror(errno));
+            break;
+        }
+        if (poll_fds[1].revents & POLLIN)
+        {
+            break;
+        }
+        if (0 == (poll_fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        ssize_t len = recv(m_sock_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (0 > len)
+        {
+            if (ENOBUFS == errno)
+            {
+                /* Notifications were lost, reload both tables */
+                MIRACASTLOG_WARNING("Interface notifications overrun, dumping the tables again");
+                if (!synchronise(&events))
+                {
+                    MIRACASTLOG_ERROR("Interface table resync failed");
+                }
+                notify(events);
+                events.clear();
+            }
+            continue;
+        }
+
+        for (struct nlmsghdr *msg_header = reinterpret_cast<struct nlmsghdr *>(buffer);
+             NLMSG_OK(msg_header, static_cast<unsigned int>(len));
+             msg_header = NLMSG_NEXT(msg_header, len))
+        {
+            apply_message(msg_header, &events);
+        }
+        if (!events.empty())
+        {
+            m_link_cond.notify_all();
+            notify(events);
+            events.clear();
+        }
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
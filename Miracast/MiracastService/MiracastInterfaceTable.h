@@ -0,0 +1,143 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_INTERFACE_TABLE_H_
+#define _MIRACAST_INTERFACE_TABLE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <pthread.h>
+#include <stdint.h>
+#include <MiracastLogger.h>
+
+struct nlmsghdr;
+
+#define INTERFACE_TABLE_RECV_BUFFER_SIZE    (16384)
+#define INTERFACE_TABLE_REQUEST_TIMEOUT_MS  (1000)
+#define INTERFACE_TABLE_SYSFS_NET_PATH      "/sys/class/net/"
+
+typedef enum interface_event_type_e
+{
+    INTERFACE_EVENT_LINK_UP = 0,
+    INTERFACE_EVENT_LINK_DOWN,
+    INTERFACE_EVENT_ADDRESS_ASSIGNED,
+    INTERFACE_EVENT_ADDRESS_REMOVED
+}
+INTERFACE_EVENT_TYPE;
+
+typedef struct interface_event_st
+{
+    INTERFACE_EVENT_TYPE type;
+    int ifindex;
+    std::string interface;
+    /* Only set for the address events */
+    std::string ip_address;
+}
+INTERFACE_EVENT;
+
+/* Runs on the table thread without the table lock held, must not block */
+typedef void (*INTERFACE_EVENT_HANDLER)(void *ctx, const INTERFACE_EVENT &event);
+
+/**
+ * In-memory copy of the IPv4 interface and address tables. A worker keeps it
+ * current from RTM_NEWLINK/RTM_DELLINK and RTM_NEWADDR/RTM_DELADDR so lookups
+ * by address or name are answered without a syscall, and link-up and
+ * address-assigned changes are handed to the registered handler as they
+ * happen instead of being polled for.
+ */
+class MiracastInterfaceTable
+{
+public:
+    MiracastInterfaceTable();
+    ~MiracastInterfaceTable();
+
+    bool start(INTERFACE_EVENT_HANDLER handler = nullptr, void *ctx = nullptr);
+    void stop(void);
+    bool is_running(void);
+
+    /* Interface holding ip_address, empty when no interface has it */
+    std::string find_interface_by_ipv4(const std::string &ip_address);
+    /* Returns 0 when the interface does not exist */
+    int get_ifindex(const std::string &interface);
+    bool is_link_up(const std::string &interface);
+    /* Waits up to timeout_ms for the interface to appear and come up */
+    bool wait_for_link_up(const std::string &interface, unsigned int timeout_ms);
+    /*
+     * First wireless (cfg80211) link that is up and is not a P2P interface,
+     * empty when there is none. change_count moves whenever a wireless link
+     * goes up or down or one of its addresses changes, so a caller can keep
+     * what it learnt about the station until the count moves.
+     */
+    std::string find_wireless_station(uint32_t &change_count);
+
+private:
+    typedef struct link_entry_st
+    {
+        std::string name;
+        bool up;
+        bool wireless;
+    }
+    LINK_ENTRY;
+
+    typedef struct address_entry_st
+    {
+        /* Host byte order so the index sorts numerically */
+        uint32_t address;
+        int ifindex;
+    }
+    ADDRESS_ENTRY;
+
+    std::mutex m_table_mutex;
+    std::condition_variable m_link_cond;
+    /* Keyed by ifindex */
+    std::map<int, LINK_ENTRY> m_links;
+    /* Sorted by address then ifindex, searched with lower_bound */
+    std::vector<ADDRESS_ENTRY> m_addresses;
+    INTERFACE_EVENT_HANDLER m_event_handler;
+    void *m_event_ctx;
+    bool m_running;
+    int m_sock_fd;
+    int m_stop_fd;
+    uint32_t m_sequence;
+    uint32_t m_wireless_change_count;
+    pthread_t m_table_thread_id;
+
+    bool open_socket(void);
+    void close_sockets(void);
+    bool dump(uint16_t msg_type);
+    /* Reloads both tables, events gets what changed against the old copy */
+    bool synchronise(std::vector<INTERFACE_EVENT> *events = nullptr);
+    void diff_tables(const std::map<int, LINK_ENTRY> &old_links,
+                     const std::vector<ADDRESS_ENTRY> &old_addresses,
+                     std::vector<INTERFACE_EVENT> *events);
+    void apply_message(const struct nlmsghdr *msg_header, std::vector<INTERFACE_EVENT> *events);
+    void apply_link(const struct nlmsghdr *msg_header, std::vector<INTERFACE_EVENT> *events);
+    void apply_address(const struct nlmsghdr *msg_header, std::vector<INTERFACE_EVENT> *events);
+    const LINK_ENTRY *find_link(const std::string &interface, int *ifindex);
+    void notify(const std::vector<INTERFACE_EVENT> &events);
+    static bool address_less(const ADDRESS_ENTRY &lhs, const ADDRESS_ENTRY &rhs);
+
+    static void *table_thread(void *ctx);
+    void table_loop(void);
+};
+
+#endif /* _MIRACAST_INTERFACE_TABLE_H_ */
@@ -0,0 +1,485 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <unistd.h>
+#include <poll.h>
+#include <strings.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+#include "MiracastNeighborTable.h"
+
+#define NEIGHBOR_RESOLVED_STATES (NUD_REACHABLE | NUD_STALE | NUD_DELAY | NUD_PROBE | NUD_PERMANENT | NUD_NOARP)
+
+typedef struct neighbor_request_st
+{
+    struct nlmsghdr header;
+    struct ndmsg message;
+    char attributes[64];
+}
+NEIGHBOR_REQUEST;
+
+static std::string format_mac(const unsigned char *addr, size_t len)
+{
+    char mac[18] = {0};
+
+    if (6 != len)
+    {
+        return "";
+    }
+    snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
+             addr[0], addr[1], addr[2], addr[3], addr[4], addr[5]);
+    return mac;
+}
+
+MiracastNeighborTable::MiracastNeighborTable()
+    : m_sequence(0)
+{
+}
+
+MiracastNeighborTable::~MiracastNeighborTable()
+{
+}
+
+int MiracastNeighborTable::open_socket(uint32_t groups)
+{
+    struct sockaddr_nl local_addr;
+    int sock_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+
+    if (0 > sock_fd)
+    {
+        MIRACASTLOG_ERROR("rtnetlink socket failed [%s]", strerror(errno));
+        return -1;
+    }
+
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.nl_family = AF_NETLINK;
+    local_addr.nl_groups = groups;
+    if (0 != bind(sock_fd, reinterpret_cast<struct sockaddr *>(&local_addr), sizeof(local_addr)))
+    {
+        MIRACASTLOG_ERROR("rtnetlink bind failed [%s]", strerror(errno));
+        close(sock_fd);
+        return -1;
+    }
+    return sock_fd;
+}
+
+bool MiracastNeighborTable::parse_entry(const struct nlmsghdr *msg_header, NEIGHBOR_ENTRY &entry)
+{
+    const struct ndmsg *neighbor = static_cast<const struct ndmsg *>(NLMSG_DATA(msg_header));
+    int attr_len = static_cast<int>(msg_header->nlmsg_len) - static_cast<int>(NLMSG_LENGTH(sizeof(*neighbor)));
+
+    if ((0 > attr_len) || (AF_INET != neighbor->ndm_family))
+    {
+        return false;
+    }
+
+    entry.ifindex = neighbor->ndm_ifindex;
+    entry.state = neighbor->ndm_state;
+    entry.ip_address.clear();
+    entry.mac_address.clear();
+
+    for (const struct rtattr *attr = reinterpret_cast<const struct rtattr *>(
+             reinterpret_cast<const char *>(neighbor) + NLMSG_ALIGN(sizeof(*neighbor)));
+         RTA_OK(attr, attr_len);
+         attr = RTA_NEXT(attr, attr_len))
+    {
+        if ((NDA_DST == attr->rta_type) && (sizeof(struct in_addr) == RTA_PAYLOAD(attr)))
+        {
+            char ip_address[INET_ADDRSTRLEN] = {0};
+            inet_ntop(AF_INET, RTA_DATA(attr), ip_address, sizeof(ip_address));
+            entry.ip_address = ip_address;
+        }
+        else if (NDA_LLADDR == attr->rta_type)
+        {
+            entry.mac_address = format_mac(static_cast<const unsigned char *>(RTA_DATA(attr)), RTA_PAYLOAD(attr));
+        }
+    }
+    return (!entry.ip_address.empty());
+}
+
+bool MiracastNeighborTable::is_resolved(const NEIGHBOR_ENTRY &entry)
+{
+    return ((0 != (entry.state & NEIGHBOR_RESOLVED_STATES)) &&
+            (!entry.mac_address.empty()) &&
+            ("00:00:00:00:00:00" != entry.mac_address));
+}
+
+bool MiracastNeighborTable::matches(const NEIGHBOR_ENTRY &entry, int ifindex, const std::string &mac)
+{
+    return (((0 == ifindex) || (ifindex == entry.ifindex)) &&
+            is_resolved(entry) &&
+            (0 == strcasecmp(entry.mac_address.c_str(), mac.c_str())));
+}
+
+bool MiracastNeighborTable::dump(int sock_fd, std::vector<NEIGHBOR_ENTRY> &entries)
+{
+    NEIGHBOR_REQUEST request;
+    char buffer[NEIGHBOR_TABLE_RECV_BUFFER_SIZE];
+    uint32_t sequence = ++m_sequence;
+
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.message));
+    request.header.nlmsg_type = RTM_GETNEIGH;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = sequence;
+    request.message.ndm_family = AF_INET;
+
+    if (0 > send(sock_fd, &request, request.header.nlmsg_len, 0))
+    {
+        MIRACASTLOG_ERROR("RTM_GETNEIGH send failed [%s]", strerror(errno));
+        return false;
+    }
+
+    while (true)
+    {
+        struct pollfd poll_fd = { sock_fd, POLLIN, 0 };
+        if (0 >= poll(&poll_fd, 1, NEIGHBOR_TABLE_REQUEST_TIMEOUT_MS))
+        {
+            MIRACASTLOG_ERROR("RTM_GETNEIGH dump timed out");
+            return false;
+        }
+
+        ssize_t len = recv(sock_fd, buffer, sizeof(buffer), 0);
+        if (0 > len)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            MIRACASTLOG_ERROR("RTM_GETNEIGH recv failed [%s]", strerror(errno));
+            return false;
+        }
+
+        for (struct nlmsghdr *msg_header = reinterpret_cast<struct nlmsghdr *>(buffer);
+             NLMSG_OK(msg_header, static_cast<unsigned int>(len));
+             msg_header = NLMSG_NEXT(msg_header, len))
+        {
+            if (sequence != msg_header->nlmsg_seq)
+            {
+                /* Multicast notifications share the socket when it is subscribed */
+                if (RTM_NEWNEIGH == msg_header->nlmsg_type)
+                {
+                    NEIGHBOR_ENTRY entry;
+                    if (parse_entry(msg_header, entry))
+                    {
+                        entries.push_back(std::move(entry));
+                    }
+                }
+                continue;
+            }
+            if (NLMSG_DONE == msg_header->nlmsg_type)
+            {
+                return true;
+            }
+            if (NLMSG_ERROR == msg_header->nlmsg_type)
+            {
+                MIRACASTLOG_ERROR("RTM_GETNEIGH dump failed");
+                return false;
+            }
+            if (RTM_NEWNEIGH == msg_header->nlmsg_type)
+            {
+                NEIGHBOR_ENTRY entry;
+                if (parse_entry(msg_header, entry))
+                {
+                    entries.push_back(std::move(entry));
+                }
+            }
+        }
+    }
+}
+
+bool MiracastNeighborTable::wait_for_ack(int sock_fd, uint32_t sequence)
+{
+    char buffer[NEIGHBOR_TABLE_RECV_BUFFER_SIZE];
+
+    while (true)
+    {
+        struct pollfd poll_fd = { sock_fd, POLLIN, 0 };
+        if (0 >= poll(&poll_fd, 1, NEIGHBOR_TABLE_REQUEST_TIMEOUT_MS))
+        {
+            return false;
+        }
+
+        ssize_t len = recv(sock_fd, buffer, sizeof(buffer), 0);
+        if (0 > len)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        for (struct nlmsghdr *msg_header = reinterpret_cast<struct nlmsghdr *>(buffer);
+             NLMSG_OK(msg_header, static_cast<unsigned int>(len));
+             msg_header = NLMSG_NEXT(msg_header, len))
+        {
+            if ((sequence == msg_header->nlmsg_seq) && (NLMSG_ERROR == msg_header->nlmsg_type))
+            {
+                const struct nlmsgerr *error = static_cast<const struct nlmsgerr *>(NLMSG_DATA(msg_header));
+                /* Already gone is as good as removed */
+                return ((0 == error->error) || (-ENOENT == error->error));
+            }
+        }
+    }
+}
+
+bool MiracastNeighborTable::delete_entry(int sock_fd, const NEIGHBOR_ENTRY &entry)
+{
+    NEIGHBOR_REQUEST request;
+    struct rtattr *attr = nullptr;
+    struct in_addr ip_address;
+    uint32_t sequence = ++m_sequence;
+
+    if (1 != inet_pton(AF_INET, entry.ip_address.c_str(), &ip_address))
+    {
+        return false;
+    }
+
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.message));
+    request.header.nlmsg_type = RTM_DELNEIGH;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    request.header.nlmsg_seq = sequence;
+    request.message.ndm_family = AF_INET;
+    request.message.ndm_ifindex = entry.ifindex;
+
+    attr = reinterpret_cast<struct rtattr *>(reinterpret_cast<char *>(&request) + NLMSG_ALIGN(request.header.nlmsg_len));
+    attr->rta_type = NDA_DST;
+    attr->rta_len = RTA_LENGTH(sizeof(ip_address));
+    memcpy(RTA_DATA(attr), &ip_address, sizeof(ip_address));
+    request.header.nlmsg_len = NLMSG_ALIGN(request.header.nlmsg_len) + RTA_ALIGN(attr->rta_len);
+
+    if (0 > send(sock_fd, &request, request.header.nlmsg_len, 0))
+    {
+        MIRACASTLOG_ERROR("RTM_DELNEIGH send failed [%s]", strerror(errno));
+        return false;
+    }
+    return wait_for_ack(sock_fd, sequence);
+}
+
+bool MiracastNeighborTable::find_ip_by_mac(const std::string &interface, const std::string &mac, std::string &ip_address)
+{
+    std::vector<NEIGHBOR_ENTRY> entries;
+    int ifindex = interface.empty() ? 0 : static_cast<int>(if_nametoindex(interface.c_str()));
+    int sock_fd = -1;
+    bool found = false;
+
+    MIRACASTLOG_TRACE("Entering...");
+    if (mac.empty() || ((!interface.empty()) && (0 == ifindex)))
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    sock_fd = open_socket(0);
+    if ((0 <= sock_fd) && dump(sock_fd, entries))
+    {
+        for (const NEIGHBOR_ENTRY &entry : entries)
+        {
+            if (matches(entry, ifindex, mac))
+            {
+                ip_address = entry.ip_address;
+                found = true;
+                break;
+            }
+        }
+    }
+    if (0 <= sock_fd)
+    {
+        close(sock_fd);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return found;
+}
+
+bool MiracastNeighborTable::wait_for_ip_by_mac(const std::string &interface,
+                                               const std::string &mac,
+                                               std::string &ip_address,
+                                               unsigned int timeout_ms)
+{
+    std::vector<NEIGHBOR_ENTRY> entries;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    int ifindex = interface.empty() ? 0 : static_cast<int>(if_nametoindex(interface.c_str()));
+    int sock_fd = -1;
+    bool found = false;
+
+    MIRACASTLOG_TRACE("Entering...");
+    if (mac.empty() || ((!interface.empty()) && (0 == ifindex)))
+    {
+        MIRACASTLOG_ERROR("Invalid neighbor lookup mac[%s] interface[%s]", mac.c_str(), interface.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    /* Subscribe before the dump so an entry learnt in between is not missed */
+    sock_fd = open_socket(RTMGRP_NEIGH);
+    if ((0 > sock_fd) || !dump(sock_fd, entries))
+    {
+        if (0 <= sock_fd)
+        {
+            close(sock_fd);
+        }
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    while (!found)
+    {
+        for (const NEIGHBOR_ENTRY &entry : entries)
+        {
+            if (matches(entry, ifindex, mac))
+            {
+                ip_address = entry.ip_address;
+                found = true;
+                break;
+            }
+        }
+        entries.clear();
+        if (found)
+        {
+            break;
+        }
+
+        long long remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (0 >= remaining_ms)
+        {
+            break;
+        }
+
+        struct pollfd poll_fd = { sock_fd, POLLIN, 0 };
+        int ready = poll(&poll_fd, 1, static_cast<int>(remaining_ms));
+        if ((0 > ready) && (EINTR != errno))
+        {
+            MIRACASTLOG_ERROR("Neighbor notification poll failed [%s]", strerror(errno));
+            break;
+        }
+        if (0 >= ready)
+        {
+            continue;
+        }
+
+        char buffer[NEIGHBOR_TABLE_RECV_BUFFER_SIZE];
+        ssize_t len = recv(sock_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (0 > len)
+        {
+            if (ENOBUFS == errno)
+            {
+                /* Notifications were lost, resynchronise with a full dump */
+                MIRACASTLOG_WARNING("Neighbor notifications overrun, dumping the table again");
+                if (!dump(sock_fd, entries))
+                {
+                    break;
+                }
+            }
+            continue;
+        }
+        for (struct nlmsghdr *msg_header = reinterpret_cast<struct nlmsghdr *>(buffer);
+             NLMSG_OK(msg_header, static_cast<unsigned int>(len));
+             msg_header = NLMSG_NEXT(msg_header, len))
+        {
+            NEIGHBOR_ENTRY entry;
+            if ((RTM_NEWNEIGH == msg_header->nlmsg_type) && parse_entry(msg_header, entry))
+            {
+                entries.push_back(std::move(entry));
+            }
+        }
+    }
+    close(sock_fd);
+
+    if (found)
+    {
+        MIRACASTLOG_INFO("Neighbor [%s] resolved to [%s]", mac.c_str(), ip_address.c_str());
+    }
+    else
+    {
+        MIRACASTLOG_ERROR("Neighbor [%s] not learnt on [%s] within %u ms", mac.c_str(), interface.c_str(), timeout_ms);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return found;
+}
+
+bool MiracastNeighborTable::has_entry(const std::string &ip_address)
+{
+    std::vector<NEIGHBOR_ENTRY> entries;
+    int sock_fd = open_socket(0);
+    bool present = false;
+
+    if ((0 <= sock_fd) && dump(sock_fd, entries))
+    {
+        for (const NEIGHBOR_ENTRY &entry : entries)
+        {
+            if (ip_address == entry.ip_address)
+            {
+                present = true;
+                break;
+            }
+        }
+    }
+    if (0 <= sock_fd)
+    {
+        close(sock_fd);
+    }
+    return present;
+}
+
+bool MiracastNeighborTable::remove_entry(const std::string &ip_address)
+{
+    std::vector<NEIGHBOR_ENTRY> entries;
+    int sock_fd = open_socket(0);
+    bool removed = true;
+
+    MIRACASTLOG_TRACE("Entering...");
+    if ((0 > sock_fd) || !dump(sock_fd, entries))
+    {
+        if (0 <= sock_fd)
+        {
+            close(sock_fd);
+        }
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    for (const NEIGHBOR_ENTRY &entry : entries)
+    {
+        if (ip_address != entry.ip_address)
+        {
+            continue;
+        }
+        if (delete_entry(sock_fd, entry))
+        {
+            MIRACASTLOG_INFO("Neighbor entry [%s] removed from ifindex[%d]", ip_address.c_str(), entry.ifindex);
+        }
+        else
+        {
+            MIRACASTLOG_ERROR("Unable to remove neighbor entry [%s] from ifindex[%d]", ip_address.c_str(), entry.ifindex);
+            removed = false;
+        }
+    }
+    close(sock_fd);
+    MIRACASTLOG_TRACE("Exiting...");
+    return removed;
+}
@@ -0,0 +1,86 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_NEIGHBOR_TABLE_H_
+#define _MIRACAST_NEIGHBOR_TABLE_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <MiracastLogger.h>
+
+struct nlmsghdr;
+
+#define NEIGHBOR_TABLE_RECV_BUFFER_SIZE     (16384)
+#define NEIGHBOR_TABLE_REQUEST_TIMEOUT_MS   (1000)
+
+typedef struct neighbor_entry_st
+{
+    int ifindex;
+    std::string ip_address;
+    std::string mac_address;
+    uint16_t state;
+}
+NEIGHBOR_ENTRY;
+
+/* Neighbor table access of the controller, L1 tests install their own through MiracastController */
+class MiracastNeighborTableInterface
+{
+public:
+    virtual ~MiracastNeighborTableInterface() {}
+
+    virtual bool find_ip_by_mac(const std::string &interface, const std::string &mac, std::string &ip_address) = 0;
+    virtual bool wait_for_ip_by_mac(const std::string &interface, const std::string &mac, std::string &ip_address, unsigned int timeout_ms) = 0;
+    virtual bool has_entry(const std::string &ip_address) = 0;
+    virtual bool remove_entry(const std::string &ip_address) = 0;
+};
+
+/**
+ * IPv4 neighbor (ARP) table access over rtnetlink. Lookups and removals talk
+ * to the kernel directly instead of going through arp and awk, and a lookup
+ * can subscribe to RTM_NEWNEIGH so it completes as soon as the kernel learns
+ * the peer instead of at the next poll.
+ */
+class MiracastNeighborTable : public MiracastNeighborTableInterface
+{
+public:
+    MiracastNeighborTable();
+    ~MiracastNeighborTable() override;
+
+    /* A resolved entry whose link address matches mac, interface may be empty for any */
+    bool find_ip_by_mac(const std::string &interface, const std::string &mac, std::string &ip_address) override;
+    /* Same as find_ip_by_mac but waits up to timeout_ms for the kernel to learn the entry */
+    bool wait_for_ip_by_mac(const std::string &interface, const std::string &mac, std::string &ip_address, unsigned int timeout_ms) override;
+    bool has_entry(const std::string &ip_address) override;
+    /* Returns true once no entry for ip_address is left on any interface */
+    bool remove_entry(const std::string &ip_address) override;
+
+private:
+    uint32_t m_sequence;
+
+    int open_socket(uint32_t groups);
+    bool dump(int sock_fd, std::vector<NEIGHBOR_ENTRY> &entries);
+    bool delete_entry(int sock_fd, const NEIGHBOR_ENTRY &entry);
+    bool wait_for_ack(int sock_fd, uint32_t sequence);
+    static bool parse_entry(const struct nlmsghdr *msg_header, NEIGHBOR_ENTRY &entry);
+    static bool is_resolved(const NEIGHBOR_ENTRY &entry);
+    static bool matches(const NEIGHBOR_ENTRY &entry, int ifindex, const std::string &mac);
+};
+
+#endif /* _MIRACAST_NEIGHBOR_TABLE_H_ */
@@ -34,6 +34,8 @@ using PowerState = WPEFramework::Exchange::IPowerManager::PowerState;
 #define SYSTEM_CALLSIGN_VER SYSTEM_CALLSIGN ".1"
 #define WIFI_CALLSIGN "org.rdk.Wifi"
 #define WIFI_CALLSIGN_VER WIFI_CALLSIGN ".1"
+#define NETWORKMANAGER_CALLSIGN "org.rdk.NetworkManager"
+#define NETWORKMANAGER_CALLSIGN_VER NETWORKMANAGER_CALLSIGN ".1"
 #define SECURITY_TOKEN_LEN_MAX 1024
 #define THUNDER_RPC_TIMEOUT 2000
 
@@ -52,7 +54,7 @@ namespace WPEFramework
         MiracastController *MiracastServiceImplementation::m_miracast_ctrler_obj = nullptr;
     
         MiracastServiceImplementation::MiracastServiceImplementation()
-        : _adminLock(), _pwrMgrNotification(*this)
+        : _adminLock(), _pwrMgrNotification(*this), _pluginStateNotification(*this), _playerNotification(*this)
         {
             LOGINFO("Create MiracastServiceImplementation Instance");
             MiracastServiceImplementation::_instance = this;
@@ -80,12 +82,7 @@ namespace WPEFramework
             _adminLock.Lock();
 
             // Make sure we can't register the same notification callback multiple times
-            if (std::find(_miracastServiceNotification.begin(), _miracastServiceNotification.end(), notification) == _miracastServiceNotification.end())
-            {
-                _miracastServiceNotification.push_back(notification);
-                notification->AddRef();
-            }
-            else
+            if (!_miracastServiceNotification.add(notification))
             {
                 MIRACASTLOG_ERROR("same notification is registered already");
             }
@@ -108,12 +105,9 @@ namespace WPEFramework
             _adminLock.Lock();
 
             // we just unregister one notification once
-            auto itr = std::find(_miracastServiceNotification.begin(), _miracastServiceNotification.end(), notification);
-            if (itr != _miracastServiceNotification.end())
+            if (_miracastServiceNotification.remove(notification))
             {
-                (*itr)->Release();
                 MIRACASTLOG_INFO("Unregister notification");
-                _miracastServiceNotification.erase(itr);
                 status = Core::ERROR_NONE;
             }
             else
@@ -220,6 +214,16 @@ namespace WPEFramework
                 {
                     MIRACASTLOG_INFO("JSONRPC: %s: initialization ok", WIFI_CALLSIGN_VER);
                 }
+
+                m_NetworkManagerPluginObj = new WPEFramework::JSONRPC::LinkType<Core::JSON::IElement>(_T(NETWORKMANAGER_CALLSIGN_VER), (_T("MiracastService")), false, query);
+                if (nullptr == m_NetworkManagerPluginObj)
+                {
+                    MIRACASTLOG_ERROR("JSONRPC: %s: initialization failed", NETWORKMANAGER_CALLSIGN_VER);
+                }
+                else
+                {
+                    MIRACASTLOG_INFO("JSONRPC: %s: initialization ok", NETWORKMANAGER_CALLSIGN_VER);
+                }
             }
             MIRACASTLOG_TRACE("Exiting ...");
         }
@@ -280,103 +284,112 @@ namespace WPEFramework
         /*  Helper and Internal methods End */
         /* ------------------------------------------------------------------------------------------------------- */
 
-        void MiracastServiceImplementation::dispatchEvent(Event event, const JsonObject &params)
+        void MiracastServiceImplementation::dispatchEvent(Event event, ServiceEventParams &&params)
         {
-            Core::IWorkerPool::Instance().Submit(Job::Create(this, event, params));
+            Core::IWorkerPool::Instance().Submit(Job::Create(this, event, std::move(params)));
         }
 
-        void MiracastServiceImplementation::Dispatch(Event event,const JsonObject& params)
+        void MiracastServiceImplementation::Dispatch(Event event, const ServiceEventParams &params)
         {
-            _adminLock.Lock();
+            MiracastNotificationList<Exchange::IMiracastService::INotification>::NOTIFICATION_SNAPSHOT listeners;
 
-            std::list<Exchange::IMiracastService::INotification *>::const_iterator index(_miracastServiceNotification.begin());
+            /* Listeners are called on the snapshot, a slow one cannot hold up Register/Unregister */
+            _adminLock.Lock();
+            listeners = _miracastServiceNotification.snapshot();
+            _adminLock.Unlock();
 
             switch (event)
             {
                 case MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_REQUEST:
                 {
-                    string clientMac = "";
-                    string clientName = "";
+                    const ClientConnectionRequestParams *request = boost::get<ClientConnectionRequestParams>(&params);
 
-                    if (!(params.HasLabel("source_dev_mac") && !(clientMac = params["source_dev_mac"].String()).empty()))
+                    if (nullptr == request)
+                    {
+                        MIRACASTLOG_ERROR("MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_REQUEST: Invalid parameters");
+                    }
+                    else if (request->clientMac.empty())
                     {
                         MIRACASTLOG_ERROR("source_dev_mac not present or empty");
                     }
-                    else if (!(params.HasLabel("source_dev_name") && !(clientName = params["source_dev_name"].String()).empty()))
+                    else if (request->clientName.empty())
                     {
                         MIRACASTLOG_ERROR("source_dev_name not present or empty");
                     }
                     else
                     {
-                        MIRACASTLOG_INFO("Notifying CLIENT_CONNECTION_REQUEST Event ClientMac[%s] ClientName[%s]", clientMac.c_str(), clientName.c_str());
-                        while (index != _miracastServiceNotification.end())
+                        MIRACASTLOG_INFO("Notifying CLIENT_CONNECTION_REQUEST Event ClientMac[%s] ClientName[%s]", request->clientMac.c_str(), request->clientName.c_str());
+                        for (Exchange::IMiracastService::INotification *notification : *listeners)
                         {
-                            (*index)->OnClientConnectionRequest(clientMac , clientName );
-                            ++index;
+                            notification->OnClientConnectionRequest(request->clientMac, request->clientName);
                         }
                     }
                 }
                 break;
                 case MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_ERROR:
                 {
-                    string clientMac = "";
-                    string clientName = "";
-                    string reasonCodeStr = "";
-                    MiracastServiceReasonCode reason = WPEFramework::Exchange::IMiracastService::REASON_CODE_SUCCESS;
+                    const ClientConnectionErrorParams *error = boost::get<ClientConnectionErrorParams>(&params);
 
-                    if (!(params.HasLabel("source_dev_mac") && !(clientMac = params["source_dev_mac"].String()).empty()))
+                    if (nullptr == error)
                     {
-                        MIRACASTLOG_ERROR("source_dev_mac not present or empty");
+                        MIRACASTLOG_ERROR("MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_ERROR: Invalid parameters");
                     }
-                    else if (!(params.HasLabel("source_dev_name") && !(clientName = params["source_dev_name"].String()).empty()))
+                    else if (error->clientMac.empty())
                     {
-                        MIRACASTLOG_ERROR("source_dev_name not present or empty");
+                        MIRACASTLOG_ERROR("source_dev_mac not present or empty");
                     }
-                    else if (!(params.HasLabel("reason_code")))
+                    else if (error->clientName.empty())
                     {
-                        MIRACASTLOG_ERROR("reason_code not present or empty");
+                        MIRACASTLOG_ERROR("source_dev_name not present or empty");
                     }
                     else
                     {
-                        reason = static_cast<MiracastServiceReasonCode>(params["reason_code"].Number());
-                        reasonCodeStr = std::to_string(reason);
-                        MIRACASTLOG_INFO("Notifying CLIENT_CONNECTION_ERROR Event Mac[%s] Name[%s] Reason[%u]",clientMac.c_str(), clientName.c_str(), reason);
-                        while (index != _miracastServiceNotification.end())
+                        string reasonCodeStr = std::to_string(error->reasonCode);
+                        MIRACASTLOG_INFO("Notifying CLIENT_CONNECTION_ERROR Event Mac[%s] Name[%s] Reason[%u]",error->clientMac.c_str(), error->clientName.c_str(), error->reasonCode);
+                        for (Exchange::IMiracastService::INotification *notification : *listeners)
                         {
-                            (*index)->OnClientConnectionError(clientMac , clientName , reasonCodeStr , reason);
-                            ++index;
+                            notification->OnClientConnectionError(error->clientMac, error->clientName, reasonCodeStr, error->reasonCode);
                         }
                     }
                 }
                 break;
                 case MIRACASTSERVICE_EVENT_PLAYER_LAUNCH_REQUEST:
                 {
-                    DeviceParameters deviceParameters;
-                    if (!(params.HasLabel("source_dev_mac") && !(deviceParameters.sourceDeviceMac = params["source_dev_mac"].String()).empty()))
+                    const LaunchRequestParams *launch = boost::get<LaunchRequestParams>(&params);
+
+                    if (nullptr == launch)
+                    {
+                        MIRACASTLOG_ERROR("MIRACASTSERVICE_EVENT_PLAYER_LAUNCH_REQUEST: Invalid parameters");
+                    }
+                    else if (launch->sourceDeviceMac.empty())
                     {
                         MIRACASTLOG_ERROR("source_dev_mac not present or empty");
                     }
-                    else if (!(params.HasLabel("source_dev_name") && !(deviceParameters.sourceDeviceName = params["source_dev_name"].String()).empty()))
+                    else if (launch->sourceDeviceName.empty())
                     {
                         MIRACASTLOG_ERROR("source_dev_name not present or empty");
                     }
-                    else if (!(params.HasLabel("source_dev_ip") && !(deviceParameters.sourceDeviceIP = params["source_dev_ip"].String()).empty()))
+                    else if (launch->sourceDeviceIP.empty())
                     {
                         MIRACASTLOG_ERROR("source_dev_ip not present or empty");
                     }
-                    else if (!(params.HasLabel("sink_dev_ip") && !(deviceParameters.sinkDeviceIP = params["sink_dev_ip"].String()).empty()))
+                    else if (launch->sinkDeviceIP.empty())
                     {
                         MIRACASTLOG_ERROR("sink_dev_ip not present or empty");
                     }
                     else
                     {
+                        DeviceParameters deviceParameters;
+                        deviceParameters.sourceDeviceIP = launch->sourceDeviceIP;
+                        deviceParameters.sourceDeviceMac = launch->sourceDeviceMac;
+                        deviceParameters.sourceDeviceName = launch->sourceDeviceName;
+                        deviceParameters.sinkDeviceIP = launch->sinkDeviceIP;
                         MIRACASTLOG_INFO("Notifying PLAYER_LAUNCH_REQUEST Event SourceDeviceIP[%s] SourceDeviceMac[%s] SourceDeviceName[%s] SinkDeviceIP[%s]",
                                         deviceParameters.sourceDeviceIP.c_str(), deviceParameters.sourceDeviceMac.c_str(),
                                         deviceParameters.sourceDeviceName.c_str(), deviceParameters.sinkDeviceIP.c_str());
-                        while (index != _miracastServiceNotification.end())
+                        for (Exchange::IMiracastService::INotification *notification : *listeners)
                         {
-                            (*index)->OnLaunchRequest(deviceParameters);
-                            ++index;
+                            notification->OnLaunchRequest(deviceParameters);
                         }
                     }
                 }
@@ -387,7 +400,6 @@ namespace WPEFramework
                 }
                 break;
             }
-            _adminLock.Unlock();
         }
 
         /*  COMRPC Methods Start */
@@ -402,14 +414,15 @@ namespace WPEFramework
             {
 				MIRACASTLOG_INFO("MiracastServiceImplementation::Configure deinitialize");
                 MIRACASTLOG_TRACE("Call MiracastServiceImplementation deinitialize");
-            	if (m_FriendlyNameMonitorTimerID)
+            	if (m_isServiceInitialized)
             	{
-                	g_source_remove(m_FriendlyNameMonitorTimerID);
-                	m_FriendlyNameMonitorTimerID = 0;
+                	m_CurrentService->Unregister(&_pluginStateNotification);
             	}
             	remove_wifi_connection_state_timer();
             	remove_miracast_connection_timer();
 
+            	releasePlayerPlugin();
+
             	if (_powerManagerPlugin)
             	{
                 	_powerManagerPlugin->Unregister(_pwrMgrNotification.baseInterface<Exchange::IPowerManager::IModeChangedNotification>());
@@ -417,19 +430,34 @@ namespace WPEFramework
             	}
             	_registeredEventHandlers = false;
 
-	   			if (m_WiFiPluginObj)
-            	{
-                	m_WiFiPluginObj->Unsubscribe(1000, _T("onWIFIStateChanged"));
-                	delete m_WiFiPluginObj;
-                	m_WiFiPluginObj = nullptr;
-            	}
-
-
-            	if (m_SystemPluginObj)
             	{
-                	m_SystemPluginObj->Unsubscribe(1000, _T("onFriendlyNameChanged"));
-                	delete m_SystemPluginObj;
-                	m_SystemPluginObj = nullptr;
+                	lock_guard<mutex> lock(m_PluginLinkMutex);
+                	m_PluginMonitorActive = false;
+
+                	if (m_WiFiPluginObj)
+                	{
+                    	m_WiFiPluginObj->Unsubscribe(1000, _T("onWIFIStateChanged"));
+                    	delete m_WiFiPluginObj;
+                    	m_WiFiPluginObj = nullptr;
+                	}
+
+                	if (m_NetworkManagerPluginObj)
+                	{
+                    	m_NetworkManagerPluginObj->Unsubscribe(1000, _T("onWiFiStateChange"));
+                    	delete m_NetworkManagerPluginObj;
+                    	m_NetworkManagerPluginObj = nullptr;
+                	}
+
+                	if (m_SystemPluginObj)
+                	{
+                    	m_SystemPluginObj->Unsubscribe(1000, _T("onFriendlyNameChanged"));
+                    	delete m_SystemPluginObj;
+                    	m_SystemPluginObj = nullptr;
+                	}
+                	m_SystemEventsSubscribed = false;
+                	m_WiFiEventsSubscribed = false;
+                	m_NetworkManagerEventsSubscribed = false;
+                	m_FriendlyNameUpdated = false;
             	}
 
             	MIRACASTLOG_INFO("Disconnect from the COM-RPC socket");
@@ -440,6 +468,9 @@ namespace WPEFramework
                 	m_CurrentService = nullptr;
                 	m_miracast_ctrler_obj = nullptr;
                 	m_isServiceInitialized = false;
+                	MiracastEventBufferPool::destroyInstance();
+                	MiracastSessionTracer::destroyInstance();
+                	MiracastOptFlags::destroyInstance();
 					lock_guard<recursive_mutex> lock(m_EventMutex);
                 	m_isServiceEnabled = false;
 					MIRACASTLOG_INFO("Done..!!!");
@@ -481,27 +512,23 @@ namespace WPEFramework
                     m_miracast_ctrler_obj = MiracastController::getInstance(ret_code, this,std::move(p2p_ctrl_iface));
                     if (nullptr != m_miracast_ctrler_obj)
                     {
-                        getThunderPlugins();
-                        // subscribe for event
-                        if (nullptr != m_SystemPluginObj)
-                        {
-                            m_SystemPluginObj->Subscribe<JsonObject>(1000, "onFriendlyNameChanged", &MiracastServiceImplementation::onFriendlyNameUpdateHandler, this);
-                        }
-                        if (nullptr != m_WiFiPluginObj)
                         {
-                            m_WiFiPluginObj->Subscribe<JsonObject>(1000, "onWIFIStateChanged", &MiracastServiceImplementation::onWIFIStateChangedHandler, this);
+                            lock_guard<mutex> lock(m_PluginLinkMutex);
+                            m_PluginMonitorActive = true;
                         }
+                        subscribePluginEvents("");
 
-                        if ( false == updateSystemFriendlyName())
+                        if (m_FriendlyNameUpdated)
                         {
-                            m_FriendlyNameMonitorTimerID = g_timeout_add(2000, MiracastServiceImplementation::monitor_friendly_name_timercallback, this);
-                            MIRACASTLOG_WARNING("Unable to get friendlyName, requires polling [%u]...",m_FriendlyNameMonitorTimerID);
+                            MIRACASTLOG_INFO("friendlyName updated properly...");
                         }
                         else
                         {
-                            MIRACASTLOG_INFO("friendlyName updated properly...");
+                            MIRACASTLOG_WARNING("Unable to get friendlyName, waiting for %s to be activated...", SYSTEM_CALLSIGN);
                         }
                         m_isServiceInitialized = true;
+                        /* Plugins already active are reported right away, the others when they come up */
+                        m_CurrentService->Register(&_pluginStateNotification);
                         result = Core::ERROR_NONE;
                     }
                     else
@@ -785,6 +812,10 @@ namespace WPEFramework
             {
                 lock_guard<recursive_mutex> lock(m_EventMutex);
                 isServiceEnabled = m_isServiceEnabled;
+                if (WPEFramework::Exchange::IMiracastService::PLAYER_STATE_STOPPED == playerState)
+                {
+                    m_LaunchHandedToPlayer = false;
+                }
             }
             if ( isServiceEnabled && restart_discovery_needed )
             {
@@ -819,7 +850,7 @@ namespace WPEFramework
             MIRACASTLOG_TRACE("Entering ...");
             bool is_another_connect_request = false;
 
-            lock_guard<recursive_mutex> lock(m_EventMutex);
+            unique_lock<recursive_mutex> lock(m_EventMutex);
             eMIRA_SERVICE_STATES current_state = getCurrentServiceState();
 
             if ( MIRACAST_SERVICE_STATE_PLAYER_LAUNCHED == current_state )
@@ -828,17 +859,23 @@ namespace WPEFramework
                 MIRACASTLOG_WARNING("Another Connect Request received while casting");
             }
 
-            if (0 == access("/opt/miracast_autoconnect", F_OK))
+            if (MiracastOptFlags::getInstance()->is_present(MIRACAST_OPT_AUTOCONNECT))
             {
-                char commandBuffer[768] = {0};
+                Result acceptResult;
 
                 if ( is_another_connect_request )
                 {
+                    std::string ongoing_mac = m_src_dev_mac,
+                                ongoing_name = m_src_dev_name;
+
                     MIRACASTLOG_INFO("!!! NEED TO STOP ONGOING SESSION !!!");
-                    strncpy(commandBuffer,"curl -H \"Authorization: Bearer `WPEFrameworkSecurityUtility | cut -d '\"' -f 4`\" --header \"Content-Type: application/json\" --request POST --data '{\"jsonrpc\":\"2.0\", \"id\":3,\"method\":\"org.rdk.MiracastPlayer.1.stopRequest\", \"params\":{\"reason\": \"NEW_CONNECTION\"}}' http://127.0.0.1:9998/jsonrpc &",sizeof(commandBuffer));
-                    commandBuffer[sizeof(commandBuffer) - 1] = '\0';
-                    MIRACASTLOG_INFO("Stopping old Session by [%s]",commandBuffer);
-                    MiracastCommon::execute_SystemCommand(commandBuffer);
+                    /* The player reports its state back through this lock, never call it with the lock held */
+                    lock.unlock();
+                    if (!stopPlayerDirect(ongoing_mac, ongoing_name, STOP_REASON_APP_REQ_FOR_NEW_CONNECTION))
+                    {
+                        MIRACASTLOG_ERROR("Unable to stop the ongoing Session");
+                    }
+                    lock.lock();
                 }
                 if (MIRACAST_SERVICE_STATE_DIRECT_LAUCH_REQUESTED == current_state)
                 {
@@ -848,18 +885,15 @@ namespace WPEFramework
                 {
                     changeServiceState(MIRACAST_SERVICE_STATE_CONNECTING);
                 }
-                memset(commandBuffer,0x00,sizeof(commandBuffer));
-                strncpy(commandBuffer,"curl -H \"Authorization: Bearer `WPEFrameworkSecurityUtility | cut -d '\"' -f 4`\" --header \"Content-Type: application/json\" --request POST --data '{\"jsonrpc\":\"2.0\", \"id\":3,\"method\":\"org.rdk.MiracastService.1.acceptClientConnection\", \"params\":{\"requestStatus\": \"Accept\"}}' http://127.0.0.1:9998/jsonrpc &",sizeof(commandBuffer));
-                commandBuffer[sizeof(commandBuffer) - 1] = '\0';
-                MIRACASTLOG_INFO("AutoConnecting [%s - %s] by [%s]",client_name.c_str(),client_mac.c_str(),commandBuffer);
-                MiracastCommon::execute_SystemCommand(commandBuffer);
+                MIRACASTLOG_INFO("AutoConnecting [%s - %s]",client_name.c_str(),client_mac.c_str());
+                AcceptClientConnection("Accept", acceptResult);
             }
             else
             {
-                JsonObject eventDetails;
-                eventDetails["source_dev_mac"] = client_mac;
-                eventDetails["source_dev_name"] = client_name;
-                dispatchEvent(MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_REQUEST, eventDetails);
+                ClientConnectionRequestParams request;
+                request.clientMac = client_mac;
+                request.clientName = std::move(client_name);
+                dispatchEvent(MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_REQUEST, std::move(request));
 
                 m_src_dev_mac = std::move(client_mac);
 
@@ -877,6 +911,25 @@ namespace WPEFramework
             MIRACASTLOG_TRACE("Exiting ...");
         }
 
+        void MiracastServiceImplementation::onMiracastServiceClientConnectionAccepted(string client_mac, string client_name)
+        {
+            MIRACASTLOG_TRACE("Entering ...");
+            lock_guard<recursive_mutex> lock(m_EventMutex);
+            eMIRA_SERVICE_STATES current_state = getCurrentServiceState();
+
+            if ( MIRACAST_SERVICE_STATE_PLAYER_LAUNCHED == current_state )
+            {
+                MIRACASTLOG_WARNING("Pre-approved Connect Request received while casting");
+            }
+            MIRACASTLOG_INFO("Connect Request from [%s - %s] accepted by the source policy",client_name.c_str(),client_mac.c_str());
+
+            /* No onClientConnectionRequest, the next event the application sees is the launch request */
+            remove_miracast_connection_timer();
+            m_src_dev_mac = std::move(client_mac);
+            changeServiceState(MIRACAST_SERVICE_STATE_CONNECTION_ACCEPTED);
+            MIRACASTLOG_TRACE("Exiting ...");
+        }
+
         void MiracastServiceImplementation::onMiracastServiceClientConnectionError(string client_mac, string client_name , MiracastServiceReasonCode reason_code )
         {
             MIRACASTLOG_TRACE("Entering ...");
@@ -889,18 +942,18 @@ namespace WPEFramework
             }
             else
             {
-                JsonObject eventDetails;
-                eventDetails["source_dev_mac"] = client_mac;
-                eventDetails["source_dev_name"] = client_name;
-                eventDetails["reason_code"] = static_cast<int>(reason_code);
-                dispatchEvent(MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_ERROR, eventDetails);
+                ClientConnectionErrorParams error;
+                error.clientMac = std::move(client_mac);
+                error.clientName = std::move(client_name);
+                error.reasonCode = reason_code;
+                dispatchEvent(MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_ERROR, std::move(error));
             }
             MIRACASTLOG_TRACE("Exiting ...");
         }
 
         void MiracastServiceImplementation::onMiracastServiceLaunchRequest(string src_dev_ip, string src_dev_mac, string src_dev_name, string sink_dev_ip, bool is_connect_req_reported )
         {
-            lock_guard<recursive_mutex> lock(m_EventMutex);
+            unique_lock<recursive_mutex> lock(m_EventMutex);
             eMIRA_SERVICE_STATES current_state = getCurrentServiceState();
             MIRACASTLOG_INFO("Entering[%u]..!!!",is_connect_req_reported);
 
@@ -921,31 +974,95 @@ namespace WPEFramework
             }
             else
             {
-                auto tupleParam = std::make_tuple(src_dev_ip,src_dev_mac,src_dev_name,sink_dev_ip);
+                MiracastOptFlags *opt_flags = MiracastOptFlags::getInstance();
+                bool handoff_to_player = ( opt_flags->is_present(MIRACAST_OPT_AUTOCONNECT) ||
+                                           opt_flags->is_present(MIRACAST_OPT_PLAYER_HANDOFF));
+
+                bool handed_to_player = false;
+
+                /* Set before the player is called, so a state it reports straight away is not overwritten */
+                changeServiceState(MIRACAST_SERVICE_STATE_PLAYER_LAUNCHED);
+                m_LaunchHandedToPlayer = handoff_to_player;
+                if ( handoff_to_player )
+                {
+                    /* The player reports its state back through this lock, never call it with the lock held */
+                    lock.unlock();
+                    handed_to_player = launchPlayerDirect(src_dev_ip, src_dev_mac, src_dev_name, sink_dev_ip);
+                    lock.lock();
+
+                    current_state = getCurrentServiceState();
+                    if ( MIRACAST_SERVICE_STATE_PLAYER_LAUNCHED != current_state )
+                    {
+                        /* Torn down while the player was called; a STOPPED from the player already cleared the flag */
+                        bool stop_needed = ( handed_to_player && m_LaunchHandedToPlayer );
+
+                        MIRACASTLOG_WARNING("Session torn down during the Launch Request, current state [%#08X]",current_state);
+                        m_LaunchHandedToPlayer = false;
+                        if ( stop_needed )
+                        {
+                            lock.unlock();
+                            if (!stopPlayerDirect(src_dev_mac, src_dev_name, STOP_REASON_APP_REQ_FOR_EXIT))
+                            {
+                                MIRACASTLOG_ERROR("Unable to stop the torn down Session");
+                            }
+                        }
+                        MIRACASTLOG_INFO("Exiting ...");
+                        return;
+                    }
+                }
 
-                if (0 == access("/opt/miracast_autoconnect", F_OK))
+                m_LaunchHandedToPlayer = handed_to_player;
+                if ( handed_to_player )
                 {
-                    char commandBuffer[768] = {0};
-                    snprintf( commandBuffer,
-                            sizeof(commandBuffer),
-                            "curl -H \"Authorization: Bearer `WPEFrameworkSecurityUtility | cut -d '\"' -f 4`\" --header \"Content-Type: application/json\" --request POST --data '{\"jsonrpc\":\"2.0\", \"id\":3,\"method\":\"org.rdk.MiracastPlayer.1.playRequest\", \"params\":{\"device_parameters\": {\"source_dev_ip\": \"%s\",\"source_dev_mac\": \"%s\",\"source_dev_name\": \"%s\",\"sink_dev_ip\": \"%s\"},\"video_rectangle\": {\"X\": 0,\"Y\": 0,\"W\": 1280,\"H\": 720}}}' http://127.0.0.1:9998/jsonrpc &",
-                            src_dev_ip.c_str(),
-                            src_dev_mac.c_str(),
-                            src_dev_name.c_str(),
-                            sink_dev_ip.c_str());
-                    MIRACASTLOG_INFO("System Command [%s]",commandBuffer);
-                    MiracastCommon::execute_SystemCommand(commandBuffer);
+                    MIRACASTLOG_INFO("Launch Request for [%s - %s] handed to MiracastPlayer",src_dev_name.c_str(),src_dev_mac.c_str());
                 }
                 else
                 {
-                    JsonObject eventDetails;
-                    eventDetails["source_dev_mac"] = src_dev_mac;
-                    eventDetails["source_dev_name"] = src_dev_name;
-                    eventDetails["source_dev_ip"] = src_dev_ip;
-                    eventDetails["sink_dev_ip"] = sink_dev_ip;
-                    dispatchEvent(MIRACASTSERVICE_EVENT_PLAYER_LAUNCH_REQUEST, eventDetails);
+                    if ( handoff_to_player )
+                    {
+                        MIRACASTLOG_WARNING("MiracastPlayer not reachable, reporting the Launch Request instead");
+                    }
+                    LaunchRequestParams launch;
+                    launch.sourceDeviceIP = std::move(src_dev_ip);
+                    launch.sourceDeviceMac = std::move(src_dev_mac);
+                    launch.sourceDeviceName = std::move(src_dev_name);
+                    launch.sinkDeviceIP = std::move(sink_dev_ip);
+                    dispatchEvent(MIRACASTSERVICE_EVENT_PLAYER_LAUNCH_REQUEST, std::move(launch));
                 }
-                changeServiceState(MIRACAST_SERVICE_STATE_PLAYER_LAUNCHED);
+            }
+            MIRACASTLOG_INFO("Exiting ...");
+        }
+
+        void MiracastServiceImplementation::onMiracastServiceLaunchCancel(string src_dev_mac, string src_dev_name, MiracastServiceReasonCode reason_code )
+        {
+            unique_lock<recursive_mutex> lock(m_EventMutex);
+            eMIRA_SERVICE_STATES current_state = getCurrentServiceState();
+            MIRACASTLOG_INFO("Entering state [%#08X]",current_state);
+
+            if (( MIRACAST_SERVICE_STATE_PLAYER_LAUNCHED == current_state ) && m_LaunchHandedToPlayer )
+            {
+                m_LaunchHandedToPlayer = false;
+                /* The player reports its state back through this lock, never call it with the lock held */
+                lock.unlock();
+                if (!stopPlayerDirect(src_dev_mac, src_dev_name, STOP_REASON_APP_REQ_FOR_EXIT))
+                {
+                    MIRACASTLOG_ERROR("Unable to stop the cancelled Session");
+                }
+            }
+            else if (( MIRACAST_SERVICE_STATE_PLAYER_LAUNCHED == current_state ) ||
+                     ( MIRACAST_SERVICE_STATE_DIRECT_LAUCH_REQUESTED == current_state ) ||
+                     ( MIRACAST_SERVICE_STATE_DIRECT_LAUCH_WITH_CONNECTING == current_state ))
+            {
+                /* The application launched the player itself, or still has the connect request to answer */
+                ClientConnectionErrorParams error;
+                error.clientMac = std::move(src_dev_mac);
+                error.clientName = std::move(src_dev_name);
+                error.reasonCode = reason_code;
+                dispatchEvent(MIRACASTSERVICE_EVENT_CLIENT_CONNECTION_ERROR, std::move(error));
+            }
+            else
+            {
+                MIRACASTLOG_INFO("Session already refreshed, So no Launch Request to cancel. Current state [%#08X]",current_state);
             }
             MIRACASTLOG_INFO("Exiting ...");
         }
@@ -959,6 +1076,15 @@ namespace WPEFramework
                 case MIRACAST_SERVICE_STATE_IDLE:
                 case MIRACAST_SERVICE_STATE_DISCOVERABLE:
                 {
+                    eMIRA_SERVICE_STATES current_state = getCurrentServiceState();
+
+                    if ((MIRACAST_SERVICE_STATE_CONNECTING == current_state) ||
+                        (MIRACAST_SERVICE_STATE_DIRECT_LAUCH_WITH_CONNECTING == current_state))
+                    {
+                        /* Controller gave up on the pending request, its deadline must not restart the next session */
+                        MIRACASTLOG_INFO("Pending Connect Request dropped by the controller");
+                        remove_miracast_connection_timer();
+                    }
                     if ((!m_isServiceEnabled) && (MIRACAST_SERVICE_STATE_DISCOVERABLE == state))
                     {
                         /*User already disabled the discovery, so should not enable again.*/
@@ -995,6 +1121,131 @@ namespace WPEFramework
             registerEventHandlers();
         }
 
+        /* Caller holds m_PlayerPluginMutex */
+        bool MiracastServiceImplementation::acquirePlayerPlugin(void)
+        {
+            if (!m_PlayerPlugin)
+            {
+                /* Single attempt, a missing player must not hold up the launch path */
+                m_PlayerPlugin = MiracastPlayerInterfaceBuilder(_T(MIRACAST_PLAYER_CALLSIGN))
+                                        .withIShell(m_CurrentService)
+                                        .createInterface();
+                if (m_PlayerPlugin)
+                {
+                    MIRACASTLOG_INFO("Acquired [%s] interface", MIRACAST_PLAYER_CALLSIGN);
+                    /* In autoconnect mode the player reports through updatePlayerState itself */
+                    if ((!MiracastOptFlags::getInstance()->is_present(MIRACAST_OPT_AUTOCONNECT)) &&
+                        (Core::ERROR_NONE == m_PlayerPlugin->Register(&_playerNotification)))
+                    {
+                        m_PlayerNotificationRegistered = true;
+                    }
+                }
+            }
+            return (m_PlayerPlugin);
+        }
+
+        /* Caller holds m_PlayerPluginMutex, unregister is skipped when the player is gone already */
+        void MiracastServiceImplementation::resetPlayerPlugin(bool unregister)
+        {
+            if (m_PlayerPlugin && m_PlayerNotificationRegistered && unregister)
+            {
+                m_PlayerPlugin->Unregister(&_playerNotification);
+            }
+            m_PlayerNotificationRegistered = false;
+            m_PlayerPlugin.Reset();
+        }
+
+        void MiracastServiceImplementation::releasePlayerPlugin(void)
+        {
+            lock_guard<mutex> lock(m_PlayerPluginMutex);
+            resetPlayerPlugin(true);
+        }
+
+        void MiracastServiceImplementation::onPlayerStateChange(const string &client_mac, Exchange::IMiracastPlayer::State player_state, Exchange::IMiracastPlayer::ReasonCode reason_code)
+        {
+            MiracastPlayerState service_player_state;
+            Result result;
+
+            switch (player_state)
+            {
+                case Exchange::IMiracastPlayer::STATE_IDLE:
+                    service_player_state = WPEFramework::Exchange::IMiracastService::PLAYER_STATE_IDLE;
+                    break;
+                case Exchange::IMiracastPlayer::STATE_INITIATED:
+                    service_player_state = WPEFramework::Exchange::IMiracastService::PLAYER_STATE_INITIATED;
+                    break;
+                case Exchange::IMiracastPlayer::STATE_INPROGRESS:
+                    service_player_state = WPEFramework::Exchange::IMiracastService::PLAYER_STATE_INPROGRESS;
+                    break;
+                case Exchange::IMiracastPlayer::STATE_PLAYING:
+                    service_player_state = WPEFramework::Exchange::IMiracastService::PLAYER_STATE_PLAYING;
+                    break;
+                case Exchange::IMiracastPlayer::STATE_STOPPED:
+                    service_player_state = WPEFramework::Exchange::IMiracastService::PLAYER_STATE_STOPPED;
+                    break;
+                default:
+                    MIRACASTLOG_VERBOSE("Player state [%d] not tracked", (int)player_state);
+                    return;
+            }
+            /* Both ReasonCode enums share their values, as with the updatePlayerState call */
+            UpdatePlayerState(client_mac, service_player_state, static_cast<int>(reason_code), result);
+        }
+
+        bool MiracastServiceImplementation::launchPlayerDirect(const string &src_dev_ip, const string &src_dev_mac, const string &src_dev_name, const string &sink_dev_ip)
+        {
+            Exchange::IMiracastPlayer::DeviceParameters deviceParams;
+            Exchange::IMiracastPlayer::VideoRectangle videoRect;
+            Exchange::IMiracastPlayer::Result playResult;
+            Core::hresult status = Core::ERROR_UNAVAILABLE;
+
+            MIRACASTLOG_TRACE("Entering ...");
+            deviceParams.sourceDeviceIP = src_dev_ip;
+            deviceParams.sourceDeviceMac = src_dev_mac;
+            deviceParams.sourceDeviceName = src_dev_name;
+            deviceParams.sinkDeviceIP = sink_dev_ip;
+            videoRect.startX = 0;
+            videoRect.startY = 0;
+            videoRect.width = MIRACAST_PLAYER_DIRECT_LAUNCH_WIDTH;
+            videoRect.height = MIRACAST_PLAYER_DIRECT_LAUNCH_HEIGHT;
+            playResult.success = false;
+
+            lock_guard<mutex> lock(m_PlayerPluginMutex);
+            if (acquirePlayerPlugin())
+            {
+                status = m_PlayerPlugin->PlayRequest(deviceParams, videoRect, playResult);
+                if (Core::ERROR_NONE != status)
+                {
+                    /* Player went away, acquire it again on the next request */
+                    MIRACASTLOG_ERROR("PlayRequest failed [%u]", status);
+                    resetPlayerPlugin(false);
+                }
+            }
+            MIRACASTLOG_TRACE("Exiting ...");
+            return ((Core::ERROR_NONE == status) && playResult.success);
+        }
+
+        bool MiracastServiceImplementation::stopPlayerDirect(const string &client_mac, const string &client_name, MiracastPlayerStopReasonCode reason_code)
+        {
+            Exchange::IMiracastPlayer::Result stopResult;
+            Core::hresult status = Core::ERROR_UNAVAILABLE;
+
+            MIRACASTLOG_TRACE("Entering ...");
+            stopResult.success = false;
+
+            lock_guard<mutex> lock(m_PlayerPluginMutex);
+            if (acquirePlayerPlugin())
+            {
+                status = m_PlayerPlugin->StopRequest(client_mac, client_name, static_cast<int>(reason_code), stopResult);
+                if (Core::ERROR_NONE != status)
+                {
+                    MIRACASTLOG_ERROR("StopRequest failed [%u]", status);
+                    resetPlayerPlugin(false);
+                }
+            }
+            MIRACASTLOG_TRACE("Exiting ...");
+            return ((Core::ERROR_NONE == status) && stopResult.success);
+        }
+
         void MiracastServiceImplementation::registerEventHandlers()
         {
             ASSERT (_powerManagerPlugin);
@@ -1120,6 +1371,11 @@ namespace WPEFramework
                     case DEVICE_WIFI_STATE_CONNECTING:
                     {
                         MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-WIFI DEVICE_WIFI_STATE [CONNECTING] ####");
+                        if (m_IsWiFiConnectingState)
+                        {
+                            /* Repeated CONNECTING for the attempt already in progress */
+                            break;
+                        }
                         {lock_guard<recursive_mutex> lock(m_EventMutex);
                             setEnableInternal(false);
                         }
@@ -1181,37 +1437,159 @@ namespace WPEFramework
             parameters.ToString(message);
             MIRACASTLOG_INFO("[WiFi State Changed Event], [%s]", message.c_str());
 
-            if (parameters.HasLabel("state"))
+            if (m_NetworkManagerEventsSubscribed)
+            {
+                /* Both plugins report the same station, their events interleave in any order.
+                 * Following one of them keeps a late CONNECTING from re-opening a finished attempt. */
+                MIRACASTLOG_VERBOSE("NetworkManager reports the WiFi state, ignoring org.rdk.Wifi");
+            }
+            else if (parameters.HasLabel("state"))
             {
                 wifiState = parameters["state"].Number();
                 setWiFiStateInternal(static_cast<DEVICE_WIFI_STATES>(wifiState));
             }
             MIRACASTLOG_TRACE("Exiting ...");
         }
+
+        void MiracastServiceImplementation::onNetworkManagerWiFiStateHandler(const JsonObject &parameters)
+        {
+            MIRACASTLOG_TRACE("Entering ...");
+            string message;
+            uint32_t wifiState;
+            parameters.ToString(message);
+            MIRACASTLOG_INFO("[NetworkManager WiFi State Event], [%s]", message.c_str());
+
+            if (parameters.HasLabel("state"))
+            {
+                wifiState = parameters["state"].Number();
+                switch (wifiState)
+                {
+                    case DEVICE_WIFI_STATE_UNINSTALLED:
+                    case DEVICE_WIFI_STATE_DISABLED:
+                    case DEVICE_WIFI_STATE_DISCONNECTED:
+                    case DEVICE_WIFI_STATE_PAIRING:
+                    case DEVICE_WIFI_STATE_CONNECTING:
+                    case DEVICE_WIFI_STATE_CONNECTED:
+                    {
+                        setWiFiStateInternal(static_cast<DEVICE_WIFI_STATES>(wifiState));
+                    }
+                    break;
+                    /* The connection attempt ended without a link */
+                    case NM_WIFI_STATE_SSID_NOT_FOUND:
+                    case NM_WIFI_STATE_CONNECTION_FAILED:
+                    case NM_WIFI_STATE_INVALID_CREDENTIALS:
+                    case NM_WIFI_STATE_AUTHENTICATION_FAILED:
+                    case NM_WIFI_STATE_ERROR:
+                    {
+                        setWiFiStateInternal(DEVICE_WIFI_STATE_FAILED);
+                    }
+                    break;
+                    /* An established link went away, not the outcome of an attempt */
+                    case NM_WIFI_STATE_SSID_CHANGED:
+                    case NM_WIFI_STATE_CONNECTION_LOST:
+                    case NM_WIFI_STATE_CONNECTION_INTERRUPTED:
+                    {
+                        setWiFiStateInternal(DEVICE_WIFI_STATE_DISCONNECTED);
+                    }
+                    break;
+                    default:
+                    {
+                        MIRACASTLOG_WARNING("Unknown NetworkManager WiFi state [%u], ignored", wifiState);
+                    }
+                    break;
+                }
+            }
+            MIRACASTLOG_TRACE("Exiting ...");
+        }
         /*  JsonRPC Event Subscribed handler methods End */
         /* ------------------------------------------------------------------------------------------------------- */
 
-        /*  Internal Timer Callback and methods Start */
+        /*  Plugin activation methods Start */
         /* ------------------------------------------------------------------------------------------------------- */
-        gboolean MiracastServiceImplementation::monitor_friendly_name_timercallback(gpointer userdata)
+        void MiracastServiceImplementation::onPluginActivated(const string &callsign)
         {
-            gboolean timer_retry_state = G_SOURCE_CONTINUE;
-            MIRACASTLOG_TRACE("Entering ...");
-            MiracastServiceImplementation *self = (MiracastServiceImplementation *)userdata;
-            MIRACASTLOG_INFO("TimerCallback Triggered for updating friendlyName...");
-            if ( true == self->updateSystemFriendlyName() )
+            if ((SYSTEM_CALLSIGN == callsign) || (WIFI_CALLSIGN == callsign) || (NETWORKMANAGER_CALLSIGN == callsign))
             {
-                MIRACASTLOG_INFO("friendlyName updated properly, No polling required...");
-                timer_retry_state = G_SOURCE_REMOVE;
+                MIRACASTLOG_INFO("[%s] activated", callsign.c_str());
+                Core::IWorkerPool::Instance().Submit(PluginActivatedJob::Create(this, callsign));
+            }
+        }
+
+        void MiracastServiceImplementation::onPluginDeactivated(const string &callsign)
+        {
+            if (SYSTEM_CALLSIGN == callsign)
+            {
+                m_SystemEventsSubscribed = false;
+                m_FriendlyNameUpdated = false;
+            }
+            else if (WIFI_CALLSIGN == callsign)
+            {
+                m_WiFiEventsSubscribed = false;
+            }
+            else if (NETWORKMANAGER_CALLSIGN == callsign)
+            {
+                m_NetworkManagerEventsSubscribed = false;
             }
             else
             {
-                MIRACASTLOG_WARNING("Unable to get friendlyName, still requires polling...");
+                return;
+            }
+            MIRACASTLOG_INFO("[%s] deactivated", callsign.c_str());
+        }
+
+        bool MiracastServiceImplementation::subscribePluginEvent(WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> *pluginObj,
+                                                                 const char *eventName,
+                                                                 void (MiracastServiceImplementation::*handler)(const JsonObject &))
+        {
+            /* Drop what an earlier instance of the plugin left on the link before registering again */
+            pluginObj->Unsubscribe(1000, eventName);
+            uint32_t ret = pluginObj->Subscribe<JsonObject>(1000, eventName, handler, this);
+            if (Core::ERROR_NONE != ret)
+            {
+                MIRACASTLOG_WARNING("Unable to subscribe [%s] E[%u]", eventName, ret);
+            }
+            return (Core::ERROR_NONE == ret);
+        }
+
+        /* Empty callsign covers every plugin the service listens to */
+        void MiracastServiceImplementation::subscribePluginEvents(const string &callsign)
+        {
+            MIRACASTLOG_TRACE("Entering ...");
+            lock_guard<mutex> lock(m_PluginLinkMutex);
+
+            if (!m_PluginMonitorActive)
+            {
+                MIRACASTLOG_INFO("Service is going down, ignoring [%s]", callsign.c_str());
+                return;
+            }
+            getThunderPlugins();
+
+            if ((callsign.empty() || (SYSTEM_CALLSIGN == callsign)) && (nullptr != m_SystemPluginObj))
+            {
+                if (!m_SystemEventsSubscribed)
+                {
+                    m_SystemEventsSubscribed = subscribePluginEvent(m_SystemPluginObj, "onFriendlyNameChanged", &MiracastServiceImplementation::onFriendlyNameUpdateHandler);
+                }
+                if ((!m_FriendlyNameUpdated) && (updateSystemFriendlyName()))
+                {
+                    m_FriendlyNameUpdated = true;
+                }
+            }
+            if ((callsign.empty() || (WIFI_CALLSIGN == callsign)) && (nullptr != m_WiFiPluginObj) && (!m_WiFiEventsSubscribed))
+            {
+                m_WiFiEventsSubscribed = subscribePluginEvent(m_WiFiPluginObj, "onWIFIStateChanged", &MiracastServiceImplementation::onWIFIStateChangedHandler);
+            }
+            if ((callsign.empty() || (NETWORKMANAGER_CALLSIGN == callsign)) && (nullptr != m_NetworkManagerPluginObj) && (!m_NetworkManagerEventsSubscribed))
+            {
+                m_NetworkManagerEventsSubscribed = subscribePluginEvent(m_NetworkManagerPluginObj, "onWiFiStateChange", &MiracastServiceImplementation::onNetworkManagerWiFiStateHandler);
             }
             MIRACASTLOG_TRACE("Exiting ...");
-            return timer_retry_state;
         }
+        /*  Plugin activation methods End */
+        /* ------------------------------------------------------------------------------------------------------- */
 
+        /*  Internal Timer Callback and methods Start */
+        /* ------------------------------------------------------------------------------------------------------- */
         gboolean MiracastServiceImplementation::monitor_wifi_connection_state_timercallback(gpointer userdata)
         {
             MIRACASTLOG_TRACE("Entering ...");
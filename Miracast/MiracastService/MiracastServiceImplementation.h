@@ -20,18 +20,22 @@
 #pragma once
 
 #include "Module.h"
+#include <boost/variant.hpp>
 
 #include <interfaces/Ids.h>
 #include <interfaces/IMiracastService.h>
+#include <interfaces/IMiracastPlayer.h>
 #include <interfaces/IPowerManager.h>
 #include<interfaces/IConfiguration.h>
 
 #include <MiracastController.h>
+#include <MiracastNotificationList.h>
 #include "libIARM.h"
 
 #include <com/com.h>
 #include <core/core.h>
 #include <mutex>
+#include <atomic>
 #include <vector>
 
 #include "libIBus.h"
@@ -43,6 +47,40 @@ using PowerState = WPEFramework::Exchange::IPowerManager::PowerState;
 using MiracastPlayerState = WPEFramework::Exchange::IMiracastService::PlayerState;
 using MiracastPlayerReasonCode = WPEFramework::Exchange::IMiracastService::PlayerReasonCode;
 using MiracastServiceReasonCode = WPEFramework::Exchange::IMiracastService::ReasonCode;
+using MiracastPlayerInterfaceBuilder = WPEFramework::Plugin::PluginInterfaceBuilder<WPEFramework::Exchange::IMiracastPlayer>;
+using MiracastPlayerInterfaceRef = WPEFramework::Plugin::PluginInterfaceRef<WPEFramework::Exchange::IMiracastPlayer>;
+
+/* Typed payloads of the events reported to the registered notifications */
+typedef struct client_connection_request_params_st
+{
+    std::string clientMac;
+    std::string clientName;
+}
+ClientConnectionRequestParams;
+
+typedef struct client_connection_error_params_st
+{
+    std::string clientMac;
+    std::string clientName;
+    MiracastServiceReasonCode reasonCode;
+}
+ClientConnectionErrorParams;
+
+typedef struct launch_request_params_st
+{
+    std::string sourceDeviceIP;
+    std::string sourceDeviceMac;
+    std::string sourceDeviceName;
+    std::string sinkDeviceIP;
+}
+LaunchRequestParams;
+
+using ServiceEventParams = boost::variant<ClientConnectionRequestParams, ClientConnectionErrorParams, LaunchRequestParams>;
+
+#define MIRACAST_PLAYER_CALLSIGN            "org.rdk.MiracastPlayer"
+/* Video rectangle used when the service launches the player itself */
+#define MIRACAST_PLAYER_DIRECT_LAUNCH_WIDTH     (1280)
+#define MIRACAST_PLAYER_DIRECT_LAUNCH_HEIGHT    (720)
 
 typedef enum DeviceWiFiStates
 {
@@ -55,6 +93,19 @@ typedef enum DeviceWiFiStates
     DEVICE_WIFI_STATE_FAILED = 6
 }DEVICE_WIFI_STATES;
 
+/* org.rdk.NetworkManager onWiFiStateChange states, the same as DEVICE_WIFI_STATES up to CONNECTED */
+typedef enum NetworkManagerWiFiStates
+{
+    NM_WIFI_STATE_SSID_NOT_FOUND = 6,
+    NM_WIFI_STATE_SSID_CHANGED = 7,
+    NM_WIFI_STATE_CONNECTION_LOST = 8,
+    NM_WIFI_STATE_CONNECTION_FAILED = 9,
+    NM_WIFI_STATE_CONNECTION_INTERRUPTED = 10,
+    NM_WIFI_STATE_INVALID_CREDENTIALS = 11,
+    NM_WIFI_STATE_AUTHENTICATION_FAILED = 12,
+    NM_WIFI_STATE_ERROR = 13
+}NM_WIFI_STATES;
+
 namespace WPEFramework
 {
     namespace Plugin
@@ -74,8 +125,10 @@ namespace WPEFramework
                 MiracastServiceImplementation &operator=(const MiracastServiceImplementation &) = delete;
 
                 virtual void onMiracastServiceClientConnectionRequest(string client_mac, string client_name) override;
+                virtual void onMiracastServiceClientConnectionAccepted(string client_mac, string client_name) override;
                 virtual void onMiracastServiceClientConnectionError(string client_mac, string client_name , MiracastServiceReasonCode reason_code ) override;
                 virtual void onMiracastServiceLaunchRequest(string src_dev_ip, string src_dev_mac, string src_dev_name, string sink_dev_ip, bool is_connect_req_reported ) override;
+                virtual void onMiracastServiceLaunchCancel(string src_dev_mac, string src_dev_name, MiracastServiceReasonCode reason_code ) override;
                 virtual void onStateChange(eMIRA_SERVICE_STATES state ) override;
                 
                 BEGIN_INTERFACE_MAP(MiracastServiceImplementation)
@@ -94,8 +147,8 @@ namespace WPEFramework
                 class EXTERNAL Job : public Core::IDispatch
                 {
                     protected:
-                        Job(MiracastServiceImplementation *MiracastServiceImplementation, Event event, JsonObject &params)
-                            : _miracastServiceImplementation(MiracastServiceImplementation), _event(event), _params(params)
+                        Job(MiracastServiceImplementation *MiracastServiceImplementation, Event event, ServiceEventParams &&params)
+                            : _miracastServiceImplementation(MiracastServiceImplementation), _event(event), _params(std::move(params))
                         {
                             if (_miracastServiceImplementation != nullptr)
                             {
@@ -116,12 +169,12 @@ namespace WPEFramework
                         }
 
                     public:
-                        static Core::ProxyType<Core::IDispatch> Create(MiracastServiceImplementation *miracastServiceImplementation, Event event, JsonObject params)
+                        static Core::ProxyType<Core::IDispatch> Create(MiracastServiceImplementation *miracastServiceImplementation, Event event, ServiceEventParams &&params)
                         {
         #ifndef USE_THUNDER_R4
-                            return (Core::proxy_cast<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastServiceImplementation, event, params)));
+                            return (Core::proxy_cast<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastServiceImplementation, event, std::move(params))));
         #else
-                            return (Core::ProxyType<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastServiceImplementation, event, params)));
+                            return (Core::ProxyType<Core::IDispatch>(Core::ProxyType<Job>::Create(miracastServiceImplementation, event, std::move(params))));
         #endif
                         }
 
@@ -133,7 +186,7 @@ namespace WPEFramework
                     private:
                         MiracastServiceImplementation *_miracastServiceImplementation;
                         const Event _event;
-                        JsonObject _params;
+                        ServiceEventParams _params;
                 }; // class Job
 
             public:
@@ -184,6 +237,115 @@ namespace WPEFramework
                         MiracastServiceImplementation& _parent;
                 }; // class PowerManagerNotification
 
+                /* Activation of the plugins whose events the service listens to, replaces polling them */
+                class PluginStateNotification : public PluginHost::IPlugin::INotification
+                {
+                    private:
+                        PluginStateNotification(const PluginStateNotification&) = delete;
+                        PluginStateNotification& operator=(const PluginStateNotification&) = delete;
+
+                    public:
+                        explicit PluginStateNotification(MiracastServiceImplementation& parent)
+                            : _parent(parent)
+                        {
+                        }
+                        ~PluginStateNotification() override = default;
+
+                    public:
+                        void Activated(const string& callsign, PluginHost::IShell* plugin) override
+                        {
+                            _parent.onPluginActivated(callsign);
+                        }
+                        void Deactivated(const string& callsign, PluginHost::IShell* plugin) override
+                        {
+                            _parent.onPluginDeactivated(callsign);
+                        }
+                        void Unavailable(const string& callsign, PluginHost::IShell* plugin) override
+                        {
+                            _parent.onPluginDeactivated(callsign);
+                        }
+
+                        BEGIN_INTERFACE_MAP(PluginStateNotification)
+                        INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
+                        END_INTERFACE_MAP
+
+                    private:
+                        MiracastServiceImplementation& _parent;
+                }; // class PluginStateNotification
+
+                /* State of a player launched through the handoff, takes the place of its updatePlayerState call */
+                class PlayerNotification : public Exchange::IMiracastPlayer::INotification
+                {
+                    private:
+                        PlayerNotification(const PlayerNotification&) = delete;
+                        PlayerNotification& operator=(const PlayerNotification&) = delete;
+
+                    public:
+                        explicit PlayerNotification(MiracastServiceImplementation& parent)
+                            : _parent(parent)
+                        {
+                        }
+                        ~PlayerNotification() override = default;
+
+                    public:
+                        void OnStateChange(const string &clientName , const string &clientMac , const Exchange::IMiracastPlayer::State playerState , const string &reasonCode , const Exchange::IMiracastPlayer::ReasonCode reasonDescription ) override
+                        {
+                            _parent.onPlayerStateChange(clientMac, playerState, reasonDescription);
+                        }
+
+                        BEGIN_INTERFACE_MAP(PlayerNotification)
+                        INTERFACE_ENTRY(Exchange::IMiracastPlayer::INotification)
+                        END_INTERFACE_MAP
+
+                    private:
+                        MiracastServiceImplementation& _parent;
+                }; // class PlayerNotification
+
+                /* Plugin activation is reported under the framework lock, the JSON-RPC work runs from here */
+                class EXTERNAL PluginActivatedJob : public Core::IDispatch
+                {
+                    protected:
+                        PluginActivatedJob(MiracastServiceImplementation *miracastServiceImplementation, const string &callsign)
+                            : _miracastServiceImplementation(miracastServiceImplementation), _callsign(callsign)
+                        {
+                            if (_miracastServiceImplementation != nullptr)
+                            {
+                                _miracastServiceImplementation->AddRef();
+                            }
+                        }
+
+                    public:
+                        PluginActivatedJob() = delete;
+                        PluginActivatedJob(const PluginActivatedJob &) = delete;
+                        PluginActivatedJob &operator=(const PluginActivatedJob &) = delete;
+                        ~PluginActivatedJob()
+                        {
+                            if (_miracastServiceImplementation != nullptr)
+                            {
+                                _miracastServiceImplementation->Release();
+                            }
+                        }
+
+                    public:
+                        static Core::ProxyType<Core::IDispatch> Create(MiracastServiceImplementation *miracastServiceImplementation, const string &callsign)
+                        {
+        #ifndef USE_THUNDER_R4
+                            return (Core::proxy_cast<Core::IDispatch>(Core::ProxyType<PluginActivatedJob>::Create(miracastServiceImplementation, callsign)));
+        #else
+                            return (Core::ProxyType<Core::IDispatch>(Core::ProxyType<PluginActivatedJob>::Create(miracastServiceImplementation, callsign)));
+        #endif
+                        }
+
+                        virtual void Dispatch()
+                        {
+                            _miracastServiceImplementation->subscribePluginEvents(_callsign);
+                        }
+
+                    private:
+                        MiracastServiceImplementation *_miracastServiceImplementation;
+                        const string _callsign;
+                }; // class PluginActivatedJob
+
                 mutable Core::CriticalSection _adminLock;
                 std::mutex m_DiscoveryStateMutex;
                 std::recursive_mutex m_EventMutex;
@@ -191,19 +353,33 @@ namespace WPEFramework
                 std::string m_src_dev_mac{""};
                 std::string m_src_dev_name{""};
                 std::string m_sink_dev_ip{""};
+                /* Last launch went to MiracastPlayer directly rather than to the application, guarded by m_EventMutex */
+                bool m_LaunchHandedToPlayer{false};
                 WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> *m_SystemPluginObj = nullptr;
                 WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> *m_WiFiPluginObj = nullptr;
-                std::list<Exchange::IMiracastService::INotification *> _miracastServiceNotification; // List of registered notifications
+                WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> *m_NetworkManagerPluginObj = nullptr;
+                /* Guards the JSON-RPC links and m_PluginMonitorActive */
+                std::mutex m_PluginLinkMutex;
+                bool m_PluginMonitorActive{false};
+                /* Cleared from the deactivation notification without m_PluginLinkMutex, hence atomic */
+                std::atomic<bool> m_SystemEventsSubscribed{false};
+                std::atomic<bool> m_WiFiEventsSubscribed{false};
+                std::atomic<bool> m_NetworkManagerEventsSubscribed{false};
+                std::atomic<bool> m_FriendlyNameUpdated{false};
+                MiracastNotificationList<Exchange::IMiracastService::INotification> _miracastServiceNotification; // List of registered notifications
                 PluginHost::IShell *m_CurrentService;
-                guint m_FriendlyNameMonitorTimerID{0};
                 guint m_WiFiConnectedStateMonitorTimerID{0};
                 guint m_MiracastConnectionMonitorTimerID{0};
                 eMIRA_SERVICE_STATES m_eService_state;
                 bool m_isServiceInitialized{false};
                 bool m_isServiceEnabled{false};
+                /* Cached COM-RPC link to MiracastPlayer, dropped when a call on it fails */
+                std::mutex m_PlayerPluginMutex;
+                MiracastPlayerInterfaceRef m_PlayerPlugin;
+                bool m_PlayerNotificationRegistered{false};
 
-                void dispatchEvent(Event, const JsonObject &params);
-                void Dispatch(Event event, const JsonObject &params);
+                void dispatchEvent(Event, ServiceEventParams &&params);
+                void Dispatch(Event event, const ServiceEventParams &params);
 
                 eMIRA_SERVICE_STATES getCurrentServiceState(void);
                 void changeServiceState(eMIRA_SERVICE_STATES eService_state);
@@ -222,22 +398,39 @@ namespace WPEFramework
 
                 void onFriendlyNameUpdateHandler(const JsonObject &parameters);
                 void onWIFIStateChangedHandler(const JsonObject &parameters);
+                void onNetworkManagerWiFiStateHandler(const JsonObject &parameters);
+
+                void subscribePluginEvents(const string &callsign);
+                bool subscribePluginEvent(WPEFramework::JSONRPC::LinkType<WPEFramework::Core::JSON::IElement> *pluginObj,
+                                          const char *eventName,
+                                          void (MiracastServiceImplementation::*handler)(const JsonObject &));
+                void onPluginActivated(const string &callsign);
+                void onPluginDeactivated(const string &callsign);
 
-                static gboolean monitor_friendly_name_timercallback(gpointer userdata);
                 static gboolean monitor_wifi_connection_state_timercallback(gpointer userdata);
                 static gboolean monitor_miracast_connection_timercallback(gpointer userdata);
                 void remove_wifi_connection_state_timer(void);
                 void remove_miracast_connection_timer(void);
 
+                bool acquirePlayerPlugin(void);
+                void releasePlayerPlugin(void);
+                void resetPlayerPlugin(bool unregister);
+                void onPlayerStateChange(const string &client_mac, Exchange::IMiracastPlayer::State player_state, Exchange::IMiracastPlayer::ReasonCode reason_code);
+                bool launchPlayerDirect(const string &src_dev_ip, const string &src_dev_mac, const string &src_dev_name, const string &sink_dev_ip);
+                bool stopPlayerDirect(const string &client_mac, const string &client_name, MiracastPlayerStopReasonCode reason_code);
+
             public:
                 static MiracastServiceImplementation *_instance;
                 static PowerManagerInterfaceRef _powerManagerPlugin;
                 Core::Sink<PowerManagerNotification> _pwrMgrNotification;
+                Core::Sink<PluginStateNotification> _pluginStateNotification;
+                Core::Sink<PlayerNotification> _playerNotification;
                 bool _registeredEventHandlers;
 
                 void onPowerModeChanged(const PowerState currentState, const PowerState newState);
 
                 friend class Job;
+                friend class PluginActivatedJob;
         }; // class MiracastServiceImplementation
     } // namespace Plugin
 } // namespace WPEFramework
\ No newline at end of file
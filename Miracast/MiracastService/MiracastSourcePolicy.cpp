@@ -0,0 +1,355 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fnmatch.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include "MiracastSourcePolicy.h"
+
+#define TRUSTED_SOURCES_FIELD_SEPARATOR '|'
+#define TRUSTED_SOURCES_FIELD_COUNT     (3)
+
+/* Device names come from the peer, keep them from breaking the record format */
+static std::string sanitize_field(const std::string &value)
+{
+    std::string sanitized = value;
+    std::replace(sanitized.begin(), sanitized.end(), TRUSTED_SOURCES_FIELD_SEPARATOR, ' ');
+    std::replace(sanitized.begin(), sanitized.end(), '\n', ' ');
+    std::replace(sanitized.begin(), sanitized.end(), '\r', ' ');
+    return sanitized;
+}
+
+static std::string trim(const std::string &value)
+{
+    size_t first = value.find_first_not_of(" \t\r");
+    size_t last = value.find_last_not_of(" \t\r");
+
+    return (std::string::npos == first) ? "" : value.substr(first, last - first + 1);
+}
+
+MiracastSourcePolicy::MiracastSourcePolicy(const std::string &policy_file, const std::string &trust_file)
+    : m_policy_file(policy_file),
+      m_trust_file(trust_file),
+      m_trust_accepted(false),
+      m_policy_present(false)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    memset(&m_policy_mtime, 0, sizeof(m_policy_mtime));
+    refresh_policy();
+    load_trusted();
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastSourcePolicy::~MiracastSourcePolicy()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastSourcePolicy::refresh_policy(void)
+{
+    struct stat policy_stat;
+    bool present = (0 == stat(m_policy_file.c_str(), &policy_stat));
+
+    if ((present == m_policy_present) &&
+        ((!present) ||
+         ((policy_stat.st_mtim.tv_sec == m_policy_mtime.tv_sec) &&
+          (policy_stat.st_mtim.tv_nsec == m_policy_mtime.tv_nsec))))
+    {
+        return;
+    }
+
+    m_policy_present = present;
+    if (present)
+    {
+        m_policy_mtime = policy_stat.st_mtim;
+    }
+    else
+    {
+        memset(&m_policy_mtime, 0, sizeof(m_policy_mtime));
+    }
+    load_policy();
+}
+
+void MiracastSourcePolicy::load_policy(void)
+{
+    std::ifstream policy_file(m_policy_file.c_str());
+    std::string line;
+
+    m_rules.clear();
+    m_trust_accepted = false;
+
+    if (!policy_file.is_open())
+    {
+        MIRACASTLOG_VERBOSE("No source policy in [%s], every request is reported", m_policy_file.c_str());
+        return;
+    }
+
+    while (std::getline(policy_file, line))
+    {
+        std::string action,
+                    match;
+        SOURCE_POLICY_RULE rule;
+
+        line = trim(line);
+        if (line.empty() || ('#' == line[0]))
+        {
+            continue;
+        }
+        std::stringstream line_stream(line);
+        line_stream >> action >> match;
+
+        if (("trust" == action) && ("accepted" == match))
+        {
+            m_trust_accepted = true;
+            continue;
+        }
+        if (("allow" != action) && ("ask" != action))
+        {
+            MIRACASTLOG_WARNING("Skipping unknown source policy rule [%s]", line.c_str());
+            continue;
+        }
+
+        rule.allow = ("allow" == action);
+        if ("mac" == match)
+        {
+            rule.match = SOURCE_POLICY_MATCH_MAC;
+        }
+        else if ("name" == match)
+        {
+            rule.match = SOURCE_POLICY_MATCH_NAME;
+        }
+        else if ("type" == match)
+        {
+            rule.match = SOURCE_POLICY_MATCH_TYPE;
+        }
+        else
+        {
+            MIRACASTLOG_WARNING("Skipping source policy rule with unknown match [%s]", line.c_str());
+            continue;
+        }
+
+        /* The pattern is the rest of the line so names with spaces work */
+        std::getline(line_stream, rule.pattern);
+        rule.pattern = trim(rule.pattern);
+        if (rule.pattern.empty())
+        {
+            MIRACASTLOG_WARNING("Skipping source policy rule without pattern [%s]", line.c_str());
+            continue;
+        }
+        m_rules.push_back(std::move(rule));
+    }
+    MIRACASTLOG_INFO("Loaded %zu source policy rules from [%s], trust accepted[%s]",
+                     m_rules.size(),
+                     m_policy_file.c_str(),
+                     m_trust_accepted ? "yes" : "no");
+}
+
+void MiracastSourcePolicy::load_trusted(void)
+{
+    std::ifstream trust_file(m_trust_file.c_str());
+    std::string line;
+
+    if (!trust_file.is_open())
+    {
+        MIRACASTLOG_VERBOSE("No trusted sources stored in [%s]", m_trust_file.c_str());
+        return;
+    }
+
+    if (!std::getline(trust_file, line) || (MIRACAST_TRUSTED_SOURCES_VERSION != line))
+    {
+        MIRACASTLOG_WARNING("Ignoring [%s] with unknown version [%s]", m_trust_file.c_str(), line.c_str());
+        return;
+    }
+
+    while (std::getline(trust_file, line) && (MIRACAST_TRUSTED_SOURCES_MAX_ENTRIES > m_trusted.size()))
+    {
+        std::vector<std::string> fields;
+        std::stringstream line_stream(line);
+        std::string field;
+
+        while (std::getline(line_stream, field, TRUSTED_SOURCES_FIELD_SEPARATOR))
+        {
+            fields.push_back(field);
+        }
+        if ((TRUSTED_SOURCES_FIELD_COUNT != fields.size()) || fields[0].empty())
+        {
+            MIRACASTLOG_WARNING("Skipping malformed trusted source entry [%s]", line.c_str());
+            continue;
+        }
+
+        TRUSTED_SOURCE source;
+        source.device_mac = fields[0];
+        source.device_name = fields[1];
+        source.trusted_since = strtoull(fields[2].c_str(), nullptr, 10);
+        m_trusted.push_back(std::move(source));
+    }
+    MIRACASTLOG_INFO("Loaded %zu trusted sources from [%s]", m_trusted.size(), m_trust_file.c_str());
+}
+
+void MiracastSourcePolicy::save_trusted(void)
+{
+    std::string temp_file_name = m_trust_file + ".tmp";
+    {
+        std::ofstream trust_file(temp_file_name.c_str(), std::ios::trunc);
+
+        if (!trust_file.is_open())
+        {
+            MIRACASTLOG_WARNING("Unable to write [%s] (%s)", temp_file_name.c_str(), strerror(errno));
+            return;
+        }
+        trust_file << MIRACAST_TRUSTED_SOURCES_VERSION << "\n";
+        for (const TRUSTED_SOURCE &source : m_trusted)
+        {
+            trust_file << sanitize_field(source.device_mac) << TRUSTED_SOURCES_FIELD_SEPARATOR
+                       << sanitize_field(source.device_name) << TRUSTED_SOURCES_FIELD_SEPARATOR
+                       << source.trusted_since << "\n";
+        }
+        trust_file.flush();
+        if (!trust_file.good())
+        {
+            MIRACASTLOG_WARNING("Failed to write [%s]", temp_file_name.c_str());
+            trust_file.close();
+            remove(temp_file_name.c_str());
+            return;
+        }
+    }
+    if (0 != rename(temp_file_name.c_str(), m_trust_file.c_str()))
+    {
+        MIRACASTLOG_WARNING("Unable to replace [%s] (%s)", m_trust_file.c_str(), strerror(errno));
+        remove(temp_file_name.c_str());
+    }
+}
+
+int MiracastSourcePolicy::index_of_trusted(const std::string &device_mac)
+{
+    if (device_mac.empty())
+    {
+        return -1;
+    }
+    for (size_t index = 0; index < m_trusted.size(); ++index)
+    {
+        if (0 == strcasecmp(m_trusted[index].device_mac.c_str(), device_mac.c_str()))
+        {
+            return static_cast<int>(index);
+        }
+    }
+    return -1;
+}
+
+bool MiracastSourcePolicy::matches(const SOURCE_POLICY_RULE &rule,
+                                   const std::string &device_mac,
+                                   const std::string &device_name,
+                                   const std::string &device_type)
+{
+    const std::string *value = nullptr;
+
+    switch (rule.match)
+    {
+        case SOURCE_POLICY_MATCH_MAC:
+        {
+            value = &device_mac;
+        }
+        break;
+        case SOURCE_POLICY_MATCH_NAME:
+        {
+            value = &device_name;
+        }
+        break;
+        case SOURCE_POLICY_MATCH_TYPE:
+        {
+            value = &device_type;
+        }
+        break;
+        default:
+        break;
+    }
+    return ((nullptr != value) &&
+            (!value->empty()) &&
+            (0 == fnmatch(rule.pattern.c_str(), value->c_str(), FNM_CASEFOLD)));
+}
+
+SOURCE_POLICY_VERDICT MiracastSourcePolicy::evaluate(const std::string &device_mac,
+                                                     const std::string &device_name,
+                                                     const std::string &device_type,
+                                                     std::string &reason)
+{
+    static const char *match_names[] = { "mac", "name", "type" };
+    std::lock_guard<std::mutex> lock(m_policy_mutex);
+
+    refresh_policy();
+    for (const SOURCE_POLICY_RULE &rule : m_rules)
+    {
+        if (matches(rule, device_mac, device_name, device_type))
+        {
+            reason = std::string(rule.allow ? "allow " : "ask ") + match_names[rule.match] + " " + rule.pattern;
+            return rule.allow ? SOURCE_POLICY_ACCEPT : SOURCE_POLICY_ASK;
+        }
+    }
+
+    if (m_trust_accepted && (0 <= index_of_trusted(device_mac)))
+    {
+        reason = "trusted source";
+        return SOURCE_POLICY_ACCEPT;
+    }
+    reason = "no matching rule";
+    return SOURCE_POLICY_ASK;
+}
+
+void MiracastSourcePolicy::record_decision(const std::string &device_mac, const std::string &device_name, bool accepted)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    std::lock_guard<std::mutex> lock(m_policy_mutex);
+    int index = index_of_trusted(device_mac);
+
+    refresh_policy();
+    if (accepted && m_trust_accepted && (!device_mac.empty()))
+    {
+        TRUSTED_SOURCE source;
+
+        if (0 <= index)
+        {
+            m_trusted.erase(m_trusted.begin() + index);
+        }
+        source.device_mac = device_mac;
+        source.device_name = device_name;
+        source.trusted_since = static_cast<uint64_t>(time(nullptr));
+        /* Most recent first, the oldest trust falls off the end */
+        m_trusted.insert(m_trusted.begin(), std::move(source));
+        if (MIRACAST_TRUSTED_SOURCES_MAX_ENTRIES < m_trusted.size())
+        {
+            m_trusted.resize(MIRACAST_TRUSTED_SOURCES_MAX_ENTRIES);
+        }
+        MIRACASTLOG_INFO("Trusting source [%s - %s] from now on", device_name.c_str(), device_mac.c_str());
+        save_trusted();
+    }
+    else if ((!accepted) && (0 <= index))
+    {
+        MIRACASTLOG_INFO("Source [%s - %s] rejected, no longer trusted", device_name.c_str(), device_mac.c_str());
+        m_trusted.erase(m_trusted.begin() + index);
+        save_trusted();
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
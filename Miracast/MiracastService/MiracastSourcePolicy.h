@@ -0,0 +1,121 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_SOURCE_POLICY_H_
+#define _MIRACAST_SOURCE_POLICY_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+#include <time.h>
+#include <MiracastLogger.h>
+
+#define MIRACAST_SOURCE_POLICY_FILE             "/opt/persistent/miracast_source_policy"
+#define MIRACAST_TRUSTED_SOURCES_FILE           "/opt/persistent/miracast_trusted_sources"
+#define MIRACAST_TRUSTED_SOURCES_MAX_ENTRIES    (16)
+#define MIRACAST_TRUSTED_SOURCES_VERSION        "v1"
+
+typedef enum source_policy_verdict_e
+{
+    /* Report the request and wait for acceptClientConnection */
+    SOURCE_POLICY_ASK = 0,
+    /* Connect right away, the request is never reported */
+    SOURCE_POLICY_ACCEPT
+}
+SOURCE_POLICY_VERDICT;
+
+typedef enum source_policy_match_e
+{
+    SOURCE_POLICY_MATCH_MAC = 0,
+    SOURCE_POLICY_MATCH_NAME,
+    SOURCE_POLICY_MATCH_TYPE
+}
+SOURCE_POLICY_MATCH;
+
+typedef struct source_policy_rule_st
+{
+    /* false for an 'ask' rule, which keeps the prompt for a source other rules would accept */
+    bool allow;
+    SOURCE_POLICY_MATCH match;
+    /* fnmatch pattern, compared without case */
+    std::string pattern;
+}
+SOURCE_POLICY_RULE;
+
+typedef struct trusted_source_st
+{
+    std::string device_mac;
+    std::string device_name;
+    uint64_t trusted_since;
+}
+TRUSTED_SOURCE;
+
+/**
+ * Decides whether a connecting source needs the application to accept it.
+ * Rules come from MIRACAST_SOURCE_POLICY_FILE, one per line and the first
+ * match wins:
+ *
+ *     allow mac 96:52:44:*        accept by P2P device address
+ *     allow name Living Room*     accept by device name
+ *     allow type 10-0050F204-5    accept by primary device type
+ *     ask mac 96:52:44:b6:7d:14   always prompt for this source
+ *     trust accepted              remember the sources the user accepts
+ *
+ * With 'trust accepted', a source accepted through the application is kept
+ * in MIRACAST_TRUSTED_SOURCES_FILE and connects without a prompt afterwards.
+ * A rejection drops it again. The rules file is reloaded when it changes.
+ */
+class MiracastSourcePolicy
+{
+public:
+    MiracastSourcePolicy(const std::string &policy_file = MIRACAST_SOURCE_POLICY_FILE,
+                         const std::string &trust_file = MIRACAST_TRUSTED_SOURCES_FILE);
+    ~MiracastSourcePolicy();
+
+    /* reason names the rule that decided, for the logs */
+    SOURCE_POLICY_VERDICT evaluate(const std::string &device_mac,
+                                   const std::string &device_name,
+                                   const std::string &device_type,
+                                   std::string &reason);
+    /* Outcome of a request the application answered */
+    void record_decision(const std::string &device_mac, const std::string &device_name, bool accepted);
+
+private:
+    std::mutex m_policy_mutex;
+    std::string m_policy_file;
+    std::string m_trust_file;
+    std::vector<SOURCE_POLICY_RULE> m_rules;
+    bool m_trust_accepted;
+    bool m_policy_present;
+    struct timespec m_policy_mtime;
+    std::vector<TRUSTED_SOURCE> m_trusted;
+
+    void refresh_policy(void);
+    void load_policy(void);
+    void load_trusted(void);
+    void save_trusted(void);
+    int index_of_trusted(const std::string &device_mac);
+    static bool matches(const SOURCE_POLICY_RULE &rule,
+                        const std::string &device_mac,
+                        const std::string &device_name,
+                        const std::string &device_type);
+};
+
+#endif /* _MIRACAST_SOURCE_POLICY_H_ */
@@ -0,0 +1,236 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <strings.h>
+#include <arpa/inet.h>
+#include "MiracastSourceStore.h"
+
+#define SOURCE_STORE_FIELD_SEPARATOR    '|'
+#define SOURCE_STORE_FIELD_COUNT        (8)
+
+/* Device names come from the peer, keep them from breaking the record format */
+static std::string sanitize_field(const std::string &value)
+{
+    std::string sanitized = value;
+    std::replace(sanitized.begin(), sanitized.end(), SOURCE_STORE_FIELD_SEPARATOR, ' ');
+    std::replace(sanitized.begin(), sanitized.end(), '\n', ' ');
+    std::replace(sanitized.begin(), sanitized.end(), '\r', ' ');
+    return sanitized;
+}
+
+/*
+ * The addresses end up on the udhcpc / dnsmasq fallback command lines, so the
+ * store only accepts dotted IPv4 addresses and colon separated MACs from disk.
+ * An empty value is valid, it means the address was not known.
+ */
+static bool is_valid_ip_field(const std::string &value)
+{
+    struct in_addr address;
+    return value.empty() || (1 == inet_pton(AF_INET, value.c_str(), &address));
+}
+
+static bool is_valid_mac_field(const std::string &value)
+{
+    unsigned int octets[6];
+    char trailing;
+
+    return value.empty() ||
+           ((17 == value.size()) &&
+            (6 == sscanf(value.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x%c",
+                         &octets[0], &octets[1], &octets[2], &octets[3], &octets[4], &octets[5], &trailing)));
+}
+
+MiracastSourceStore::MiracastSourceStore(const std::string &file_name)
+    : m_file_name(file_name)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    load();
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastSourceStore::~MiracastSourceStore()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastSourceStore::load(void)
+{
+    std::ifstream store_file(m_file_name.c_str());
+    std::string line;
+
+    if (!store_file.is_open())
+    {
+        MIRACASTLOG_VERBOSE("No known sources stored in [%s]", m_file_name.c_str());
+        return;
+    }
+
+    if (!std::getline(store_file, line) || (MIRACAST_SOURCE_STORE_VERSION != line))
+    {
+        MIRACASTLOG_WARNING("Ignoring [%s] with unknown version [%s]", m_file_name.c_str(), line.c_str());
+        return;
+    }
+
+    while (std::getline(store_file, line) && (MIRACAST_SOURCE_STORE_MAX_ENTRIES > m_sources.size()))
+    {
+        std::vector<std::string> fields;
+        std::stringstream line_stream(line);
+        std::string field;
+
+        while (std::getline(line_stream, field, SOURCE_STORE_FIELD_SEPARATOR))
+        {
+            fields.push_back(field);
+        }
+        if ((SOURCE_STORE_FIELD_COUNT != fields.size()) || fields[0].empty() ||
+            !is_valid_mac_field(fields[1]) || !is_valid_ip_field(fields[5]) || !is_valid_ip_field(fields[6]))
+        {
+            MIRACASTLOG_WARNING("Skipping malformed known source entry [%s]", line.c_str());
+            continue;
+        }
+
+        KNOWN_SOURCE source;
+        source.device_mac = fields[0];
+        source.peer_iface = fields[1];
+        source.device_name = fields[2];
+        source.persistent_network_id = atoi(fields[3].c_str());
+        source.sink_was_go = ("GO" == fields[4]);
+        source.local_ip = fields[5];
+        source.remote_ip = fields[6];
+        source.last_connected = strtoull(fields[7].c_str(), nullptr, 10);
+        m_sources.push_back(std::move(source));
+    }
+    MIRACASTLOG_INFO("Loaded %zu known sources from [%s]", m_sources.size(), m_file_name.c_str());
+}
+
+void MiracastSourceStore::save(void)
+{
+    std::string temp_file_name = m_file_name + ".tmp";
+    {
+        std::ofstream store_file(temp_file_name.c_str(), std::ios::trunc);
+
+        if (!store_file.is_open())
+        {
+            MIRACASTLOG_WARNING("Unable to write [%s] (%s)", temp_file_name.c_str(), strerror(errno));
+            return;
+        }
+        store_file << MIRACAST_SOURCE_STORE_VERSION << "\n";
+        for (const KNOWN_SOURCE &source : m_sources)
+        {
+            store_file << sanitize_field(source.device_mac) << SOURCE_STORE_FIELD_SEPARATOR
+                       << sanitize_field(source.peer_iface) << SOURCE_STORE_FIELD_SEPARATOR
+                       << sanitize_field(source.device_name) << SOURCE_STORE_FIELD_SEPARATOR
+                       << source.persistent_network_id << SOURCE_STORE_FIELD_SEPARATOR
+                       << (source.sink_was_go ? "GO" : "client") << SOURCE_STORE_FIELD_SEPARATOR
+                       << sanitize_field(source.local_ip) << SOURCE_STORE_FIELD_SEPARATOR
+                       << sanitize_field(source.remote_ip) << SOURCE_STORE_FIELD_SEPARATOR
+                       << source.last_connected << "\n";
+        }
+        store_file.flush();
+        if (!store_file.good())
+        {
+            MIRACASTLOG_WARNING("Failed to write [%s]", temp_file_name.c_str());
+            store_file.close();
+            remove(temp_file_name.c_str());
+            return;
+        }
+    }
+    if (0 != rename(temp_file_name.c_str(), m_file_name.c_str()))
+    {
+        MIRACASTLOG_WARNING("Unable to replace [%s] (%s)", m_file_name.c_str(), strerror(errno));
+        remove(temp_file_name.c_str());
+    }
+}
+
+int MiracastSourceStore::index_of(const std::string &mac)
+{
+    if (mac.empty())
+    {
+        return -1;
+    }
+    for (size_t index = 0; index < m_sources.size(); ++index)
+    {
+        if ((0 == strcasecmp(m_sources[index].device_mac.c_str(), mac.c_str())) ||
+            (0 == strcasecmp(m_sources[index].peer_iface.c_str(), mac.c_str())))
+        {
+            return static_cast<int>(index);
+        }
+    }
+    return -1;
+}
+
+bool MiracastSourceStore::find(const std::string &mac, KNOWN_SOURCE &source)
+{
+    std::lock_guard<std::mutex> lock(m_store_mutex);
+    int index = index_of(mac);
+
+    if (0 > index)
+    {
+        return false;
+    }
+    source = m_sources[index];
+    return true;
+}
+
+void MiracastSourceStore::record(const KNOWN_SOURCE &source)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    std::lock_guard<std::mutex> lock(m_store_mutex);
+    int index = index_of(source.device_mac);
+
+    if (0 <= index)
+    {
+        m_sources.erase(m_sources.begin() + index);
+    }
+    /* Most recent first, the least recently connected source falls off the end */
+    m_sources.insert(m_sources.begin(), source);
+    if (MIRACAST_SOURCE_STORE_MAX_ENTRIES < m_sources.size())
+    {
+        m_sources.resize(MIRACAST_SOURCE_STORE_MAX_ENTRIES);
+    }
+    MIRACASTLOG_INFO("Known source [%s - %s] network[%d] role[%s] local[%s] remote[%s]",
+                        source.device_name.c_str(),
+                        source.device_mac.c_str(),
+                        source.persistent_network_id,
+                        source.sink_was_go ? "GO" : "client",
+                        source.local_ip.c_str(),
+                        source.remote_ip.c_str());
+    save();
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastSourceStore::forget_persistent_group(const std::string &mac)
+{
+    std::lock_guard<std::mutex> lock(m_store_mutex);
+    int index = index_of(mac);
+
+    if ((0 <= index) && (0 <= m_sources[index].persistent_network_id))
+    {
+        MIRACASTLOG_WARNING("Dropping persistent group[%d] of [%s]",
+                            m_sources[index].persistent_network_id,
+                            mac.c_str());
+        m_sources[index].persistent_network_id = -1;
+        save();
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_SOURCE_STORE_H_
+#define _MIRACAST_SOURCE_STORE_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+#include <MiracastLogger.h>
+
+#define MIRACAST_SOURCE_STORE_FILE          "/opt/persistent/miracast_known_sources"
+#define MIRACAST_SOURCE_STORE_MAX_ENTRIES   (8)
+#define MIRACAST_SOURCE_STORE_VERSION       "v1"
+
+typedef struct known_source_st
+{
+    std::string device_mac;
+    std::string peer_iface;
+    std::string device_name;
+    int persistent_network_id;
+    bool sink_was_go;
+    std::string local_ip;
+    std::string remote_ip;
+    uint64_t last_connected;
+}
+KNOWN_SOURCE;
+
+/**
+ * On-disk store of the sources that completed a session, used to reinvoke
+ * their persistent P2P group and to request the same IP assignment on the
+ * next connection. The most recently connected sources are kept, the file is
+ * rewritten through a temporary file so a power cut never leaves it torn.
+ */
+class MiracastSourceStore
+{
+public:
+    MiracastSourceStore(const std::string &file_name = MIRACAST_SOURCE_STORE_FILE);
+    ~MiracastSourceStore();
+
+    /* Matches either the P2P device address or the peer interface address */
+    bool find(const std::string &mac, KNOWN_SOURCE &source);
+    void record(const KNOWN_SOURCE &source);
+    /* Drops the stored group so the next connection goes through full negotiation */
+    void forget_persistent_group(const std::string &mac);
+
+private:
+    std::mutex m_store_mutex;
+    std::string m_file_name;
+    std::vector<KNOWN_SOURCE> m_sources;
+
+    void load(void);
+    void save(void);
+    int index_of(const std::string &mac);
+};
+
+#endif /* _MIRACAST_SOURCE_STORE_H_ */
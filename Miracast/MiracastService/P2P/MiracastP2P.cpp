@@ -19,8 +19,13 @@
 
 #include <algorithm>
 #include <stdio.h>
-#include <wpa_ctrl.h>
 #include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/inotify.h>
 #include "libIBus.h"
 #include "MiracastLogger.h"
 #include "MiracastController.h"
@@ -35,23 +40,268 @@
 
 using namespace MIRACAST;
 
+#define P2P_EVENT_MAP_ENTRY(prefix, event_id, log_level, description) \
+    { prefix, sizeof(prefix) - 1, event_id, log_level, description }
+
+#define P2P_EVENT_PREFIX        "P2P-"
+#define P2P_EVENT_PREFIX_LEN    (sizeof(P2P_EVENT_PREFIX) - 1)
+#define P2P_EVENT_IFNAME_TAG    "IFNAME="
+
+/* Only these wpa_supplicant events are forwarded to the controller */
+static const P2P_EVENT_MAP p2p_event_map[] =
+{
+    P2P_EVENT_MAP_ENTRY("P2P-DEVICE-FOUND", EVENT_FOUND, INFO_LEVEL, "P2P Device Found"),
+    P2P_EVENT_MAP_ENTRY("P2P-DEVICE-LOST", EVENT_DEVICE_LOST, WARNING_LEVEL, "P2P Device Lost"),
+    P2P_EVENT_MAP_ENTRY("P2P-PROV-DISC-PBC-REQ", EVENT_PROVISION, INFO_LEVEL, "P2P Provision discovery"),
+    P2P_EVENT_MAP_ENTRY("P2P-PROV-DISC-SHOW-PIN", EVENT_SHOW_PIN, INFO_LEVEL, "P2P Provision discovery show PIN "),
+    P2P_EVENT_MAP_ENTRY("P2P-GO-NEG-REQUEST", EVENT_GO_NEG_REQ, INFO_LEVEL, "P2P Group owner negotiation request"),
+    P2P_EVENT_MAP_ENTRY("P2P-GO-NEG-SUCCESS", EVENT_GO_NEG_SUCCESS, INFO_LEVEL, "P2P Group owner negotiation success"),
+    P2P_EVENT_MAP_ENTRY("P2P-GO-NEG-FAILURE", EVENT_GO_NEG_FAILURE, ERROR_LEVEL, "P2P GO negotiation failure"),
+    P2P_EVENT_MAP_ENTRY("P2P-GROUP-FORMATION-SUCCESS", EVENT_FORMATION_SUCCESS, INFO_LEVEL, "P2P Formation Success"),
+    P2P_EVENT_MAP_ENTRY("P2P-GROUP-FORMATION-FAILURE", EVENT_FORMATION_FAILURE, ERROR_LEVEL, "P2P Group formation failure"),
+    P2P_EVENT_MAP_ENTRY("P2P-GROUP-STARTED", EVENT_GROUP_STARTED, INFO_LEVEL, "P2P Group Started"),
+    P2P_EVENT_MAP_ENTRY("P2P-GROUP-REMOVED", EVENT_GROUP_REMOVED, INFO_LEVEL, "P2P Group Removed"),
+    P2P_EVENT_MAP_ENTRY("P2P-FIND-STOPPED", EVENT_STOP, INFO_LEVEL, "P2P find stopped"),
+};
+
+static const char *p2p_event_keys[P2P_EVENT_KEY_MAX] =
+{
+    "p2p_dev_addr",
+    "pri_dev_type",
+    "name",
+    "config_methods",
+    "wfd_dev_info",
+    "dev_passwd_id",
+    "peer_iface",
+    "freq",
+    "ssid",
+    "go_dev_addr",
+    "ip_addr",
+    "ip_mask",
+    "go_ip_addr"
+};
+
+/* Skips the "<N>" level tag and the "IFNAME=<iface> " prefix of global control interface events */
+static const char *p2p_skip_event_header(const char *event)
+{
+    if ('<' == *event)
+    {
+        const char *tag_end = strchr(event, '>');
+        if (nullptr == tag_end)
+        {
+            return nullptr;
+        }
+        event = tag_end + 1;
+    }
+    if (0 == strncmp(event, P2P_EVENT_IFNAME_TAG, sizeof(P2P_EVENT_IFNAME_TAG) - 1))
+    {
+        const char *ifname_end = strchr(event, ' ');
+        if (nullptr == ifname_end)
+        {
+            return nullptr;
+        }
+        event = ifname_end + 1;
+    }
+    return event;
+}
+
+/*
+ * Classifies an event in a single pass over its name. Anything other than a
+ * known P2P- event (e.g. the CTRL-EVENT-BSS-* scan noise) is discarded here.
+ */
+const P2P_EVENT_MAP *p2p_classify_event(const char *event)
+{
+    event = p2p_skip_event_header(event);
+    if ((nullptr == event) || (0 != strncmp(event, P2P_EVENT_PREFIX, P2P_EVENT_PREFIX_LEN)))
+    {
+        return nullptr;
+    }
+    for (const P2P_EVENT_MAP &event_map : p2p_event_map)
+    {
+        if ((0 == strncmp(event + P2P_EVENT_PREFIX_LEN,
+                          event_map.prefix + P2P_EVENT_PREFIX_LEN,
+                          event_map.prefix_len - P2P_EVENT_PREFIX_LEN)) &&
+            (('\0' == event[event_map.prefix_len]) || (' ' == event[event_map.prefix_len])))
+        {
+            return &event_map;
+        }
+    }
+    return nullptr;
+}
+
+/* Tokenizes the event line once, the fields are views into the event buffer */
+void parse_p2p_event_fields(const char *event, P2P_EVENT_FIELDS &event_fields)
+{
+    memset(&event_fields, 0x00, sizeof(event_fields));
+
+    const char *cursor = (nullptr != event) ? p2p_skip_event_header(event) : nullptr;
+    if (nullptr == cursor)
+    {
+        return;
+    }
+
+    /* Event name */
+    cursor += strcspn(cursor, " ");
+
+    while ('\0' != *cursor)
+    {
+        while (' ' == *cursor)
+        {
+            cursor++;
+        }
+        if ('\0' == *cursor)
+        {
+            break;
+        }
+
+        const char *token = cursor;
+        size_t key_length = strcspn(token, "= ");
+
+        if ('=' != token[key_length])
+        {
+            if (P2P_EVENT_MAX_ARGS > event_fields.args_count)
+            {
+                event_fields.args[event_fields.args_count].value = token;
+                event_fields.args[event_fields.args_count].length = key_length;
+                event_fields.args_count++;
+            }
+            cursor = token + key_length;
+            continue;
+        }
+
+        const char *value = token + key_length + 1;
+        size_t value_length = 0;
+
+        if (('\'' == *value) || ('"' == *value))
+        {
+            const char *quote_end = strchr(value + 1, *value);
+            if (nullptr == quote_end)
+            {
+                MIRACASTLOG_WARNING("Unterminated quote in [%s]", token);
+                break;
+            }
+            value++;
+            value_length = quote_end - value;
+            cursor = quote_end + 1;
+        }
+        else
+        {
+            value_length = strcspn(value, " ");
+            cursor = value + value_length;
+        }
+
+        for (int key = 0; key < P2P_EVENT_KEY_MAX; ++key)
+        {
+            if ((0 == strncmp(token, p2p_event_keys[key], key_length)) &&
+                ('\0' == p2p_event_keys[key][key_length]))
+            {
+                event_fields.fields[key].value = value;
+                event_fields.fields[key].length = value_length;
+                break;
+            }
+        }
+    }
+}
+
+std::string get_p2p_event_field(const P2P_EVENT_FIELDS &event_fields, P2P_EVENT_KEY key)
+{
+    if ((P2P_EVENT_KEY_MAX <= key) || (nullptr == event_fields.fields[key].value))
+    {
+        return "";
+    }
+    return std::string(event_fields.fields[key].value, event_fields.fields[key].length);
+}
+
+std::string get_p2p_event_arg(const P2P_EVENT_FIELDS &event_fields, unsigned int index)
+{
+    if (event_fields.args_count <= index)
+    {
+        return "";
+    }
+    return std::string(event_fields.args[index].value, event_fields.args[index].length);
+}
+
+bool has_p2p_event_arg(const P2P_EVENT_FIELDS &event_fields, const char *arg)
+{
+    size_t arg_length = strlen(arg);
+
+    for (unsigned int index = 0; index < event_fields.args_count; ++index)
+    {
+        if ((arg_length == event_fields.args[index].length) &&
+            (0 == strncmp(event_fields.args[index].value, arg, arg_length)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Maps a 20 MHz channel centre frequency to its global operating class and channel number */
+static bool p2p_freq_to_channel(unsigned int freq, unsigned int &op_class, unsigned int &channel)
+{
+    if ((2412 <= freq) && (2472 >= freq))
+    {
+        op_class = 81;
+        channel = (freq - 2407) / 5;
+    }
+    else if ((5180 <= freq) && (5825 >= freq))
+    {
+        channel = (freq - 5000) / 5;
+        if (48 >= channel)
+        {
+            op_class = 115;
+        }
+        else if (64 >= channel)
+        {
+            op_class = 118;
+        }
+        else if (144 >= channel)
+        {
+            op_class = 121;
+        }
+        else
+        {
+            op_class = 124;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
 MiracastP2P *MiracastP2P::m_miracast_p2p_obj{nullptr};
+const P2P_CTRL_OPS *MiracastP2P::m_installed_ctrl_ops{nullptr};
+
+const P2P_CTRL_OPS *MiracastP2P::set_CtrlOps(const P2P_CTRL_OPS *ctrl_ops)
+{
+    const P2P_CTRL_OPS *previous_ctrl_ops = m_installed_ctrl_ops;
+    m_installed_ctrl_ops = ctrl_ops;
+    return previous_ctrl_ops;
+}
 
 MiracastP2P::MiracastP2P(void)
 {
     MIRACASTLOG_TRACE("Entering..");
+    m_ctrl_ops = m_installed_ctrl_ops;
     m_ctrler_evt_hdlr = nullptr;
     m_p2p_ctrl_monitor_thread_id = 0;
+    m_p2p_monitor_epoll_fd = -1;
+    m_p2p_monitor_shutdown_fd = -1;
     m_wpa_p2p_cmd_ctrl_iface = nullptr;
     m_wpa_p2p_ctrl_monitor = nullptr;
     m_stop_p2p_monitor = false;
     m_isWiFiDisplayParamsEnabled = false;
-    m_event_buffer_len = 0;
+    m_aligned_sta_freq = 0;
+    m_sta_freq = 0;
+    m_cached_sta_freq = 0;
+    m_sta_change_count = 0;
+    m_sta_freq_valid = false;
+    m_wpa_sta_cmd_ctrl_iface = nullptr;
 
     m_authType = MIRACAST_DFLT_CFG_METHOD;
     m_friendly_name = "";
-
-    memset(m_event_buffer, '\0', sizeof(m_event_buffer));
     MIRACASTLOG_TRACE("Exiting..");
 }
 
@@ -65,7 +315,7 @@ MiracastP2P::~MiracastP2P()
     MIRACASTLOG_TRACE("Exiting..");
 }
 
-MiracastP2P *MiracastP2P::getInstance(MiracastError &error_code,std::string p2p_ctrl_iface)
+MiracastP2P *MiracastP2P::getInstance(MiracastError &error_code,std::string p2p_ctrl_iface, int cancel_fd)
 {
     MiracastError ret_code = MIRACAST_OK;
 
@@ -74,7 +324,7 @@ MiracastP2P *MiracastP2P::getInstance(MiracastError &error_code,std::string p2p_
     {
         m_miracast_p2p_obj = new MiracastP2P();
         if (nullptr != m_miracast_p2p_obj){
-            ret_code = m_miracast_p2p_obj->Init(std::move(p2p_ctrl_iface));
+            ret_code = m_miracast_p2p_obj->Init(std::move(p2p_ctrl_iface), cancel_fd);
             if ( MIRACAST_OK != ret_code){
                 destroyInstance();
             }
@@ -96,10 +346,118 @@ void MiracastP2P::destroyInstance()
     MIRACASTLOG_TRACE("Exiting...");
 }
 
+static uint64_t p2p_monotonic_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000) + (now.tv_nsec / 1000000);
+}
+
+/*
+ * The socket appears as soon as wpa_supplicant creates the interface, so an
+ * inotify watch wakes us up right then instead of polling. The socket
+ * directory is created by wpa_supplicant as well, its parent is watched until
+ * it shows up.
+ */
+bool MiracastP2P::wait_for_CtrlIface(const std::string &p2p_ctrl_iface, unsigned int timeout_ms, int cancel_fd)
+{
+    std::string ctrl_path = std::string(WPA_SUP_DFLT_CTRL_PATH) + p2p_ctrl_iface,
+                ctrl_dir = WPA_SUP_DFLT_CTRL_PATH;
+    uint64_t deadline_ms = p2p_monotonic_ms() + timeout_ms;
+    int inotify_fd = -1,
+        dir_wd = -1,
+        parent_wd = -1;
+    bool found = false;
+
+    MIRACASTLOG_TRACE("Entering..");
+    ctrl_dir.erase(ctrl_dir.find_last_not_of('/') + 1);
+    std::string parent_dir = ctrl_dir.substr(0, ctrl_dir.find_last_of('/'));
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (0 > inotify_fd)
+    {
+        MIRACASTLOG_WARNING("inotify_init1 failed [%s], polling for [%s]", strerror(errno), ctrl_path.c_str());
+    }
+
+    while (true)
+    {
+        if ((0 <= inotify_fd) && (0 > dir_wd))
+        {
+            dir_wd = inotify_add_watch(inotify_fd, ctrl_dir.c_str(), IN_CREATE | IN_MOVED_TO | IN_ATTRIB);
+            if ((0 > dir_wd) && (0 > parent_wd))
+            {
+                parent_wd = inotify_add_watch(inotify_fd, parent_dir.c_str(), IN_CREATE | IN_MOVED_TO);
+            }
+        }
+        /* Checked after arming the watch so a socket created in between is not missed */
+        if (0 == access(ctrl_path.c_str(), F_OK))
+        {
+            found = true;
+            break;
+        }
+
+        uint64_t now_ms = p2p_monotonic_ms();
+        if (now_ms >= deadline_ms)
+        {
+            break;
+        }
+
+        struct pollfd fds[2];
+        nfds_t nfds = 0;
+        int wait_ms = static_cast<int>(deadline_ms - now_ms);
+
+        if (0 <= inotify_fd)
+        {
+            fds[nfds].fd = inotify_fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            nfds++;
+        }
+        else if (wait_ms > 100)
+        {
+            wait_ms = 100;
+        }
+        if (0 <= cancel_fd)
+        {
+            fds[nfds].fd = cancel_fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            nfds++;
+        }
+
+        int num_ready = poll(fds, nfds, wait_ms);
+        if ((0 > num_ready) && (EINTR != errno))
+        {
+            MIRACASTLOG_ERROR("poll failed [%s]", strerror(errno));
+            break;
+        }
+        if ((0 <= cancel_fd) && (0 < num_ready) && (fds[nfds - 1].revents & POLLIN))
+        {
+            MIRACASTLOG_INFO("Wait for [%s] cancelled", ctrl_path.c_str());
+            break;
+        }
+        if ((0 <= inotify_fd) && (0 < num_ready) && (fds[0].revents & POLLIN))
+        {
+            char event_buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            /* The events only trigger the re-check above, their content does not matter */
+            while (0 < read(inotify_fd, event_buffer, sizeof(event_buffer)));
+        }
+    }
+
+    if (0 <= inotify_fd)
+    {
+        close(inotify_fd);
+    }
+    MIRACASTLOG_INFO("P2P ctrl iface [%s] %s", ctrl_path.c_str(), found ? "available" : "not available");
+    MIRACASTLOG_TRACE("Exiting..");
+    return found;
+}
+
 /* The control and monitoring interface is defined and initialized during the init phase */
 void p2p_monitor_thread(void *ptr);
 
-int MiracastP2P::p2pWpaCtrlSendCmd(char *cmd, struct wpa_ctrl *wpa_p2p_ctrl_iface, char *ret_buf,size_t actual_buf_len)
+
+int MiracastP2P::p2pWpaCtrlSendCmd(char *cmd, struct wpa_ctrl *wpa_p2p_ctrl_iface, unsigned int timeout_ms, char *ret_buf,size_t actual_buf_len)
 {
     int ret;
     size_t buf_len = actual_buf_len;
@@ -111,7 +469,7 @@ int MiracastP2P::p2pWpaCtrlSendCmd(char *cmd, struct wpa_ctrl *wpa_p2p_ctrl_ifac
         return -1;
     }
 
-    ret = wpa_ctrl_request(wpa_p2p_ctrl_iface, cmd, strlen(cmd), ret_buf, &buf_len, NULL);
+    ret = m_ctrl_ops->ctrl_request(wpa_p2p_ctrl_iface, cmd, ret_buf, &buf_len, timeout_ms);
 
     if (ret == -2)
     {
@@ -129,23 +487,123 @@ void MiracastP2P::Release_P2PCtrlInterface(void)
 {
     if ( m_wpa_p2p_cmd_ctrl_iface )
     {
-        wpa_ctrl_close(m_wpa_p2p_cmd_ctrl_iface);
+        m_ctrl_ops->ctrl_close(m_wpa_p2p_cmd_ctrl_iface);
         m_wpa_p2p_cmd_ctrl_iface = nullptr;
     }
+    if ( m_wpa_sta_cmd_ctrl_iface )
+    {
+        m_ctrl_ops->ctrl_close(m_wpa_sta_cmd_ctrl_iface);
+        m_wpa_sta_cmd_ctrl_iface = nullptr;
+    }
     if ( m_wpa_p2p_ctrl_monitor )
     {
-        wpa_ctrl_close(m_wpa_p2p_ctrl_monitor);
+        m_ctrl_ops->ctrl_close(m_wpa_p2p_ctrl_monitor);
         m_wpa_p2p_ctrl_monitor = nullptr;
     }
+    if ( 0 <= m_p2p_monitor_epoll_fd )
+    {
+        close(m_p2p_monitor_epoll_fd);
+        m_p2p_monitor_epoll_fd = -1;
+    }
+    if ( 0 <= m_p2p_monitor_shutdown_fd )
+    {
+        close(m_p2p_monitor_shutdown_fd);
+        m_p2p_monitor_shutdown_fd = -1;
+    }
+}
+
+/* Monitor thread blocks on the wpa_ctrl socket and an eventfd used to wake it up for shutdown */
+MiracastError MiracastP2P::p2pCreateMonitorWaitFds(void)
+{
+    struct epoll_event event;
+    int monitor_fd = m_ctrl_ops->ctrl_get_fd(m_wpa_p2p_ctrl_monitor);
+
+    MIRACASTLOG_TRACE("Entering..");
+    if (0 > monitor_fd)
+    {
+        MIRACASTLOG_ERROR("WIFI_HAL: Invalid monitor socket fd");
+        return MIRACAST_P2P_INIT_FAILED;
+    }
+
+    m_p2p_monitor_shutdown_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    m_p2p_monitor_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if ((0 > m_p2p_monitor_shutdown_fd) || (0 > m_p2p_monitor_epoll_fd))
+    {
+        MIRACASTLOG_ERROR("WIFI_HAL: eventfd/epoll creation failed [%s]", strerror(errno));
+        return MIRACAST_P2P_INIT_FAILED;
+    }
+
+    memset(&event, 0x00, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = monitor_fd;
+    if (0 != epoll_ctl(m_p2p_monitor_epoll_fd, EPOLL_CTL_ADD, monitor_fd, &event))
+    {
+        MIRACASTLOG_ERROR("WIFI_HAL: epoll_ctl failed for monitor fd [%s]", strerror(errno));
+        return MIRACAST_P2P_INIT_FAILED;
+    }
+
+    event.events = EPOLLIN;
+    event.data.fd = m_p2p_monitor_shutdown_fd;
+    if (0 != epoll_ctl(m_p2p_monitor_epoll_fd, EPOLL_CTL_ADD, m_p2p_monitor_shutdown_fd, &event))
+    {
+        MIRACASTLOG_ERROR("WIFI_HAL: epoll_ctl failed for shutdown fd [%s]", strerror(errno));
+        return MIRACAST_P2P_INIT_FAILED;
+    }
+    MIRACASTLOG_TRACE("Exiting..");
+    return MIRACAST_OK;
+}
+
+/*
+ * Blocks until the monitor socket becomes readable or shutdown is requested.
+ * Returns false once the monitor thread has to exit.
+ */
+bool MiracastP2P::p2pWaitForMonitorEvents(void)
+{
+    struct epoll_event events[P2P_MONITOR_MAX_EPOLL_EVENTS];
+    bool socket_readable = false;
+
+    while (!socket_readable)
+    {
+        int num_ready = epoll_wait(m_p2p_monitor_epoll_fd, events, P2P_MONITOR_MAX_EPOLL_EVENTS, -1);
+
+        if (0 > num_ready)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            MIRACASTLOG_ERROR("WIFI_HAL: epoll_wait failed [%s]", strerror(errno));
+            return false;
+        }
+
+        for (int i = 0; i < num_ready; i++)
+        {
+            if (events[i].data.fd == m_p2p_monitor_shutdown_fd)
+            {
+                MIRACASTLOG_INFO("P2P monitor shutdown requested");
+                return false;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                /* Stop watching a broken socket, keep waiting for the shutdown request */
+                MIRACASTLOG_ERROR("WIFI_HAL: monitor socket error events[%#x]", events[i].events);
+                epoll_ctl(m_p2p_monitor_epoll_fd, EPOLL_CTL_DEL, events[i].data.fd, nullptr);
+                continue;
+            }
+            socket_readable = true;
+        }
+    }
+    return (true != m_stop_p2p_monitor);
 }
 
 // Initializes WiFi - P2P
 // Connects to the wpa_supplicant via control interface
 // Gets attached to wpa_supplicant to receiver events
 // Starts the p2p_monitor thread
-MiracastError MiracastP2P::p2pInit(const std::string& p2p_ctrl_iface)
+MiracastError MiracastP2P::p2pInit(const std::string& p2p_ctrl_iface, int cancel_fd)
 {
-    int retry = 0;
+    unsigned int backoff_ms = 50;
+    uint64_t open_deadline_ms = 0;
     m_stop_p2p_monitor = false;
     pthread_attr_t thread_attr;
     int ret = 0;
@@ -153,23 +611,43 @@ MiracastError MiracastP2P::p2pInit(const std::string& p2p_ctrl_iface)
     MIRACASTLOG_VERBOSE("WIFI_HAL: Initializing P2P WiFi HAL.");
     std::string wpa_supp_ctrl_path_name = WPA_SUP_DFLT_CTRL_PATH;
 
+    if (nullptr == m_ctrl_ops)
+    {
+        MIRACASTLOG_ERROR("WIFI_HAL: No control interface backend installed");
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_P2P_INIT_FAILED;
+    }
     wpa_supp_ctrl_path_name.append(p2p_ctrl_iface);
 
-    if (0 != access(wpa_supp_ctrl_path_name.c_str(), F_OK))
+    /* wpa_supplicant may still be creating the interface, give it a moment */
+    if (!wait_for_CtrlIface(p2p_ctrl_iface, P2P_CTRL_IFACE_SYNC_WAIT_MS, cancel_fd))
     {
         MIRACASTLOG_ERROR("Unable to find P2P ctrl iface path[%s]", wpa_supp_ctrl_path_name.c_str());
         return MIRACAST_INVALID_P2P_CTRL_IFACE;
     }
 
-    /* Starting wpa_supplicant may take some time, try 10 times before giving up */
-    retry = 0;
-    while (retry++ < 10)
+    /* The socket file can exist before wpa_supplicant listens on it, retry with a short backoff */
+    open_deadline_ms = p2p_monotonic_ms() + P2P_CTRL_OPEN_TIMEOUT_MS;
+    while (true)
     {
-        m_wpa_p2p_cmd_ctrl_iface = wpa_ctrl_open(wpa_supp_ctrl_path_name.c_str());
-        if (m_wpa_p2p_cmd_ctrl_iface != NULL)
+        m_wpa_p2p_cmd_ctrl_iface = m_ctrl_ops->ctrl_open(wpa_supp_ctrl_path_name.c_str());
+        if ((m_wpa_p2p_cmd_ctrl_iface != NULL) || (p2p_monotonic_ms() >= open_deadline_ms))
             break;
-        MIRACASTLOG_ERROR("WIFI_HAL: p2p ctrl_open returned NULL ");
-        sleep(1);
+        MIRACASTLOG_ERROR("WIFI_HAL: p2p ctrl_open returned NULL, retry in %u ms", backoff_ms);
+        if (0 <= cancel_fd)
+        {
+            struct pollfd cancel_poll = {cancel_fd, POLLIN, 0};
+            if (0 < poll(&cancel_poll, 1, static_cast<int>(backoff_ms)))
+            {
+                MIRACASTLOG_INFO("WIFI_HAL: P2P init cancelled");
+                break;
+            }
+        }
+        else
+        {
+            usleep(backoff_ms * 1000);
+        }
+        backoff_ms = std::min(backoff_ms * 2, static_cast<unsigned int>(P2P_CTRL_OPEN_MAX_BACKOFF_MS));
     }
     if (m_wpa_p2p_cmd_ctrl_iface == NULL)
     {
@@ -179,7 +657,7 @@ MiracastError MiracastP2P::p2pInit(const std::string& p2p_ctrl_iface)
     }
     MIRACASTLOG_VERBOSE("WIFI_HAL: m_wpa_p2p_cmd_ctrl_iface created successfully.");
 
-    m_wpa_p2p_ctrl_monitor = wpa_ctrl_open(wpa_supp_ctrl_path_name.c_str());
+    m_wpa_p2p_ctrl_monitor = m_ctrl_ops->ctrl_open(wpa_supp_ctrl_path_name.c_str());
     if (m_wpa_p2p_ctrl_monitor == NULL)
     {
         MIRACASTLOG_ERROR("WIFI_HAL: wpa_ctrl_open for p2p failed for monitor interface ");
@@ -188,7 +666,7 @@ MiracastError MiracastP2P::p2pInit(const std::string& p2p_ctrl_iface)
         return MIRACAST_P2P_INIT_FAILED;
     }
     MIRACASTLOG_VERBOSE("WIFI_HAL: m_wpa_p2p_ctrl_monitor created successfully.");
-    if (wpa_ctrl_attach(m_wpa_p2p_ctrl_monitor) != 0)
+    if (m_ctrl_ops->ctrl_attach(m_wpa_p2p_ctrl_monitor) != 0)
     {
         MIRACASTLOG_ERROR("WIFI_HAL: p2p wpa_ctrl_attach failed ");
         Release_P2PCtrlInterface();
@@ -196,6 +674,25 @@ MiracastError MiracastP2P::p2pInit(const std::string& p2p_ctrl_iface)
         return MIRACAST_P2P_INIT_FAILED;
     }
     MIRACASTLOG_VERBOSE("WIFI_HAL: m_wpa_p2p_ctrl_monitor attached successfully.");
+
+    if (MIRACAST_OK != p2pCreateMonitorWaitFds())
+    {
+        Release_P2PCtrlInterface();
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_P2P_INIT_FAILED;
+    }
+
+    ret = m_command_queue.start([this](const char *cmd, int interface, unsigned int timeout_ms, char *ret_buf, size_t ret_buf_len)
+                                {
+                                    return p2pExecute(const_cast<char *>(cmd), static_cast<P2P_INTERFACE>(interface), timeout_ms, ret_buf, ret_buf_len);
+                                });
+    if (MIRACAST_OK != ret)
+    {
+        Release_P2PCtrlInterface();
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_P2P_INIT_FAILED;
+    }
+
     pthread_attr_init(&thread_attr);
     pthread_attr_setstacksize(&thread_attr, 256 * 1024);
 
@@ -203,6 +700,7 @@ MiracastError MiracastP2P::p2pInit(const std::string& p2p_ctrl_iface)
     if (ret != 0)
     {
         MIRACASTLOG_ERROR("WIFI_HAL: P2P Monitor thread creation failed ");
+        m_command_queue.stop(0);
         Release_P2PCtrlInterface();
         MIRACASTLOG_TRACE("Exiting...");
         return MIRACAST_P2P_INIT_FAILED;
@@ -229,13 +727,24 @@ MiracastError MiracastP2P::p2pUninit()
     if (0!=m_p2p_ctrl_monitor_thread_id)
     {
         m_stop_p2p_monitor = true;
+        if (0 <= m_p2p_monitor_shutdown_fd)
+        {
+            uint64_t wakeup = 1;
+            if (sizeof(wakeup) != write(m_p2p_monitor_shutdown_fd, &wakeup, sizeof(wakeup)))
+            {
+                MIRACASTLOG_ERROR("WIFI_HAL: Failed to wakeup P2P Monitor thread [%s]", strerror(errno));
+            }
+        }
         pthread_join(m_p2p_ctrl_monitor_thread_id, nullptr);
+        m_p2p_ctrl_monitor_thread_id = 0;
     }
 
     if ( nullptr != m_wpa_p2p_cmd_ctrl_iface )
     {
         stop_discover_devices();
     }
+    /* Let the queued commands reach wpa_supplicant before the control socket is closed */
+    m_command_queue.stop(P2P_CMD_DRAIN_TIMEOUT_MS);
     Release_P2PCtrlInterface();
 
     MIRACASTLOG_TRACE("Exiting..");
@@ -252,138 +761,126 @@ void MiracastP2P::p2pCtrlMonitorThread()
 
     while ((m_stop_p2p_monitor != true) && (m_wpa_p2p_ctrl_monitor != NULL))
     {
-        if (wpa_ctrl_pending(m_wpa_p2p_ctrl_monitor) > 0)
+        /* Drain everything queued on the socket before blocking again */
+        while ((m_stop_p2p_monitor != true) && (m_ctrl_ops->ctrl_pending(m_wpa_p2p_ctrl_monitor) > 0))
         {
-            memset(m_event_buffer, '\0', sizeof(m_event_buffer));
-            m_event_buffer_len = sizeof(m_event_buffer) - 1;
-
-            if (0 == wpa_ctrl_recv(m_wpa_p2p_ctrl_monitor, m_event_buffer, &m_event_buffer_len))
+            if (!p2pRecvAndDispatchEvent(miracast_obj, goStart))
             {
-                if (!(( strstr( m_event_buffer , "CTRL-EVENT-BSS-ADDED" )) ||
-                    ( strstr( m_event_buffer , "CTRL-EVENT-BSS-REMOVED" )))){
-                    MIRACASTLOG_TRACE("wpa_ctrl_recv got m_event_buffer = [%s]\n", m_event_buffer);
-                }
+                break;
+            }
+        }
+        if (!p2pWaitForMonitorEvents())
+        {
+            break;
+        }
+    }
+    MIRACASTLOG_TRACE("Exiting ctrl monitor thread");
+}
 
-                if (strstr(m_event_buffer, "P2P-DEVICE-FOUND"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P Device Found");
-                    miracast_obj->event_handler(EVENT_FOUND, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-PROV-DISC-PBC-REQ"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P Provision discovery");
-                    miracast_obj->event_handler(EVENT_PROVISION, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-PROV-DISC-SHOW-PIN"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P Provision discovery show PIN ");
-                    miracast_obj->event_handler(EVENT_SHOW_PIN, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-GO-NEG-REQUEST"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P Group owner negotiation request");
-                    miracast_obj->event_handler(EVENT_GO_NEG_REQ, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-FIND-STOPPED"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P find stopped");
-                    miracast_obj->event_handler(EVENT_STOP, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-GO-NEG-SUCCESS"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P Group owner negotiation success");
-                    miracast_obj->event_handler(EVENT_GO_NEG_SUCCESS, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-GROUP-FORMATION-SUCCESS"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P Formation Success");
-                    miracast_obj->event_handler(EVENT_FORMATION_SUCCESS, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-GROUP-STARTED"))
-                {
-                    if (!goStart)
-                    {
-                        char *evt_buf = strdup(m_event_buffer);
-                        MIRACASTLOG_INFO("P2P Group Started");
-                        goStart = true;
-                        miracast_obj->event_handler(EVENT_GROUP_STARTED, (void *)evt_buf, m_event_buffer_len);
-                    }
-                }
-                if (strstr(m_event_buffer, "P2P-GROUP-REMOVED"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_INFO("P2P Group Removed");
-                    miracast_obj->event_handler(EVENT_GROUP_REMOVED, (void *)evt_buf, m_event_buffer_len);
-                    goStart = false;
-                }
-                if (strstr(m_event_buffer, "P2P-DEVICE-LOST"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_WARNING("P2P Device Lost");
-                    miracast_obj->event_handler(EVENT_DEVICE_LOST, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-GROUP-FORMATION-FAILURE"))
-                {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_ERROR("P2P Group formation failure");
-                    miracast_obj->event_handler(EVENT_FORMATION_FAILURE, (void *)evt_buf, m_event_buffer_len);
-                }
-                if (strstr(m_event_buffer, "P2P-GO-NEG-FAILURE"))
+bool MiracastP2P::p2pRecvAndDispatchEvent(MiracastController *miracast_obj, bool &goStart)
+{
+    MiracastEventBufferPool *event_pool = MiracastEventBufferPool::getInstance();
+    MIRACAST_EVENT_BUFFER *event_buffer = event_pool->acquire();
+    size_t event_len = sizeof(event_buffer->data) - 1;
+
+    if (0 != m_ctrl_ops->ctrl_recv(m_wpa_p2p_ctrl_monitor, event_buffer->data, &event_len))
+    {
+        MIRACASTLOG_ERROR("WIFI_HAL: Failed to receive from monitor socket");
+        event_pool->release(event_buffer);
+        return false;
+    }
+    else
+    {
+        event_buffer->data[event_len] = '\0';
+        event_buffer->length = strlen(event_buffer->data);
+
+        const P2P_EVENT_MAP *event_map = p2p_classify_event(event_buffer->data);
+
+        if (nullptr != event_map)
+        {
+            MIRACASTLOG_TRACE("wpa_ctrl_recv got event_buffer = [%s]\n", event_buffer->data);
+
+            if (EVENT_GROUP_STARTED == event_map->event_id)
+            {
+                if (goStart)
                 {
-                    char *evt_buf = strdup(m_event_buffer);
-                    MIRACASTLOG_ERROR("P2P GO negotiation failure");
-                    miracast_obj->event_handler(EVENT_GO_NEG_FAILURE, (void *)evt_buf, m_event_buffer_len);
+                    event_pool->release(event_buffer);
+                    return true;
                 }
+                goStart = true;
+            }
+            else if (EVENT_GROUP_REMOVED == event_map->event_id)
+            {
+                goStart = false;
             }
+            _LOG(event_map->log_level, "%s", event_map->description);
+            /* Ownership of the buffer reference moves to the controller */
+            miracast_obj->event_handler(event_map->event_id, event_buffer);
+            event_buffer = nullptr;
         }
-        usleep(50000);
     }
-    MIRACASTLOG_TRACE("Exiting ctrl monitor thread");
+    event_pool->release(event_buffer);
+    return true;
 }
 
-int MiracastP2P::p2pExecute(char *cmd, enum INTERFACE iface, char *ret_buf, size_t actual_buffer_len)
+int MiracastP2P::p2pExecute(char *cmd, enum INTERFACE iface, unsigned int timeout_ms, char *ret_buf, size_t actual_buffer_len)
 {
     int ret = -1;
     MIRACASTLOG_TRACE("Entering...");
     MIRACASTLOG_VERBOSE("WIFI_HAL: Command to execute - %s", cmd);
-    if ( nullptr != m_wpa_p2p_cmd_ctrl_iface )
+    if (GLOBAL_INTERFACE == iface)
+    {
+        /* Only the per-interface control socket of the P2P device is opened */
+        MIRACASTLOG_ERROR("WIFI_HAL: global ctrl iface not available for [%s]", cmd);
+    }
+    else if (STA_INTERFACE == iface)
+    {
+        struct wpa_ctrl *sta_ctrl_iface = get_STACtrlInterface();
+        if (nullptr != sta_ctrl_iface)
+        {
+            ret = p2pWpaCtrlSendCmd(cmd, sta_ctrl_iface, timeout_ms, ret_buf, actual_buffer_len);
+        }
+    }
+    else if ( nullptr != m_wpa_p2p_cmd_ctrl_iface )
     {
-        ret = p2pWpaCtrlSendCmd(cmd, m_wpa_p2p_cmd_ctrl_iface, ret_buf,actual_buffer_len);
+        ret = p2pWpaCtrlSendCmd(cmd, m_wpa_p2p_cmd_ctrl_iface, timeout_ms, ret_buf,actual_buffer_len);
     }
     MIRACASTLOG_TRACE("Exiting...");
     return ret;
 }
 
+/* Runs the command on the command worker and waits for its reply, bounded by the command deadline */
 MiracastError MiracastP2P::executeCommand(const std::string& command, int interface, std::string &retBuffer)
 {
+    MiracastError ret = MIRACAST_FAIL;
     MIRACASTLOG_TRACE("Entering..");
+    ret = m_command_queue.execute(command, interface, retBuffer);
+    MIRACASTLOG_TRACE("Exiting..");
+    return ret;
+}
 
-    MIRACASTLOG_INFO("Executing P2P command %s", command.c_str());
-    {
-        char ret_buffer[2048] = {0};
-        p2pExecute((char *)command.c_str(), static_cast<P2P_INTERFACE>(interface), ret_buffer,sizeof(ret_buffer));
-        retBuffer = ret_buffer;
-        MIRACASTLOG_INFO("command return buffer is - %s", retBuffer.c_str());
-    }
+/* Queues the command on the command worker, failures are only logged */
+void MiracastP2P::executeCommandAsync(const std::string& command, int interface)
+{
+    MIRACASTLOG_TRACE("Entering..");
+    m_command_queue.submit(command, interface, 0, [](const std::string &cmd, const P2P_COMMAND_RESULT &result)
+                                        {
+                                            if ((MIRACAST_OK != result.status) || (0 == result.reply.compare(0, strlen("FAIL"), "FAIL")))
+                                            {
+                                                MIRACASTLOG_ERROR("P2P command [%s] failed [%s]", cmd.c_str(), result.reply.c_str());
+                                            }
+                                        });
     MIRACASTLOG_TRACE("Exiting..");
-    return MIRACAST_OK;
 }
 
-MiracastError MiracastP2P::Init( std::string p2p_ctrl_iface )
+MiracastError MiracastP2P::Init( std::string p2p_ctrl_iface, int cancel_fd )
 {
     MiracastError ret_code = MIRACAST_OK;
 
     MIRACASTLOG_TRACE("Entering..");
 
     {
-        ret_code = p2pInit(std::move(p2p_ctrl_iface));
+        ret_code = p2pInit(std::move(p2p_ctrl_iface), cancel_fd);
         if (MIRACAST_OK != ret_code)
         {
             MIRACASTLOG_ERROR("P2P Init failed");
@@ -398,24 +895,22 @@ MiracastError MiracastP2P::Init( std::string p2p_ctrl_iface )
     return ret_code;
 }
 
-MiracastError MiracastP2P::set_WFDParameters(void)
+MiracastError MiracastP2P::set_WFDParameters(const std::string &sta_iface_name, uint32_t sta_change_count)
 {
     MiracastError ret = MIRACAST_OK;
     MIRACASTLOG_TRACE("Entering..");
     if (false == m_isWiFiDisplayParamsEnabled)
     {
-        std::string command, retBuffer;
-        command = "STATUS";
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        std::string command;
         command = "SET wifi_display 1";
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
         command = "WFD_SUBELEM_SET 0";
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
         command = "WFD_SUBELEM_SET 0 000600111c4400c8";
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
-        std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_custom_p2p_cfg");
+        std::string opt_flag_buffer = MiracastOptFlags::getInstance()->get_string(MIRACAST_OPT_CUSTOM_P2P_CFG);
         if (!opt_flag_buffer.empty())
         {
             command = "SET config_methods " + opt_flag_buffer;
@@ -424,24 +919,26 @@ MiracastError MiracastP2P::set_WFDParameters(void)
         {
             command = "SET config_methods pbc";
         }
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
         set_FriendlyName(get_FriendlyName() , true);
         /* Set Device type */
         command = "SET device_type 1-0050F204-1";
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
         /* Set persistent_reconnect to true */
         command = "SET persistent_reconnect 1";
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
         /* Adding Post Fix name */
         command = "SET p2p_ssid_postfix -Element-Xumo-TV";
-        executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
         /* Set p2p_go_intent to 14 */
         command = "SET p2p_go_intent 14";
-        executeCommand(std::move(command), NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
+
+        align_OperatingChannel(sta_iface_name, sta_change_count);
 
         m_isWiFiDisplayParamsEnabled = true;
     }
@@ -453,19 +950,20 @@ void MiracastP2P::reset_WFDParameters(void)
 {
     MIRACASTLOG_TRACE("Entering...");
     m_isWiFiDisplayParamsEnabled = false;
+    m_aligned_sta_freq = 0;
     MIRACASTLOG_TRACE("Exiting...");
 }
 
 MiracastError MiracastP2P::discover_devices(void)
 {
-    MiracastError ret = MIRACAST_FAIL;
-    std::string command, retBuffer;
-    std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_custom_p2p_scan");
+    MiracastError ret = MIRACAST_OK;
+    std::string command;
+    std::string opt_flag_buffer = MiracastOptFlags::getInstance()->get_string(MIRACAST_OPT_CUSTOM_P2P_SCAN);
     MIRACASTLOG_TRACE("Entering..");
 
     /*Start Passive Scanning*/
     command = "P2P_EXT_LISTEN 0 0";
-    ret = executeCommand(std::move(command), NON_GLOBAL_INTERFACE, retBuffer);
+    executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
     if (!opt_flag_buffer.empty())
     {
@@ -476,50 +974,69 @@ MiracastError MiracastP2P::discover_devices(void)
 	    command = "P2P_EXT_LISTEN 200 1000";
     }
 
-    ret = executeCommand(std::move(command), NON_GLOBAL_INTERFACE, retBuffer);
-    if (ret != MIRACAST_OK)
-    {
-        MIRACASTLOG_ERROR("Failed to discovering devices");
-    }
+    executeCommandAsync(command, NON_GLOBAL_INTERFACE);
     MIRACASTLOG_TRACE("Exiting..");
     return ret;
 }
 
 MiracastError MiracastP2P::stop_discover_devices(void)
 {
-    MiracastError ret = MIRACAST_FAIL;
-    std::string command, retBuffer;
+    MiracastError ret = MIRACAST_OK;
+    std::string command;
     MIRACASTLOG_TRACE("Entering...");
 
     /*Stop Passive Scanning*/
     command = "P2P_EXT_LISTEN 0 0";
-    ret = executeCommand(std::move(command), NON_GLOBAL_INTERFACE, retBuffer);
-    if (ret != MIRACAST_OK)
-    {
-        MIRACASTLOG_ERROR("Failed to stop discovering devices");
-    }
+    executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
     command = "P2P_STOP_FIND";
-    ret = executeCommand(std::move(command), NON_GLOBAL_INTERFACE, retBuffer);
-    if (ret != MIRACAST_OK)
-    {
-        MIRACASTLOG_ERROR("Failed to Stop discovering devices");
-    }
+    executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
     MIRACASTLOG_TRACE("Exiting...");
     return ret;
 }
 
-MiracastError MiracastP2P::connect_device(std::string MAC,std::string authType )
+MiracastError MiracastP2P::connect_device(std::string MAC,std::string authType, int persistent_network_id, const std::string &sta_iface_name, uint32_t sta_change_count )
 {
     MIRACASTLOG_TRACE("Entering...");
     MiracastError ret = MIRACAST_FAIL;
     std::string command("P2P_CONNECT"), retBuffer;
+    unsigned int sta_freq = align_OperatingChannel(sta_iface_name, sta_change_count);
     command.append(SPACE_CHAR);
     command.append(MAC);
     command.append(SPACE_CHAR);
     command.append(authType);
-    ret = (MiracastError)executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+    if (P2P_PERSISTENT_NETWORK_NEW == persistent_network_id)
+    {
+        command.append(" persistent");
+    }
+    else if (P2P_PERSISTENT_NETWORK_NONE != persistent_network_id)
+    {
+        /* Reinvoke the stored group so that WPS provisioning is skipped */
+        command.append(" persistent=");
+        command.append(std::to_string(persistent_network_id));
+    }
+    if (0 != sta_freq)
+    {
+        /* Form the group on the STA channel so the radio does not time-slice between two channels */
+        std::string freq_command = command + " freq=" + std::to_string(sta_freq);
+
+        ret = executeCommand(freq_command, NON_GLOBAL_INTERFACE, retBuffer);
+        if ((MIRACAST_OK == ret) && (0 == retBuffer.compare(0, strlen("FAIL"), "FAIL")))
+        {
+            /* The STA channel may not be allowed for P2P (e.g. DFS), let wpa_supplicant pick one */
+            MIRACASTLOG_WARNING("P2P_CONNECT on %u MHz rejected [%s], retrying without freq", sta_freq, retBuffer.c_str());
+            ret = executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        }
+        else
+        {
+            command = std::move(freq_command);
+        }
+    }
+    else
+    {
+        ret = executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+    }
     if (strstr(retBuffer.c_str(), "OK"))
     {
         ret = MIRACAST_OK;
@@ -534,19 +1051,195 @@ MiracastError MiracastP2P::connect_device(std::string MAC,std::string authType )
     return ret;
 }
 
+/*
+ * Returns the frequency of the associated wireless station, 0 when there is
+ * none. The controller passes the STA interface and the change count of its
+ * interface table; the STATUS is read over the command worker, so this never
+ * waits longer than P2P_STA_STATUS_TIMEOUT_MS. The result is kept until the
+ * change count moves, which is what a (re)association looks like from here.
+ */
+unsigned int MiracastP2P::get_STAOperatingFrequency(const std::string &sta_iface_name, uint32_t change_count)
+{
+    std::string status_buffer;
+    unsigned int sta_freq = 0;
+    MIRACASTLOG_TRACE("Entering...");
+
+    {
+        std::lock_guard<std::mutex> lock(m_sta_mutex);
+        if (m_sta_freq_valid && (change_count == m_sta_change_count) && (sta_iface_name == m_sta_iface_name))
+        {
+            MIRACASTLOG_TRACE("Exiting...");
+            return m_cached_sta_freq;
+        }
+        m_sta_iface_name = sta_iface_name;
+        m_sta_freq_valid = false;
+    }
+
+    if (sta_iface_name.empty())
+    {
+        MIRACASTLOG_VERBOSE("No wireless station interface up");
+    }
+    else if (MIRACAST_OK == m_command_queue.execute("STATUS", STA_INTERFACE, status_buffer, P2P_STA_STATUS_TIMEOUT_MS))
+    {
+        std::istringstream status(status_buffer);
+        std::string line;
+        unsigned int freq = 0;
+        bool associated = false;
+
+        while (std::getline(status, line))
+        {
+            if (0 == line.compare(0, strlen("freq="), "freq="))
+            {
+                freq = static_cast<unsigned int>(atoi(line.c_str() + strlen("freq=")));
+            }
+            else if ("wpa_state=COMPLETED" == line)
+            {
+                associated = true;
+            }
+        }
+        if (associated)
+        {
+            sta_freq = freq;
+            MIRACASTLOG_INFO("STA [%s] operating at %u MHz", sta_iface_name.c_str(), sta_freq);
+        }
+    }
+    else
+    {
+        /* Not cached, the next alignment asks again */
+        MIRACASTLOG_WARNING("STATUS of STA [%s] failed", sta_iface_name.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sta_mutex);
+        if (sta_iface_name == m_sta_iface_name)
+        {
+            m_cached_sta_freq = sta_freq;
+            m_sta_change_count = change_count;
+            m_sta_freq_valid = true;
+        }
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return sta_freq;
+}
+
+/* Runs on the command worker, (re)opens the control socket of the current STA interface */
+struct wpa_ctrl *MiracastP2P::get_STACtrlInterface(void)
+{
+    std::string sta_iface_name;
+    {
+        std::lock_guard<std::mutex> lock(m_sta_mutex);
+        sta_iface_name = m_sta_iface_name;
+    }
+
+    if ((nullptr != m_wpa_sta_cmd_ctrl_iface) && (sta_iface_name == m_sta_ctrl_iface_name))
+    {
+        return m_wpa_sta_cmd_ctrl_iface;
+    }
+    if (nullptr != m_wpa_sta_cmd_ctrl_iface)
+    {
+        m_ctrl_ops->ctrl_close(m_wpa_sta_cmd_ctrl_iface);
+        m_wpa_sta_cmd_ctrl_iface = nullptr;
+    }
+    m_sta_ctrl_iface_name = sta_iface_name;
+    if (!sta_iface_name.empty())
+    {
+        std::string ctrl_path = std::string(WPA_SUP_DFLT_CTRL_PATH) + sta_iface_name;
+        m_wpa_sta_cmd_ctrl_iface = m_ctrl_ops->ctrl_open(ctrl_path.c_str());
+        if (nullptr == m_wpa_sta_cmd_ctrl_iface)
+        {
+            MIRACASTLOG_ERROR("WIFI_HAL: wpa_ctrl_open failed for STA ctrl iface [%s]", ctrl_path.c_str());
+        }
+    }
+    return m_wpa_sta_cmd_ctrl_iface;
+}
+
+/* Steers P2P group formation and listen onto the STA channel, returns the STA frequency or 0 */
+unsigned int MiracastP2P::align_OperatingChannel(const std::string &sta_iface_name, uint32_t sta_change_count)
+{
+    unsigned int sta_freq = get_STAOperatingFrequency(sta_iface_name, sta_change_count),
+                 op_class = 0,
+                 channel = 0;
+    MIRACASTLOG_TRACE("Entering...");
+
+    m_sta_freq = sta_freq;
+    if ((0 == sta_freq) || (sta_freq == m_aligned_sta_freq))
+    {
+        /* Keep the last preference, it only ever biases the negotiation */
+        MIRACASTLOG_TRACE("Exiting...");
+        return sta_freq;
+    }
+
+    if (!p2p_freq_to_channel(sta_freq, op_class, channel))
+    {
+        MIRACASTLOG_WARNING("No P2P channel for STA frequency %u MHz", sta_freq);
+        MIRACASTLOG_TRACE("Exiting...");
+        return sta_freq;
+    }
+
+    executeCommandAsync("SET p2p_pref_chan " + std::to_string(op_class) + ":" + std::to_string(channel), NON_GLOBAL_INTERFACE);
+    if ((81 == op_class) && ((1 == channel) || (6 == channel) || (11 == channel)))
+    {
+        /* Only the social channels are valid listen channels */
+        executeCommandAsync("SET p2p_listen_reg_class 81", NON_GLOBAL_INTERFACE);
+        executeCommandAsync("SET p2p_listen_channel " + std::to_string(channel), NON_GLOBAL_INTERFACE);
+    }
+    MIRACASTLOG_INFO("P2P channel aligned to STA [%u MHz -> class %u channel %u]", sta_freq, op_class, channel);
+    m_aligned_sta_freq = sta_freq;
+    MIRACASTLOG_TRACE("Exiting...");
+    return sta_freq;
+}
+
+unsigned int MiracastP2P::get_STAFrequency(void)
+{
+    return m_sta_freq;
+}
+
+/* Looks up the network block wpa_supplicant stored for the persistent group with this SSID */
+int MiracastP2P::get_PersistentNetworkId(std::string ssid)
+{
+    int network_id = P2P_PERSISTENT_NETWORK_NONE;
+    std::string command("LIST_NETWORKS"), retBuffer;
+    MIRACASTLOG_TRACE("Entering...");
+
+    if (!ssid.empty() && (MIRACAST_OK == executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer)))
+    {
+        std::istringstream networks(retBuffer);
+        std::string line;
+
+        /* network id / ssid / bssid / flags */
+        while (std::getline(networks, line))
+        {
+            std::istringstream columns(line);
+            std::string id, network_ssid, bssid, flags;
+
+            if (std::getline(columns, id, '\t') &&
+                std::getline(columns, network_ssid, '\t') &&
+                std::getline(columns, bssid, '\t') &&
+                std::getline(columns, flags) &&
+                (network_ssid == ssid) &&
+                (std::string::npos != flags.find("[P2P-PERSISTENT]")))
+            {
+                network_id = atoi(id.c_str());
+                break;
+            }
+        }
+    }
+    MIRACASTLOG_INFO("Persistent network id of [%s] is [%d]", ssid.c_str(), network_id);
+    MIRACASTLOG_TRACE("Exiting...");
+    return network_id;
+}
+
 MiracastError MiracastP2P::cancel_negotiation(void)
 {
-    MiracastError ret = MIRACAST_FAIL;
-    std::string command, retBuffer;
+    MiracastError ret = MIRACAST_OK;
+    std::string command;
     MIRACASTLOG_TRACE("Entering...");
 
     /*Stop P2P Negotiation*/
     command = "P2P_CANCEL";
-    ret = executeCommand(std::move(command), NON_GLOBAL_INTERFACE, retBuffer);
-    if (ret != MIRACAST_OK)
-    {
-        MIRACASTLOG_ERROR("Failed to cancel P2P Negotiation");
-    }
+    executeCommandAsync(command, NON_GLOBAL_INTERFACE);
 
     MIRACASTLOG_TRACE("Exiting...");
     return ret;
@@ -578,9 +1271,9 @@ MiracastError MiracastP2P::set_FriendlyName(std::string friendly_name , bool app
                                 trimmed_length);
         }
         if (apply){
-            std::string command, retBuffer;
+            std::string command;
             command = "SET device_name " + m_friendly_name;
-            ret = executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+            executeCommandAsync(command, NON_GLOBAL_INTERFACE);
         }
     }
 
@@ -603,9 +1296,9 @@ MiracastError MiracastP2P::remove_GroupInterface(std::string group_iface_name )
         ret = MIRACAST_FAIL;
     }
     else{
-        std::string command, retBuffer;
+        std::string command;
         command = "P2P_GROUP_REMOVE " + std::move(group_iface_name);
-        ret = executeCommand(command, NON_GLOBAL_INTERFACE, retBuffer);
+        executeCommandAsync(command, NON_GLOBAL_INTERFACE);
     }
 
     MIRACASTLOG_TRACE("Exiting..");
@@ -22,6 +22,7 @@
 
 #include <string.h>
 #include <MiracastLogger.h>
+#include "MiracastP2PCommandQueue.h"
 
 using namespace std;
 using namespace MIRACAST;
@@ -31,7 +32,9 @@ using namespace MIRACAST;
 typedef enum INTERFACE
 {
     NON_GLOBAL_INTERFACE = 0,
-    GLOBAL_INTERFACE
+    GLOBAL_INTERFACE,
+    /* Control socket of the wireless station, see get_STAOperatingFrequency() */
+    STA_INTERFACE
 }P2P_INTERFACE;
 
 typedef enum p2p_events_e
@@ -54,11 +57,106 @@ P2P_EVENTS;
 
 #define MIRACAST_DFLT_NAME "Miracast-Generic"
 #define MIRACAST_DFLT_CFG_METHOD "pbc"
+#define P2P_MONITOR_MAX_EPOLL_EVENTS    (2)
+#define P2P_EVENT_MAX_ARGS              (4)
+#define P2P_PERSISTENT_NETWORK_NONE     (-1)
+/* connect_device() forms a new persistent group instead of a temporary one */
+#define P2P_PERSISTENT_NETWORK_NEW      (-2)
+#define P2P_PERSISTENT_GROUP_FLAG       "[PERSISTENT]"
+#define P2P_STA_STATUS_TIMEOUT_MS       (1000)
+#define P2P_CTRL_IFACE_SYNC_WAIT_MS     (2000)
+#define P2P_CTRL_IFACE_ASYNC_WAIT_MS    (60000)
+#define P2P_CTRL_OPEN_TIMEOUT_MS        (10000)
+#define P2P_CTRL_OPEN_MAX_BACKOFF_MS    (400)
+
+typedef enum p2p_event_key_e
+{
+    P2P_EVENT_KEY_P2P_DEV_ADDR = 0,
+    P2P_EVENT_KEY_PRI_DEV_TYPE,
+    P2P_EVENT_KEY_NAME,
+    P2P_EVENT_KEY_CONFIG_METHODS,
+    P2P_EVENT_KEY_WFD_DEV_INFO,
+    P2P_EVENT_KEY_DEV_PASSWD_ID,
+    P2P_EVENT_KEY_PEER_IFACE,
+    P2P_EVENT_KEY_FREQ,
+    P2P_EVENT_KEY_SSID,
+    P2P_EVENT_KEY_GO_DEV_ADDR,
+    P2P_EVENT_KEY_IP_ADDR,
+    P2P_EVENT_KEY_IP_MASK,
+    P2P_EVENT_KEY_GO_IP_ADDR,
+    P2P_EVENT_KEY_MAX
+}
+P2P_EVENT_KEY;
+
+/* View into the event buffer, valid only while the buffer is referenced */
+typedef struct p2p_event_field_st
+{
+    const char *value;
+    size_t length;
+}
+P2P_EVENT_FIELD;
+
+/*
+ * Tokens of a wpa_supplicant P2P event line. args[] holds the tokens without
+ * '=' following the event name (peer MAC, group interface, role, PIN), and
+ * fields[] the values of the known key=value pairs with the quotes of
+ * name='..' and ssid=".." already stripped.
+ */
+typedef struct p2p_event_fields_st
+{
+    P2P_EVENT_FIELD args[P2P_EVENT_MAX_ARGS];
+    unsigned int args_count;
+    P2P_EVENT_FIELD fields[P2P_EVENT_KEY_MAX];
+}
+P2P_EVENT_FIELDS;
+
+typedef struct p2p_event_map_st
+{
+    const char *prefix;
+    size_t prefix_len;
+    P2P_EVENTS event_id;
+    LogLevel log_level;
+    const char *description;
+}
+P2P_EVENT_MAP;
+
+/* nullptr for anything that is not forwarded to the controller */
+const P2P_EVENT_MAP *p2p_classify_event(const char *event);
+void parse_p2p_event_fields(const char *event, P2P_EVENT_FIELDS &event_fields);
+std::string get_p2p_event_field(const P2P_EVENT_FIELDS &event_fields, P2P_EVENT_KEY key);
+std::string get_p2p_event_arg(const P2P_EVENT_FIELDS &event_fields, unsigned int index);
+bool has_p2p_event_arg(const P2P_EVENT_FIELDS &event_fields, const char *arg);
+
+struct wpa_ctrl;
+
+/*
+ * Calls made on the wpa_supplicant control sockets. The wpa_client backend in
+ * MiracastP2PCtrl.cpp installs itself when the library loads, L1 tests
+ * install their own through MiracastP2P::set_CtrlOps().
+ */
+typedef struct p2p_ctrl_ops_st
+{
+    struct wpa_ctrl *(*ctrl_open)(const char *ctrl_path);
+    void (*ctrl_close)(struct wpa_ctrl *ctrl);
+    int (*ctrl_attach)(struct wpa_ctrl *ctrl);
+    /* Same return codes as wpa_ctrl_request(), -2 once timeout_ms has passed */
+    int (*ctrl_request)(struct wpa_ctrl *ctrl, const char *cmd, char *reply, size_t *reply_len, unsigned int timeout_ms);
+    int (*ctrl_pending)(struct wpa_ctrl *ctrl);
+    int (*ctrl_recv)(struct wpa_ctrl *ctrl, char *reply, size_t *reply_len);
+    /* Socket the monitor thread waits on for events */
+    int (*ctrl_get_fd)(struct wpa_ctrl *ctrl);
+}
+P2P_CTRL_OPS;
+
+class MiracastController;
 
 class MiracastP2P
 {
 private:
     static MiracastP2P *m_miracast_p2p_obj;
+    static const P2P_CTRL_OPS *m_installed_ctrl_ops;
+    /* Backend taken when the instance was created, used for all its sockets */
+    const P2P_CTRL_OPS *m_ctrl_ops;
     MiracastP2P *m_ctrler_evt_hdlr;
     MiracastP2P();
     virtual ~MiracastP2P();
@@ -70,30 +168,60 @@ private:
     struct wpa_ctrl *m_wpa_p2p_cmd_ctrl_iface;
     struct wpa_ctrl *m_wpa_p2p_ctrl_monitor;
     bool m_stop_p2p_monitor;
-    char m_event_buffer[2048];
-    size_t m_event_buffer_len;
     bool m_isWiFiDisplayParamsEnabled;
     pthread_t m_p2p_ctrl_monitor_thread_id;
+    int m_p2p_monitor_epoll_fd;
+    int m_p2p_monitor_shutdown_fd;
+    MiracastP2PCommandQueue m_command_queue;
+    unsigned int m_aligned_sta_freq;
+    unsigned int m_sta_freq;
+    /* STA frequency cache, valid while the interface table change count stays the same */
+    std::mutex m_sta_mutex;
+    std::string m_sta_iface_name;
+    unsigned int m_cached_sta_freq;
+    uint32_t m_sta_change_count;
+    bool m_sta_freq_valid;
+    /* Only used on the command worker */
+    struct wpa_ctrl *m_wpa_sta_cmd_ctrl_iface;
+    std::string m_sta_ctrl_iface_name;
 
-    MiracastError p2pInit(const std::string& p2p_ctrl_iface);
+    MiracastError p2pInit(const std::string& p2p_ctrl_iface, int cancel_fd);
     MiracastError p2pUninit();
     MiracastError executeCommand(const std::string& command, int interface, std::string &retBuffer);
-    int p2pExecute(char *cmd, enum INTERFACE iface, char *ret_buf, size_t actual_buffer_len);
-    int p2pWpaCtrlSendCmd(char *cmd, struct wpa_ctrl *wpa_p2p_ctrl_iface, char *ret_buf,size_t actual_buffer_len);
+    void executeCommandAsync(const std::string& command, int interface);
+    int p2pExecute(char *cmd, enum INTERFACE iface, unsigned int timeout_ms, char *ret_buf, size_t actual_buffer_len);
+    int p2pWpaCtrlSendCmd(char *cmd, struct wpa_ctrl *wpa_p2p_ctrl_iface, unsigned int timeout_ms, char *ret_buf,size_t actual_buffer_len);
     void Release_P2PCtrlInterface(void);
+    MiracastError p2pCreateMonitorWaitFds(void);
+    bool p2pWaitForMonitorEvents(void);
+    /* Returns false when nothing could be received from the monitor socket */
+    bool p2pRecvAndDispatchEvent(MiracastController *miracast_obj, bool &goStart);
+    unsigned int get_STAOperatingFrequency(const std::string &sta_iface_name, uint32_t change_count);
+    struct wpa_ctrl *get_STACtrlInterface(void);
+    unsigned int align_OperatingChannel(const std::string &sta_iface_name, uint32_t sta_change_count);
 
 public:
-    static MiracastP2P *getInstance(MiracastError &error_code,std::string p2p_ctrl_iface);
+    /* Opens the control interface with retries, cancel_fd aborts the retries when signalled */
+    static MiracastP2P *getInstance(MiracastError &error_code,std::string p2p_ctrl_iface, int cancel_fd = -1);
     static void destroyInstance();
+    /* Blocks until wpa_supplicant creates the control socket, the deadline passes or cancel_fd is signalled */
+    static bool wait_for_CtrlIface(const std::string &p2p_ctrl_iface, unsigned int timeout_ms, int cancel_fd = -1);
+    /* Installs the control socket backend for instances created afterwards, returns the previous one */
+    static const P2P_CTRL_OPS *set_CtrlOps(const P2P_CTRL_OPS *ctrl_ops);
 
     /*members for interacting with wpa_supplicant*/
-    MiracastError Init(std::string p2p_ctrl_iface);
+    MiracastError Init(std::string p2p_ctrl_iface, int cancel_fd = -1);
     void p2pCtrlMonitorThread();
-    MiracastError set_WFDParameters(void);
+    /* The STA interface, from MiracastController::get_STAInterface(), steers the P2P channel */
+    MiracastError set_WFDParameters(const std::string &sta_iface_name = "", uint32_t sta_change_count = 0);
     void reset_WFDParameters();
     MiracastError discover_devices(void);
     MiracastError stop_discover_devices(void);
-    MiracastError connect_device(std::string MAC,std::string authType = "pbc");
+    MiracastError connect_device(std::string MAC,std::string authType = "pbc", int persistent_network_id = P2P_PERSISTENT_NETWORK_NONE,
+                                 const std::string &sta_iface_name = "", uint32_t sta_change_count = 0);
+    int get_PersistentNetworkId(std::string ssid);
+    /* STA frequency seen by the last channel alignment, 0 when the STA is not associated */
+    unsigned int get_STAFrequency(void);
     MiracastError cancel_negotiation(void);
 
     MiracastError set_FriendlyName(std::string friendly_name , bool apply=false );
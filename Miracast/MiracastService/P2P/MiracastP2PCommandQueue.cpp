@@ -0,0 +1,324 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include "MiracastP2PCommandQueue.h"
+
+typedef struct p2p_command_timeout_st
+{
+    const char *prefix;
+    size_t prefix_len;
+    unsigned int timeout_ms;
+}
+P2P_COMMAND_TIMEOUT;
+
+#define P2P_COMMAND_TIMEOUT_ENTRY(prefix, timeout_ms) { prefix, sizeof(prefix) - 1, timeout_ms }
+
+static const P2P_COMMAND_TIMEOUT p2p_command_timeouts[] =
+{
+    P2P_COMMAND_TIMEOUT_ENTRY("P2P_CONNECT",    P2P_CMD_CONNECT_TIMEOUT_MS),
+    P2P_COMMAND_TIMEOUT_ENTRY("P2P_FIND",       P2P_CMD_DISCOVERY_TIMEOUT_MS),
+    P2P_COMMAND_TIMEOUT_ENTRY("P2P_STOP_FIND",  P2P_CMD_DISCOVERY_TIMEOUT_MS),
+    P2P_COMMAND_TIMEOUT_ENTRY("P2P_EXT_LISTEN", P2P_CMD_DISCOVERY_TIMEOUT_MS),
+};
+
+typedef enum p2p_discovery_group_e
+{
+    P2P_DISCOVERY_GROUP_NONE = 0,
+    P2P_DISCOVERY_GROUP_FIND,
+    P2P_DISCOVERY_GROUP_EXT_LISTEN
+}
+P2P_DISCOVERY_GROUP;
+
+/* Commands of the same group set the same discovery state, a newer one makes a pending one moot */
+static P2P_DISCOVERY_GROUP get_discovery_group(const std::string &command)
+{
+    if ((0 == command.compare(0, strlen("P2P_FIND"), "P2P_FIND")) ||
+        (0 == command.compare(0, strlen("P2P_STOP_FIND"), "P2P_STOP_FIND")))
+    {
+        return P2P_DISCOVERY_GROUP_FIND;
+    }
+    if (0 == command.compare(0, strlen("P2P_EXT_LISTEN"), "P2P_EXT_LISTEN"))
+    {
+        return P2P_DISCOVERY_GROUP_EXT_LISTEN;
+    }
+    return P2P_DISCOVERY_GROUP_NONE;
+}
+
+MiracastP2PCommandQueue::MiracastP2PCommandQueue()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    m_worker_thread_id = 0;
+    m_running = false;
+    m_stopping = false;
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastP2PCommandQueue::~MiracastP2PCommandQueue()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    stop(0);
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+unsigned int MiracastP2PCommandQueue::get_default_timeout(const std::string &command)
+{
+    for (const P2P_COMMAND_TIMEOUT &entry : p2p_command_timeouts)
+    {
+        if (0 == command.compare(0, entry.prefix_len, entry.prefix))
+        {
+            return entry.timeout_ms;
+        }
+    }
+    return P2P_CMD_DFLT_TIMEOUT_MS;
+}
+
+MiracastError MiracastP2PCommandQueue::start(P2P_COMMAND_EXECUTOR executor)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+
+    if (m_running)
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_OK;
+    }
+    m_executor = std::move(executor);
+    m_stopping = false;
+    if (0 != pthread_create(&m_worker_thread_id, nullptr, MiracastP2PCommandQueue::worker_thread, this))
+    {
+        MIRACASTLOG_ERROR("P2P command worker creation failed");
+        m_worker_thread_id = 0;
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_FAIL;
+    }
+    m_running = true;
+    MIRACASTLOG_TRACE("Exiting...");
+    return MIRACAST_OK;
+}
+
+void MiracastP2PCommandQueue::stop(unsigned int drain_timeout_ms)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        if (!m_running)
+        {
+            MIRACASTLOG_TRACE("Exiting...");
+            return;
+        }
+        m_stopping = true;
+        m_drain_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(drain_timeout_ms);
+    }
+    m_queue_condition.notify_all();
+    pthread_join(m_worker_thread_id, nullptr);
+
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    m_worker_thread_id = 0;
+    m_running = false;
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastP2PCommandQueue::complete(const std::shared_ptr<P2P_COMMAND_REQUEST> &request, const P2P_COMMAND_RESULT &result)
+{
+    request->promise.set_value(result);
+    for (const P2P_COMMAND_CALLBACK &callback : request->callbacks)
+    {
+        callback(request->command, result);
+    }
+    for (const std::shared_ptr<P2P_COMMAND_REQUEST> &merged : request->merged)
+    {
+        complete(merged, result);
+    }
+}
+
+/* Called with m_queue_mutex held, returns true when the request was absorbed by the queue tail */
+bool MiracastP2PCommandQueue::coalesce_locked(const std::shared_ptr<P2P_COMMAND_REQUEST> &request)
+{
+    if (m_pending.empty())
+    {
+        return false;
+    }
+
+    std::shared_ptr<P2P_COMMAND_REQUEST> tail = m_pending.back();
+    P2P_DISCOVERY_GROUP discovery_group = get_discovery_group(request->command);
+
+    if (tail->interface != request->interface)
+    {
+        return false;
+    }
+    if (tail->command == request->command)
+    {
+        MIRACASTLOG_VERBOSE("Coalescing repeated P2P command [%s]", request->command.c_str());
+        tail->callbacks.insert(tail->callbacks.end(), request->callbacks.begin(), request->callbacks.end());
+        request->callbacks.clear();
+        request->future = tail->future;
+        return true;
+    }
+    if ((P2P_DISCOVERY_GROUP_NONE != discovery_group) && (get_discovery_group(tail->command) == discovery_group))
+    {
+        /* Only the latest discovery state matters, the pending one is never sent */
+        MIRACASTLOG_VERBOSE("P2P command [%s] supersedes pending [%s]", request->command.c_str(), tail->command.c_str());
+        m_pending.pop_back();
+        request->merged.push_back(std::move(tail));
+    }
+    return false;
+}
+
+std::shared_future<P2P_COMMAND_RESULT> MiracastP2PCommandQueue::submit(const std::string &command,
+                                                                       int interface,
+                                                                       unsigned int timeout_ms,
+                                                                       P2P_COMMAND_CALLBACK callback)
+{
+    std::shared_ptr<P2P_COMMAND_REQUEST> request = std::make_shared<P2P_COMMAND_REQUEST>();
+    bool rejected = false;
+
+    if (0 == timeout_ms)
+    {
+        timeout_ms = get_default_timeout(command);
+    }
+    request->command = command;
+    request->interface = interface;
+    request->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    request->future = request->promise.get_future().share();
+    if (callback)
+    {
+        request->callbacks.push_back(std::move(callback));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        if ((!m_running) || (m_stopping))
+        {
+            rejected = true;
+        }
+        else if (!coalesce_locked(request))
+        {
+            m_pending.push_back(request);
+        }
+    }
+
+    if (rejected)
+    {
+        MIRACASTLOG_ERROR("P2P command worker not running, dropping [%s]", command.c_str());
+        complete(request, P2P_COMMAND_RESULT{MIRACAST_FAIL, ""});
+    }
+    else
+    {
+        m_queue_condition.notify_one();
+    }
+    return request->future;
+}
+
+MiracastError MiracastP2PCommandQueue::execute(const std::string &command, int interface, std::string &reply, unsigned int timeout_ms)
+{
+    MiracastError ret = MIRACAST_FAIL;
+    bool on_worker_thread = false;
+
+    if (0 == timeout_ms)
+    {
+        timeout_ms = get_default_timeout(command);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        on_worker_thread = (m_running && pthread_equal(pthread_self(), m_worker_thread_id));
+    }
+    if (on_worker_thread)
+    {
+        /* Issued from a completion callback, waiting on the queue would deadlock */
+        char reply_buffer[P2P_CMD_REPLY_BUFFER_SIZE] = {0};
+        ret = (0 == m_executor(command.c_str(), interface, timeout_ms, reply_buffer, sizeof(reply_buffer) - 1)) ? MIRACAST_OK : MIRACAST_FAIL;
+        reply = reply_buffer;
+        return ret;
+    }
+
+    std::shared_future<P2P_COMMAND_RESULT> result = submit(command, interface, timeout_ms);
+
+    if (std::future_status::ready == result.wait_for(std::chrono::milliseconds(timeout_ms)))
+    {
+        reply = result.get().reply;
+        ret = result.get().status;
+    }
+    else
+    {
+        MIRACASTLOG_ERROR("P2P command [%s] not completed within %u ms", command.c_str(), timeout_ms);
+        reply.clear();
+    }
+    return ret;
+}
+
+void *MiracastP2PCommandQueue::worker_thread(void *ctx)
+{
+    MiracastP2PCommandQueue *command_queue = static_cast<MiracastP2PCommandQueue *>(ctx);
+    command_queue->worker_loop();
+    return nullptr;
+}
+
+void MiracastP2PCommandQueue::worker_loop(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    while (true)
+    {
+        std::shared_ptr<P2P_COMMAND_REQUEST> request;
+        std::deque<std::shared_ptr<P2P_COMMAND_REQUEST>> abandoned;
+        {
+            std::unique_lock<std::mutex> lock(m_queue_mutex);
+            m_queue_condition.wait(lock, [this]{ return (m_stopping || !m_pending.empty()); });
+
+            if (m_stopping && (m_pending.empty() || (std::chrono::steady_clock::now() >= m_drain_deadline)))
+            {
+                abandoned.swap(m_pending);
+            }
+            else
+            {
+                request = m_pending.front();
+                m_pending.pop_front();
+            }
+        }
+
+        if (nullptr == request)
+        {
+            for (const std::shared_ptr<P2P_COMMAND_REQUEST> &pending : abandoned)
+            {
+                MIRACASTLOG_WARNING("P2P command [%s] dropped on shutdown", pending->command.c_str());
+                complete(pending, P2P_COMMAND_RESULT{MIRACAST_FAIL, ""});
+            }
+            break;
+        }
+
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        if (start_time >= request->deadline)
+        {
+            MIRACASTLOG_ERROR("P2P command [%s] expired before it could be sent", request->command.c_str());
+            complete(request, P2P_COMMAND_RESULT{MIRACAST_FAIL, ""});
+            continue;
+        }
+
+        char reply_buffer[P2P_CMD_REPLY_BUFFER_SIZE] = {0};
+        MIRACASTLOG_INFO("Executing P2P command %s", request->command.c_str());
+        unsigned int remaining_ms = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(request->deadline - start_time).count());
+        int ret = m_executor(request->command.c_str(), request->interface, remaining_ms, reply_buffer, sizeof(reply_buffer) - 1);
+        long long elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+        MIRACASTLOG_INFO("command return buffer is - %s [%lld ms]", reply_buffer, elapsed_ms);
+        complete(request, P2P_COMMAND_RESULT{(0 == ret) ? MIRACAST_OK : MIRACAST_FAIL, reply_buffer});
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
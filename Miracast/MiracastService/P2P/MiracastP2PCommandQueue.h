@@ -0,0 +1,111 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_P2P_COMMAND_QUEUE_H_
+#define _MIRACAST_P2P_COMMAND_QUEUE_H_
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <pthread.h>
+#include <MiracastCommon.h>
+
+#define P2P_CMD_DFLT_TIMEOUT_MS         (5000)
+#define P2P_CMD_CONNECT_TIMEOUT_MS      (12000)
+#define P2P_CMD_DISCOVERY_TIMEOUT_MS    (3000)
+#define P2P_CMD_DRAIN_TIMEOUT_MS        (2000)
+#define P2P_CMD_REPLY_BUFFER_SIZE       (2048)
+
+typedef struct p2p_command_result_st
+{
+    MiracastError status;
+    std::string reply;
+}
+P2P_COMMAND_RESULT;
+
+typedef std::function<void(const std::string &command, const P2P_COMMAND_RESULT &result)> P2P_COMMAND_CALLBACK;
+/* timeout_ms is what is left of the command deadline, the executor must not block past it */
+typedef std::function<int(const char *command, int interface, unsigned int timeout_ms, char *reply, size_t reply_len)> P2P_COMMAND_EXECUTOR;
+
+/**
+ * Serialises the wpa_supplicant control commands on a dedicated worker so
+ * that neither the controller thread nor the Thunder RPC threads block while
+ * the supplicant is busy scanning. Each command carries a deadline: commands
+ * still queued when it expires are dropped and synchronous callers stop
+ * waiting, and the executor is handed the remaining time so a command that
+ * is sent never holds the worker past its deadline. A command identical to
+ * the one at the tail of the queue is answered by that one; a pending
+ * P2P_EXT_LISTEN is replaced by a newer one, and so are P2P_FIND and
+ * P2P_STOP_FIND by each other, as only the latest discovery state matters.
+ */
+class MiracastP2PCommandQueue
+{
+public:
+    MiracastP2PCommandQueue();
+    ~MiracastP2PCommandQueue();
+
+    MiracastError start(P2P_COMMAND_EXECUTOR executor);
+    /* Lets the pending commands run for up to drain_timeout_ms, the rest complete with MIRACAST_FAIL */
+    void stop(unsigned int drain_timeout_ms = P2P_CMD_DRAIN_TIMEOUT_MS);
+
+    std::shared_future<P2P_COMMAND_RESULT> submit(const std::string &command,
+                                                  int interface,
+                                                  unsigned int timeout_ms = 0,
+                                                  P2P_COMMAND_CALLBACK callback = nullptr);
+    /* Blocks until the command completes or its deadline passes */
+    MiracastError execute(const std::string &command, int interface, std::string &reply, unsigned int timeout_ms = 0);
+
+    static unsigned int get_default_timeout(const std::string &command);
+
+private:
+    typedef struct p2p_command_request_st
+    {
+        std::string command;
+        int interface;
+        std::chrono::steady_clock::time_point deadline;
+        std::promise<P2P_COMMAND_RESULT> promise;
+        std::shared_future<P2P_COMMAND_RESULT> future;
+        std::vector<P2P_COMMAND_CALLBACK> callbacks;
+        /* Requests folded into this one, they complete with its result */
+        std::vector<std::shared_ptr<struct p2p_command_request_st>> merged;
+    }
+    P2P_COMMAND_REQUEST;
+
+    std::mutex m_queue_mutex;
+    std::condition_variable m_queue_condition;
+    std::deque<std::shared_ptr<P2P_COMMAND_REQUEST>> m_pending;
+    P2P_COMMAND_EXECUTOR m_executor;
+    pthread_t m_worker_thread_id;
+    bool m_running;
+    bool m_stopping;
+    std::chrono::steady_clock::time_point m_drain_deadline;
+
+    static void *worker_thread(void *ctx);
+    void worker_loop(void);
+    bool coalesce_locked(const std::shared_ptr<P2P_COMMAND_REQUEST> &request);
+    static void complete(const std::shared_ptr<P2P_COMMAND_REQUEST> &request, const P2P_COMMAND_RESULT &result);
+};
+
+#endif /* _MIRACAST_P2P_COMMAND_QUEUE_H_ */
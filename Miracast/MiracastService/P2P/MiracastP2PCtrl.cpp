@@ -0,0 +1,114 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <wpa_ctrl.h>
+#include "MiracastP2P.h"
+
+static uint64_t p2p_ctrl_monotonic_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000) + (now.tv_nsec / 1000000);
+}
+
+/*
+ * wpa_ctrl_request() waits up to 10 s for the reply whatever the caller's
+ * deadline is. The command socket is a connected datagram socket, so the
+ * request is sent and its reply polled for here, bounded by timeout_ms. A
+ * reply that arrives after the caller gave up is discarded before the next
+ * command is sent, so replies never get out of step with their commands.
+ * Same return codes as wpa_ctrl_request(): -2 on timeout, -1 on failure.
+ */
+static int p2p_ctrl_timed_request(struct wpa_ctrl *ctrl_iface, const char *cmd, char *reply, size_t *reply_len, unsigned int timeout_ms)
+{
+    int ctrl_fd = wpa_ctrl_get_fd(ctrl_iface);
+    uint64_t deadline_ms = p2p_ctrl_monotonic_ms() + timeout_ms;
+    char stale_reply[P2P_CMD_REPLY_BUFFER_SIZE];
+
+    while (0 <= recv(ctrl_fd, stale_reply, sizeof(stale_reply), MSG_DONTWAIT))
+    {
+        MIRACASTLOG_WARNING("WIFI_HAL: discarding late reply of an expired command");
+    }
+
+    if (0 > send(ctrl_fd, cmd, strlen(cmd), MSG_DONTWAIT))
+    {
+        return -1;
+    }
+
+    while (true)
+    {
+        uint64_t now_ms = p2p_ctrl_monotonic_ms();
+        struct pollfd poll_fd = {ctrl_fd, POLLIN, 0};
+        int poll_ret = 0;
+        ssize_t received = 0;
+
+        if (now_ms >= deadline_ms)
+        {
+            return -2;
+        }
+        poll_ret = poll(&poll_fd, 1, static_cast<int>(deadline_ms - now_ms));
+        if (0 > poll_ret)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (0 == poll_ret)
+        {
+            return -2;
+        }
+        received = recv(ctrl_fd, reply, *reply_len, MSG_DONTWAIT);
+        if (0 > received)
+        {
+            if ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno))
+            {
+                continue;
+            }
+            return -1;
+        }
+        if ((0 < received) && ('<' == reply[0]))
+        {
+            /* Unsolicited event, only delivered to attached sockets */
+            continue;
+        }
+        *reply_len = static_cast<size_t>(received);
+        return 0;
+    }
+}
+
+static const P2P_CTRL_OPS p2p_wpa_client_ctrl_ops =
+{
+    wpa_ctrl_open,
+    wpa_ctrl_close,
+    wpa_ctrl_attach,
+    p2p_ctrl_timed_request,
+    wpa_ctrl_pending,
+    wpa_ctrl_recv,
+    wpa_ctrl_get_fd
+};
+
+/* Installed while the library loads, before any MiracastP2P instance exists */
+static const P2P_CTRL_OPS *p2p_previous_ctrl_ops __attribute__((unused)) = MiracastP2P::set_CtrlOps(&p2p_wpa_client_ctrl_ops);
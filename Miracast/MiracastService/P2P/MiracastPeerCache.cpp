@@ -0,0 +1,350 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "MiracastPeerCache.h"
+
+#define PEER_CACHE_SLOT_MASK    (PEER_CACHE_TABLE_SIZE - 1)
+
+MiracastPeerCache::MiracastPeerCache(unsigned int ttl_sec)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    memset(m_entries, 0x00, sizeof(m_entries));
+    m_entry_count = 0;
+    m_ttl_ms = static_cast<uint64_t>(ttl_sec) * 1000;
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastPeerCache::~MiracastPeerCache()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+uint64_t MiracastPeerCache::get_monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000) + (ts.tv_nsec / 1000000);
+}
+
+bool MiracastPeerCache::pack_mac_address(const std::string &mac, uint64_t &mac_key)
+{
+    uint64_t packed = 0;
+    unsigned int digits = 0;
+
+    for (char c : mac)
+    {
+        unsigned int nibble;
+
+        if ((c >= '0') && (c <= '9'))
+        {
+            nibble = c - '0';
+        }
+        else if ((c >= 'a') && (c <= 'f'))
+        {
+            nibble = c - 'a' + 10;
+        }
+        else if ((c >= 'A') && (c <= 'F'))
+        {
+            nibble = c - 'A' + 10;
+        }
+        else if ((':' == c) || (' ' == c))
+        {
+            continue;
+        }
+        else
+        {
+            return false;
+        }
+        packed = (packed << 4) | nibble;
+        digits++;
+    }
+    if (12 != digits)
+    {
+        return false;
+    }
+    mac_key = packed;
+    return true;
+}
+
+unsigned int MiracastPeerCache::home_slot(uint64_t mac_key)
+{
+    /* Fibonacci hashing, the vendor OUI and the NIC bits both spread over the table */
+    return static_cast<unsigned int>((mac_key * 0x9E3779B97F4A7C15ULL) >> (64 - PEER_CACHE_TABLE_BITS)) & PEER_CACHE_SLOT_MASK;
+}
+
+int MiracastPeerCache::find_slot(uint64_t mac_key)
+{
+    unsigned int slot = home_slot(mac_key);
+
+    for (unsigned int probe = 0; probe < PEER_CACHE_TABLE_SIZE; ++probe)
+    {
+        if (!m_entries[slot].in_use)
+        {
+            return -1;
+        }
+        if (mac_key == m_entries[slot].mac_key)
+        {
+            return static_cast<int>(slot);
+        }
+        slot = (slot + 1) & PEER_CACHE_SLOT_MASK;
+    }
+    return -1;
+}
+
+/* Linear probing delete with backward shift, no tombstones left behind */
+void MiracastPeerCache::erase_slot(unsigned int slot)
+{
+    unsigned int hole = slot,
+                 next = slot;
+
+    m_entries[hole].in_use = false;
+    m_entry_count--;
+
+    while (true)
+    {
+        next = (next + 1) & PEER_CACHE_SLOT_MASK;
+        if (!m_entries[next].in_use)
+        {
+            break;
+        }
+
+        unsigned int home = home_slot(m_entries[next].mac_key);
+        bool movable = (hole <= next) ? ((home <= hole) || (home > next))
+                                      : ((home <= hole) && (home > next));
+        if (movable)
+        {
+            m_entries[hole] = m_entries[next];
+            m_entries[next].in_use = false;
+            hole = next;
+        }
+    }
+}
+
+void MiracastPeerCache::expire_entries(uint64_t now_ms)
+{
+    unsigned int slot = 0;
+
+    while (slot < PEER_CACHE_TABLE_SIZE)
+    {
+        if ((m_entries[slot].in_use) && ((now_ms - m_entries[slot].last_seen_ms) > m_ttl_ms))
+        {
+            MIRACASTLOG_INFO("Peer [%s] not seen for %llu ms, dropped",
+                                m_entries[slot].device_mac,
+                                static_cast<unsigned long long>(now_ms - m_entries[slot].last_seen_ms));
+            /* The backward shift may refill this slot, check it again */
+            erase_slot(slot);
+            continue;
+        }
+        slot++;
+    }
+}
+
+void MiracastPeerCache::evict_oldest(void)
+{
+    int oldest = -1;
+
+    for (unsigned int slot = 0; slot < PEER_CACHE_TABLE_SIZE; ++slot)
+    {
+        if ((m_entries[slot].in_use) &&
+            ((0 > oldest) || (m_entries[slot].last_seen_ms < m_entries[oldest].last_seen_ms)))
+        {
+            oldest = static_cast<int>(slot);
+        }
+    }
+    if (0 <= oldest)
+    {
+        MIRACASTLOG_WARNING("Peer cache full, evicting [%s]", m_entries[oldest].device_mac);
+        erase_slot(static_cast<unsigned int>(oldest));
+    }
+}
+
+void MiracastPeerCache::copy_field(char *destination, size_t size, const std::string &source)
+{
+    size_t length = source.copy(destination, size - 1);
+    destination[length] = '\0';
+}
+
+void MiracastPeerCache::fill_device_info(const PEER_CACHE_ENTRY &entry, DeviceInfo &device_info)
+{
+    device_info.deviceMAC = entry.device_mac;
+    device_info.deviceType = entry.device_type;
+    device_info.modelName = entry.model_name;
+    device_info.peer_iface = entry.peer_iface;
+    device_info.authType = entry.auth_type;
+    device_info.isCPSupported = false;
+    device_info.deviceRole = DEVICEROLE_SOURCE;
+}
+
+bool MiracastPeerCache::update(const std::string &mac, const std::string &auth_type, const std::string &model_name,
+                                const std::string &device_type, bool force_overwrite)
+{
+    uint64_t mac_key = 0,
+             now_ms = get_monotonic_ms();
+    bool new_entry = false;
+
+    if (!pack_mac_address(mac, mac_key))
+    {
+        MIRACASTLOG_ERROR("Invalid peer MAC [%s]", mac.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    int slot = find_slot(mac_key);
+
+    if (0 > slot)
+    {
+        expire_entries(now_ms);
+        if (PEER_CACHE_MAX_ENTRIES <= m_entry_count)
+        {
+            evict_oldest();
+        }
+
+        unsigned int free_slot = home_slot(mac_key);
+        while (m_entries[free_slot].in_use)
+        {
+            free_slot = (free_slot + 1) & PEER_CACHE_SLOT_MASK;
+        }
+        slot = static_cast<int>(free_slot);
+        memset(&m_entries[slot], 0x00, sizeof(m_entries[slot]));
+        m_entries[slot].in_use = true;
+        m_entries[slot].mac_key = mac_key;
+        m_entry_count++;
+        new_entry = true;
+        force_overwrite = true;
+    }
+
+    PEER_CACHE_ENTRY &entry = m_entries[slot];
+    entry.last_seen_ms = now_ms;
+
+    if (force_overwrite)
+    {
+        copy_field(entry.device_mac, sizeof(entry.device_mac), mac);
+        copy_field(entry.auth_type, sizeof(entry.auth_type), auth_type);
+        copy_field(entry.model_name, sizeof(entry.model_name), model_name);
+        copy_field(entry.device_type, sizeof(entry.device_type), device_type);
+        MIRACASTLOG_INFO("#### Device Cache Name[%s]Mac[%s]Authtype[%s]Type[%s] New[%u] Force[%u] Count[%u] ####",
+                            entry.model_name,
+                            entry.device_mac,
+                            entry.auth_type,
+                            entry.device_type,
+                            new_entry,
+                            force_overwrite,
+                            m_entry_count);
+    }
+    return true;
+}
+
+bool MiracastPeerCache::lookup(const std::string &mac, DeviceInfo &device_info)
+{
+    uint64_t mac_key = 0;
+
+    if (!pack_mac_address(mac, mac_key))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    int slot = find_slot(mac_key);
+    if (0 > slot)
+    {
+        return false;
+    }
+    /* Expiry otherwise only runs on insert, do not hand out a peer that is gone */
+    if ((get_monotonic_ms() - m_entries[slot].last_seen_ms) > m_ttl_ms)
+    {
+        MIRACASTLOG_INFO("Peer [%s] expired", m_entries[slot].device_mac);
+        erase_slot(static_cast<unsigned int>(slot));
+        return false;
+    }
+    fill_device_info(m_entries[slot], device_info);
+    return true;
+}
+
+bool MiracastPeerCache::set_peer_iface(const std::string &mac, const std::string &peer_iface)
+{
+    uint64_t mac_key = 0;
+
+    if (!pack_mac_address(mac, mac_key))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    int slot = find_slot(mac_key);
+    if (0 > slot)
+    {
+        return false;
+    }
+    copy_field(m_entries[slot].peer_iface, sizeof(m_entries[slot].peer_iface), peer_iface);
+    return true;
+}
+
+bool MiracastPeerCache::remove(const std::string &mac)
+{
+    uint64_t mac_key = 0;
+
+    if (!pack_mac_address(mac, mac_key))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    int slot = find_slot(mac_key);
+    if (0 > slot)
+    {
+        return false;
+    }
+    erase_slot(static_cast<unsigned int>(slot));
+    return true;
+}
+
+void MiracastPeerCache::clear(void)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    memset(m_entries, 0x00, sizeof(m_entries));
+    m_entry_count = 0;
+}
+
+std::vector<DeviceInfo> MiracastPeerCache::snapshot(void)
+{
+    std::vector<DeviceInfo> peers;
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+    expire_entries(get_monotonic_ms());
+    peers.reserve(m_entry_count);
+    for (unsigned int slot = 0; slot < PEER_CACHE_TABLE_SIZE; ++slot)
+    {
+        if (m_entries[slot].in_use)
+        {
+            DeviceInfo device_info;
+            fill_device_info(m_entries[slot], device_info);
+            peers.push_back(std::move(device_info));
+        }
+    }
+    return peers;
+}
+
+unsigned int MiracastPeerCache::size(void)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    return m_entry_count;
+}
@@ -0,0 +1,93 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_PEER_CACHE_H_
+#define _MIRACAST_PEER_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+#include <MiracastCommon.h>
+
+#define PEER_CACHE_TABLE_BITS       (6)
+#define PEER_CACHE_TABLE_SIZE       (1 << PEER_CACHE_TABLE_BITS)
+#define PEER_CACHE_MAX_ENTRIES      (48)
+#define PEER_CACHE_DFLT_TTL_SEC     (300)
+#define PEER_CACHE_MAC_STR_LEN      (18)
+#define PEER_CACHE_NAME_LEN         (64)
+#define PEER_CACHE_DEV_TYPE_LEN     (32)
+#define PEER_CACHE_AUTH_TYPE_LEN    (16)
+
+/**
+ * Cache of the P2P peers reported by wpa_supplicant.
+ * Entries live in place inside a fixed open-addressed table keyed by the
+ * packed 48-bit MAC, so lookups stay O(1) and memory stays bounded however
+ * many Wi-Fi Direct devices are around. Peers are dropped on P2P-DEVICE-LOST,
+ * once they have not been seen for the TTL, or (least recently seen first)
+ * when the table is full. Readers get copies, never pointers into the table.
+ */
+class MiracastPeerCache
+{
+public:
+    MiracastPeerCache(unsigned int ttl_sec = PEER_CACHE_DFLT_TTL_SEC);
+    ~MiracastPeerCache();
+
+    /* Adds the peer or refreshes its last-seen time, the details are only overwritten when forced */
+    bool update(const std::string &mac, const std::string &auth_type, const std::string &model_name,
+                const std::string &device_type, bool force_overwrite);
+    bool lookup(const std::string &mac, DeviceInfo &device_info);
+    bool set_peer_iface(const std::string &mac, const std::string &peer_iface);
+    bool remove(const std::string &mac);
+    void clear(void);
+    std::vector<DeviceInfo> snapshot(void);
+    unsigned int size(void);
+
+    static bool pack_mac_address(const std::string &mac, uint64_t &mac_key);
+
+private:
+    typedef struct peer_cache_entry_st
+    {
+        bool in_use;
+        uint64_t mac_key;
+        uint64_t last_seen_ms;
+        char device_mac[PEER_CACHE_MAC_STR_LEN];
+        char peer_iface[PEER_CACHE_MAC_STR_LEN];
+        char model_name[PEER_CACHE_NAME_LEN];
+        char device_type[PEER_CACHE_DEV_TYPE_LEN];
+        char auth_type[PEER_CACHE_AUTH_TYPE_LEN];
+    }
+    PEER_CACHE_ENTRY;
+
+    std::mutex m_cache_mutex;
+    PEER_CACHE_ENTRY m_entries[PEER_CACHE_TABLE_SIZE];
+    unsigned int m_entry_count;
+    uint64_t m_ttl_ms;
+
+    static uint64_t get_monotonic_ms(void);
+    static unsigned int home_slot(uint64_t mac_key);
+    int find_slot(uint64_t mac_key);
+    void erase_slot(unsigned int slot);
+    void expire_entries(uint64_t now_ms);
+    void evict_oldest(void);
+    static void copy_field(char *destination, size_t size, const std::string &source);
+    static void fill_device_info(const PEER_CACHE_ENTRY &entry, DeviceInfo &device_info);
+};
+
+#endif /* _MIRACAST_PEER_CACHE_H_ */
@@ -19,6 +19,71 @@
 
 #include "MiracastCommon.h"
 
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 30)))
+#define MIRACAST_HAVE_SEM_CLOCKWAIT
+#endif
+
+static void add_ms_to_timespec(struct timespec &ts, unsigned int timeout_ms)
+{
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += static_cast<long>(timeout_ms % 1000) * 1000000L;
+    if (1000000000L <= ts.tv_nsec)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+}
+
+/* Waits on the semaphore against a CLOCK_MONOTONIC deadline so that a wall
+ * clock step (NTP sync, manual time change) neither stretches nor cuts the
+ * timeout. Returns 0 when the semaphore was taken, -1 on timeout/error. */
+static int wait_semaphore_monotonic(sem_t *sem, unsigned int timeout_ms)
+{
+    struct timespec deadline;
+    int wait_status = -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    add_ms_to_timespec(deadline, timeout_ms);
+
+#ifdef MIRACAST_HAVE_SEM_CLOCKWAIT
+    do
+    {
+        wait_status = sem_clockwait(sem, CLOCK_MONOTONIC, &deadline);
+    }
+    while ((-1 == wait_status) && (EINTR == errno));
+#else
+    /* No sem_clockwait: wait in short CLOCK_REALTIME slices and check the
+     * monotonic deadline after each one, so a clock step costs at most one
+     * slice. */
+    while (true)
+    {
+        struct timespec now, ts;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        long long remaining_ms = (static_cast<long long>(deadline.tv_sec - now.tv_sec) * 1000LL) +
+                                 ((deadline.tv_nsec - now.tv_nsec) / 1000000L);
+        if (0 >= remaining_ms)
+        {
+            if (0 == sem_trywait(sem))
+            {
+                wait_status = 0;
+            }
+            break;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        add_ms_to_timespec(ts, static_cast<unsigned int>((100 < remaining_ms) ? 100 : remaining_ms));
+
+        wait_status = sem_timedwait(sem, &ts);
+        if ((0 == wait_status) || ((EINTR != errno) && (ETIMEDOUT != errno)))
+        {
+            break;
+        }
+    }
+#endif
+    return wait_status;
+}
+
 MiracastThread::MiracastThread(std::string thread_name, size_t stack_size, size_t msg_size, size_t queue_depth, void (*callback)(void *), void *user_data)
 {
     MIRACASTLOG_TRACE("Entering...");
@@ -119,11 +184,7 @@ int8_t MiracastThread::receive_message(void *message, size_t msg_size, int sem_w
         }
         else if (0 < sem_wait_timedout)
         {
-            struct timespec ts;
-            clock_gettime(CLOCK_REALTIME, &ts);
-            ts.tv_sec += sem_wait_timedout;
-
-            if (-1 != sem_timedwait(&m_empty_msgq_sem_obj, &ts))
+            if (0 == wait_semaphore_monotonic(&m_empty_msgq_sem_obj, static_cast<unsigned int>(sem_wait_timedout) * 1000U))
             {
                 status = true;
             }
@@ -147,6 +208,29 @@ int8_t MiracastThread::receive_message(void *message, size_t msg_size, int sem_w
     return status;
 }
 
+bool MiracastThread::receive_message_timed(void *message, size_t msg_size, unsigned int timeout_ms)
+{
+    bool status = false;
+    MIRACASTLOG_TRACE("Entering...");
+    if (nullptr != m_g_queue)
+    {
+        int wait_status = wait_semaphore_monotonic(&m_empty_msgq_sem_obj, timeout_ms);
+
+        if (0 == wait_status)
+        {
+            void *data_ptr = static_cast<void *>(g_async_queue_pop(m_g_queue));
+            if ((nullptr != message) && (nullptr != data_ptr))
+            {
+                memcpy(message, data_ptr, msg_size);
+            }
+            free(data_ptr);
+            status = true;
+        }
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return status;
+}
+
 std::string MiracastCommon::parse_opt_flag( std::string file_name , bool integer_check , bool debugStats )
 {
     std::string return_buffer = "";
@@ -402,3 +486,95 @@ void MessageQueue::detachQueue(void)
 
     MIRACASTLOG_TRACE("Exiting...");
 }
+
+MiracastEventBufferPool *MiracastEventBufferPool::m_event_pool_obj{nullptr};
+std::mutex MiracastEventBufferPool::m_instance_mutex;
+
+MiracastEventBufferPool *MiracastEventBufferPool::getInstance()
+{
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr == m_event_pool_obj)
+    {
+        m_event_pool_obj = new MiracastEventBufferPool();
+    }
+    return m_event_pool_obj;
+}
+
+void MiracastEventBufferPool::destroyInstance()
+{
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr != m_event_pool_obj)
+    {
+        delete m_event_pool_obj;
+        m_event_pool_obj = nullptr;
+    }
+}
+
+MiracastEventBufferPool::MiracastEventBufferPool()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    m_free_buffers.reserve(MIRACAST_EVENT_POOL_SIZE);
+    for (int count = 0; count < MIRACAST_EVENT_POOL_SIZE; ++count)
+    {
+        m_free_buffers.push_back(new MIRACAST_EVENT_BUFFER());
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastEventBufferPool::~MiracastEventBufferPool()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    for (auto event_buffer : m_free_buffers)
+    {
+        delete event_buffer;
+    }
+    m_free_buffers.clear();
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MIRACAST_EVENT_BUFFER *MiracastEventBufferPool::acquire(void)
+{
+    MIRACAST_EVENT_BUFFER *event_buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_pool_mutex);
+        if (!m_free_buffers.empty())
+        {
+            event_buffer = m_free_buffers.back();
+            m_free_buffers.pop_back();
+        }
+    }
+    if (nullptr == event_buffer)
+    {
+        MIRACASTLOG_VERBOSE("Event pool exhausted, allocating a new buffer");
+        event_buffer = new MIRACAST_EVENT_BUFFER();
+    }
+    event_buffer->ref_count.store(1);
+    event_buffer->length = 0;
+    event_buffer->data[0] = '\0';
+    return event_buffer;
+}
+
+void MiracastEventBufferPool::add_ref(MIRACAST_EVENT_BUFFER *event_buffer)
+{
+    if (nullptr != event_buffer)
+    {
+        event_buffer->ref_count.fetch_add(1);
+    }
+}
+
+void MiracastEventBufferPool::release(MIRACAST_EVENT_BUFFER *event_buffer)
+{
+    if ((nullptr == event_buffer) || (1 != event_buffer->ref_count.fetch_sub(1)))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_pool_mutex);
+        if (MIRACAST_EVENT_POOL_SIZE > m_free_buffers.size())
+        {
+            m_free_buffers.push_back(event_buffer);
+            return;
+        }
+    }
+    delete event_buffer;
+}
@@ -33,7 +33,10 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <MiracastLogger.h>
+#include <MiracastOptFlags.h>
+#include <MiracastSessionTracer.h>
 
 using namespace std;
 using namespace MIRACAST;
@@ -50,7 +53,9 @@ using namespace MIRACAST;
 #define THREAD_RECV_MSG_INDEFINITE_WAIT (-1)
 #define THREAD_RECV_MSG_WAIT_IMMEDIATE ( 0 )
 
+#ifndef WPA_SUP_DFLT_CTRL_PATH
 #define WPA_SUP_DFLT_CTRL_PATH "/var/run/wpa_supplicant/"
+#endif
 
 enum MiracastError
 {
@@ -94,7 +99,10 @@ typedef enum controller_framework_states_e
     CONTROLLER_FLUSH_CURRENT_SESSION = 0x0000001A,
     CONTROLLER_SELF_ABORT = 0x0000001B,
     CONTROLLER_RESTART_DISCOVERING = 0x0000001C,
-    CONTROLLER_INVALID_STATE = 0x0000001D,
+    CONTROLLER_P2P_READY = 0x0000001D,
+    CONTROLLER_CONNECT_CACHED_SOURCE = 0x0000001E,
+    CONTROLLER_GROUP_INTERFACE_LOST = 0x0000001F,
+    CONTROLLER_INVALID_STATE = 0x00000020,
     RTSP_M1_REQUEST_RECEIVED = 0x000FF0000,
     RTSP_M2_REQUEST_ACK = 0x000FF0001,
     RTSP_M3_REQUEST_RECEIVED = 0x000FF0002,
@@ -125,6 +133,7 @@ typedef struct group_info
     std::string ipMask;
     std::string srcDevIPAddr;
     std::string localIPAddr;
+    bool isPersistent;
 } GroupInfo;
 
 typedef enum msg_type_e
@@ -166,6 +175,14 @@ typedef enum miracast_gstplayer_states_e
     MIRACAST_GSTPLAYER_STATE_MAX,
 } eMIRA_GSTPLAYER_STATES;
 
+/* reasonCode of MiracastPlayer StopRequest, shared so the service can stop the player directly */
+typedef enum miracast_player_stop_reason_code_e
+{
+    STOP_REASON_APP_REQ_FOR_EXIT = 300,
+    STOP_REASON_APP_REQ_FOR_NEW_CONNECTION = 301
+}
+MiracastPlayerStopReasonCode;
+
 typedef struct d_info
 {
     string deviceMAC;
@@ -186,9 +203,20 @@ typedef struct video_rect_st
 }
 VIDEO_RECT_STRUCT;
 
+#define MIRACAST_EVENT_BUFFER_SIZE      (2048)
+#define MIRACAST_EVENT_POOL_SIZE        (16)
+
+typedef struct miracast_event_buffer_st
+{
+    std::atomic<int> ref_count;
+    size_t length;
+    char data[MIRACAST_EVENT_BUFFER_SIZE];
+}
+MIRACAST_EVENT_BUFFER;
+
 typedef struct controller_msgq_st
 {
-    char msg_buffer[2048];
+    MIRACAST_EVENT_BUFFER *event_buffer;
     char source_dev_ip[24];
     char source_dev_mac[24];
     char sink_dev_ip[24];
@@ -211,6 +239,8 @@ public:
     MiracastError start(void);
     void send_message(void *message, size_t msg_size);
     int8_t receive_message(void *message, size_t msg_size, int sem_wait_timedout);
+    /* Same as receive_message() with a millisecond timeout, returns false when it expired */
+    bool receive_message_timed(void *message, size_t msg_size, unsigned int timeout_ms);
 
 private:
     std::string m_thread_name;
@@ -256,4 +286,32 @@ public:
     void detachQueue(void);
 };
 
+/**
+ * Recycles the buffers used to carry wpa_supplicant events from the P2P
+ * monitor to the controller thread. A buffer is handed over by reference,
+ * the last release() returns it to the free list (up to
+ * MIRACAST_EVENT_POOL_SIZE buffers are kept, extra ones are freed).
+ */
+class MiracastEventBufferPool
+{
+public:
+    static MiracastEventBufferPool *getInstance();
+    static void destroyInstance();
+
+    MIRACAST_EVENT_BUFFER *acquire(void);
+    void add_ref(MIRACAST_EVENT_BUFFER *event_buffer);
+    void release(MIRACAST_EVENT_BUFFER *event_buffer);
+
+private:
+    static MiracastEventBufferPool *m_event_pool_obj;
+    static std::mutex m_instance_mutex;
+    std::mutex m_pool_mutex;
+    std::vector<MIRACAST_EVENT_BUFFER *> m_free_buffers;
+
+    MiracastEventBufferPool();
+    virtual ~MiracastEventBufferPool();
+    MiracastEventBufferPool &operator=(const MiracastEventBufferPool &) = delete;
+    MiracastEventBufferPool(const MiracastEventBufferPool &) = delete;
+};
+
 #endif
\ No newline at end of file
@@ -21,10 +21,47 @@
 #include <cstring>
 #include <cstdarg>
 #include <cstdlib>
+#include <cstdint>
+#include <cstddef>
 #include <ctime>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <sys/stat.h>
 #include <sys/time.h>
 
+/*
+ * Asynchronous logging backend.
+ *
+ * Every thread that logs owns a single-producer/single-consumer byte ring.
+ * log() only captures the level, call-site, format pointer and the raw
+ * arguments into that ring; a dedicated drain thread replays the format
+ * against the captured arguments, and writes the result to stderr in batches.
+ * func/file/format are always string literals coming from the _LOG macro, so
+ * only their pointers are stored. "%s" arguments are copied into the record as
+ * their lifetime is owned by the caller.
+ *
+ * Before logger_init() / once logger_deinit() has started, or when the format
+ * carries an unsupported conversion, the message is written synchronously on
+ * the calling thread, exactly like the previous backend. When the caller's
+ * ring is full the message is dropped and counted instead of stalling the
+ * caller; the drain thread reports the count with the next batch. ERROR and
+ * FATAL messages are never dropped, the caller drains the rings itself to make
+ * room, and falls back to the synchronous write if that is not enough.
+ */
+
+#define LOG_RING_SIZE               (64 * 1024)
+#define LOG_RING_MASK               (LOG_RING_SIZE - 1)
+#define LOG_FORMAT_MESSAGE_SIZE     (4096)
+#define LOG_MAX_RECORD_SIZE         (LOG_FORMAT_MESSAGE_SIZE + 1024)
+#define LOG_MAX_SPEC_SIZE           (32)
+#define LOG_DRAIN_BATCH_SIZE        (16 * 1024)
+#define LOG_DRAIN_INTERVAL_MS       (20)
+#define LOG_RECORD_ALIGN(x)         (((x) + 7) & ~((size_t)7))
+
 namespace MIRACAST
 {
     static inline void sync_stdout()
@@ -33,8 +70,742 @@ namespace MIRACAST
             setvbuf(stdout, NULL, _IOLBF, 0);
     }
 
-    static int gDefaultLogLevel = INFO_LEVEL;
+    int gDefaultLogLevel = INFO_LEVEL;
     static std::string service_name = "NOT-DEFINED";
+    static const char *levelMap[] = {"FATAL", "ERROR", "WARN", "INFO", "VERBOSE", "TRACE"};
+
+    typedef enum log_record_type_e
+    {
+        LOG_RECORD_PADDING = 0,
+        LOG_RECORD_RAW_ARGS,
+        LOG_RECORD_PREFORMATTED
+    }
+    LOG_RECORD_TYPE;
+
+    typedef struct log_record_header_st
+    {
+        uint32_t size;
+        uint32_t type;
+        uint64_t sequence;
+        const char *func;
+        const char *file;
+        const char *format;
+        int32_t line;
+        int32_t level;
+    }
+    LOG_RECORD_HEADER;
+
+    typedef enum log_arg_class_e
+    {
+        LOG_ARG_LITERAL = 0,
+        LOG_ARG_SIGNED,
+        LOG_ARG_UNSIGNED,
+        LOG_ARG_DOUBLE,
+        LOG_ARG_LONG_DOUBLE,
+        LOG_ARG_CHAR,
+        LOG_ARG_STRING,
+        LOG_ARG_POINTER,
+        LOG_ARG_COUNT,
+        LOG_ARG_UNSUPPORTED
+    }
+    LOG_ARG_CLASS;
+
+    typedef enum log_arg_length_e
+    {
+        LOG_LEN_NONE = 0,
+        LOG_LEN_HH,
+        LOG_LEN_H,
+        LOG_LEN_L,
+        LOG_LEN_LL,
+        LOG_LEN_J,
+        LOG_LEN_Z,
+        LOG_LEN_T,
+        LOG_LEN_BIG_L
+    }
+    LOG_ARG_LENGTH;
+
+    typedef struct log_conv_spec_st
+    {
+        const char *start;
+        size_t spec_len;
+        int star_count;
+        int precision;
+        bool precision_star;
+        LOG_ARG_LENGTH length;
+        LOG_ARG_CLASS arg_class;
+    }
+    LOG_CONV_SPEC;
+
+    class LogRing
+    {
+    public:
+        LogRing() : m_head(0), m_tail(0), m_orphaned(false), m_tid(0) {}
+
+        std::atomic<size_t> m_head;
+        std::atomic<size_t> m_tail;
+        std::atomic<bool> m_orphaned;
+        int m_tid;
+        alignas(8) unsigned char m_buffer[LOG_RING_SIZE];
+    };
+
+    static std::mutex gRingRegistryMutex;
+    static std::vector<LogRing*> gRingRegistry;
+    static std::mutex gDrainMutex;
+    static std::mutex gWakeMutex;
+    static std::condition_variable gWakeCondition;
+    static std::thread *gDrainThread = nullptr;
+    static std::atomic<bool> gAsyncActive(false);
+    static std::atomic<bool> gDrainStop(false);
+    static std::atomic<bool> gWakeRequested(false);
+    static std::atomic<uint64_t> gSequence(0);
+    static std::atomic<int> gActiveProducers(0);
+    static std::atomic<uint64_t> gDroppedRecords(0);
+
+    class LogRingOwner
+    {
+    public:
+        LogRingOwner() : m_ring(nullptr) {}
+        ~LogRingOwner()
+        {
+            if (nullptr != m_ring)
+            {
+                m_ring->m_orphaned.store(true, std::memory_order_release);
+            }
+        }
+        LogRing *m_ring;
+    };
+
+    static thread_local LogRingOwner tRingOwner;
+
+    static LogRing *get_thread_ring()
+    {
+        if (nullptr == tRingOwner.m_ring)
+        {
+            LogRing *ring = new (std::nothrow) LogRing();
+            if (nullptr == ring)
+            {
+                return nullptr;
+            }
+            ring->m_tid = (int)syscall(SYS_gettid);
+            {
+                std::lock_guard<std::mutex> lock(gRingRegistryMutex);
+                gRingRegistry.push_back(ring);
+            }
+            tRingOwner.m_ring = ring;
+        }
+        return tRingOwner.m_ring;
+    }
+
+    /* Parses the conversion starting at '%', returns false at end of format */
+    static bool next_conversion(const char *&cursor, LOG_CONV_SPEC &spec)
+    {
+        const char *p = strchr(cursor, '%');
+
+        if (nullptr == p)
+        {
+            return false;
+        }
+
+        spec.start = p;
+        spec.star_count = 0;
+        spec.precision = -1;
+        spec.precision_star = false;
+        spec.length = LOG_LEN_NONE;
+        spec.arg_class = LOG_ARG_UNSUPPORTED;
+        ++p;
+
+        if ('%' == *p)
+        {
+            spec.arg_class = LOG_ARG_LITERAL;
+            ++p;
+        }
+        else
+        {
+            while (('-' == *p) || ('+' == *p) || (' ' == *p) || ('#' == *p) || ('0' == *p) || ('\'' == *p))
+            {
+                ++p;
+            }
+            if ('*' == *p)
+            {
+                ++spec.star_count;
+                ++p;
+            }
+            else
+            {
+                while (('0' <= *p) && ('9' >= *p))
+                {
+                    ++p;
+                }
+            }
+            if ('.' == *p)
+            {
+                ++p;
+                spec.precision = 0;
+                if ('*' == *p)
+                {
+                    ++spec.star_count;
+                    spec.precision_star = true;
+                    ++p;
+                }
+                else
+                {
+                    while (('0' <= *p) && ('9' >= *p))
+                    {
+                        spec.precision = (spec.precision * 10) + (*p - '0');
+                        ++p;
+                    }
+                }
+            }
+            switch (*p)
+            {
+                case 'h':
+                    spec.length = ('h' == p[1]) ? LOG_LEN_HH : LOG_LEN_H;
+                    p += ('h' == p[1]) ? 2 : 1;
+                    break;
+                case 'l':
+                    spec.length = ('l' == p[1]) ? LOG_LEN_LL : LOG_LEN_L;
+                    p += ('l' == p[1]) ? 2 : 1;
+                    break;
+                case 'q': spec.length = LOG_LEN_LL; ++p; break;
+                case 'j': spec.length = LOG_LEN_J; ++p; break;
+                case 'z': spec.length = LOG_LEN_Z; ++p; break;
+                case 't': spec.length = LOG_LEN_T; ++p; break;
+                case 'L': spec.length = LOG_LEN_BIG_L; ++p; break;
+                default: break;
+            }
+            switch (*p)
+            {
+                case 'd': case 'i':
+                    spec.arg_class = LOG_ARG_SIGNED;
+                    break;
+                case 'u': case 'o': case 'x': case 'X':
+                    spec.arg_class = LOG_ARG_UNSIGNED;
+                    break;
+                case 'f': case 'F': case 'e': case 'E':
+                case 'g': case 'G': case 'a': case 'A':
+                    spec.arg_class = (LOG_LEN_BIG_L == spec.length) ? LOG_ARG_LONG_DOUBLE : LOG_ARG_DOUBLE;
+                    break;
+                case 'c':
+                    spec.arg_class = (LOG_LEN_L == spec.length) ? LOG_ARG_UNSUPPORTED : LOG_ARG_CHAR;
+                    break;
+                case 's':
+                    spec.arg_class = (LOG_LEN_L == spec.length) ? LOG_ARG_UNSUPPORTED : LOG_ARG_STRING;
+                    break;
+                case 'p':
+                    spec.arg_class = LOG_ARG_POINTER;
+                    break;
+                case 'n':
+                    spec.arg_class = LOG_ARG_COUNT;
+                    break;
+                default:
+                    spec.arg_class = LOG_ARG_UNSUPPORTED;
+                    break;
+            }
+            if ('\0' != *p)
+            {
+                ++p;
+            }
+        }
+        spec.spec_len = p - spec.start;
+        cursor = p;
+        return true;
+    }
+
+    template <typename T>
+    static inline bool put_value(unsigned char *&out, const unsigned char *end, const T &value)
+    {
+        if ((size_t)(end - out) < sizeof(uint64_t))
+        {
+            return false;
+        }
+        memcpy(out, &value, sizeof(T));
+        out += sizeof(uint64_t);
+        return true;
+    }
+
+    template <typename T>
+    static inline T get_value(const unsigned char *&in)
+    {
+        T value;
+        memcpy(&value, in, sizeof(T));
+        in += sizeof(uint64_t);
+        return value;
+    }
+
+    /*
+     * Captures the variadic arguments in format order. Integers are widened
+     * to 64-bit, strings are copied up to their precision (".N" or ".*"), so a
+     * buffer that is not NUL terminated is never read past the given length,
+     * and truncated to the legacy 4 KB message size.
+     * Returns the payload size or 0 when the arguments cannot be captured.
+     */
+    static size_t capture_arguments(const char *format, va_list args, unsigned char *payload, size_t capacity)
+    {
+        unsigned char *out = payload;
+        const unsigned char *end = payload + capacity;
+        const char *cursor = format;
+        size_t string_budget = LOG_FORMAT_MESSAGE_SIZE;
+        LOG_CONV_SPEC spec;
+
+        while (next_conversion(cursor, spec))
+        {
+            if (spec.spec_len >= LOG_MAX_SPEC_SIZE)
+            {
+                return 0;
+            }
+            int precision = spec.precision;
+
+            for (int star = 0; star < spec.star_count; ++star)
+            {
+                int64_t width = va_arg(args, int);
+                if (!put_value(out, end, width))
+                {
+                    return 0;
+                }
+                if (spec.precision_star && (star == spec.star_count - 1))
+                {
+                    /* A negative ".*" precision is taken as if it were omitted */
+                    precision = (width < 0) ? -1 : (int)width;
+                }
+            }
+            switch (spec.arg_class)
+            {
+                case LOG_ARG_LITERAL:
+                    break;
+                case LOG_ARG_SIGNED:
+                {
+                    int64_t value;
+                    switch (spec.length)
+                    {
+                        case LOG_LEN_L: value = va_arg(args, long); break;
+                        case LOG_LEN_LL: value = va_arg(args, long long); break;
+                        case LOG_LEN_J: value = va_arg(args, intmax_t); break;
+                        case LOG_LEN_Z: value = va_arg(args, ssize_t); break;
+                        case LOG_LEN_T: value = va_arg(args, ptrdiff_t); break;
+                        default: value = va_arg(args, int); break;
+                    }
+                    if (!put_value(out, end, value))
+                    {
+                        return 0;
+                    }
+                }
+                break;
+                case LOG_ARG_UNSIGNED:
+                {
+                    uint64_t value;
+                    switch (spec.length)
+                    {
+                        case LOG_LEN_L: value = va_arg(args, unsigned long); break;
+                        case LOG_LEN_LL: value = va_arg(args, unsigned long long); break;
+                        case LOG_LEN_J: value = va_arg(args, uintmax_t); break;
+                        case LOG_LEN_Z: value = va_arg(args, size_t); break;
+                        case LOG_LEN_T: value = va_arg(args, ptrdiff_t); break;
+                        default: value = va_arg(args, unsigned int); break;
+                    }
+                    if (!put_value(out, end, value))
+                    {
+                        return 0;
+                    }
+                }
+                break;
+                case LOG_ARG_DOUBLE:
+                {
+                    double value = va_arg(args, double);
+                    if (!put_value(out, end, value))
+                    {
+                        return 0;
+                    }
+                }
+                break;
+                case LOG_ARG_CHAR:
+                {
+                    int64_t value = va_arg(args, int);
+                    if (!put_value(out, end, value))
+                    {
+                        return 0;
+                    }
+                }
+                break;
+                case LOG_ARG_POINTER:
+                {
+                    uint64_t value = (uintptr_t)va_arg(args, void *);
+                    if (!put_value(out, end, value))
+                    {
+                        return 0;
+                    }
+                }
+                break;
+                case LOG_ARG_STRING:
+                {
+                    const char *value = va_arg(args, const char *);
+                    size_t limit = string_budget;
+                    uint64_t length;
+
+                    if (nullptr == value)
+                    {
+                        value = "(null)";
+                    }
+                    if ((precision >= 0) && ((size_t)precision < limit))
+                    {
+                        limit = (size_t)precision;
+                    }
+                    length = strnlen(value, limit);
+                    string_budget -= length;
+                    if (!put_value(out, end, length) ||
+                        ((size_t)(end - out) < LOG_RECORD_ALIGN(length + 1)))
+                    {
+                        return 0;
+                    }
+                    memcpy(out, value, length);
+                    out[length] = '\0';
+                    out += LOG_RECORD_ALIGN(length + 1);
+                }
+                break;
+                case LOG_ARG_COUNT:
+                {
+                    /* %n is never replayed, just consume the pointer */
+                    (void)va_arg(args, int *);
+                }
+                break;
+                default:
+                    return 0;
+            }
+        }
+        /* A record carrying no argument still needs a non-zero payload marker */
+        return (out == payload) ? sizeof(uint64_t) : (size_t)(out - payload);
+    }
+
+    template <typename T>
+    static int format_one(char *dst, size_t size, const char *spec, const int *stars, int star_count, T value)
+    {
+        if (2 == star_count)
+        {
+            return snprintf(dst, size, spec, stars[0], stars[1], value);
+        }
+        else if (1 == star_count)
+        {
+            return snprintf(dst, size, spec, stars[0], value);
+        }
+        return snprintf(dst, size, spec, value);
+    }
+
+    /* Replays a format string against arguments captured by capture_arguments() */
+    static size_t replay_arguments(const char *format, const unsigned char *payload, char *dst, size_t size)
+    {
+        const char *cursor = format;
+        const unsigned char *in = payload;
+        size_t used = 0;
+        LOG_CONV_SPEC spec;
+        char spec_buffer[LOG_MAX_SPEC_SIZE];
+
+        while (used + 1 < size)
+        {
+            const char *literal = cursor;
+            bool found = next_conversion(cursor, spec);
+            size_t literal_len = found ? (size_t)(spec.start - literal) : strlen(literal);
+            int stars[2] = {0, 0};
+            int written = 0;
+
+            if (literal_len > size - used - 1)
+            {
+                literal_len = size - used - 1;
+            }
+            memcpy(dst + used, literal, literal_len);
+            used += literal_len;
+
+            if (!found || (used + 1 >= size))
+            {
+                break;
+            }
+            for (int star = 0; star < spec.star_count; ++star)
+            {
+                stars[star] = (int)get_value<int64_t>(in);
+            }
+            if (spec.spec_len >= sizeof(spec_buffer))
+            {
+                continue;
+            }
+            memcpy(spec_buffer, spec.start, spec.spec_len);
+            spec_buffer[spec.spec_len] = '\0';
+
+            switch (spec.arg_class)
+            {
+                case LOG_ARG_LITERAL:
+                    dst[used] = '%';
+                    written = 1;
+                    break;
+                case LOG_ARG_SIGNED:
+                {
+                    int64_t value = get_value<int64_t>(in);
+                    switch (spec.length)
+                    {
+                        case LOG_LEN_HH: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (int)(signed char)value); break;
+                        case LOG_LEN_H: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (int)(short)value); break;
+                        case LOG_LEN_L: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (long)value); break;
+                        case LOG_LEN_LL: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (long long)value); break;
+                        case LOG_LEN_J: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (intmax_t)value); break;
+                        case LOG_LEN_Z: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (ssize_t)value); break;
+                        case LOG_LEN_T: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (ptrdiff_t)value); break;
+                        default: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (int)value); break;
+                    }
+                }
+                break;
+                case LOG_ARG_UNSIGNED:
+                {
+                    uint64_t value = get_value<uint64_t>(in);
+                    switch (spec.length)
+                    {
+                        case LOG_LEN_HH: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (unsigned int)(unsigned char)value); break;
+                        case LOG_LEN_H: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (unsigned int)(unsigned short)value); break;
+                        case LOG_LEN_L: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (unsigned long)value); break;
+                        case LOG_LEN_LL: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (unsigned long long)value); break;
+                        case LOG_LEN_J: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (uintmax_t)value); break;
+                        case LOG_LEN_Z: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (size_t)value); break;
+                        case LOG_LEN_T: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (ptrdiff_t)value); break;
+                        default: written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (unsigned int)value); break;
+                    }
+                }
+                break;
+                case LOG_ARG_DOUBLE:
+                    written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, get_value<double>(in));
+                    break;
+                case LOG_ARG_CHAR:
+                    written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (int)get_value<int64_t>(in));
+                    break;
+                case LOG_ARG_POINTER:
+                    written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (void *)(uintptr_t)get_value<uint64_t>(in));
+                    break;
+                case LOG_ARG_STRING:
+                {
+                    uint64_t length = get_value<uint64_t>(in);
+                    written = format_one(dst + used, size - used, spec_buffer, stars, spec.star_count, (const char *)in);
+                    in += LOG_RECORD_ALIGN(length + 1);
+                }
+                break;
+                default:
+                    break;
+            }
+            if (written > 0)
+            {
+                used += ((size_t)written < size - used) ? (size_t)written : (size - used - 1);
+            }
+        }
+        dst[used] = '\0';
+        return used;
+    }
+
+    static int format_line(char *dst, size_t size, int level, int tid, const char *file, int line, const char *func, const char *message)
+    {
+        int written = snprintf(dst, size, "[%s][%d] %s [%s:%d] %s: %s \n",
+                                service_name.c_str(),
+                                tid,
+                                levelMap[level],
+                                basename(file),
+                                line,
+                                func,
+                                message);
+        if (written < 0)
+        {
+            return 0;
+        }
+        return ((size_t)written < size) ? written : (int)(size - 1);
+    }
+
+    static void write_synchronous(int level, const char *func, const char *file, int line, const char *message)
+    {
+        fprintf(stderr, "[%s][%d] %s [%s:%d] %s: %s \n",
+                    service_name.c_str(),
+                    (int)syscall(SYS_gettid),
+                    levelMap[level],
+                    basename(file),
+                    line,
+                    func,
+                    message);
+        fflush(stderr);
+    }
+
+    /* Appends a record to the calling thread's ring, wrapping with a padding record */
+    static bool ring_push(LogRing *ring, const LOG_RECORD_HEADER &header, const unsigned char *payload, size_t payload_size)
+    {
+        size_t record_size = LOG_RECORD_ALIGN(sizeof(LOG_RECORD_HEADER) + payload_size);
+        size_t head = ring->m_head.load(std::memory_order_relaxed);
+        size_t tail = ring->m_tail.load(std::memory_order_acquire);
+        size_t contiguous = LOG_RING_SIZE - (head & LOG_RING_MASK);
+        size_t needed = record_size;
+
+        if (contiguous < record_size)
+        {
+            needed += contiguous;
+        }
+        if ((LOG_RING_SIZE - (head - tail)) < needed)
+        {
+            return false;
+        }
+        if (contiguous < record_size)
+        {
+            uint32_t padding[2] = {(uint32_t)contiguous, LOG_RECORD_PADDING};
+            memcpy(&ring->m_buffer[head & LOG_RING_MASK], padding, sizeof(padding));
+            head += contiguous;
+        }
+
+        unsigned char *slot = &ring->m_buffer[head & LOG_RING_MASK];
+        memcpy(slot, &header, sizeof(header));
+        ((LOG_RECORD_HEADER *)slot)->size = (uint32_t)record_size;
+        memcpy(slot + sizeof(header), payload, payload_size);
+        ring->m_head.store(head + record_size, std::memory_order_release);
+        return true;
+    }
+
+    static const LOG_RECORD_HEADER *ring_peek(LogRing *ring)
+    {
+        for (;;)
+        {
+            size_t tail = ring->m_tail.load(std::memory_order_relaxed);
+            size_t head = ring->m_head.load(std::memory_order_acquire);
+
+            if (tail == head)
+            {
+                return nullptr;
+            }
+
+            const LOG_RECORD_HEADER *record = (const LOG_RECORD_HEADER *)&ring->m_buffer[tail & LOG_RING_MASK];
+            if (LOG_RECORD_PADDING == record->type)
+            {
+                ring->m_tail.store(tail + record->size, std::memory_order_release);
+                continue;
+            }
+            return record;
+        }
+    }
+
+    static void ring_pop(LogRing *ring, const LOG_RECORD_HEADER *record)
+    {
+        size_t tail = ring->m_tail.load(std::memory_order_relaxed);
+        ring->m_tail.store(tail + record->size, std::memory_order_release);
+    }
+
+    /*
+     * Drains all rings in global sequence order. Must be called with
+     * gDrainMutex held; the holder is the single consumer of every ring.
+     */
+    static void drain_rings()
+    {
+        static char batch[LOG_DRAIN_BATCH_SIZE];
+        static char message[LOG_FORMAT_MESSAGE_SIZE];
+        std::vector<LogRing*> rings;
+        size_t batch_used = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(gRingRegistryMutex);
+            rings = gRingRegistry;
+        }
+
+        for (;;)
+        {
+            LogRing *next_ring = nullptr;
+            const LOG_RECORD_HEADER *next_record = nullptr;
+
+            for (LogRing *ring : rings)
+            {
+                const LOG_RECORD_HEADER *record = ring_peek(ring);
+                if ((nullptr != record) &&
+                    ((nullptr == next_record) || (record->sequence < next_record->sequence)))
+                {
+                    next_ring = ring;
+                    next_record = record;
+                }
+            }
+            if (nullptr == next_record)
+            {
+                break;
+            }
+
+            const unsigned char *payload = (const unsigned char *)(next_record + 1);
+            const char *text = (const char *)payload;
+
+            if (LOG_RECORD_RAW_ARGS == next_record->type)
+            {
+                replay_arguments(next_record->format, payload, message, sizeof(message));
+                text = message;
+            }
+
+            if (LOG_DRAIN_BATCH_SIZE - batch_used < LOG_FORMAT_MESSAGE_SIZE + 512)
+            {
+                fwrite(batch, 1, batch_used, stderr);
+                batch_used = 0;
+            }
+            batch_used += format_line(batch + batch_used, LOG_DRAIN_BATCH_SIZE - batch_used,
+                                        next_record->level, next_ring->m_tid,
+                                        next_record->file, next_record->line,
+                                        next_record->func, text);
+            ring_pop(next_ring, next_record);
+        }
+
+        if (batch_used)
+        {
+            fwrite(batch, 1, batch_used, stderr);
+        }
+
+        uint64_t dropped = gDroppedRecords.exchange(0, std::memory_order_relaxed);
+        if (dropped)
+        {
+            fprintf(stderr, "[%s] WARN %llu log message(s) dropped, logging ring full \n",
+                        service_name.c_str(), (unsigned long long)dropped);
+        }
+        fflush(stderr);
+
+        /* Release rings whose owner thread exited and whose records are written */
+        std::lock_guard<std::mutex> lock(gRingRegistryMutex);
+        for (auto it = gRingRegistry.begin(); it != gRingRegistry.end();)
+        {
+            LogRing *ring = *it;
+            if (ring->m_orphaned.load(std::memory_order_acquire) &&
+                (ring->m_head.load(std::memory_order_acquire) == ring->m_tail.load(std::memory_order_relaxed)))
+            {
+                it = gRingRegistry.erase(it);
+                delete ring;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    static void flush_rings()
+    {
+        std::lock_guard<std::mutex> lock(gDrainMutex);
+        drain_rings();
+    }
+
+    static void wake_drain_thread()
+    {
+        if (gWakeRequested.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        /* Set under the mutex, or the drain thread can miss it between its predicate check and the wait */
+        std::lock_guard<std::mutex> lock(gWakeMutex);
+        if (!gWakeRequested.exchange(true))
+        {
+            gWakeCondition.notify_one();
+        }
+    }
+
+    static void drain_thread_loop()
+    {
+        while (!gDrainStop.load(std::memory_order_acquire))
+        {
+            {
+                std::unique_lock<std::mutex> lock(gWakeMutex);
+                gWakeCondition.wait_for(lock, std::chrono::milliseconds(LOG_DRAIN_INTERVAL_MS),
+                                        [] { return gWakeRequested.load() || gDrainStop.load(); });
+                gWakeRequested.store(false);
+            }
+            flush_rings();
+        }
+        flush_rings();
+    }
 
     void logger_init(const char* module_name)
     {
@@ -50,11 +821,40 @@ namespace MIRACAST
         {
             service_name = module_name;
         }
+
+        if (nullptr == gDrainThread)
+        {
+            gDrainStop.store(false);
+            gDrainThread = new std::thread(drain_thread_loop);
+            gAsyncActive.store(true, std::memory_order_release);
+        }
     }
 
     void logger_deinit()
     {
-        /* NOP */
+        gAsyncActive.store(false);
+
+        /*
+         * From here on log() writes synchronously; wait for producers that saw
+         * the logger active to finish their push, so the final flush of the
+         * drain thread below picks their records up.
+         */
+        while (0 != gActiveProducers.load())
+        {
+            std::this_thread::yield();
+        }
+
+        if (nullptr != gDrainThread)
+        {
+            {
+                std::lock_guard<std::mutex> lock(gWakeMutex);
+                gDrainStop.store(true, std::memory_order_release);
+            }
+            gWakeCondition.notify_one();
+            gDrainThread->join();
+            delete gDrainThread;
+            gDrainThread = nullptr;
+        }
     }
 
     void set_loglevel(LogLevel level)
@@ -69,13 +869,9 @@ namespace MIRACAST
             int threadID,
             const char *format, ...)
     {
-        const char *levelMap[] = {"FATAL", "ERROR", "WARN", "INFO", "VERBOSE", "TRACE"};
-        const short kFormatMessageSize = 4096;
-        char formatted[kFormatMessageSize];
-
-        if (((MIRACAST::FATAL_LEVEL != level)&&(MIRACAST::ERROR_LEVEL != level))&&
-            (gDefaultLogLevel < level)){
-                return;
+        if (!is_loglevel_enabled(level))
+        {
+            return;
         }
 
         /* FIX: Add null pointer checks for func, file, and format parameters */
@@ -84,19 +880,87 @@ namespace MIRACAST
             return;
         }
 
+        /* seq_cst pairs with logger_deinit(): either it sees this producer, or we see it stopped */
+        gActiveProducers.fetch_add(1);
+        if (gAsyncActive.load())
+        {
+            LogRing *ring = get_thread_ring();
+
+            if (nullptr != ring)
+            {
+                alignas(8) unsigned char payload[LOG_MAX_RECORD_SIZE];
+                LOG_RECORD_HEADER header;
+                size_t payload_size;
+                va_list argptr;
+
+                va_start(argptr, format);
+                payload_size = capture_arguments(format, argptr, payload, sizeof(payload) - sizeof(LOG_RECORD_HEADER));
+                va_end(argptr);
+
+                header.size = 0;
+                header.type = LOG_RECORD_RAW_ARGS;
+                header.func = func;
+                header.file = file;
+                header.format = format;
+                header.line = line;
+                header.level = level;
+
+                if (0 == payload_size)
+                {
+                    /* Unsupported conversion, format on the caller as before */
+                    va_start(argptr, format);
+                    vsnprintf((char *)payload, LOG_FORMAT_MESSAGE_SIZE, format, argptr);
+                    va_end(argptr);
+                    payload_size = strlen((const char *)payload) + 1;
+                    header.type = LOG_RECORD_PREFORMATTED;
+                }
+
+                header.sequence = gSequence.fetch_add(1, std::memory_order_relaxed);
+
+                bool queued = ring_push(ring, header, payload, payload_size);
+
+                if ((!queued) && (MIRACAST::ERROR_LEVEL >= level))
+                {
+                    /* ERROR and FATAL are never dropped, make room on the caller */
+                    flush_rings();
+                    queued = ring_push(ring, header, payload, payload_size);
+                }
+
+                if (queued)
+                {
+                    if (MIRACAST::FATAL_LEVEL == level)
+                    {
+                        gActiveProducers.fetch_sub(1, std::memory_order_acq_rel);
+                        flush_rings();
+                        return;
+                    }
+                    else if ((MIRACAST::ERROR_LEVEL == level) ||
+                             ((ring->m_head.load(std::memory_order_relaxed) -
+                               ring->m_tail.load(std::memory_order_relaxed)) > (LOG_RING_SIZE / 2)))
+                    {
+                        wake_drain_thread();
+                    }
+                    gActiveProducers.fetch_sub(1, std::memory_order_acq_rel);
+                    return;
+                }
+                else if (MIRACAST::ERROR_LEVEL < level)
+                {
+                    /* Ring is full, drop instead of draining every ring on the caller */
+                    gDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+                    wake_drain_thread();
+                    gActiveProducers.fetch_sub(1, std::memory_order_acq_rel);
+                    return;
+                }
+            }
+        }
+        gActiveProducers.fetch_sub(1, std::memory_order_acq_rel);
+
+        char formatted[LOG_FORMAT_MESSAGE_SIZE];
         va_list argptr;
         va_start(argptr, format);
-        vsnprintf(formatted, kFormatMessageSize, format, argptr);
+        vsnprintf(formatted, LOG_FORMAT_MESSAGE_SIZE, format, argptr);
         va_end(argptr);
 
-        fprintf(stderr, "[%s][%d] %s [%s:%d] %s: %s \n",
-                    service_name.c_str(),
-                    (int)syscall(SYS_gettid),
-                    levelMap[static_cast<int>(level)],
-                    basename(file),
-                    line,
-                    func,
-                    formatted);
-        fflush(stderr);
+        write_synchronous(level, func, file, line, formatted);
     }
 } // namespace MIRACAST
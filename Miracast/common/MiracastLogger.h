@@ -39,6 +39,30 @@ namespace MIRACAST {
  */
 enum LogLevel {FATAL_LEVEL = 0, ERROR_LEVEL, WARNING_LEVEL, INFO_LEVEL, VERBOSE_LEVEL, TRACE_LEVEL};
 
+/**
+ * Most verbose level compiled into the binary. Calls above this level are
+ * removed at build time together with the evaluation of their arguments.
+ * Configured through -DMIRACAST_COMPILED_LOG_LEVEL=<0..5>, defaults to TRACE.
+ */
+#ifndef MIRACAST_COMPILED_LOG_LEVEL
+#define MIRACAST_COMPILED_LOG_LEVEL 5
+#endif
+
+/**
+ * Runtime log level, updated by logger_init (MIRACAST_DEFAULT_LOG_LEVEL)
+ * and set_loglevel. Read inline by the logging macros.
+ */
+extern int gDefaultLogLevel __attribute__((visibility("hidden")));
+
+/**
+ * @brief Returns true when a message at the given level is emitted.
+ * FATAL and ERROR are always emitted.
+ */
+static inline bool is_loglevel_enabled(LogLevel level)
+{
+    return ((ERROR_LEVEL >= level) || (gDefaultLogLevel >= level));
+}
+
 /**
  * @brief Init logging
  * Should be called once per program run before calling log-functions
@@ -74,19 +98,24 @@ void log(LogLevel level,
     const char* format, ...);
 
 #ifdef USE_RDK_LOGGER
-#define _LOG(LEVEL, FORMAT, ...)          \
-    MIRACAST::log(LEVEL,                       \
-         __func__, __FILE__, __LINE__, 0, \
-         FORMAT,                          \
-         ##__VA_ARGS__)
+#define _LOG_THREAD_ID() 0
 #else
-#define _LOG(LEVEL, FORMAT, ...)          \
-    MIRACAST::log(LEVEL,                       \
-         __func__, __FILE__, __LINE__, syscall(__NR_gettid), \
-         FORMAT,                          \
-         ##__VA_ARGS__)
+#define _LOG_THREAD_ID() syscall(__NR_gettid)
 #endif
 
+/* The level checks run before any argument of the call is evaluated */
+#define _LOG(LEVEL, FORMAT, ...)                                       \
+    do {                                                               \
+        if (((LEVEL) <= MIRACAST_COMPILED_LOG_LEVEL) &&                \
+            MIRACAST::is_loglevel_enabled(LEVEL))                      \
+        {                                                              \
+            MIRACAST::log(LEVEL,                                       \
+                 __func__, __FILE__, __LINE__, _LOG_THREAD_ID(),       \
+                 FORMAT,                                               \
+                 ##__VA_ARGS__);                                       \
+        }                                                              \
+    } while (0)
+
 #define MIRACASTLOG_TRACE(FMT, ...)   _LOG(MIRACAST::TRACE_LEVEL, FMT, ##__VA_ARGS__)
 #define MIRACASTLOG_VERBOSE(FMT, ...) _LOG(MIRACAST::VERBOSE_LEVEL, FMT, ##__VA_ARGS__)
 #define MIRACASTLOG_INFO(FMT, ...)    _LOG(MIRACAST::INFO_LEVEL, FMT, ##__VA_ARGS__)
@@ -0,0 +1,95 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2026 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_NOTIFICATION_LIST_H_
+#define _MIRACAST_NOTIFICATION_LIST_H_
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+/* Copy-on-write list of notification sinks, a snapshot keeps its sinks referenced after the owner's lock is dropped.
+ * add(), remove() and snapshot() are serialised by the owner. */
+template <typename NOTIFICATION>
+class MiracastNotificationList
+{
+public:
+    typedef std::vector<NOTIFICATION *> NOTIFICATION_LIST;
+    typedef std::shared_ptr<const NOTIFICATION_LIST> NOTIFICATION_SNAPSHOT;
+
+    MiracastNotificationList()
+        : m_listeners(make_snapshot(NOTIFICATION_LIST()))
+    {
+    }
+
+    /* false when the sink is registered already */
+    bool add(NOTIFICATION *notification)
+    {
+        if (std::find(m_listeners->begin(), m_listeners->end(), notification) != m_listeners->end())
+        {
+            return false;
+        }
+        NOTIFICATION_LIST listeners(*m_listeners);
+        listeners.push_back(notification);
+        m_listeners = make_snapshot(std::move(listeners));
+        return true;
+    }
+
+    /* false when the sink is not registered */
+    bool remove(NOTIFICATION *notification)
+    {
+        NOTIFICATION_LIST listeners(*m_listeners);
+        auto itr = std::find(listeners.begin(), listeners.end(), notification);
+
+        if (itr == listeners.end())
+        {
+            return false;
+        }
+        listeners.erase(itr);
+        m_listeners = make_snapshot(std::move(listeners));
+        return true;
+    }
+
+    NOTIFICATION_SNAPSHOT snapshot(void) const
+    {
+        return m_listeners;
+    }
+
+private:
+    NOTIFICATION_SNAPSHOT m_listeners;
+
+    static NOTIFICATION_SNAPSHOT make_snapshot(NOTIFICATION_LIST &&listeners)
+    {
+        for (NOTIFICATION *notification : listeners)
+        {
+            notification->AddRef();
+        }
+        return NOTIFICATION_SNAPSHOT(new NOTIFICATION_LIST(std::move(listeners)),
+                                     [](const NOTIFICATION_LIST *list)
+                                     {
+                                         for (NOTIFICATION *notification : *list)
+                                         {
+                                             notification->Release();
+                                         }
+                                         delete list;
+                                     });
+    }
+};
+
+#endif /* _MIRACAST_NOTIFICATION_LIST_H_ */
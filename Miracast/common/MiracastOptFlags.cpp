@@ -0,0 +1,245 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include "MiracastOptFlags.h"
+
+#define OPT_FLAGS_INOTIFY_MASK  (IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MODIFY | \
+                                 IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | \
+                                 IN_DELETE_SELF | IN_MOVE_SELF)
+
+static const char *opt_flag_names[MIRACAST_OPT_FLAG_MAX] =
+{
+    "miracast_autoconnect",
+    "miracast_direct_request",
+    "miracast_custom_p2p_cfg",
+    "miracast_custom_p2p_scan",
+    "miracast_custom_westeros_name",
+    "miracast_skip_firstframe_callback",
+    "miracast_gst",
+    "miracast_gstpipline.txt",
+    "miracast_player_stats",
+    "miracast_faststart-min-packets",
+    "miracast_tsparse_alignment",
+    "miracast_session_trace",
+    "miracast_player_handoff",
+    "miracast_persistent_group"
+};
+
+MiracastOptFlags *MiracastOptFlags::m_opt_flags_obj{nullptr};
+std::mutex MiracastOptFlags::m_instance_mutex;
+
+MiracastOptFlags *MiracastOptFlags::getInstance()
+{
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr == m_opt_flags_obj)
+    {
+        m_opt_flags_obj = new MiracastOptFlags();
+    }
+    return m_opt_flags_obj;
+}
+
+void MiracastOptFlags::destroyInstance()
+{
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr != m_opt_flags_obj)
+    {
+        delete m_opt_flags_obj;
+        m_opt_flags_obj = nullptr;
+    }
+}
+
+MiracastOptFlags::MiracastOptFlags()
+    : m_inotify_fd(-1),
+      m_watch_fd(-1)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    for (int flag = 0; flag < MIRACAST_OPT_FLAG_MAX; ++flag)
+    {
+        m_flags[flag].present = false;
+        m_flags[flag].is_integer = false;
+        m_flags[flag].integer_value = 0;
+    }
+
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (0 <= m_inotify_fd)
+    {
+        m_watch_fd = inotify_add_watch(m_inotify_fd, MIRACAST_OPT_FLAGS_DIR, OPT_FLAGS_INOTIFY_MASK);
+        if (0 > m_watch_fd)
+        {
+            MIRACASTLOG_WARNING("Unable to watch [%s] (%s), flags read on demand", MIRACAST_OPT_FLAGS_DIR, strerror(errno));
+            close(m_inotify_fd);
+            m_inotify_fd = -1;
+        }
+    }
+    else
+    {
+        MIRACASTLOG_WARNING("inotify_init1 failed (%s), flags read on demand", strerror(errno));
+    }
+
+    for (int flag = 0; flag < MIRACAST_OPT_FLAG_MAX; ++flag)
+    {
+        load_flag(static_cast<MIRACAST_OPT_FLAG>(flag));
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MiracastOptFlags::~MiracastOptFlags()
+{
+    MIRACASTLOG_TRACE("Entering...");
+    if (0 <= m_inotify_fd)
+    {
+        close(m_inotify_fd);
+        m_inotify_fd = -1;
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+void MiracastOptFlags::load_flag(MIRACAST_OPT_FLAG flag)
+{
+    OPT_FLAG_ENTRY &entry = m_flags[flag];
+    std::string file_name = std::string(MIRACAST_OPT_FLAGS_DIR) + "/" + opt_flag_names[flag];
+    std::ifstream flag_file(file_name.c_str());
+    std::string line = "";
+    bool was_present = entry.present;
+    std::string old_value = entry.value;
+
+    entry.present = flag_file.is_open();
+    if (entry.present)
+    {
+        std::getline(flag_file, line);
+        flag_file.close();
+    }
+    entry.value = line;
+    entry.is_integer = !line.empty();
+    entry.integer_value = 0;
+    for (char c : line)
+    {
+        if (!isdigit(static_cast<unsigned char>(c)))
+        {
+            entry.is_integer = false;
+            break;
+        }
+    }
+    if (entry.is_integer)
+    {
+        entry.integer_value = strtoull(line.c_str(), nullptr, 10);
+    }
+
+    if ((was_present != entry.present) || (old_value != entry.value))
+    {
+        if (entry.present)
+        {
+            MIRACASTLOG_INFO("Flag [%s] set, content [%s]", file_name.c_str(), line.c_str());
+        }
+        else if (was_present)
+        {
+            MIRACASTLOG_INFO("Flag [%s] removed", file_name.c_str());
+        }
+    }
+}
+
+/* Applies the pending inotify events, must be called with m_flags_mutex held */
+void MiracastOptFlags::refresh_flags(void)
+{
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length;
+
+    while (0 < (length = read(m_inotify_fd, buffer, sizeof(buffer))))
+    {
+        for (char *ptr = buffer; ptr < buffer + length;)
+        {
+            struct inotify_event *event = reinterpret_cast<struct inotify_event *>(ptr);
+
+            if (event->mask & (IN_Q_OVERFLOW | IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+            {
+                for (int flag = 0; flag < MIRACAST_OPT_FLAG_MAX; ++flag)
+                {
+                    load_flag(static_cast<MIRACAST_OPT_FLAG>(flag));
+                }
+            }
+            else if (event->len)
+            {
+                for (int flag = 0; flag < MIRACAST_OPT_FLAG_MAX; ++flag)
+                {
+                    if (0 == strcmp(event->name, opt_flag_names[flag]))
+                    {
+                        load_flag(static_cast<MIRACAST_OPT_FLAG>(flag));
+                        break;
+                    }
+                }
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+const MiracastOptFlags::OPT_FLAG_ENTRY &MiracastOptFlags::lookup(MIRACAST_OPT_FLAG flag)
+{
+    if (0 <= m_inotify_fd)
+    {
+        refresh_flags();
+    }
+    else
+    {
+        load_flag(flag);
+    }
+    return m_flags[flag];
+}
+
+bool MiracastOptFlags::is_present(MIRACAST_OPT_FLAG flag)
+{
+    if (MIRACAST_OPT_FLAG_MAX <= flag)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_flags_mutex);
+    return lookup(flag).present;
+}
+
+std::string MiracastOptFlags::get_string(MIRACAST_OPT_FLAG flag)
+{
+    if (MIRACAST_OPT_FLAG_MAX <= flag)
+    {
+        return "";
+    }
+    std::lock_guard<std::mutex> lock(m_flags_mutex);
+    return lookup(flag).value;
+}
+
+bool MiracastOptFlags::get_integer(MIRACAST_OPT_FLAG flag, uint64_t &value)
+{
+    if (MIRACAST_OPT_FLAG_MAX <= flag)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_flags_mutex);
+    const OPT_FLAG_ENTRY &entry = lookup(flag);
+    if (entry.is_integer)
+    {
+        value = entry.integer_value;
+    }
+    return entry.is_integer;
+}
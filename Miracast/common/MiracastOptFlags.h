@@ -0,0 +1,96 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_OPT_FLAGS_H_
+#define _MIRACAST_OPT_FLAGS_H_
+
+#include <string>
+#include <mutex>
+#include <stdint.h>
+#include <MiracastLogger.h>
+
+#define MIRACAST_OPT_FLAGS_DIR  "/opt"
+
+typedef enum miracast_opt_flag_e
+{
+    MIRACAST_OPT_AUTOCONNECT = 0,
+    MIRACAST_OPT_DIRECT_REQUEST,
+    MIRACAST_OPT_CUSTOM_P2P_CFG,
+    MIRACAST_OPT_CUSTOM_P2P_SCAN,
+    MIRACAST_OPT_CUSTOM_WESTEROS_NAME,
+    MIRACAST_OPT_SKIP_FIRSTFRAME_CALLBACK,
+    MIRACAST_OPT_GST,
+    MIRACAST_OPT_GST_PIPELINE,
+    MIRACAST_OPT_PLAYER_STATS,
+    MIRACAST_OPT_FASTSTART_MIN_PACKETS,
+    MIRACAST_OPT_TSPARSE_ALIGNMENT,
+    MIRACAST_OPT_SESSION_TRACE,
+    MIRACAST_OPT_PLAYER_HANDOFF,
+    MIRACAST_OPT_PERSISTENT_GROUP,
+    MIRACAST_OPT_FLAG_MAX
+}
+MIRACAST_OPT_FLAG;
+
+/**
+ * Registry of the Miracast debug/override flags under /opt.
+ * All known flags are loaded once and then refreshed only when inotify
+ * reports a change in /opt, so lookups are served from memory.
+ * Without inotify every lookup falls back to reading the file.
+ */
+class MiracastOptFlags
+{
+public:
+    static MiracastOptFlags *getInstance();
+    static void destroyInstance();
+
+    /* true when the flag file exists */
+    bool is_present(MIRACAST_OPT_FLAG flag);
+    /* First line of the flag file, empty when missing */
+    std::string get_string(MIRACAST_OPT_FLAG flag);
+    /* true when the first line is a non-empty decimal number */
+    bool get_integer(MIRACAST_OPT_FLAG flag, uint64_t &value);
+
+private:
+    typedef struct opt_flag_entry_st
+    {
+        bool present;
+        bool is_integer;
+        uint64_t integer_value;
+        std::string value;
+    }
+    OPT_FLAG_ENTRY;
+
+    static MiracastOptFlags *m_opt_flags_obj;
+    static std::mutex m_instance_mutex;
+    std::mutex m_flags_mutex;
+    int m_inotify_fd;
+    int m_watch_fd;
+    OPT_FLAG_ENTRY m_flags[MIRACAST_OPT_FLAG_MAX];
+
+    MiracastOptFlags();
+    virtual ~MiracastOptFlags();
+    MiracastOptFlags &operator=(const MiracastOptFlags &) = delete;
+    MiracastOptFlags(const MiracastOptFlags &) = delete;
+
+    void load_flag(MIRACAST_OPT_FLAG flag);
+    void refresh_flags(void);
+    const OPT_FLAG_ENTRY &lookup(MIRACAST_OPT_FLAG flag);
+};
+
+#endif /* _MIRACAST_OPT_FLAGS_H_ */
@@ -0,0 +1,415 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include "MiracastSessionTracer.h"
+#include "MiracastOptFlags.h"
+
+static const char *trace_span_names[MIRACAST_SPAN_MAX] =
+{
+    "P2P_FIND",
+    "PROVISION_DISCOVERY",
+    "USER_ACCEPT",
+    "GO_NEGOTIATION",
+    "GROUP_START",
+    "DHCP",
+    "ARP_VERIFY",
+    "TCP_CONNECT",
+    "RTSP_M1_M7",
+    "PIPELINE_SETUP",
+    "FIRST_VIDEO_FRAME"
+};
+
+MiracastSessionTracer *MiracastSessionTracer::m_session_tracer_obj{nullptr};
+std::mutex MiracastSessionTracer::m_instance_mutex;
+
+MiracastSessionTracer *MiracastSessionTracer::getInstance()
+{
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr == m_session_tracer_obj)
+    {
+        m_session_tracer_obj = new MiracastSessionTracer();
+    }
+    return m_session_tracer_obj;
+}
+
+void MiracastSessionTracer::destroyInstance()
+{
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr != m_session_tracer_obj)
+    {
+        delete m_session_tracer_obj;
+        m_session_tracer_obj = nullptr;
+    }
+}
+
+MiracastSessionTracer::MiracastSessionTracer()
+    : m_session_active(false),
+      m_last_session_valid(false),
+      m_session_end_handler(nullptr),
+      m_session_end_ctx(nullptr)
+{
+    memset(m_pending_begin_us, 0x00, sizeof(m_pending_begin_us));
+    memset(&m_current_session, 0x00, sizeof(m_current_session));
+    memset(&m_last_session, 0x00, sizeof(m_last_session));
+}
+
+MiracastSessionTracer::~MiracastSessionTracer()
+{
+}
+
+uint64_t MiracastSessionTracer::get_monotonic_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000ULL) + ((uint64_t)now.tv_nsec / 1000ULL);
+}
+
+/* Must be called with m_tracer_mutex held */
+void MiracastSessionTracer::add_record(MIRACAST_TRACE_SPAN span, TRACE_PHASE phase, uint64_t timestamp_us)
+{
+    if (MIRACAST_TRACER_MAX_RECORDS <= m_current_session.record_count)
+    {
+        m_current_session.dropped_count++;
+        return;
+    }
+    TRACE_RECORD &record = m_current_session.records[m_current_session.record_count++];
+    record.timestamp_us = timestamp_us;
+    record.thread_id = (int)syscall(SYS_gettid);
+    record.span = span;
+    record.phase = phase;
+}
+
+void MiracastSessionTracer::begin_session(const std::string &source_mac)
+{
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    uint64_t now_us = get_monotonic_us();
+
+    if (m_session_active)
+    {
+        return;
+    }
+
+    memset(&m_current_session, 0x00, sizeof(m_current_session));
+    snprintf(m_current_session.source_mac, sizeof(m_current_session.source_mac), "%s", source_mac.c_str());
+    m_current_session.start_us = now_us;
+    m_session_active = true;
+
+    for (int span = 0; span < MIRACAST_SPAN_MAX; ++span)
+    {
+        if (0 != m_pending_begin_us[span])
+        {
+            /* Begins before the session start yield a negative offset */
+            add_record(static_cast<MIRACAST_TRACE_SPAN>(span), TRACE_PHASE_BEGIN, m_pending_begin_us[span]);
+            m_pending_begin_us[span] = 0;
+        }
+    }
+    MIRACASTLOG_VERBOSE("Timeline session started for [%s]", m_current_session.source_mac);
+}
+
+bool MiracastSessionTracer::is_session_active(void)
+{
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    return m_session_active;
+}
+
+void MiracastSessionTracer::span_begin(MIRACAST_TRACE_SPAN span)
+{
+    if (MIRACAST_SPAN_MAX <= span)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    if (m_session_active)
+    {
+        add_record(span, TRACE_PHASE_BEGIN, get_monotonic_us());
+    }
+    else
+    {
+        m_pending_begin_us[span] = get_monotonic_us();
+    }
+}
+
+void MiracastSessionTracer::span_end(MIRACAST_TRACE_SPAN span)
+{
+    if (MIRACAST_SPAN_MAX <= span)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    if (m_session_active)
+    {
+        add_record(span, TRACE_PHASE_END, get_monotonic_us());
+    }
+}
+
+void MiracastSessionTracer::span_mark(MIRACAST_TRACE_SPAN span)
+{
+    if (MIRACAST_SPAN_MAX <= span)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    if (m_session_active)
+    {
+        add_record(span, TRACE_PHASE_INSTANT, get_monotonic_us());
+    }
+}
+
+void MiracastSessionTracer::set_sta_frequency(unsigned int sta_freq_mhz)
+{
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    if (m_session_active)
+    {
+        m_current_session.sta_freq_mhz = sta_freq_mhz;
+    }
+}
+
+void MiracastSessionTracer::set_group_frequency(unsigned int group_freq_mhz)
+{
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    if (m_session_active)
+    {
+        m_current_session.group_freq_mhz = group_freq_mhz;
+    }
+}
+
+void MiracastSessionTracer::set_session_end_handler(SESSION_TRACE_HANDLER handler, void *ctx)
+{
+    std::lock_guard<std::mutex> lock(m_handler_mutex);
+    m_session_end_handler = handler;
+    m_session_end_ctx = ctx;
+}
+
+void MiracastSessionTracer::end_session(bool success)
+{
+    std::string breakdown;
+    std::string export_path;
+    std::string source_mac;
+    TRACE_SESSION *session_copy = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(m_tracer_mutex);
+        if (!m_session_active)
+        {
+            return;
+        }
+        m_current_session.end_us = get_monotonic_us();
+        m_current_session.success = success;
+        memcpy(&m_last_session, &m_current_session, sizeof(m_last_session));
+        m_last_session_valid = true;
+        m_session_active = false;
+        breakdown = build_breakdown(m_last_session);
+        source_mac = m_last_session.source_mac;
+
+        MiracastOptFlags *opt_flags = MiracastOptFlags::getInstance();
+        if (opt_flags->is_present(MIRACAST_OPT_SESSION_TRACE))
+        {
+            export_path = opt_flags->get_string(MIRACAST_OPT_SESSION_TRACE);
+            if (export_path.empty())
+            {
+                export_path = std::string(MIRACAST_TRACER_DFLT_EXPORT_PATH) + "_" + std::to_string(getpid()) + ".json";
+            }
+            session_copy = new (std::nothrow) TRACE_SESSION;
+            if (nullptr != session_copy)
+            {
+                memcpy(session_copy, &m_last_session, sizeof(TRACE_SESSION));
+            }
+        }
+    }
+
+    MIRACASTLOG_INFO("#### MCAST-TIMELINE %s ####", breakdown.c_str());
+
+    if (nullptr != session_copy)
+    {
+        if (write_chrome_trace(*session_copy, export_path))
+        {
+            MIRACASTLOG_INFO("Session timeline exported to [%s]", export_path.c_str());
+        }
+        delete session_copy;
+    }
+
+    std::lock_guard<std::mutex> lock(m_handler_mutex);
+    if (nullptr != m_session_end_handler)
+    {
+        m_session_end_handler(m_session_end_ctx, source_mac, success, breakdown);
+    }
+}
+
+std::string MiracastSessionTracer::build_breakdown(const TRACE_SESSION &session)
+{
+    uint64_t span_begin_us[MIRACAST_SPAN_MAX] = {0};
+    uint64_t span_end_us[MIRACAST_SPAN_MAX] = {0};
+    bool span_seen[MIRACAST_SPAN_MAX] = {false};
+    uint64_t end_us = session.end_us ? session.end_us : get_monotonic_us();
+    char buffer[128];
+    std::string breakdown;
+
+    for (unsigned int index = 0; index < session.record_count; ++index)
+    {
+        const TRACE_RECORD &record = session.records[index];
+
+        if ((TRACE_PHASE_BEGIN == record.phase) || (TRACE_PHASE_INSTANT == record.phase))
+        {
+            if ((!span_seen[record.span]) || (record.timestamp_us < span_begin_us[record.span]))
+            {
+                span_begin_us[record.span] = record.timestamp_us;
+            }
+        }
+        if ((TRACE_PHASE_END == record.phase) || (TRACE_PHASE_INSTANT == record.phase))
+        {
+            if (record.timestamp_us > span_end_us[record.span])
+            {
+                span_end_us[record.span] = record.timestamp_us;
+            }
+        }
+        span_seen[record.span] = true;
+    }
+
+    snprintf(buffer, sizeof(buffer), "{\"source_mac\":\"%s\",\"result\":\"%s\",\"total_ms\":%llu",
+             session.source_mac,
+             session.success ? "OK" : "NOK",
+             (unsigned long long)((end_us - session.start_us) / 1000));
+    breakdown = buffer;
+
+    for (int span = 0; span < MIRACAST_SPAN_MAX; ++span)
+    {
+        if (!span_seen[span])
+        {
+            continue;
+        }
+        if (0 == span_end_us[span])
+        {
+            /* Span never completed within the session */
+            snprintf(buffer, sizeof(buffer), ",\"%s\":{\"offset_ms\":%lld,\"duration_ms\":%llu,\"complete\":false}",
+                     trace_span_names[span],
+                     ((long long)span_begin_us[span] - (long long)session.start_us) / 1000,
+                     (unsigned long long)((end_us - span_begin_us[span]) / 1000));
+        }
+        else
+        {
+            uint64_t begin_us = span_begin_us[span] ? span_begin_us[span] : session.start_us;
+            snprintf(buffer, sizeof(buffer), ",\"%s\":{\"offset_ms\":%lld,\"duration_ms\":%llu}",
+                     trace_span_names[span],
+                     ((long long)begin_us - (long long)session.start_us) / 1000,
+                     (unsigned long long)((span_end_us[span] - begin_us) / 1000));
+        }
+        breakdown.append(buffer);
+    }
+    if (session.sta_freq_mhz || session.group_freq_mhz)
+    {
+        /* mcc: the radio time-slices between the STA and the P2P group channels */
+        snprintf(buffer, sizeof(buffer), ",\"channel\":{\"sta_freq\":%u,\"group_freq\":%u,\"mcc\":%s}",
+                 session.sta_freq_mhz,
+                 session.group_freq_mhz,
+                 (session.sta_freq_mhz && session.group_freq_mhz && (session.sta_freq_mhz != session.group_freq_mhz)) ? "true" : "false");
+        breakdown.append(buffer);
+    }
+    if (session.dropped_count)
+    {
+        snprintf(buffer, sizeof(buffer), ",\"dropped_records\":%u", session.dropped_count);
+        breakdown.append(buffer);
+    }
+    breakdown.append("}");
+    return breakdown;
+}
+
+std::string MiracastSessionTracer::get_session_breakdown(void)
+{
+    std::lock_guard<std::mutex> lock(m_tracer_mutex);
+    if (m_session_active)
+    {
+        return build_breakdown(m_current_session);
+    }
+    if (m_last_session_valid)
+    {
+        return build_breakdown(m_last_session);
+    }
+    return "{}";
+}
+
+bool MiracastSessionTracer::write_chrome_trace(const TRACE_SESSION &session, const std::string &file_name)
+{
+    static const char phase_names[] = {'B', 'E', 'i'};
+    FILE *trace_file = fopen(file_name.c_str(), "w");
+    int process_id = getpid();
+
+    if (nullptr == trace_file)
+    {
+        MIRACASTLOG_ERROR("Unable to open [%s] for timeline export", file_name.c_str());
+        return false;
+    }
+
+    fprintf(trace_file, "{\"traceEvents\":[");
+    fprintf(trace_file, "{\"name\":\"SESSION %s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%d,\"tid\":%d,\"args\":{\"result\":\"%s\"}}",
+            session.source_mac,
+            (unsigned long long)session.start_us,
+            (unsigned long long)(session.end_us - session.start_us),
+            process_id,
+            process_id,
+            session.success ? "OK" : "NOK");
+    for (unsigned int index = 0; index < session.record_count; ++index)
+    {
+        const TRACE_RECORD &record = session.records[index];
+        fprintf(trace_file, ",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":%d,\"tid\":%d%s}",
+                trace_span_names[record.span],
+                phase_names[record.phase],
+                (unsigned long long)record.timestamp_us,
+                process_id,
+                record.thread_id,
+                (TRACE_PHASE_INSTANT == record.phase) ? ",\"s\":\"t\"" : "");
+    }
+    fprintf(trace_file, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(trace_file);
+    return true;
+}
+
+bool MiracastSessionTracer::export_chrome_trace(const std::string &file_name)
+{
+    TRACE_SESSION *session_copy = new (std::nothrow) TRACE_SESSION;
+    bool ret = false;
+
+    if (nullptr == session_copy)
+    {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_tracer_mutex);
+        if (m_session_active)
+        {
+            memcpy(session_copy, &m_current_session, sizeof(TRACE_SESSION));
+            session_copy->end_us = get_monotonic_us();
+            ret = true;
+        }
+        else if (m_last_session_valid)
+        {
+            memcpy(session_copy, &m_last_session, sizeof(TRACE_SESSION));
+            ret = true;
+        }
+    }
+    if (ret)
+    {
+        ret = write_chrome_trace(*session_copy, file_name);
+    }
+    delete session_copy;
+    return ret;
+}
@@ -0,0 +1,140 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_SESSION_TRACER_H_
+#define _MIRACAST_SESSION_TRACER_H_
+
+#include <string>
+#include <mutex>
+#include <stdint.h>
+#include <MiracastLogger.h>
+
+#define MIRACAST_TRACER_MAX_RECORDS         (128)
+#define MIRACAST_TRACER_DFLT_EXPORT_PATH    "/tmp/miracast_session_trace"
+
+typedef enum miracast_trace_span_e
+{
+    MIRACAST_SPAN_P2P_FIND = 0,
+    MIRACAST_SPAN_PROVISION_DISCOVERY,
+    MIRACAST_SPAN_USER_ACCEPT,
+    MIRACAST_SPAN_GO_NEGOTIATION,
+    MIRACAST_SPAN_GROUP_START,
+    MIRACAST_SPAN_DHCP,
+    MIRACAST_SPAN_ARP_VERIFY,
+    MIRACAST_SPAN_TCP_CONNECT,
+    MIRACAST_SPAN_RTSP_M1_M7,
+    MIRACAST_SPAN_PIPELINE_SETUP,
+    MIRACAST_SPAN_FIRST_VIDEO_FRAME,
+    MIRACAST_SPAN_MAX
+}
+MIRACAST_TRACE_SPAN;
+
+/* Called by end_session() outside the tracer lock with the per-phase breakdown as JSON */
+typedef void (*SESSION_TRACE_HANDLER)(void *ctx, const std::string &source_mac, bool success, const std::string &breakdown);
+
+/**
+ * Session setup timeline tracer.
+ * Spans are recorded with CLOCK_MONOTONIC timestamps into a fixed-size
+ * buffer between begin_session() and end_session(). end_session() logs the
+ * per-phase breakdown and, when /opt/miracast_session_trace exists, exports
+ * the timeline as Chrome trace JSON (the flag content overrides the path).
+ * A span begun while no session is open (e.g. P2P find) is carried into the
+ * next session. The STA and P2P group frequencies are kept with the session
+ * so multi-channel concurrency shows up in the breakdown.
+ */
+class MiracastSessionTracer
+{
+public:
+    static MiracastSessionTracer *getInstance();
+    static void destroyInstance();
+
+    void begin_session(const std::string &source_mac);
+    void end_session(bool success);
+    bool is_session_active(void);
+
+    void span_begin(MIRACAST_TRACE_SPAN span);
+    void span_end(MIRACAST_TRACE_SPAN span);
+    void span_mark(MIRACAST_TRACE_SPAN span);
+
+    /* STA frequency the group formation was steered to, 0 when the STA is not associated */
+    void set_sta_frequency(unsigned int sta_freq_mhz);
+    void set_group_frequency(unsigned int group_freq_mhz);
+
+    /* Per-phase durations of the active or last completed session as JSON */
+    std::string get_session_breakdown(void);
+    bool export_chrome_trace(const std::string &file_name);
+    /* Once this returns with nullptr, the previous handler is not running any more */
+    void set_session_end_handler(SESSION_TRACE_HANDLER handler, void *ctx);
+
+private:
+    typedef enum trace_phase_e
+    {
+        TRACE_PHASE_BEGIN = 0,
+        TRACE_PHASE_END,
+        TRACE_PHASE_INSTANT
+    }
+    TRACE_PHASE;
+
+    typedef struct trace_record_st
+    {
+        uint64_t timestamp_us;
+        int thread_id;
+        MIRACAST_TRACE_SPAN span;
+        TRACE_PHASE phase;
+    }
+    TRACE_RECORD;
+
+    typedef struct trace_session_st
+    {
+        char source_mac[24];
+        uint64_t start_us;
+        uint64_t end_us;
+        bool success;
+        unsigned int record_count;
+        unsigned int dropped_count;
+        unsigned int sta_freq_mhz;
+        unsigned int group_freq_mhz;
+        TRACE_RECORD records[MIRACAST_TRACER_MAX_RECORDS];
+    }
+    TRACE_SESSION;
+
+    static MiracastSessionTracer *m_session_tracer_obj;
+    static std::mutex m_instance_mutex;
+    std::mutex m_tracer_mutex;
+    std::mutex m_handler_mutex;
+    bool m_session_active;
+    bool m_last_session_valid;
+    uint64_t m_pending_begin_us[MIRACAST_SPAN_MAX];
+    TRACE_SESSION m_current_session;
+    TRACE_SESSION m_last_session;
+    SESSION_TRACE_HANDLER m_session_end_handler;
+    void *m_session_end_ctx;
+
+    MiracastSessionTracer();
+    virtual ~MiracastSessionTracer();
+    MiracastSessionTracer &operator=(const MiracastSessionTracer &) = delete;
+    MiracastSessionTracer(const MiracastSessionTracer &) = delete;
+
+    static uint64_t get_monotonic_us(void);
+    void add_record(MIRACAST_TRACE_SPAN span, TRACE_PHASE phase, uint64_t timestamp_us);
+    std::string build_breakdown(const TRACE_SESSION &session);
+    bool write_chrome_trace(const TRACE_SESSION &session, const std::string &file_name);
+};
+
+#endif /* _MIRACAST_SESSION_TRACER_H_ */
@@ -0,0 +1,301 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Drives MiracastController through the emulated wpa_supplicant and reports
+ *  - GO-NEG-REQUEST to onMiracastServiceClientConnectionRequest latency
+ *  - DEVICE-FOUND storm throughput up to the same notification
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MiracastController.h"
+#include "WpaSupplicantEmulator.h"
+
+#define BENCH_P2P_IFACE             "p2p0"
+#define BENCH_NOTIFY_TIMEOUT_MS     (5000)
+#define BENCH_STARTUP_TIMEOUT_MS    (10000)
+#define BENCH_DFLT_ITERATIONS       (200)
+#define BENCH_DFLT_STORM_EVENTS     (2000)
+
+typedef std::chrono::steady_clock bench_clock;
+
+class BenchNotifier : public MiracastServiceNotifier
+{
+public:
+    BenchNotifier() : m_requests(0) {}
+
+    virtual void onMiracastServiceClientConnectionRequest(string client_mac, string client_name) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_last_request = bench_clock::now();
+        m_last_mac = client_mac;
+        m_requests++;
+        m_condition.notify_all();
+    }
+    virtual void onMiracastServiceClientConnectionAccepted(string client_mac, string client_name) override {}
+    virtual void onMiracastServiceClientConnectionError(string client_mac, string client_name, MiracastServiceReasonCode reason_code) override {}
+    virtual void onMiracastServiceLaunchRequest(string src_dev_ip, string src_dev_mac, string src_dev_name, string sink_dev_ip, bool is_connect_req_reported) override {}
+    virtual void onMiracastServiceLaunchCancel(string src_dev_mac, string src_dev_name, MiracastServiceReasonCode reason_code) override {}
+    virtual void onStateChange(eMIRA_SERVICE_STATES state) override {}
+
+    /* Waits for the request count to reach expected, returns the time of the last one */
+    bool wait_for_request(unsigned int expected, const std::string &mac, bench_clock::time_point &notified_at)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_condition.wait_for(lock,
+                                  std::chrono::milliseconds(BENCH_NOTIFY_TIMEOUT_MS),
+                                  [&]{ return (expected <= m_requests); }))
+        {
+            return false;
+        }
+        notified_at = m_last_request;
+        return (mac == m_last_mac);
+    }
+    unsigned int get_requests(void)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_requests;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bench_clock::time_point m_last_request;
+    std::string m_last_mac;
+    unsigned int m_requests;
+};
+
+static std::string bench_mac(unsigned int prefix, unsigned int index)
+{
+    char mac[18] = {0};
+    snprintf(mac, sizeof(mac), "02:%02x:00:%02x:%02x:%02x",
+             prefix & 0xFF, (index >> 16) & 0xFF, (index >> 8) & 0xFF, index & 0xFF);
+    return mac;
+}
+
+static std::string device_found_event(const std::string &mac, unsigned int index)
+{
+    return "P2P-DEVICE-FOUND " + mac + " p2p_dev_addr=" + mac +
+           " pri_dev_type=10-0050F204-5 name='Bench-" + std::to_string(index) +
+           "' config_methods=0x188 dev_capab=0x25 group_capab=0x0 wfd_dev_info=0x01111c440032";
+}
+
+static std::string go_neg_request_event(const std::string &mac)
+{
+    return "P2P-GO-NEG-REQUEST " + mac + " dev_passwd_id=4 go_intent=13";
+}
+
+static double to_usec(bench_clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(duration).count();
+}
+
+static double percentile(const std::vector<double> &sorted, double ratio)
+{
+    size_t index = static_cast<size_t>(ratio * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void report_latency(const std::vector<double> &samples, unsigned int timeouts)
+{
+    std::vector<double> sorted = samples;
+    double total = 0;
+
+    printf("event-to-notification latency: samples[%zu] timeouts[%u]\n", samples.size(), timeouts);
+    if (sorted.empty())
+    {
+        return;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    for (double sample : sorted)
+    {
+        total += sample;
+    }
+    printf("  min %.1f us  avg %.1f us  p50 %.1f us  p95 %.1f us  p99 %.1f us  max %.1f us\n",
+           sorted.front(),
+           total / sorted.size(),
+           percentile(sorted, 0.50),
+           percentile(sorted, 0.95),
+           percentile(sorted, 0.99),
+           sorted.back());
+}
+
+static void run_latency(MiracastController *controller, WpaSupplicantEmulator &emulator,
+                        BenchNotifier &notifier, unsigned int iterations, bool report = true)
+{
+    std::vector<double> samples;
+    unsigned int timeouts = 0;
+
+    samples.reserve(iterations);
+    for (unsigned int index = 0; index < iterations; ++index)
+    {
+        std::string mac = bench_mac(0x10, index);
+        unsigned int expected = notifier.get_requests() + 1;
+        bench_clock::time_point notified_at;
+        bench_clock::time_point sent_at = bench_clock::now();
+
+        emulator.send_event(go_neg_request_event(mac));
+        if (notifier.wait_for_request(expected, mac, notified_at))
+        {
+            samples.push_back(to_usec(notified_at - sent_at));
+        }
+        else
+        {
+            timeouts++;
+        }
+        /* Rejecting clears the pending request so the next one is reported again */
+        controller->accept_client_connection("Reject");
+    }
+    if (report)
+    {
+        report_latency(samples, timeouts);
+    }
+}
+
+static void run_storm(MiracastController *controller, WpaSupplicantEmulator &emulator,
+                      BenchNotifier &notifier, unsigned int storm_events, unsigned int interval_us)
+{
+    std::string sentinel_mac = bench_mac(0x30, 0);
+    uint64_t dropped_before = emulator.get_dropped_events();
+    unsigned int expected = notifier.get_requests() + 1;
+    bench_clock::time_point notified_at;
+    bench_clock::time_point start_time = bench_clock::now();
+
+    for (unsigned int index = 0; index < storm_events; ++index)
+    {
+        emulator.send_event(device_found_event(bench_mac(0x20, index), index));
+        if (0 < interval_us)
+        {
+            usleep(interval_us);
+        }
+    }
+    bench_clock::time_point sent_time = bench_clock::now();
+
+    /* The controller handles events in order, the sentinel marks the end of the storm */
+    emulator.send_event(go_neg_request_event(sentinel_mac));
+    bool completed = notifier.wait_for_request(expected, sentinel_mac, notified_at);
+    controller->accept_client_connection("Reject");
+
+    printf("DEVICE-FOUND storm: events[%u] dropped[%llu] peers[%zu]\n",
+           storm_events,
+           static_cast<unsigned long long>(emulator.get_dropped_events() - dropped_before),
+           controller->get_allPeers().size());
+    if (!completed)
+    {
+        printf("  sentinel not reported within %u ms\n", BENCH_NOTIFY_TIMEOUT_MS);
+        return;
+    }
+    double send_usec = to_usec(sent_time - start_time);
+    double total_usec = to_usec(notified_at - start_time);
+    printf("  injected in %.1f ms, drained in %.1f ms, %.0f events/s\n",
+           send_usec / 1000,
+           total_usec / 1000,
+           (storm_events + 1) / (total_usec / 1000000));
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [--iterations <count>] [--storm <events>] [--interval-us <usec>] [--loglevel <0..5>]\n",
+            program);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int iterations = BENCH_DFLT_ITERATIONS;
+    unsigned int storm_events = BENCH_DFLT_STORM_EVENTS;
+    unsigned int interval_us = 0;
+    int log_level = ERROR_LEVEL;
+    MiracastError error_code = MIRACAST_OK;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if ((0 == strcmp(argv[index], "--iterations")) && (index + 1 < argc))
+        {
+            iterations = static_cast<unsigned int>(strtoul(argv[++index], nullptr, 10));
+        }
+        else if ((0 == strcmp(argv[index], "--storm")) && (index + 1 < argc))
+        {
+            storm_events = static_cast<unsigned int>(strtoul(argv[++index], nullptr, 10));
+        }
+        else if ((0 == strcmp(argv[index], "--interval-us")) && (index + 1 < argc))
+        {
+            interval_us = static_cast<unsigned int>(strtoul(argv[++index], nullptr, 10));
+        }
+        else if ((0 == strcmp(argv[index], "--loglevel")) && (index + 1 < argc))
+        {
+            log_level = atoi(argv[++index]);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    MIRACAST::logger_init("MiracastP2PBench");
+    MIRACAST::set_loglevel(static_cast<LogLevel>(log_level));
+
+    mkdir(WPA_SUP_DFLT_CTRL_PATH, 0755);
+    WpaSupplicantEmulator emulator(std::string(WPA_SUP_DFLT_CTRL_PATH) + BENCH_P2P_IFACE);
+    if (!emulator.start())
+    {
+        return 1;
+    }
+
+    BenchNotifier notifier;
+    MiracastController *controller = MiracastController::getInstance(error_code, &notifier, BENCH_P2P_IFACE);
+    if ((nullptr == controller) || (MIRACAST_OK != error_code))
+    {
+        fprintf(stderr, "MiracastController creation failed [%d]\n", error_code);
+        emulator.stop();
+        return 1;
+    }
+    if (!emulator.wait_for_monitor(BENCH_STARTUP_TIMEOUT_MS))
+    {
+        fprintf(stderr, "Controller never attached to [%s]\n", WPA_SUP_DFLT_CTRL_PATH BENCH_P2P_IFACE);
+        MiracastController::destroyInstance();
+        emulator.stop();
+        return 1;
+    }
+    controller->set_enable(true);
+    if (!emulator.wait_for_command("P2P_FIND", 1, BENCH_STARTUP_TIMEOUT_MS))
+    {
+        fprintf(stderr, "Controller never started discovery\n");
+    }
+
+    /* Untimed round trip, the first request also waits for the controller thread to start */
+    run_latency(controller, emulator, notifier, 1, false);
+    run_latency(controller, emulator, notifier, iterations);
+    run_storm(controller, emulator, notifier, storm_events, interval_us);
+
+    MiracastController::destroyInstance();
+    emulator.stop();
+    MIRACAST::logger_deinit();
+    return 0;
+}
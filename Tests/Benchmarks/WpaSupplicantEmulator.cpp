@@ -0,0 +1,390 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "WpaSupplicantEmulator.h"
+
+#define WPA_EMULATOR_WAIT_DIRECTIVE "@wait"
+
+static bool same_address(const struct sockaddr_un &left, const struct sockaddr_un &right)
+{
+    return (0 == strncmp(left.sun_path, right.sun_path, sizeof(left.sun_path)));
+}
+
+static bool has_prefix(const std::string &value, const std::string &prefix)
+{
+    return (0 == value.compare(0, prefix.size(), prefix));
+}
+
+WpaSupplicantEmulator::WpaSupplicantEmulator(const std::string &ctrl_path)
+    : m_ctrl_path(ctrl_path),
+      m_sock_fd(-1),
+      m_stop_fd(-1),
+      m_server_thread_id(0),
+      m_sent_events(0),
+      m_dropped_events(0)
+{
+    m_replies["PING"] = "PONG\n";
+    m_replies["STATUS"] = "wpa_state=DISCONNECTED\n";
+    m_replies["LIST_NETWORKS"] = "network id / ssid / bssid / flags\n";
+}
+
+WpaSupplicantEmulator::~WpaSupplicantEmulator()
+{
+    stop();
+}
+
+bool WpaSupplicantEmulator::start(void)
+{
+    struct sockaddr_un addr;
+
+    if (0 != m_server_thread_id)
+    {
+        return true;
+    }
+    if (sizeof(addr.sun_path) <= m_ctrl_path.size())
+    {
+        fprintf(stderr, "emulator: control path [%s] is too long\n", m_ctrl_path.c_str());
+        return false;
+    }
+
+    m_sock_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (0 > m_sock_fd)
+    {
+        fprintf(stderr, "emulator: socket failed (%s)\n", strerror(errno));
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, m_ctrl_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(m_ctrl_path.c_str());
+
+    if (0 != bind(m_sock_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)))
+    {
+        fprintf(stderr, "emulator: bind to [%s] failed (%s)\n", m_ctrl_path.c_str(), strerror(errno));
+        close(m_sock_fd);
+        m_sock_fd = -1;
+        return false;
+    }
+
+    m_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((0 > m_stop_fd) ||
+        (0 != pthread_create(&m_server_thread_id, nullptr, WpaSupplicantEmulator::server_thread, this)))
+    {
+        fprintf(stderr, "emulator: unable to start the server thread\n");
+        m_server_thread_id = 0;
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void WpaSupplicantEmulator::stop(void)
+{
+    if (0 != m_server_thread_id)
+    {
+        uint64_t value = 1;
+        if (sizeof(value) != write(m_stop_fd, &value, sizeof(value)))
+        {
+            fprintf(stderr, "emulator: unable to signal the server thread\n");
+        }
+        pthread_join(m_server_thread_id, nullptr);
+        m_server_thread_id = 0;
+    }
+    if (0 <= m_stop_fd)
+    {
+        close(m_stop_fd);
+        m_stop_fd = -1;
+    }
+    if (0 <= m_sock_fd)
+    {
+        close(m_sock_fd);
+        m_sock_fd = -1;
+        unlink(m_ctrl_path.c_str());
+    }
+    std::lock_guard<std::mutex> lock(m_state_mutex);
+    m_monitors.clear();
+}
+
+void WpaSupplicantEmulator::set_reply(const std::string &command_prefix, const std::string &reply)
+{
+    std::lock_guard<std::mutex> lock(m_state_mutex);
+    m_replies[command_prefix] = reply;
+}
+
+bool WpaSupplicantEmulator::wait_for_monitor(unsigned int timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(m_state_mutex);
+    return m_state_condition.wait_for(lock,
+                                      std::chrono::milliseconds(timeout_ms),
+                                      [this]{ return !m_monitors.empty(); });
+}
+
+unsigned int WpaSupplicantEmulator::count_commands_locked(const std::string &command_prefix)
+{
+    unsigned int count = 0;
+
+    for (const std::string &command : m_commands)
+    {
+        if (has_prefix(command, command_prefix))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+unsigned int WpaSupplicantEmulator::get_command_count(const std::string &command_prefix)
+{
+    std::lock_guard<std::mutex> lock(m_state_mutex);
+    return count_commands_locked(command_prefix);
+}
+
+bool WpaSupplicantEmulator::wait_for_command(const std::string &command_prefix, unsigned int count, unsigned int timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(m_state_mutex);
+    return m_state_condition.wait_for(lock,
+                                      std::chrono::milliseconds(timeout_ms),
+                                      [&]{ return (count <= count_commands_locked(command_prefix)); });
+}
+
+bool WpaSupplicantEmulator::send_event(const std::string &event)
+{
+    std::string message = WPA_EMULATOR_EVENT_PRIORITY + event;
+    std::vector<struct sockaddr_un> monitors;
+    bool delivered = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_state_mutex);
+        monitors = m_monitors;
+    }
+    if (monitors.empty())
+    {
+        m_dropped_events++;
+        return false;
+    }
+    for (const struct sockaddr_un &monitor : monitors)
+    {
+        /* A full monitor queue means the controller fell behind, count it rather than block the storm */
+        if (0 > sendto(m_sock_fd, message.c_str(), message.size(), MSG_DONTWAIT,
+                       reinterpret_cast<const struct sockaddr *>(&monitor), sizeof(monitor)))
+        {
+            m_dropped_events++;
+            delivered = false;
+        }
+        else
+        {
+            m_sent_events++;
+        }
+    }
+    return delivered;
+}
+
+std::string WpaSupplicantEmulator::handle_request(const std::string &command, const struct sockaddr_un &from, socklen_t from_len)
+{
+    std::lock_guard<std::mutex> lock(m_state_mutex);
+    std::string reply = WPA_EMULATOR_DFLT_REPLY;
+    size_t matched_len = 0;
+
+    m_commands.push_back(command);
+
+    if ("ATTACH" == command)
+    {
+        struct sockaddr_un monitor;
+        memset(&monitor, 0, sizeof(monitor));
+        memcpy(&monitor, &from, std::min(static_cast<size_t>(from_len), sizeof(monitor)));
+        m_monitors.push_back(monitor);
+    }
+    else if ("DETACH" == command)
+    {
+        for (std::vector<struct sockaddr_un>::iterator it = m_monitors.begin(); it != m_monitors.end(); ++it)
+        {
+            if (same_address(*it, from))
+            {
+                m_monitors.erase(it);
+                break;
+            }
+        }
+    }
+    else
+    {
+        for (const std::pair<const std::string, std::string> &entry : m_replies)
+        {
+            if ((matched_len < entry.first.size()) && has_prefix(command, entry.first))
+            {
+                matched_len = entry.first.size();
+                reply = entry.second;
+            }
+        }
+    }
+    m_state_condition.notify_all();
+    return reply;
+}
+
+void *WpaSupplicantEmulator::server_thread(void *ctx)
+{
+    WpaSupplicantEmulator *emulator = static_cast<WpaSupplicantEmulator *>(ctx);
+    emulator->server_loop();
+    return nullptr;
+}
+
+void WpaSupplicantEmulator::server_loop(void)
+{
+    char buffer[WPA_EMULATOR_MAX_MSG_SIZE];
+    struct pollfd fds[2];
+
+    fds[0].fd = m_sock_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_stop_fd;
+    fds[1].events = POLLIN;
+
+    while (true)
+    {
+        if (0 > poll(fds, 2, -1))
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            fprintf(stderr, "emulator: poll failed (%s)\n", strerror(errno));
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            break;
+        }
+        if (0 == (fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        struct sockaddr_un from;
+        socklen_t from_len = sizeof(from);
+        memset(&from, 0, sizeof(from));
+        ssize_t len = recvfrom(m_sock_fd, buffer, sizeof(buffer) - 1, 0,
+                               reinterpret_cast<struct sockaddr *>(&from), &from_len);
+        if (0 >= len)
+        {
+            continue;
+        }
+        buffer[len] = '\0';
+
+        std::string reply = handle_request(buffer, from, from_len);
+        if (0 > sendto(m_sock_fd, reply.c_str(), reply.size(), MSG_DONTWAIT,
+                       reinterpret_cast<struct sockaddr *>(&from), from_len))
+        {
+            fprintf(stderr, "emulator: reply to [%s] failed (%s)\n", buffer, strerror(errno));
+        }
+    }
+}
+
+bool WpaSupplicantEmulator::load_script(const std::string &file_name, std::vector<WPA_EMULATOR_STEP> &steps)
+{
+    std::ifstream script(file_name.c_str());
+    std::string line;
+    unsigned int line_number = 0;
+
+    if (!script.is_open())
+    {
+        fprintf(stderr, "emulator: unable to open script [%s]\n", file_name.c_str());
+        return false;
+    }
+    while (std::getline(script, line))
+    {
+        line_number++;
+        size_t start = line.find_first_not_of(" \t");
+        if ((std::string::npos == start) || ('#' == line[start]))
+        {
+            continue;
+        }
+
+        char *text = nullptr;
+        unsigned long delay_ms = strtoul(line.c_str() + start, &text, 10);
+        if ((line.c_str() + start) == text)
+        {
+            fprintf(stderr, "emulator: %s:%u: missing delay\n", file_name.c_str(), line_number);
+            return false;
+        }
+
+        std::string payload(text);
+        payload.erase(0, payload.find_first_not_of(" \t"));
+        payload.erase(payload.find_last_not_of(" \t\r") + 1);
+
+        WPA_EMULATOR_STEP step;
+        step.delay_ms = static_cast<unsigned int>(delay_ms);
+        if (has_prefix(payload, WPA_EMULATOR_WAIT_DIRECTIVE))
+        {
+            step.type = WPA_EMULATOR_STEP_WAIT_COMMAND;
+            step.text = payload.substr(strlen(WPA_EMULATOR_WAIT_DIRECTIVE));
+            step.text.erase(0, step.text.find_first_not_of(" \t"));
+        }
+        else
+        {
+            step.type = WPA_EMULATOR_STEP_EVENT;
+            step.text = payload;
+        }
+        if (step.text.empty())
+        {
+            fprintf(stderr, "emulator: %s:%u: empty step\n", file_name.c_str(), line_number);
+            return false;
+        }
+        steps.push_back(std::move(step));
+    }
+    return true;
+}
+
+size_t WpaSupplicantEmulator::play_script(const std::vector<WPA_EMULATOR_STEP> &steps, unsigned int wait_timeout_ms)
+{
+    size_t completed = 0;
+    /* Commands already matched by earlier waits, a command sent before its wait step still counts */
+    std::map<std::string, unsigned int> consumed;
+
+    for (const WPA_EMULATOR_STEP &step : steps)
+    {
+        if (0 < step.delay_ms)
+        {
+            usleep(step.delay_ms * 1000);
+        }
+        if (WPA_EMULATOR_STEP_WAIT_COMMAND == step.type)
+        {
+            unsigned int expected = ++consumed[step.text];
+            if (!wait_for_command(step.text, expected, wait_timeout_ms))
+            {
+                fprintf(stderr, "emulator: [%s] not received within %u ms\n", step.text.c_str(), wait_timeout_ms);
+                break;
+            }
+        }
+        else if (!send_event(step.text))
+        {
+            fprintf(stderr, "emulator: event [%s] not delivered\n", step.text.c_str());
+        }
+        completed++;
+    }
+    return completed;
+}
@@ -0,0 +1,109 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _WPA_SUPPLICANT_EMULATOR_H_
+#define _WPA_SUPPLICANT_EMULATOR_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define WPA_EMULATOR_MAX_MSG_SIZE       (4096)
+#define WPA_EMULATOR_EVENT_PRIORITY     "<3>"
+#define WPA_EMULATOR_DFLT_REPLY         "OK\n"
+
+typedef enum wpa_emulator_step_type_e
+{
+    WPA_EMULATOR_STEP_EVENT = 0x01,
+    /* Blocks the script until the controller has sent the given command */
+    WPA_EMULATOR_STEP_WAIT_COMMAND
+}
+WPA_EMULATOR_STEP_TYPE;
+
+typedef struct wpa_emulator_step_st
+{
+    WPA_EMULATOR_STEP_TYPE type;
+    unsigned int delay_ms;
+    std::string text;
+}
+WPA_EMULATOR_STEP;
+
+/**
+ * Minimal stand-in for the wpa_supplicant control interface. It binds a Unix
+ * datagram socket at the control path so the unmodified wpa_ctrl client can
+ * open, attach and send requests to it, answers requests from a prefix table
+ * and pushes unsolicited events to every attached monitor.
+ *
+ * Scripts hold one step per line, '#' starts a comment:
+ *     <delay_ms> <event text>             sends the event after delay_ms
+ *     <delay_ms> @wait <command prefix>   waits for the controller to send it
+ */
+class WpaSupplicantEmulator
+{
+public:
+    WpaSupplicantEmulator(const std::string &ctrl_path);
+    ~WpaSupplicantEmulator();
+
+    bool start(void);
+    void stop(void);
+
+    /* The longest matching prefix wins, anything unmatched is answered with "OK" */
+    void set_reply(const std::string &command_prefix, const std::string &reply);
+    bool wait_for_monitor(unsigned int timeout_ms);
+    bool wait_for_command(const std::string &command_prefix, unsigned int count, unsigned int timeout_ms);
+    unsigned int get_command_count(const std::string &command_prefix);
+
+    /* Returns false when the event could not be queued to every monitor */
+    bool send_event(const std::string &event);
+    uint64_t get_sent_events(void) const { return m_sent_events; }
+    uint64_t get_dropped_events(void) const { return m_dropped_events; }
+
+    static bool load_script(const std::string &file_name, std::vector<WPA_EMULATOR_STEP> &steps);
+    /* Returns the number of steps completed */
+    size_t play_script(const std::vector<WPA_EMULATOR_STEP> &steps, unsigned int wait_timeout_ms);
+
+private:
+    std::string m_ctrl_path;
+    int m_sock_fd;
+    int m_stop_fd;
+    pthread_t m_server_thread_id;
+
+    std::mutex m_state_mutex;
+    std::condition_variable m_state_condition;
+    std::vector<struct sockaddr_un> m_monitors;
+    std::map<std::string, std::string> m_replies;
+    std::vector<std::string> m_commands;
+
+    std::atomic<uint64_t> m_sent_events;
+    std::atomic<uint64_t> m_dropped_events;
+
+    static void *server_thread(void *ctx);
+    void server_loop(void);
+    std::string handle_request(const std::string &command, const struct sockaddr_un &from, socklen_t from_len);
+    unsigned int count_commands_locked(const std::string &command_prefix);
+};
+
+#endif /* _WPA_SUPPLICANT_EMULATOR_H_ */
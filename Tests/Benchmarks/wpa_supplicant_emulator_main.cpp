@@ -0,0 +1,112 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Replays a scenario script against whatever process opens the emulated
+ * control interface, e.g. a MiracastService built with
+ * -DWPA_SUP_DFLT_CTRL_PATH=\"/tmp/miracast_bench/\".
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "WpaSupplicantEmulator.h"
+
+#define EMULATOR_DFLT_CTRL_PATH     "/tmp/miracast_bench/p2p0"
+#define EMULATOR_ATTACH_TIMEOUT_MS  (60000)
+#define EMULATOR_WAIT_TIMEOUT_MS    (30000)
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s --script <file> [--ctrl-path <path>] [--repeat <count>]\n"
+            "  default control path is %s\n",
+            program, EMULATOR_DFLT_CTRL_PATH);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string ctrl_path = EMULATOR_DFLT_CTRL_PATH;
+    std::string script_file;
+    unsigned int repeat = 1;
+    std::vector<WPA_EMULATOR_STEP> steps;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if ((0 == strcmp(argv[index], "--ctrl-path")) && (index + 1 < argc))
+        {
+            ctrl_path = argv[++index];
+        }
+        else if ((0 == strcmp(argv[index], "--script")) && (index + 1 < argc))
+        {
+            script_file = argv[++index];
+        }
+        else if ((0 == strcmp(argv[index], "--repeat")) && (index + 1 < argc))
+        {
+            repeat = static_cast<unsigned int>(strtoul(argv[++index], nullptr, 10));
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (script_file.empty() || !WpaSupplicantEmulator::load_script(script_file, steps))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string ctrl_dir = ctrl_path.substr(0, ctrl_path.find_last_of('/'));
+    if (!ctrl_dir.empty())
+    {
+        mkdir(ctrl_dir.c_str(), 0755);
+    }
+
+    WpaSupplicantEmulator emulator(ctrl_path);
+    if (!emulator.start())
+    {
+        return 1;
+    }
+
+    printf("Waiting for a monitor on [%s]...\n", ctrl_path.c_str());
+    if (!emulator.wait_for_monitor(EMULATOR_ATTACH_TIMEOUT_MS))
+    {
+        fprintf(stderr, "No client attached within %u ms\n", EMULATOR_ATTACH_TIMEOUT_MS);
+        return 1;
+    }
+
+    for (unsigned int round = 0; round < repeat; ++round)
+    {
+        size_t completed = emulator.play_script(steps, EMULATOR_WAIT_TIMEOUT_MS);
+        printf("Round %u: %zu/%zu steps\n", round + 1, completed, steps.size());
+        if (completed != steps.size())
+        {
+            break;
+        }
+    }
+    printf("Events sent[%llu] dropped[%llu]\n",
+           static_cast<unsigned long long>(emulator.get_sent_events()),
+           static_cast<unsigned long long>(emulator.get_dropped_events()));
+    emulator.stop();
+    return 0;
+}
@@ -0,0 +1,138 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <chrono>
+
+#include "MiracastControllerFSM.h"
+
+/* Guards and handlers are controller members, they are covered by the MiracastService tests */
+namespace
+{
+    const CONTROLLER_FSM_STATE testStates[CONTROLLER_SESSION_STATE_MAX] =
+    {
+        { "IDLE",               false,  false },
+        { "LISTENING",          true,   false },
+        { "CONNECT_REQUESTED",  true,   false },
+        { "CONNECTING",         true,   false },
+        { "GROUP_FORMING",      true,   false },
+        { "CONNECTED",          false,  true  }
+    };
+
+    const CONTROLLER_FSM_TRANSITION testTransitions[] =
+    {
+        { CONTROLLER_START_DISCOVERING, CONTROLLER_SESSION_ANY_MASK, nullptr, nullptr, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING },
+        { CONTROLLER_GO_NEG_SUCCESS, CONTROLLER_SESSION_MASK(CONTROLLER_SESSION_LISTENING) | CONTROLLER_SESSION_MASK(CONTROLLER_SESSION_CONNECTING),
+            nullptr, nullptr, CONTROLLER_SESSION_GROUP_FORMING, CONTROLLER_SESSION_SAME },
+        /* Shadowed by the entry above in LISTENING and CONNECTING */
+        { CONTROLLER_GO_NEG_SUCCESS, CONTROLLER_SESSION_ANY_MASK, nullptr, nullptr, CONTROLLER_SESSION_SAME, CONTROLLER_SESSION_SAME },
+        { CONTROLLER_GO_GROUP_STARTED, CONTROLLER_SESSION_MASK(CONTROLLER_SESSION_GROUP_FORMING),
+            nullptr, nullptr, CONTROLLER_SESSION_CONNECTED, CONTROLLER_SESSION_IDLE },
+        { CONTROLLER_GO_GROUP_REMOVED, CONTROLLER_SESSION_ANY_MASK, nullptr, nullptr, CONTROLLER_SESSION_LISTENING, CONTROLLER_SESSION_LISTENING }
+    };
+
+    const size_t testTransitionCount = sizeof(testTransitions) / sizeof(testTransitions[0]);
+
+    bool dispatchAction(MiracastControllerFSM &fsm, eCONTROLLER_FW_STATES action)
+    {
+        CONTROLLER_MSGQ_STRUCT message = {0};
+        CONTROLLER_FSM_EVENT event = { &message, nullptr, nullptr };
+
+        message.state = action;
+        return fsm.dispatch(nullptr, event);
+    }
+}
+
+TEST(MiracastControllerFSMTest, StartsIdle)
+{
+    MiracastControllerFSM fsm(testStates, testTransitions, testTransitionCount);
+
+    EXPECT_EQ(CONTROLLER_SESSION_IDLE, fsm.get_State());
+    EXPECT_STREQ("IDLE", fsm.get_StateInfo().name);
+    EXPECT_EQ(1u, fsm.get_StateMetrics(CONTROLLER_SESSION_IDLE).entries);
+    EXPECT_EQ(0u, fsm.get_InvalidCount());
+    EXPECT_STREQ("SAME", fsm.get_StateName(CONTROLLER_SESSION_SAME));
+}
+
+TEST(MiracastControllerFSMTest, FollowsTheFirstMatchingTransition)
+{
+    MiracastControllerFSM fsm(testStates, testTransitions, testTransitionCount);
+
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_START_DISCOVERING));
+    EXPECT_EQ(CONTROLLER_SESSION_LISTENING, fsm.get_State());
+
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_GO_NEG_SUCCESS));
+    EXPECT_EQ(CONTROLLER_SESSION_GROUP_FORMING, fsm.get_State());
+    EXPECT_EQ(1u, fsm.get_TransitionCount(1));
+    EXPECT_EQ(0u, fsm.get_TransitionCount(2));
+
+    /* Not in LISTENING/CONNECTING any more, the catch-all keeps the state */
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_GO_NEG_SUCCESS));
+    EXPECT_EQ(CONTROLLER_SESSION_GROUP_FORMING, fsm.get_State());
+    EXPECT_EQ(1u, fsm.get_TransitionCount(2));
+
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_GO_GROUP_STARTED));
+    EXPECT_EQ(CONTROLLER_SESSION_CONNECTED, fsm.get_State());
+    EXPECT_TRUE(fsm.get_StateInfo().group_alive);
+
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_GO_GROUP_REMOVED));
+    EXPECT_EQ(CONTROLLER_SESSION_LISTENING, fsm.get_State());
+    EXPECT_EQ(2u, fsm.get_StateMetrics(CONTROLLER_SESSION_LISTENING).entries);
+    EXPECT_EQ(0u, fsm.get_InvalidCount());
+}
+
+TEST(MiracastControllerFSMTest, InvalidActionsAreCountedAndIgnored)
+{
+    MiracastControllerFSM fsm(testStates, testTransitions, testTransitionCount);
+
+    /* GROUP_STARTED is only accepted in GROUP_FORMING */
+    EXPECT_FALSE(dispatchAction(fsm, CONTROLLER_GO_GROUP_STARTED));
+    EXPECT_EQ(CONTROLLER_SESSION_IDLE, fsm.get_State());
+
+    EXPECT_FALSE(dispatchAction(fsm, CONTROLLER_GO_DEVICE_FOUND));
+    EXPECT_FALSE(dispatchAction(fsm, CONTROLLER_INVALID_STATE));
+    EXPECT_EQ(CONTROLLER_SESSION_IDLE, fsm.get_State());
+    EXPECT_EQ(3u, fsm.get_InvalidCount());
+    EXPECT_EQ(1u, fsm.get_StateMetrics(CONTROLLER_SESSION_IDLE).entries);
+    EXPECT_EQ(0u, fsm.get_TransitionCount(testTransitionCount));
+}
+
+TEST(MiracastControllerFSMTest, SelfTransitionKeepsTheDwellTime)
+{
+    MiracastControllerFSM fsm(testStates, testTransitions, testTransitionCount);
+
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_START_DISCOVERING));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    /* Same state, not re-entered */
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_START_DISCOVERING));
+    EXPECT_EQ(1u, fsm.get_StateMetrics(CONTROLLER_SESSION_LISTENING).entries);
+    EXPECT_EQ(2u, fsm.get_TransitionCount(0));
+
+    CONTROLLER_FSM_STATE_METRICS metrics = fsm.get_StateMetrics(CONTROLLER_SESSION_LISTENING);
+    EXPECT_GE(metrics.total_dwell_us, 20000u);
+    EXPECT_GE(metrics.max_dwell_us, 20000u);
+
+    EXPECT_TRUE(dispatchAction(fsm, CONTROLLER_GO_NEG_SUCCESS));
+    metrics = fsm.get_StateMetrics(CONTROLLER_SESSION_LISTENING);
+    EXPECT_GE(metrics.total_dwell_us, 20000u);
+    EXPECT_EQ(metrics.total_dwell_us, fsm.get_StateMetrics(CONTROLLER_SESSION_LISTENING).total_dwell_us);
+}
@@ -0,0 +1,362 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "MiracastDHCPCommon.h"
+#include "MiracastDHCPClient.h"
+
+namespace
+{
+    const uint8_t testHwAddr[DHCP_HW_ADDR_LEN] = { 0x96, 0x52, 0x44, 0xb6, 0xfd, 0x14 };
+
+    uint32_t toAddr(const char *ip_address)
+    {
+        uint32_t addr = 0;
+        inet_pton(AF_INET, ip_address, &addr);
+        return addr;
+    }
+
+    /* Builds the IPv4/UDP frame an AF_PACKET SOCK_DGRAM socket would deliver */
+    size_t buildFrame(const DHCP_PACKET &packet, uint16_t dst_port, DHCP_IP_PACKET &frame)
+    {
+        size_t dhcp_len = MiracastDHCPCommon::get_packet_length(packet);
+
+        memset(&frame, 0, sizeof(frame));
+        frame.ip.version = 4;
+        frame.ip.ihl = sizeof(frame.ip) >> 2;
+        frame.ip.protocol = IPPROTO_UDP;
+        frame.udp.source = htons(DHCP_SERVER_PORT);
+        frame.udp.dest = htons(dst_port);
+        frame.udp.len = htons(static_cast<uint16_t>(sizeof(frame.udp) + dhcp_len));
+        memcpy(&frame.dhcp, &packet, dhcp_len);
+        return sizeof(frame.ip) + sizeof(frame.udp) + dhcp_len;
+    }
+
+    /* The test plays the GO on the other end of a socketpair */
+    struct FakeGroupOwner
+    {
+        int clientFd = -1;
+        int serverFd = -1;
+        uint32_t configuredIp = 0;
+        uint8_t configuredPrefix = 0;
+        uint32_t removedIp = 0;
+    };
+    FakeGroupOwner fakeGO;
+
+    int fakeOpenSocket(int ifindex)
+    {
+        return dup(fakeGO.clientFd);
+    }
+
+    bool fakeSend(int sock_fd, int ifindex,
+                  uint32_t src_ip, uint16_t src_port,
+                  uint32_t dst_ip, uint16_t dst_port,
+                  const uint8_t *dst_hw_addr,
+                  const DHCP_PACKET &packet)
+    {
+        size_t len = MiracastDHCPCommon::get_packet_length(packet);
+        return (static_cast<ssize_t>(len) == write(sock_fd, &packet, len));
+    }
+
+    bool fakeSetAddress(int ifindex, uint32_t ip_address, uint8_t prefix_len)
+    {
+        fakeGO.configuredIp = ip_address;
+        fakeGO.configuredPrefix = prefix_len;
+        return true;
+    }
+
+    bool fakeRemoveAddress(int ifindex, uint32_t ip_address, uint8_t prefix_len)
+    {
+        fakeGO.removedIp = ip_address;
+        return true;
+    }
+
+    const DHCP_CLIENT_IO_OPS fakeIOOps =
+    {
+        &fakeOpenSocket,
+        &fakeSend,
+        &MiracastDHCPCommon::recv_raw,
+        &fakeSetAddress,
+        &fakeRemoveAddress
+    };
+
+    /* Skips retransmits of earlier messages until one of the expected type arrives */
+    bool receiveRequest(uint8_t expected_type, DHCP_PACKET &request, size_t &request_len)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            struct pollfd poll_fd = { fakeGO.serverFd, POLLIN, 0 };
+            if (0 >= poll(&poll_fd, 1, 100))
+            {
+                continue;
+            }
+            memset(&request, 0, sizeof(request));
+            ssize_t len = read(fakeGO.serverFd, &request, sizeof(request));
+            if ((0 < len) && (expected_type == MiracastDHCPCommon::get_message_type(request, len)))
+            {
+                request_len = len;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void sendReply(const DHCP_PACKET &request, DHCP_MESSAGE_TYPE type, const char *your_ip, uint32_t lease_time_s)
+    {
+        DHCP_PACKET reply;
+        DHCP_IP_PACKET frame;
+
+        MiracastDHCPCommon::init_packet(reply, DHCP_BOOTREPLY, type, request.xid, request.chaddr);
+        if (DHCP_NAK != type)
+        {
+            reply.yiaddr = toAddr(your_ip);
+            MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_SUBNET_MASK, toAddr("255.255.255.0"));
+            MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_ROUTER, toAddr("192.168.49.1"));
+            MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_LEASE_TIME, htonl(lease_time_s));
+        }
+        MiracastDHCPCommon::add_option_u32(reply, DHCP_OPTION_SERVER_ID, toAddr("192.168.49.1"));
+
+        size_t frame_len = buildFrame(reply, DHCP_CLIENT_PORT, frame);
+        ASSERT_EQ(static_cast<ssize_t>(frame_len), write(fakeGO.serverFd, &frame, frame_len));
+    }
+
+    struct LeaseLostRecord
+    {
+        std::mutex lock;
+        std::condition_variable signal;
+        bool lost = false;
+        std::string interface;
+        std::string ipAddress;
+    };
+
+    void onLeaseLost(void *ctx, const std::string &interface, const std::string &ip_address)
+    {
+        LeaseLostRecord *record = static_cast<LeaseLostRecord *>(ctx);
+        std::lock_guard<std::mutex> guard(record->lock);
+        record->lost = true;
+        record->interface = interface;
+        record->ipAddress = ip_address;
+        record->signal.notify_one();
+    }
+}
+
+TEST(MiracastDHCPCommonTest, OptionsRoundTrip)
+{
+    DHCP_PACKET packet;
+    std::vector<uint8_t> value;
+    uint32_t router = 0;
+    const uint32_t dns_servers[2] = { toAddr("192.168.49.1"), toAddr("8.8.8.8") };
+
+    MiracastDHCPCommon::init_packet(packet, DHCP_BOOTREPLY, DHCP_OFFER, 0x1234, testHwAddr);
+    EXPECT_TRUE(MiracastDHCPCommon::add_option_u32(packet, DHCP_OPTION_ROUTER, toAddr("192.168.49.1")));
+    EXPECT_TRUE(MiracastDHCPCommon::add_option(packet, DHCP_OPTION_DNS_SERVER, dns_servers, sizeof(dns_servers)));
+
+    size_t packet_len = MiracastDHCPCommon::get_packet_length(packet);
+    EXPECT_EQ(300u, packet_len);
+    EXPECT_EQ(DHCP_OFFER, MiracastDHCPCommon::get_message_type(packet, packet_len));
+    EXPECT_EQ(0, memcmp(packet.chaddr, testHwAddr, DHCP_HW_ADDR_LEN));
+
+    EXPECT_TRUE(MiracastDHCPCommon::get_option_u32(packet, packet_len, DHCP_OPTION_ROUTER, router));
+    EXPECT_EQ("192.168.49.1", MiracastDHCPCommon::ip_to_string(router));
+
+    ASSERT_TRUE(MiracastDHCPCommon::get_option(packet, packet_len, DHCP_OPTION_DNS_SERVER, value));
+    ASSERT_EQ(sizeof(dns_servers), value.size());
+    EXPECT_EQ(0, memcmp(value.data(), dns_servers, sizeof(dns_servers)));
+
+    EXPECT_FALSE(MiracastDHCPCommon::get_option(packet, packet_len, DHCP_OPTION_LEASE_TIME, value));
+}
+
+TEST(MiracastDHCPCommonTest, OptionsBeyondPacketLengthAreIgnored)
+{
+    DHCP_PACKET packet;
+    std::vector<uint8_t> value;
+    uint32_t lease_time = 0;
+
+    MiracastDHCPCommon::init_packet(packet, DHCP_BOOTREPLY, DHCP_ACK, 0x1234, testHwAddr);
+    EXPECT_TRUE(MiracastDHCPCommon::add_option_u32(packet, DHCP_OPTION_LEASE_TIME, htonl(3600)));
+
+    /* Message type takes options[0..2], the lease time option starts at options[3] */
+    size_t truncated_len = offsetof(DHCP_PACKET, options) + 5;
+    EXPECT_EQ(DHCP_ACK, MiracastDHCPCommon::get_message_type(packet, truncated_len));
+    EXPECT_FALSE(MiracastDHCPCommon::get_option_u32(packet, truncated_len, DHCP_OPTION_LEASE_TIME, lease_time));
+    EXPECT_FALSE(MiracastDHCPCommon::get_option(packet, offsetof(DHCP_PACKET, options), DHCP_OPTION_MESSAGE_TYPE, value));
+
+    EXPECT_TRUE(MiracastDHCPCommon::get_option_u32(packet, sizeof(packet), DHCP_OPTION_LEASE_TIME, lease_time));
+    EXPECT_EQ(3600u, ntohl(lease_time));
+
+    packet.cookie = 0;
+    EXPECT_EQ(0, MiracastDHCPCommon::get_message_type(packet, sizeof(packet)));
+}
+
+TEST(MiracastDHCPCommonTest, AddOptionStopsWhenFull)
+{
+    DHCP_PACKET packet;
+    uint8_t filler[200] = {0};
+
+    MiracastDHCPCommon::init_packet(packet, DHCP_BOOTREQUEST, DHCP_DISCOVER, 0x1234, testHwAddr);
+    EXPECT_TRUE(MiracastDHCPCommon::add_option(packet, DHCP_OPTION_HOST_NAME, filler, sizeof(filler)));
+    EXPECT_FALSE(MiracastDHCPCommon::add_option(packet, DHCP_OPTION_CLIENT_ID, filler, sizeof(filler)));
+    EXPECT_EQ(DHCP_DISCOVER, MiracastDHCPCommon::get_message_type(packet, sizeof(packet)));
+}
+
+TEST(MiracastDHCPCommonTest, RecvRawDecodesFramesForThePort)
+{
+    int fds[2] = { -1, -1 };
+    DHCP_PACKET packet,
+                received;
+    DHCP_IP_PACKET frame;
+
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+    MiracastDHCPCommon::init_packet(packet, DHCP_BOOTREPLY, DHCP_ACK, 0xCAFE, testHwAddr);
+    packet.yiaddr = toAddr("192.168.49.165");
+
+    size_t frame_len = buildFrame(packet, DHCP_SERVER_PORT, frame);
+    ASSERT_EQ(static_cast<ssize_t>(frame_len), write(fds[0], &frame, frame_len));
+    EXPECT_EQ(0u, MiracastDHCPCommon::recv_raw(fds[1], DHCP_CLIENT_PORT, received));
+
+    frame_len = buildFrame(packet, DHCP_CLIENT_PORT, frame);
+    ASSERT_EQ(static_cast<ssize_t>(frame_len), write(fds[0], &frame, frame_len));
+    size_t received_len = MiracastDHCPCommon::recv_raw(fds[1], DHCP_CLIENT_PORT, received);
+    EXPECT_EQ(MiracastDHCPCommon::get_packet_length(packet), received_len);
+    EXPECT_EQ(0xCAFEu, received.xid);
+    EXPECT_EQ(packet.yiaddr, received.yiaddr);
+    EXPECT_EQ(DHCP_ACK, MiracastDHCPCommon::get_message_type(received, received_len));
+
+    /* Shorter than the IP and UDP headers */
+    ASSERT_EQ(4, write(fds[0], &frame, 4));
+    EXPECT_EQ(0u, MiracastDHCPCommon::recv_raw(fds[1], DHCP_CLIENT_PORT, received));
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+class MiracastDHCPClientTest : public ::testing::Test
+{
+protected:
+    const DHCP_CLIENT_IO_OPS *previousIOOps = nullptr;
+
+    void SetUp() override
+    {
+        int fds[2] = { -1, -1 };
+
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, fds));
+        fakeGO = FakeGroupOwner();
+        fakeGO.clientFd = fds[0];
+        fakeGO.serverFd = fds[1];
+        previousIOOps = MiracastDHCPClient::set_IOOps(&fakeIOOps);
+    }
+
+    void TearDown() override
+    {
+        MiracastDHCPClient::set_IOOps(previousIOOps);
+        close(fakeGO.clientFd);
+        close(fakeGO.serverFd);
+    }
+};
+
+TEST_F(MiracastDHCPClientTest, InitRebootNakFallsBackToDiscover)
+{
+    MiracastDHCPClient client;
+    DHCP_LEASE lease;
+    MiracastError status = MIRACAST_FAIL;
+    DHCP_PACKET request;
+    size_t request_len = 0;
+    uint32_t option = 0;
+
+    std::thread client_thread([&]() {
+        status = client.start("lo", "192.168.49.200", lease, 5000);
+    });
+
+    /* INIT-REBOOT asks for the previous address without a server id */
+    ASSERT_TRUE(receiveRequest(DHCP_REQUEST, request, request_len));
+    EXPECT_EQ(0u, request.ciaddr);
+    EXPECT_TRUE(MiracastDHCPCommon::get_option_u32(request, request_len, DHCP_OPTION_REQUESTED_IP, option));
+    EXPECT_EQ(toAddr("192.168.49.200"), option);
+    EXPECT_FALSE(MiracastDHCPCommon::get_option_u32(request, request_len, DHCP_OPTION_SERVER_ID, option));
+    sendReply(request, DHCP_NAK, nullptr, 0);
+
+    ASSERT_TRUE(receiveRequest(DHCP_DISCOVER, request, request_len));
+    sendReply(request, DHCP_OFFER, "192.168.49.165", DHCP_INFINITE_LEASE);
+
+    ASSERT_TRUE(receiveRequest(DHCP_REQUEST, request, request_len));
+    EXPECT_TRUE(MiracastDHCPCommon::get_option_u32(request, request_len, DHCP_OPTION_REQUESTED_IP, option));
+    EXPECT_EQ(toAddr("192.168.49.165"), option);
+    EXPECT_TRUE(MiracastDHCPCommon::get_option_u32(request, request_len, DHCP_OPTION_SERVER_ID, option));
+    EXPECT_EQ(toAddr("192.168.49.1"), option);
+    sendReply(request, DHCP_ACK, "192.168.49.165", DHCP_INFINITE_LEASE);
+
+    client_thread.join();
+    EXPECT_EQ(MIRACAST_OK, status);
+    EXPECT_EQ("192.168.49.165", lease.ip_address);
+    EXPECT_EQ("192.168.49.1", lease.router);
+    EXPECT_EQ(toAddr("192.168.49.165"), fakeGO.configuredIp);
+    EXPECT_EQ(24, fakeGO.configuredPrefix);
+    client.stop();
+}
+
+TEST_F(MiracastDHCPClientTest, RenewNakFlushesAddressAndReportsLoss)
+{
+    MiracastDHCPClient client;
+    LeaseLostRecord record;
+    DHCP_LEASE lease;
+    MiracastError status = MIRACAST_FAIL;
+    DHCP_PACKET request;
+    size_t request_len = 0;
+
+    client.set_lease_lost_handler(&onLeaseLost, &record);
+    std::thread client_thread([&]() {
+        status = client.start("lo", "", lease, 5000);
+    });
+
+    ASSERT_TRUE(receiveRequest(DHCP_DISCOVER, request, request_len));
+    sendReply(request, DHCP_OFFER, "192.168.49.165", 2);
+    ASSERT_TRUE(receiveRequest(DHCP_REQUEST, request, request_len));
+    sendReply(request, DHCP_ACK, "192.168.49.165", 2);
+    client_thread.join();
+    ASSERT_EQ(MIRACAST_OK, status);
+
+    /* The renewal at T1 carries the leased address in ciaddr */
+    ASSERT_TRUE(receiveRequest(DHCP_REQUEST, request, request_len));
+    EXPECT_EQ(toAddr("192.168.49.165"), request.ciaddr);
+    sendReply(request, DHCP_NAK, nullptr, 0);
+
+    {
+        std::unique_lock<std::mutex> guard(record.lock);
+        EXPECT_TRUE(record.signal.wait_for(guard, std::chrono::seconds(5), [&record]() { return record.lost; }));
+    }
+    EXPECT_EQ("lo", record.interface);
+    EXPECT_EQ("192.168.49.165", record.ipAddress);
+    EXPECT_EQ(toAddr("192.168.49.165"), fakeGO.removedIp);
+    client.stop();
+}
@@ -0,0 +1,146 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "MiracastLogger.h"
+
+#define LOGGER_TEST_FLOOD_COUNT     (2000)
+#define LOGGER_TEST_ERROR_COUNT     (16)
+
+/*
+ * stderr is redirected into a pipe nobody reads yet, so the drain thread blocks
+ * in its write and the producer's ring fills up; reading the pipe releases it.
+ */
+class MiracastLoggerTest : public ::testing::Test
+{
+protected:
+    int pipeFds[2] = { -1, -1 };
+    int savedStderr = -1;
+    std::string output;
+    std::thread reader;
+
+    void SetUp() override
+    {
+        ASSERT_EQ(0, pipe(pipeFds));
+        fflush(stderr);
+        savedStderr = dup(STDERR_FILENO);
+        ASSERT_NE(-1, savedStderr);
+        ASSERT_NE(-1, dup2(pipeFds[1], STDERR_FILENO));
+        close(pipeFds[1]);
+    }
+
+    void TearDown() override
+    {
+        restoreStderr();
+        if (reader.joinable())
+        {
+            reader.join();
+        }
+        close(pipeFds[0]);
+    }
+
+    void startReading(void)
+    {
+        reader = std::thread([this]()
+        {
+            char buffer[4096];
+            ssize_t length = 0;
+
+            while (0 < (length = read(pipeFds[0], buffer, sizeof(buffer))))
+            {
+                output.append(buffer, length);
+            }
+        });
+    }
+
+    /* Drops the last write end of the pipe, the reader then sees EOF */
+    void restoreStderr(void)
+    {
+        if (-1 != savedStderr)
+        {
+            fflush(stderr);
+            dup2(savedStderr, STDERR_FILENO);
+            close(savedStderr);
+            savedStderr = -1;
+        }
+    }
+
+    size_t countOf(const std::string &text)
+    {
+        size_t count = 0;
+
+        for (size_t position = output.find(text); std::string::npos != position; position = output.find(text, position + 1))
+        {
+            ++count;
+        }
+        return count;
+    }
+};
+
+TEST_F(MiracastLoggerTest, FullRingDropsInfoButKeepsErrors)
+{
+    std::atomic<bool> flooded(false);
+    std::string filler(1000, 'x');
+
+    MIRACAST::logger_init("LoggerTest");
+    MIRACAST::set_loglevel(MIRACAST::INFO_LEVEL);
+
+    std::thread producer([&]()
+    {
+        for (int index = 0; index < LOGGER_TEST_FLOOD_COUNT; ++index)
+        {
+            MIRACASTLOG_INFO("flood %d %s", index, filler.c_str());
+        }
+        flooded.store(true);
+
+        /* The ring is still full, these drain it on this thread instead of being dropped */
+        for (int index = 0; index < LOGGER_TEST_ERROR_COUNT; ++index)
+        {
+            MIRACASTLOG_ERROR("ring-full error %d", index);
+        }
+    });
+
+    while (!flooded.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    startReading();
+    producer.join();
+
+    MIRACAST::logger_deinit();
+    restoreStderr();
+    reader.join();
+
+    EXPECT_NE(std::string::npos, output.find("log message(s) dropped, logging ring full"));
+    EXPECT_LT(countOf("flood "), static_cast<size_t>(LOGGER_TEST_FLOOD_COUNT));
+    for (int index = 0; index < LOGGER_TEST_ERROR_COUNT; ++index)
+    {
+        EXPECT_EQ(1u, countOf("ring-full error " + std::to_string(index) + " ")) << index;
+    }
+}
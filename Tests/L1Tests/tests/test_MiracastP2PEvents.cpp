@@ -0,0 +1,174 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <cstring>
+
+#include "MiracastCommon.h"
+#include "MiracastP2P.h"
+
+TEST(MiracastP2PEventTest, ClassifiesForwardedEvents)
+{
+    const P2P_EVENT_MAP *event_map = p2p_classify_event("P2P-DEVICE-FOUND 96:52:44:b6:fd:14 p2p_dev_addr=96:52:44:b6:fd:14");
+    ASSERT_NE(nullptr, event_map);
+    EXPECT_EQ(EVENT_FOUND, event_map->event_id);
+
+    event_map = p2p_classify_event("P2P-GROUP-STARTED p2p-wlan0-0 client ssid=\"DIRECT-UU\" freq=2437");
+    ASSERT_NE(nullptr, event_map);
+    EXPECT_EQ(EVENT_GROUP_STARTED, event_map->event_id);
+
+    event_map = p2p_classify_event("P2P-FIND-STOPPED");
+    ASSERT_NE(nullptr, event_map);
+    EXPECT_EQ(EVENT_STOP, event_map->event_id);
+}
+
+TEST(MiracastP2PEventTest, ClassifierSkipsLevelAndInterfaceHeader)
+{
+    const P2P_EVENT_MAP *event_map = p2p_classify_event("<3>IFNAME=p2p-dev-wlan0 P2P-GO-NEG-FAILURE status=1");
+    ASSERT_NE(nullptr, event_map);
+    EXPECT_EQ(EVENT_GO_NEG_FAILURE, event_map->event_id);
+
+    event_map = p2p_classify_event("<3>P2P-GROUP-REMOVED p2p-wlan0-0 GO reason=REQUESTED");
+    ASSERT_NE(nullptr, event_map);
+    EXPECT_EQ(EVENT_GROUP_REMOVED, event_map->event_id);
+}
+
+TEST(MiracastP2PEventTest, ClassifierDropsUnknownEvents)
+{
+    EXPECT_EQ(nullptr, p2p_classify_event("<3>CTRL-EVENT-BSS-ADDED 12 aa:bb:cc:dd:ee:ff"));
+    EXPECT_EQ(nullptr, p2p_classify_event("P2P-INVITATION-RECEIVED sa=96:52:44:b6:fd:14"));
+    /* Only whole event names match */
+    EXPECT_EQ(nullptr, p2p_classify_event("P2P-DEVICE-FOUNDX 96:52:44:b6:fd:14"));
+    EXPECT_EQ(nullptr, p2p_classify_event("<3"));
+    EXPECT_EQ(nullptr, p2p_classify_event("IFNAME=p2p-dev-wlan0"));
+    EXPECT_EQ(nullptr, p2p_classify_event(""));
+}
+
+TEST(MiracastP2PEventTest, ParsesArgsAndQuotedFields)
+{
+    P2P_EVENT_FIELDS event_fields;
+    const char *event = "<3>P2P-GROUP-STARTED p2p-wlan0-0 client ssid=\"DIRECT-UU Living Room\" freq=2437 "
+                        "go_dev_addr=96:52:44:b6:fd:14 [PERSISTENT] ip_addr=192.168.49.165 ip_mask=255.255.255.0 go_ip_addr=192.168.49.1";
+
+    parse_p2p_event_fields(event, event_fields);
+    EXPECT_EQ(3u, event_fields.args_count);
+    EXPECT_EQ("p2p-wlan0-0", get_p2p_event_arg(event_fields, 0));
+    EXPECT_EQ("client", get_p2p_event_arg(event_fields, 1));
+    EXPECT_EQ("", get_p2p_event_arg(event_fields, 3));
+    EXPECT_TRUE(has_p2p_event_arg(event_fields, P2P_PERSISTENT_GROUP_FLAG));
+    EXPECT_FALSE(has_p2p_event_arg(event_fields, "GO"));
+
+    EXPECT_EQ("DIRECT-UU Living Room", get_p2p_event_field(event_fields, P2P_EVENT_KEY_SSID));
+    EXPECT_EQ("2437", get_p2p_event_field(event_fields, P2P_EVENT_KEY_FREQ));
+    EXPECT_EQ("96:52:44:b6:fd:14", get_p2p_event_field(event_fields, P2P_EVENT_KEY_GO_DEV_ADDR));
+    EXPECT_EQ("192.168.49.165", get_p2p_event_field(event_fields, P2P_EVENT_KEY_IP_ADDR));
+    EXPECT_EQ("192.168.49.1", get_p2p_event_field(event_fields, P2P_EVENT_KEY_GO_IP_ADDR));
+    EXPECT_EQ("", get_p2p_event_field(event_fields, P2P_EVENT_KEY_NAME));
+    EXPECT_EQ("", get_p2p_event_field(event_fields, P2P_EVENT_KEY_MAX));
+}
+
+TEST(MiracastP2PEventTest, ParsesDeviceFoundName)
+{
+    P2P_EVENT_FIELDS event_fields;
+    const char *event = "P2P-DEVICE-FOUND 96:52:44:b6:fd:14 p2p_dev_addr=96:52:44:b6:fd:14 pri_dev_type=10-0050F204-5 "
+                        "name='Galaxy S23' config_methods=0x188 dev_capab=0x25 group_capab=0x0 wfd_dev_info=0x00111c440032";
+
+    parse_p2p_event_fields(event, event_fields);
+    EXPECT_EQ(1u, event_fields.args_count);
+    EXPECT_EQ("96:52:44:b6:fd:14", get_p2p_event_arg(event_fields, 0));
+    EXPECT_EQ("96:52:44:b6:fd:14", get_p2p_event_field(event_fields, P2P_EVENT_KEY_P2P_DEV_ADDR));
+    EXPECT_EQ("10-0050F204-5", get_p2p_event_field(event_fields, P2P_EVENT_KEY_PRI_DEV_TYPE));
+    EXPECT_EQ("Galaxy S23", get_p2p_event_field(event_fields, P2P_EVENT_KEY_NAME));
+    EXPECT_EQ("0x188", get_p2p_event_field(event_fields, P2P_EVENT_KEY_CONFIG_METHODS));
+    EXPECT_EQ("0x00111c440032", get_p2p_event_field(event_fields, P2P_EVENT_KEY_WFD_DEV_INFO));
+}
+
+TEST(MiracastP2PEventTest, ParserStopsAtUnterminatedQuote)
+{
+    P2P_EVENT_FIELDS event_fields;
+
+    parse_p2p_event_fields("P2P-DEVICE-FOUND 96:52:44:b6:fd:14 freq=2412 name='Galaxy config_methods=0x188", event_fields);
+    EXPECT_EQ("2412", get_p2p_event_field(event_fields, P2P_EVENT_KEY_FREQ));
+    EXPECT_EQ("", get_p2p_event_field(event_fields, P2P_EVENT_KEY_NAME));
+    EXPECT_EQ("", get_p2p_event_field(event_fields, P2P_EVENT_KEY_CONFIG_METHODS));
+
+    parse_p2p_event_fields(nullptr, event_fields);
+    EXPECT_EQ(0u, event_fields.args_count);
+}
+
+TEST(MiracastP2PEventTest, ParserKeepsFirstArgsOnly)
+{
+    P2P_EVENT_FIELDS event_fields;
+
+    parse_p2p_event_fields("P2P-EVENT a b c d e f", event_fields);
+    EXPECT_EQ(static_cast<unsigned int>(P2P_EVENT_MAX_ARGS), event_fields.args_count);
+    EXPECT_EQ("d", get_p2p_event_arg(event_fields, P2P_EVENT_MAX_ARGS - 1));
+    EXPECT_FALSE(has_p2p_event_arg(event_fields, "e"));
+}
+
+TEST(MiracastEventBufferPoolTest, LastReleaseRecyclesTheBuffer)
+{
+    MiracastEventBufferPool *event_pool = MiracastEventBufferPool::getInstance();
+    MIRACAST_EVENT_BUFFER *event_buffer = event_pool->acquire();
+
+    ASSERT_NE(nullptr, event_buffer);
+    EXPECT_EQ(1, event_buffer->ref_count.load());
+    EXPECT_EQ(0u, event_buffer->length);
+    strncpy(event_buffer->data, "P2P-FIND-STOPPED", sizeof(event_buffer->data) - 1);
+    event_buffer->length = strlen(event_buffer->data);
+
+    /* Still referenced by the controller, must not be handed out again */
+    event_pool->add_ref(event_buffer);
+    event_pool->release(event_buffer);
+    EXPECT_EQ(1, event_buffer->ref_count.load());
+    MIRACAST_EVENT_BUFFER *other_buffer = event_pool->acquire();
+    EXPECT_NE(event_buffer, other_buffer);
+    event_pool->release(other_buffer);
+
+    event_pool->release(event_buffer);
+    MIRACAST_EVENT_BUFFER *recycled_buffer = event_pool->acquire();
+    EXPECT_EQ(event_buffer, recycled_buffer);
+    EXPECT_EQ(0u, recycled_buffer->length);
+    EXPECT_EQ('\0', recycled_buffer->data[0]);
+    event_pool->release(recycled_buffer);
+}
+
+TEST(MiracastEventBufferPoolTest, GrowsBeyondThePoolSize)
+{
+    MiracastEventBufferPool *event_pool = MiracastEventBufferPool::getInstance();
+    std::vector<MIRACAST_EVENT_BUFFER *> event_buffers;
+    std::set<MIRACAST_EVENT_BUFFER *> distinct_buffers;
+
+    for (int count = 0; count < MIRACAST_EVENT_POOL_SIZE + 2; ++count)
+    {
+        event_buffers.push_back(event_pool->acquire());
+        ASSERT_NE(nullptr, event_buffers.back());
+        EXPECT_EQ(1, event_buffers.back()->ref_count.load());
+        distinct_buffers.insert(event_buffers.back());
+    }
+    EXPECT_EQ(event_buffers.size(), distinct_buffers.size());
+    for (auto event_buffer : event_buffers)
+    {
+        event_pool->release(event_buffer);
+    }
+}
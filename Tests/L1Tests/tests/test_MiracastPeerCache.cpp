@@ -0,0 +1,147 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+
+#include "MiracastPeerCache.h"
+
+namespace
+{
+    std::string peerMac(unsigned int index)
+    {
+        char mac[PEER_CACHE_MAC_STR_LEN] = {0};
+        snprintf(mac, sizeof(mac), "96:52:44:b6:%02x:%02x", (index >> 8) & 0xFF, index & 0xFF);
+        return mac;
+    }
+}
+
+TEST(MiracastPeerCacheTest, PackMacAddress)
+{
+    uint64_t mac_key = 0,
+             upper_key = 0;
+
+    EXPECT_TRUE(MiracastPeerCache::pack_mac_address("96:52:44:b6:fd:14", mac_key));
+    EXPECT_EQ(0x965244b6fd14ULL, mac_key);
+    EXPECT_TRUE(MiracastPeerCache::pack_mac_address("96:52:44:B6:FD:14", upper_key));
+    EXPECT_EQ(mac_key, upper_key);
+
+    EXPECT_FALSE(MiracastPeerCache::pack_mac_address("96:52:44:b6:fd", mac_key));
+    EXPECT_FALSE(MiracastPeerCache::pack_mac_address("96:52:44:b6:fd:1g", mac_key));
+    EXPECT_FALSE(MiracastPeerCache::pack_mac_address("", mac_key));
+}
+
+TEST(MiracastPeerCacheTest, UpdateOnlyOverwritesWhenForced)
+{
+    MiracastPeerCache peer_cache;
+    DeviceInfo device_info;
+
+    EXPECT_TRUE(peer_cache.update("96:52:44:b6:fd:14", "pbc", "Galaxy S23", "10-0050F204-5", false));
+    EXPECT_TRUE(peer_cache.update("96:52:44:B6:FD:14", "display", "Renamed", "1-0050F204-1", false));
+    EXPECT_EQ(1u, peer_cache.size());
+
+    ASSERT_TRUE(peer_cache.lookup("96:52:44:b6:fd:14", device_info));
+    EXPECT_EQ("Galaxy S23", device_info.modelName);
+    EXPECT_EQ("pbc", device_info.authType);
+
+    EXPECT_TRUE(peer_cache.update("96:52:44:b6:fd:14", "display", "Renamed", "1-0050F204-1", true));
+    EXPECT_TRUE(peer_cache.set_peer_iface("96:52:44:b6:fd:14", "96:52:44:b6:fd:15"));
+    ASSERT_TRUE(peer_cache.lookup("96:52:44:b6:fd:14", device_info));
+    EXPECT_EQ("Renamed", device_info.modelName);
+    EXPECT_EQ("display", device_info.authType);
+    EXPECT_EQ("96:52:44:b6:fd:15", device_info.peer_iface);
+
+    EXPECT_FALSE(peer_cache.update("not-a-mac", "pbc", "Galaxy S23", "10-0050F204-5", true));
+    EXPECT_FALSE(peer_cache.set_peer_iface("96:52:44:b6:fd:16", "96:52:44:b6:fd:17"));
+}
+
+TEST(MiracastPeerCacheTest, PeersExpireAfterTheTTL)
+{
+    MiracastPeerCache peer_cache(1);
+    DeviceInfo device_info;
+
+    EXPECT_TRUE(peer_cache.update(peerMac(1), "pbc", "Refreshed", "10-0050F204-5", false));
+    EXPECT_TRUE(peer_cache.update(peerMac(2), "pbc", "Stale", "10-0050F204-5", false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+    /* A repeated P2P-DEVICE-FOUND only refreshes the last-seen time */
+    EXPECT_TRUE(peer_cache.update(peerMac(1), "pbc", "Refreshed", "10-0050F204-5", false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+    EXPECT_FALSE(peer_cache.lookup(peerMac(2), device_info));
+    std::vector<DeviceInfo> peers = peer_cache.snapshot();
+    ASSERT_EQ(1u, peers.size());
+    EXPECT_EQ(peerMac(1), peers[0].deviceMAC);
+    EXPECT_EQ(1u, peer_cache.size());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    EXPECT_FALSE(peer_cache.lookup(peerMac(1), device_info));
+    EXPECT_EQ(0u, peer_cache.size());
+}
+
+TEST(MiracastPeerCacheTest, FullCacheEvictsLeastRecentlySeen)
+{
+    MiracastPeerCache peer_cache;
+    DeviceInfo device_info;
+
+    EXPECT_TRUE(peer_cache.update(peerMac(0), "pbc", "Oldest", "10-0050F204-5", false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    for (unsigned int index = 1; index < PEER_CACHE_MAX_ENTRIES; ++index)
+    {
+        EXPECT_TRUE(peer_cache.update(peerMac(index), "pbc", "Peer", "10-0050F204-5", false));
+    }
+    EXPECT_EQ(static_cast<unsigned int>(PEER_CACHE_MAX_ENTRIES), peer_cache.size());
+
+    EXPECT_TRUE(peer_cache.update(peerMac(PEER_CACHE_MAX_ENTRIES), "pbc", "Newest", "10-0050F204-5", false));
+    EXPECT_EQ(static_cast<unsigned int>(PEER_CACHE_MAX_ENTRIES), peer_cache.size());
+    EXPECT_FALSE(peer_cache.lookup(peerMac(0), device_info));
+    ASSERT_TRUE(peer_cache.lookup(peerMac(PEER_CACHE_MAX_ENTRIES), device_info));
+    EXPECT_EQ("Newest", device_info.modelName);
+}
+
+TEST(MiracastPeerCacheTest, RemoveKeepsCollidingPeersReachable)
+{
+    MiracastPeerCache peer_cache;
+    DeviceInfo device_info;
+
+    for (unsigned int index = 0; index < PEER_CACHE_MAX_ENTRIES; ++index)
+    {
+        EXPECT_TRUE(peer_cache.update(peerMac(index), "pbc", "Peer", "10-0050F204-5", false));
+    }
+    for (unsigned int index = 0; index < PEER_CACHE_MAX_ENTRIES; index += 3)
+    {
+        EXPECT_TRUE(peer_cache.remove(peerMac(index)));
+    }
+    EXPECT_FALSE(peer_cache.remove(peerMac(0)));
+
+    for (unsigned int index = 0; index < PEER_CACHE_MAX_ENTRIES; ++index)
+    {
+        EXPECT_EQ(0 != (index % 3), peer_cache.lookup(peerMac(index), device_info)) << peerMac(index);
+    }
+    EXPECT_EQ(static_cast<unsigned int>(PEER_CACHE_MAX_ENTRIES - (PEER_CACHE_MAX_ENTRIES / 3)), peer_cache.size());
+
+    peer_cache.clear();
+    EXPECT_EQ(0u, peer_cache.size());
+    EXPECT_TRUE(peer_cache.snapshot().empty());
+}
@@ -649,6 +649,16 @@ TEST_F(MiracastPlayerTest, RegisteredMethods)
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("playRequest")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("stopRequest")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setVideoRectangle")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getSessionBreakdown")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("exportSessionTrace")));
+}
+
+TEST_F(MiracastPlayerTest, GetSessionBreakdownBeforeAnySession)
+{
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getSessionBreakdown"), _T("{}"), response));
+    EXPECT_NE(string::npos, response.find(_T("\"breakdown\":{}")));
+    EXPECT_NE(string::npos, response.find(_T("\"success\":true")));
+    EXPECT_EQ(Core::ERROR_BAD_REQUEST, handler.Invoke(connection, _T("exportSessionTrace"), _T("{}"), response));
 }
 
 TEST_F(MiracastPlayerTest, GetInformation)
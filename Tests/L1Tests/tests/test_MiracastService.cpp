@@ -18,6 +18,7 @@
 **/
 
 #include <gtest/gtest.h>
+#include <gmock/gmock.h>
 
 #include "MiracastService.h"
 
@@ -35,6 +36,8 @@
 #include "WorkerPoolImplementation.h"
 #include "MiracastServiceImplementation.h"
 #include <sys/time.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <future>
 
 using namespace WPEFramework;
@@ -140,6 +143,68 @@ namespace
 }
 
 static struct wpa_ctrl global_wpa_ctrl_handle;
+/* Stays readable, so the P2P monitor thread keeps polling the wpa_ctrl mocks */
+static int global_wpa_ctrl_event_fd = -1;
+
+static int testCtrlRequest(struct wpa_ctrl *ctrl, const char *cmd, char *reply, size_t *reply_len, unsigned int timeout_ms)
+{
+    return wpa_ctrl_request(ctrl, cmd, strlen(cmd), reply, reply_len, NULL);
+}
+
+static int testCtrlPending(struct wpa_ctrl *ctrl)
+{
+    /* Paces the monitor thread the way the wpa_supplicant socket would */
+    usleep(50000);
+    return wpa_ctrl_pending(ctrl);
+}
+
+static int testCtrlGetFd(struct wpa_ctrl *ctrl)
+{
+    return global_wpa_ctrl_event_fd;
+}
+
+class NeighborTableMock : public MiracastNeighborTableInterface
+{
+public:
+    MOCK_METHOD(bool, find_ip_by_mac, (const std::string &interface, const std::string &mac, std::string &ip_address), (override));
+    MOCK_METHOD(bool, wait_for_ip_by_mac, (const std::string &interface, const std::string &mac, std::string &ip_address, unsigned int timeout_ms), (override));
+    MOCK_METHOD(bool, has_entry, (const std::string &ip_address), (override));
+    MOCK_METHOD(bool, remove_entry, (const std::string &ip_address), (override));
+};
+
+class ArpProberMock : public MiracastArpProberInterface
+{
+public:
+    MOCK_METHOD(bool, probe, (const std::string &interface, const std::string &target_ip, ARP_PROBE_RESULT &result, unsigned int attempts, unsigned int attempt_timeout_ms), (override));
+};
+
+class DHCPClientMock : public MiracastDHCPClientInterface
+{
+public:
+    MOCK_METHOD(MiracastError, start, (const std::string &interface, const std::string &requested_ip, DHCP_LEASE &lease, unsigned int timeout_ms), (override));
+    MOCK_METHOD(void, stop, (), (override));
+    MOCK_METHOD(void, set_lease_lost_handler, (DHCP_LEASE_LOST_HANDLER handler, void *ctx), (override));
+};
+
+class DHCPServerMock : public MiracastDHCPServerInterface
+{
+public:
+    MOCK_METHOD(MiracastError, start, (const std::string &interface, const std::string &reserved_mac, const std::string &reserved_ip), (override));
+    MOCK_METHOD(void, stop, (), (override));
+    MOCK_METHOD(bool, is_running, (), (override));
+    MOCK_METHOD(bool, wait_for_lease, (const std::string &mac_address, DHCP_SERVER_LEASE &lease, unsigned int timeout_ms), (override));
+};
+
+static const P2P_CTRL_OPS global_wpa_ctrl_ops =
+{
+    [](const char *ctrl_path) { return wpa_ctrl_open(ctrl_path); },
+    [](struct wpa_ctrl *ctrl) { wpa_ctrl_close(ctrl); },
+    [](struct wpa_ctrl *ctrl) { return wpa_ctrl_attach(ctrl); },
+    testCtrlRequest,
+    testCtrlPending,
+    [](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) { return wpa_ctrl_recv(ctrl, reply, reply_len); },
+    testCtrlGetFd
+};
 
 class MiracastServiceTest : public ::testing::Test {
 protected:
@@ -158,6 +223,11 @@ protected:
     Core::ProxyType<WorkerPoolImplementation> workerPool;
     
     NiceMock<FactoriesImplementation> factoriesImplementation;
+    const P2P_CTRL_OPS *previousCtrlOps = nullptr;
+    NiceMock<NeighborTableMock> neighborTableMock;
+    NiceMock<ArpProberMock> arpProberMock;
+    NiceMock<DHCPClientMock> dhcpClientMock;
+    NiceMock<DHCPServerMock> dhcpServerMock;
 
     MiracastServiceTest()
         : plugin(Core::ProxyType<Plugin::MiracastService>::Create())
@@ -168,6 +238,32 @@ protected:
         p_wrapsImplMock = new NiceMock<WrapsImplMock>;
         printf("Pass created wrapsImplMock: %p ", p_wrapsImplMock);
         Wraps::setImpl(p_wrapsImplMock);
+
+        uint64_t readable = 1;
+        global_wpa_ctrl_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(readable)), write(global_wpa_ctrl_event_fd, &readable, sizeof(readable)));
+        previousCtrlOps = MiracastP2P::set_CtrlOps(&global_wpa_ctrl_ops);
+
+        /* The source shows up in the neighbor table with the address it leased */
+        ON_CALL(neighborTableMock, wait_for_ip_by_mac(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault(::testing::DoAll(::testing::SetArgReferee<2>(std::string("192.168.59.165")), ::testing::Return(true)));
+        ON_CALL(neighborTableMock, remove_entry(::testing::_))
+            .WillByDefault(::testing::Return(true));
+        ON_CALL(neighborTableMock, has_entry(::testing::_))
+            .WillByDefault(::testing::Return(false));
+        MiracastController::set_NeighborTable(&neighborTableMock);
+        ON_CALL(arpProberMock, probe(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault(::testing::Return(true));
+        MiracastController::set_ArpProber(&arpProberMock);
+        /* Unless a test leases the address itself, the controller falls back to the udhcpc stubs */
+        ON_CALL(dhcpClientMock, start(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault(::testing::Return(MIRACAST_INVALID_CONFIGURATION));
+        MiracastController::set_DHCPClient(&dhcpClientMock);
+        ON_CALL(dhcpServerMock, start(::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault(::testing::Return(MIRACAST_INVALID_CONFIGURATION));
+        ON_CALL(dhcpServerMock, is_running())
+            .WillByDefault(::testing::Return(false));
+        MiracastController::set_DHCPServer(&dhcpServerMock);
         
         ON_CALL(service, COMLink())
         .WillByDefault(::testing::Invoke(
@@ -220,6 +316,14 @@ protected:
         Core::IWorkerPool::Assign(nullptr);
         workerPool.Release();
     
+        MiracastController::set_DHCPServer(nullptr);
+        MiracastController::set_DHCPClient(nullptr);
+        MiracastController::set_ArpProber(nullptr);
+        MiracastController::set_NeighborTable(nullptr);
+        MiracastP2P::set_CtrlOps(previousCtrlOps);
+        close(global_wpa_ctrl_event_fd);
+        global_wpa_ctrl_event_fd = -1;
+
         Wraps::setImpl(nullptr);
         if (p_wrapsImplMock != nullptr)
         {
@@ -631,6 +735,180 @@ TEST_F(MiracastServiceEventTest, P2P_GOMode_onClientConnectionAndLaunchRequest)
 	removeFile("/var/run/wpa_supplicant/p2p0");
 }
 
+TEST_F(MiracastServiceEventTest, P2P_GOMode_BuiltinDHCPServerLease)
+{
+	createFile("/etc/device.properties","WIFI_P2P_CTRL_INTERFACE=p2p0");
+	createFile("/var/run/wpa_supplicant/p2p0","p2p0");
+
+	EXPECT_EQ(string(""), plugin->Initialize(&service));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setEnable"), _T("{\"enabled\": true}"), response));
+
+	bool serverRunning = false;
+	EXPECT_CALL(dhcpServerMock, start(::testing::StrEq("lo"), ::testing::_, ::testing::_))
+		.WillOnce(::testing::Invoke(
+					[&](const std::string &interface, const std::string &reserved_mac, const std::string &reserved_ip)
+					{
+						serverRunning = true;
+						return MIRACAST_OK;
+					}));
+	ON_CALL(dhcpServerMock, is_running())
+		.WillByDefault(::testing::Invoke([&]() { return serverRunning; }));
+	EXPECT_CALL(dhcpServerMock, wait_for_lease(::testing::StrEq("96:52:44:b6:fd:14"), ::testing::_, ::testing::_))
+		.WillOnce(::testing::Invoke(
+					[&](const std::string &mac_address, DHCP_SERVER_LEASE &lease, unsigned int timeout_ms)
+					{
+						lease.ip_address = "192.168.59.170";
+						lease.mac_address = mac_address;
+						return true;
+					}));
+	/* The peer address comes from the lease, never from the neighbor table */
+	EXPECT_CALL(neighborTableMock, wait_for_ip_by_mac(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+		.Times(0);
+	EXPECT_CALL(*p_wrapsImplMock, system(::testing::_))
+		.Times(::testing::AnyNumber())
+		.WillRepeatedly(::testing::Invoke(
+					[&](const char* command)
+					{
+						EXPECT_EQ(nullptr, strstr(command, "dnsmasq"));
+						return 0;
+					}));
+
+	EXPECT_CALL(*p_wrapsImplMock, wpa_ctrl_request(::testing::_, ::testing::_, ::testing::_,::testing::_, ::testing::_, ::testing::_))
+		.Times(::testing::AnyNumber())
+		.WillRepeatedly(::testing::Invoke(
+					[&](struct wpa_ctrl *ctrl, const char *cmd, size_t cmd_len, char *reply, size_t *reply_len, void(*msg_cb)(char *msg, size_t len))
+					{
+						if ( 0 == strncmp(cmd,"P2P_CONNECT",strlen("P2P_CONNECT")))
+						{
+							strncpy(reply,"OK",*reply_len);
+						}
+						return false;
+					}));
+
+	EXPECT_CALL(*p_wrapsImplMock, wpa_ctrl_recv(::testing::_, ::testing::_, ::testing::_))
+		.WillOnce(::testing::Invoke(
+					[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+					strncpy(reply, "P2P-DEVICE-FOUND 2c:33:58:9c:73:2d p2p_dev_addr=2c:33:58:9c:73:2d pri_dev_type=1-0050F200-0 name='Sample-Test-Android-1' config_methods=0x11e8 dev_capab=0x25 group_capab=0x82 wfd_dev_info=0x01101c440006 new=0", *reply_len);
+					return false;
+					}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-DEVICE-LOST 2c:33:58:9c:73:2d p2p_dev_addr=2c:33:58:9c:73:2d pri_dev_type=1-0050F200-0 name='Sample-Test-Android-1' config_methods=0x11e8 dev_capab=0x25 group_capab=0x82 wfd_dev_info=0x01101c440006 new=0", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-DEVICE-FOUND 96:52:44:b6:7d:14 p2p_dev_addr=96:52:44:b6:7d:14 pri_dev_type=10-0050F204-5 name='Sample-Test-Android-2' config_methods=0x188 dev_capab=0x25 group_capab=0x0 wfd_dev_info=0x01101c440032 vendor_elems=1 new=1", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-PROV-DISC-PBC-REQ 96:52:44:b6:7d:14 p2p_dev_addr=96:52:44:b6:7d:14 pri_dev_type=10-0050F204-5 name='Sample-Test-Android-2' config_methods=0x188 dev_capab=0x25 group_capab=0x0", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-PROV-DISC-PBC-REQ 96:52:44:b6:7d:14 p2p_dev_addr=96:52:44:b6:7d:14 pri_dev_type=10-0050F204-5 name='Sample-Test-Android-2' config_methods=0x188 dev_capab=0x25 group_capab=0x0", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-GO-NEG-REQUEST 96:52:44:b6:7d:14 dev_passwd_id=4 go_intent=13", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-GO-NEG-SUCCESS role=client freq=2437 ht40=0 x=96:52:44:b6:7d:14 peer_iface=96:52:44:b6:fd:14 wps_method=PBC", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-GROUP-FORMATION-SUCCESS", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-FIND-STOPPED", *reply_len);
+				return false;
+				}))
+
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				// Here using lo to avoid the operation not permitted error for unknown interfaces
+				strncpy(reply, "P2P-GROUP-STARTED lo GO ssid=\"DIRECT-UU-Element-Xumo-TV\" freq=2437 psk=12c3ce3d8976152df796e5f42fc646723471bf1aab8d72a546fa3dce60dc14a3 go_dev_addr=96:52:44:b6:7d:14 ip_addr=192.168.49.200 ip_mask=255.255.255.0 go_ip_addr=192.168.49.1", *reply_len);
+				return false;
+				}))
+
+	.WillRepeatedly(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				return true;
+				}));
+
+	Core::Event connectRequest(false, true);
+	Core::Event P2PGrpStart(false, true);
+
+	EXPECT_CALL(service, Submit(::testing::_, ::testing::_))
+		.Times(2)
+		.WillOnce(::testing::Invoke(
+					[&](const uint32_t, const Core::ProxyType<Core::JSON::IElement>& json) {
+					string text;
+					EXPECT_TRUE(json->ToString(text));
+					EXPECT_EQ(text,string(_T("{"
+									"\"jsonrpc\":\"2.0\","
+									"\"method\":\"client.events.onClientConnectionRequest\","
+									"\"params\":{\"mac\":\"96:52:44:b6:7d:14\","
+									"\"name\":\"Sample-Test-Android-2\""
+									"}}"
+								)));
+					connectRequest.SetEvent();
+					return Core::ERROR_NONE;
+					}))
+
+	.WillOnce(::testing::Invoke(
+				[&](const uint32_t, const Core::ProxyType<Core::JSON::IElement>& json) {
+				string text;
+				EXPECT_TRUE(json->ToString(text));
+				EXPECT_EQ(text,string(_T("{"
+								"\"jsonrpc\":\"2.0\","
+								"\"method\":\"client.events.onLaunchRequest\","
+								"\"params\":{\"device_parameters\":{\"source_dev_ip\":\"192.168.59.170\","
+								"\"source_dev_mac\":\"96:52:44:b6:7d:14\","
+								"\"source_dev_name\":\"Sample-Test-Android-2\","
+								"\"sink_dev_ip\":\"192.168.59.1\""
+								"}}}"
+							)));
+				P2PGrpStart.SetEvent();
+				return Core::ERROR_NONE;
+				}));
+
+
+	EVENT_SUBSCRIBE(0, _T("onClientConnectionRequest"), _T("client.events"), message);
+	EVENT_SUBSCRIBE(0, _T("onLaunchRequest"), _T("client.events"), message);
+
+	EXPECT_EQ(Core::ERROR_NONE, connectRequest.Lock(10000));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("acceptClientConnection"), _T("{\"requestStatus\": Accept}"), response));
+
+	EXPECT_EQ(Core::ERROR_NONE, P2PGrpStart.Lock(10000));
+
+	EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("updatePlayerState"), _T("{\"mac\": \"96:52:44:b6:7d:14\",\"state\":\"STOPPED\"}"), response));
+
+	EVENT_UNSUBSCRIBE(0, _T("onClientConnectionRequest"), _T("client.events"), message);
+	EVENT_UNSUBSCRIBE(0, _T("onLaunchRequest"), _T("client.events"), message);
+
+	plugin->Deinitialize(nullptr);
+
+	removeEntryFromFile("/etc/device.properties","WIFI_P2P_CTRL_INTERFACE=p2p0");
+	removeFile("/var/run/wpa_supplicant/p2p0");
+}
+
 TEST_F(MiracastServiceEventTest, onClientConnectionRequestRejected)
 {
 	createFile("/etc/device.properties","WIFI_P2P_CTRL_INTERFACE=p2p0");
@@ -1414,6 +1692,106 @@ TEST_F(MiracastServiceEventTest, P2P_ClientMode_DirectGroupStartWithName)
 	removeFile("/var/run/wpa_supplicant/p2p0");
 }
 
+TEST_F(MiracastServiceEventTest, P2P_ClientMode_BuiltinDHCPClientLease)
+{
+	createFile("/etc/device.properties","WIFI_P2P_CTRL_INTERFACE=p2p0");
+	createFile("/var/run/wpa_supplicant/p2p0","p2p0");
+
+	EXPECT_EQ(string(""), plugin->Initialize(&service));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setEnable"), _T("{\"enabled\": true}"), response));
+
+	EXPECT_CALL(dhcpClientMock, start(::testing::StrEq("lo"), ::testing::_, ::testing::_, ::testing::_))
+		.WillOnce(::testing::Invoke(
+					[&](const std::string &interface, const std::string &requested_ip, DHCP_LEASE &lease, unsigned int timeout_ms)
+					{
+						lease.ip_address = "192.168.49.165";
+						lease.subnet_mask = "255.255.255.0";
+						lease.router = "192.168.49.1";
+						lease.server_id = "192.168.49.1";
+						lease.lease_time_s = 3600;
+						return MIRACAST_OK;
+					}));
+
+	EXPECT_CALL(*p_wrapsImplMock, popen(::testing::_, ::testing::_))
+		.Times(::testing::AnyNumber())
+		.WillRepeatedly(::testing::Invoke(
+					[&](const char* command, const char* type)
+					{
+					EXPECT_NE(0, strncmp(command,"/sbin/udhcpc",strlen("/sbin/udhcpc")));
+					char buffer[1024] = {0};
+					size_t len = strnlen(buffer, sizeof(buffer));
+					return (fmemopen(buffer, len, "r"));
+					}));
+
+	EXPECT_CALL(*p_wrapsImplMock, wpa_ctrl_request(::testing::_, ::testing::_, ::testing::_,::testing::_, ::testing::_, ::testing::_))
+		.Times(::testing::AnyNumber())
+		.WillRepeatedly(::testing::Invoke(
+					[&](struct wpa_ctrl *ctrl, const char *cmd, size_t cmd_len, char *reply, size_t *reply_len, void(*msg_cb)(char *msg, size_t len))
+					{
+						if ( 0 == strncmp(cmd,"P2P_CONNECT",strlen("P2P_CONNECT")))
+						{
+							strncpy(reply,"OK",*reply_len);
+						}
+						return false;
+					}));
+
+	EXPECT_CALL(*p_wrapsImplMock, wpa_ctrl_recv(::testing::_, ::testing::_, ::testing::_))
+	.WillOnce(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				strncpy(reply, "P2P-GROUP-STARTED lo client ssid=\"DIRECT-UU-Galaxy A23 5G\" freq=2437 psk=12c3ce3d8976152df796e5f42fc646723471bf1aab8d72a546fa3dce60dc14a3 go_dev_addr=96:52:44:b6:7d:14 [PERSISTENT]", *reply_len);
+				return false;
+				}))
+
+	.WillRepeatedly(::testing::Invoke(
+				[&](struct wpa_ctrl *ctrl, char *reply, size_t *reply_len) {
+				return true;
+				}));
+
+	Core::Event connectRequest(false, true);
+	Core::Event P2PGrpStart(false, true);
+
+	EXPECT_CALL(service, Submit(::testing::_, ::testing::_))
+		.Times(2)
+		.WillOnce(::testing::Invoke(
+					[&](const uint32_t, const Core::ProxyType<Core::JSON::IElement>& json) {
+					connectRequest.SetEvent();
+					return Core::ERROR_NONE;
+					}))
+
+	.WillOnce(::testing::Invoke(
+				[&](const uint32_t, const Core::ProxyType<Core::JSON::IElement>& json) {
+				string text;
+				EXPECT_TRUE(json->ToString(text));
+				EXPECT_EQ(text,string(_T("{"
+								"\"jsonrpc\":\"2.0\","
+								"\"method\":\"client.events.onLaunchRequest\","
+								"\"params\":{\"device_parameters\":{\"source_dev_ip\":\"192.168.49.1\","
+								"\"source_dev_mac\":\"96:52:44:b6:7d:14\","
+								"\"source_dev_name\":\"Galaxy A23 5G\","
+								"\"sink_dev_ip\":\"192.168.49.165\""
+								"}}}"
+							)));
+				P2PGrpStart.SetEvent();
+				return Core::ERROR_NONE;
+				}));
+
+	EVENT_SUBSCRIBE(0, _T("onClientConnectionRequest"), _T("client.events"), message);
+	EVENT_SUBSCRIBE(0, _T("onLaunchRequest"), _T("client.events"), message);
+
+	EXPECT_EQ(Core::ERROR_NONE, connectRequest.Lock(10000));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("acceptClientConnection"), _T("{\"requestStatus\": Accept}"), response));
+
+	EXPECT_EQ(Core::ERROR_NONE, P2PGrpStart.Lock(10000));
+
+	EVENT_UNSUBSCRIBE(0, _T("onClientConnectionRequest"), _T("client.events"), message);
+	EVENT_UNSUBSCRIBE(0, _T("onLaunchRequest"), _T("client.events"), message);
+
+	plugin->Deinitialize(nullptr);
+
+	removeEntryFromFile("/etc/device.properties","WIFI_P2P_CTRL_INTERFACE=p2p0");
+	removeFile("/var/run/wpa_supplicant/p2p0");
+}
+
 TEST_F(MiracastServiceEventTest, P2P_ClientMode_DirectGroupStartWithoutName)
 {
 	createFile("/etc/device.properties","WIFI_P2P_CTRL_INTERFACE=p2p0");
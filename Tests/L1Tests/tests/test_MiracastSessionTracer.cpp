@@ -0,0 +1,141 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "MiracastSessionTracer.h"
+
+namespace
+{
+    struct SessionEnd
+    {
+        int calls = 0;
+        std::string source_mac;
+        bool success = false;
+        std::string breakdown;
+    };
+
+    void sessionEndHandler(void *ctx, const std::string &source_mac, bool success, const std::string &breakdown)
+    {
+        SessionEnd *session_end = static_cast<SessionEnd *>(ctx);
+
+        session_end->calls++;
+        session_end->source_mac = source_mac;
+        session_end->success = success;
+        session_end->breakdown = breakdown;
+    }
+}
+
+class MiracastSessionTracerTest : public ::testing::Test
+{
+protected:
+    MiracastSessionTracer *session_tracer = nullptr;
+
+    void SetUp() override
+    {
+        MiracastSessionTracer::destroyInstance();
+        session_tracer = MiracastSessionTracer::getInstance();
+    }
+
+    void TearDown() override
+    {
+        MiracastSessionTracer::destroyInstance();
+    }
+};
+
+TEST_F(MiracastSessionTracerTest, EndSessionReportsTheBreakdown)
+{
+    SessionEnd session_end;
+
+    EXPECT_EQ("{}", session_tracer->get_session_breakdown());
+    session_tracer->set_session_end_handler(&sessionEndHandler, &session_end);
+
+    /* Begun before the session, carried into it */
+    session_tracer->span_begin(MIRACAST_SPAN_P2P_FIND);
+    session_tracer->begin_session("96:52:44:b6:fd:14");
+    session_tracer->span_end(MIRACAST_SPAN_P2P_FIND);
+    session_tracer->span_begin(MIRACAST_SPAN_DHCP);
+    session_tracer->set_sta_frequency(2437);
+    session_tracer->set_group_frequency(5180);
+
+    std::string breakdown = session_tracer->get_session_breakdown();
+    EXPECT_NE(std::string::npos, breakdown.find("\"source_mac\":\"96:52:44:b6:fd:14\""));
+    EXPECT_NE(std::string::npos, breakdown.find("\"DHCP\":{"));
+    EXPECT_EQ(0, session_end.calls);
+
+    session_tracer->end_session(true);
+    ASSERT_EQ(1, session_end.calls);
+    EXPECT_EQ("96:52:44:b6:fd:14", session_end.source_mac);
+    EXPECT_TRUE(session_end.success);
+    EXPECT_NE(std::string::npos, session_end.breakdown.find("\"result\":\"OK\""));
+    EXPECT_NE(std::string::npos, session_end.breakdown.find("\"P2P_FIND\":{\"offset_ms\":"));
+    EXPECT_NE(std::string::npos, session_end.breakdown.find("\"complete\":false"));
+    EXPECT_NE(std::string::npos, session_end.breakdown.find("\"mcc\":true"));
+
+    /* The last completed session stays readable, a second end is ignored */
+    EXPECT_EQ(session_end.breakdown, session_tracer->get_session_breakdown());
+    session_tracer->end_session(false);
+    EXPECT_EQ(1, session_end.calls);
+
+    session_tracer->set_session_end_handler(nullptr, nullptr);
+    session_tracer->begin_session("2a:00:00:00:00:01");
+    session_tracer->end_session(false);
+    EXPECT_EQ(1, session_end.calls);
+    EXPECT_NE(std::string::npos, session_tracer->get_session_breakdown().find("\"result\":\"NOK\""));
+}
+
+TEST_F(MiracastSessionTracerTest, ExportsChromeTrace)
+{
+    char directory[] = "/tmp/MiracastSessionTracerTestXXXXXX";
+    std::stringstream content;
+
+    ASSERT_NE(nullptr, mkdtemp(directory));
+    std::string trace_file = std::string(directory) + "/trace.json";
+
+    EXPECT_FALSE(session_tracer->export_chrome_trace(trace_file));
+
+    session_tracer->begin_session("96:52:44:b6:fd:14");
+    session_tracer->span_begin(MIRACAST_SPAN_RTSP_M1_M7);
+    session_tracer->span_end(MIRACAST_SPAN_RTSP_M1_M7);
+    session_tracer->span_mark(MIRACAST_SPAN_FIRST_VIDEO_FRAME);
+
+    /* The active session can be exported too */
+    ASSERT_TRUE(session_tracer->export_chrome_trace(trace_file));
+    {
+        std::ifstream file(trace_file.c_str());
+        content << file.rdbuf();
+    }
+    EXPECT_EQ(0u, content.str().find("{\"traceEvents\":[{\"name\":\"SESSION 96:52:44:b6:fd:14\",\"ph\":\"X\""));
+    EXPECT_NE(std::string::npos, content.str().find("\"name\":\"RTSP_M1_M7\",\"ph\":\"B\""));
+    EXPECT_NE(std::string::npos, content.str().find("\"name\":\"RTSP_M1_M7\",\"ph\":\"E\""));
+    EXPECT_NE(std::string::npos, content.str().find("\"name\":\"FIRST_VIDEO_FRAME\",\"ph\":\"i\""));
+
+    session_tracer->end_session(true);
+    EXPECT_FALSE(session_tracer->export_chrome_trace(std::string(directory) + "/missing/trace.json"));
+
+    std::remove(trace_file.c_str());
+    rmdir(directory);
+}
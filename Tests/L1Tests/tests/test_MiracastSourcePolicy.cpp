@@ -0,0 +1,202 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "MiracastSourcePolicy.h"
+
+class MiracastSourcePolicyTest : public ::testing::Test
+{
+protected:
+    std::string policyFile;
+    std::string trustFile;
+
+    void SetUp() override
+    {
+        char directory[] = "/tmp/MiracastSourcePolicyTestXXXXXX";
+
+        ASSERT_NE(nullptr, mkdtemp(directory));
+        policyFile = std::string(directory) + "/source_policy";
+        trustFile = std::string(directory) + "/trusted_sources";
+    }
+
+    void TearDown() override
+    {
+        std::remove(policyFile.c_str());
+        std::remove(trustFile.c_str());
+        rmdir(policyFile.substr(0, policyFile.rfind('/')).c_str());
+    }
+
+    /* The policy is reloaded on an mtime change, so each write gets its own mtime */
+    void writePolicy(const std::string &rules, time_t mtime)
+    {
+        struct timespec times[2] = { { mtime, 0 }, { mtime, 0 } };
+        std::ofstream file(policyFile.c_str(), std::ios::trunc);
+
+        file << rules;
+        file.close();
+        ASSERT_EQ(0, utimensat(AT_FDCWD, policyFile.c_str(), times, 0));
+    }
+
+    std::string readTrustFile(void)
+    {
+        std::ifstream file(trustFile.c_str());
+        std::stringstream content;
+
+        content << file.rdbuf();
+        return content.str();
+    }
+};
+
+TEST_F(MiracastSourcePolicyTest, AsksWithoutPolicy)
+{
+    MiracastSourcePolicy policy(policyFile, trustFile);
+    std::string reason;
+
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("96:52:44:b6:fd:14", "Galaxy S23", "10-0050F204-5", reason));
+    EXPECT_EQ("no matching rule", reason);
+
+    /* Without 'trust accepted' nothing is remembered */
+    policy.record_decision("96:52:44:b6:fd:14", "Galaxy S23", true);
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("96:52:44:b6:fd:14", "Galaxy S23", "10-0050F204-5", reason));
+    EXPECT_NE(0, access(trustFile.c_str(), F_OK));
+}
+
+TEST_F(MiracastSourcePolicyTest, FirstMatchingRuleWins)
+{
+    std::string reason;
+
+    writePolicy("# comment\n"
+                "ask mac 96:52:44:b6:7d:14\n"
+                "allow mac 96:52:44:*\n"
+                "allow name Living Room*\n"
+                "allow type 1-0050F204-1\n"
+                "deny mac *\n"
+                "allow colour blue\n"
+                "allow name\n", 1000);
+    MiracastSourcePolicy policy(policyFile, trustFile);
+
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("96:52:44:B6:7D:14", "Galaxy S23", "10-0050F204-5", reason));
+    EXPECT_EQ("ask mac 96:52:44:b6:7d:14", reason);
+
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate("96:52:44:b6:fd:14", "Galaxy S23", "10-0050F204-5", reason));
+    EXPECT_EQ("allow mac 96:52:44:*", reason);
+
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate("2a:00:00:00:00:01", "living room laptop", "", reason));
+    EXPECT_EQ("allow name Living Room*", reason);
+
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate("2a:00:00:00:00:02", "", "1-0050F204-1", reason));
+    EXPECT_EQ("allow type 1-0050F204-1", reason);
+
+    /* The unknown 'deny', 'colour' and pattern-less rules are skipped */
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("2a:00:00:00:00:03", "Kitchen", "10-0050F204-5", reason));
+    EXPECT_EQ("no matching rule", reason);
+}
+
+TEST_F(MiracastSourcePolicyTest, ReloadsTheChangedPolicy)
+{
+    std::string reason;
+
+    writePolicy("allow name Kitchen\n", 1000);
+    MiracastSourcePolicy policy(policyFile, trustFile);
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate("2a:00:00:00:00:03", "Kitchen", "", reason));
+
+    writePolicy("allow name Bedroom\n", 2000);
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("2a:00:00:00:00:03", "Kitchen", "", reason));
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate("2a:00:00:00:00:03", "Bedroom", "", reason));
+
+    std::remove(policyFile.c_str());
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("2a:00:00:00:00:03", "Bedroom", "", reason));
+}
+
+TEST_F(MiracastSourcePolicyTest, TrustedSourcesRoundTrip)
+{
+    std::string reason;
+
+    writePolicy("ask name Guest*\n"
+                "trust accepted\n", 1000);
+    {
+        MiracastSourcePolicy policy(policyFile, trustFile);
+
+        EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("96:52:44:b6:fd:14", "Galaxy|S23", "", reason));
+        policy.record_decision("96:52:44:b6:fd:14", "Galaxy|S23", true);
+        policy.record_decision("2a:00:00:00:00:04", "Guest Phone", true);
+        EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate("96:52:44:B6:FD:14", "Galaxy|S23", "", reason));
+        EXPECT_EQ("trusted source", reason);
+    }
+
+    /* Most recent first, the separator in the name does not break the record */
+    std::string content = readTrustFile();
+    EXPECT_EQ(0u, content.find(MIRACAST_TRUSTED_SOURCES_VERSION "\n2a:00:00:00:00:04|Guest Phone|"));
+    EXPECT_NE(std::string::npos, content.find("\n96:52:44:b6:fd:14|Galaxy S23|"));
+
+    MiracastSourcePolicy reloaded(policyFile, trustFile);
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, reloaded.evaluate("96:52:44:b6:fd:14", "Galaxy S23", "", reason));
+    EXPECT_EQ("trusted source", reason);
+
+    /* Rules still come before the trust list */
+    EXPECT_EQ(SOURCE_POLICY_ASK, reloaded.evaluate("2a:00:00:00:00:04", "Guest Phone", "", reason));
+    EXPECT_EQ("ask name Guest*", reason);
+
+    reloaded.record_decision("96:52:44:b6:fd:14", "Galaxy S23", false);
+    EXPECT_EQ(SOURCE_POLICY_ASK, reloaded.evaluate("96:52:44:b6:fd:14", "Galaxy S23", "", reason));
+    EXPECT_EQ(std::string::npos, readTrustFile().find("96:52:44:b6:fd:14"));
+}
+
+TEST_F(MiracastSourcePolicyTest, TrustListIsBounded)
+{
+    std::string reason;
+    char mac[18] = {0};
+
+    writePolicy("trust accepted\n", 1000);
+    MiracastSourcePolicy policy(policyFile, trustFile);
+
+    for (int index = 0; index <= MIRACAST_TRUSTED_SOURCES_MAX_ENTRIES; ++index)
+    {
+        snprintf(mac, sizeof(mac), "2a:00:00:00:00:%02x", index);
+        policy.record_decision(mac, "Phone", true);
+    }
+
+    /* The oldest trust fell off the end */
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("2a:00:00:00:00:00", "Phone", "", reason));
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate("2a:00:00:00:00:01", "Phone", "", reason));
+    EXPECT_EQ(SOURCE_POLICY_ACCEPT, policy.evaluate(mac, "Phone", "", reason));
+}
+
+TEST_F(MiracastSourcePolicyTest, IgnoresTrustFileWithUnknownVersion)
+{
+    std::string reason;
+
+    writePolicy("trust accepted\n", 1000);
+    {
+        std::ofstream file(trustFile.c_str(), std::ios::trunc);
+        file << "v0\n96:52:44:b6:fd:14|Galaxy S23|1700000000\n";
+    }
+    MiracastSourcePolicy policy(policyFile, trustFile);
+    EXPECT_EQ(SOURCE_POLICY_ASK, policy.evaluate("96:52:44:b6:fd:14", "Galaxy S23", "", reason));
+}
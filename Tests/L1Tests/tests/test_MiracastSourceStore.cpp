@@ -0,0 +1,156 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "MiracastSourceStore.h"
+
+namespace
+{
+    KNOWN_SOURCE knownSource(const std::string &mac, int network_id)
+    {
+        KNOWN_SOURCE source;
+
+        source.device_mac = mac;
+        source.peer_iface = "96:52:44:b6:fd:15";
+        source.device_name = "Galaxy S23";
+        source.persistent_network_id = network_id;
+        source.sink_was_go = false;
+        source.local_ip = "192.168.49.165";
+        source.remote_ip = "192.168.49.1";
+        source.last_connected = 1700000000;
+        return source;
+    }
+}
+
+class MiracastSourceStoreTest : public ::testing::Test
+{
+protected:
+    std::string storeFile;
+
+    void SetUp() override
+    {
+        char directory[] = "/tmp/MiracastSourceStoreTestXXXXXX";
+
+        ASSERT_NE(nullptr, mkdtemp(directory));
+        storeFile = std::string(directory) + "/known_sources";
+    }
+
+    void TearDown() override
+    {
+        std::remove(storeFile.c_str());
+        rmdir(storeFile.substr(0, storeFile.rfind('/')).c_str());
+    }
+};
+
+TEST_F(MiracastSourceStoreTest, RecordedSourceSurvivesReload)
+{
+    KNOWN_SOURCE source = knownSource("96:52:44:b6:fd:14", 3);
+    KNOWN_SOURCE found;
+
+    source.device_name = "Galaxy|S23";
+    {
+        MiracastSourceStore store(storeFile);
+        EXPECT_FALSE(store.find("96:52:44:b6:fd:14", found));
+        store.record(source);
+    }
+
+    MiracastSourceStore store(storeFile);
+    ASSERT_TRUE(store.find("96:52:44:B6:FD:14", found));
+    EXPECT_EQ("96:52:44:b6:fd:15", found.peer_iface);
+    EXPECT_EQ("Galaxy S23", found.device_name);
+    EXPECT_EQ(3, found.persistent_network_id);
+    EXPECT_FALSE(found.sink_was_go);
+    EXPECT_EQ("192.168.49.165", found.local_ip);
+    EXPECT_EQ("192.168.49.1", found.remote_ip);
+    EXPECT_EQ(1700000000u, found.last_connected);
+
+    /* The peer interface address finds the same source */
+    ASSERT_TRUE(store.find("96:52:44:b6:fd:15", found));
+    EXPECT_EQ("96:52:44:b6:fd:14", found.device_mac);
+}
+
+TEST_F(MiracastSourceStoreTest, ForgetPersistentGroupKeepsTheSource)
+{
+    KNOWN_SOURCE found;
+    {
+        MiracastSourceStore store(storeFile);
+        store.record(knownSource("96:52:44:b6:fd:14", 3));
+        store.forget_persistent_group("96:52:44:b6:fd:14");
+    }
+
+    MiracastSourceStore store(storeFile);
+    ASSERT_TRUE(store.find("96:52:44:b6:fd:14", found));
+    EXPECT_EQ(-1, found.persistent_network_id);
+    EXPECT_EQ("192.168.49.165", found.local_ip);
+}
+
+TEST_F(MiracastSourceStoreTest, KeepsTheMostRecentSources)
+{
+    KNOWN_SOURCE found;
+    char mac[18] = {0};
+    MiracastSourceStore store(storeFile);
+
+    for (int index = 0; index <= MIRACAST_SOURCE_STORE_MAX_ENTRIES; ++index)
+    {
+        snprintf(mac, sizeof(mac), "2a:00:00:00:00:%02x", index);
+        KNOWN_SOURCE source = knownSource(mac, index);
+        source.peer_iface.clear();
+        store.record(source);
+    }
+    /* Recording the second oldest again moves it to the front */
+    store.record(knownSource("2a:00:00:00:00:01", 1));
+    snprintf(mac, sizeof(mac), "2a:00:00:00:00:%02x", MIRACAST_SOURCE_STORE_MAX_ENTRIES + 1);
+    KNOWN_SOURCE source = knownSource(mac, 0);
+    source.peer_iface.clear();
+    store.record(source);
+
+    MiracastSourceStore reloaded(storeFile);
+    EXPECT_FALSE(reloaded.find("2a:00:00:00:00:00", found));
+    EXPECT_TRUE(reloaded.find("2a:00:00:00:00:01", found));
+    EXPECT_FALSE(reloaded.find("2a:00:00:00:00:02", found));
+    EXPECT_TRUE(reloaded.find(mac, found));
+}
+
+TEST_F(MiracastSourceStoreTest, SkipsMalformedEntries)
+{
+    KNOWN_SOURCE found;
+    {
+        std::ofstream file(storeFile.c_str(), std::ios::trunc);
+        file << MIRACAST_SOURCE_STORE_VERSION "\n"
+             << "2a:00:00:00:00:01||Phone|2|GO|192.168.49.1|192.168.49.165|1700000000\n"
+             << "2a:00:00:00:00:02||Phone|2|GO|192.168.49.1;reboot|192.168.49.165|1700000000\n"
+             << "2a:00:00:00:00:03|not-a-mac|Phone|2|GO|192.168.49.1|192.168.49.165|1700000000\n"
+             << "2a:00:00:00:00:04||Phone|2|GO\n";
+    }
+
+    MiracastSourceStore store(storeFile);
+    ASSERT_TRUE(store.find("2a:00:00:00:00:01", found));
+    EXPECT_TRUE(found.sink_was_go);
+    EXPECT_EQ(2, found.persistent_network_id);
+    EXPECT_FALSE(store.find("2a:00:00:00:00:02", found));
+    EXPECT_FALSE(store.find("2a:00:00:00:00:03", found));
+    EXPECT_FALSE(store.find("2a:00:00:00:00:04", found));
+}